@@ -1,49 +1,50 @@
-#include <algorithm>
-#include <kiss_fftr.h>
+#include <gsl/assert>
 
 #include <analysis/analysis.hpp>
 
-
-namespace wt::analysis {
+#include <algorithm>
+#include <utility>
 
 
-    FftAnalyzer::FftAnalyzer() : _kiss_cfg{kiss_fftr_alloc(WINDOW_SIZE, 0, nullptr, nullptr)} {}
+namespace wt::analysis {
 
-    FftAnalyzer::~FftAnalyzer() {
-        free(static_cast<kiss_fftr_cfg>(_kiss_cfg));
-    }
+    DynamicFftAnalyzer::DynamicFftAnalyzer(std::size_t size, std::shared_ptr<FftBackend const> const& backend)
+        : _fft{backend->real_float(size)},
+          _buffer(size),
+          _scratch(_fft->scratch_size()) {}
 
-    auto FftAnalyzer::set_preprocessor(processor_func<float> func) -> void {
-        _pre_processor = func;
+    auto DynamicFftAnalyzer::set_preprocessor(preprocessor func) -> void {
+        _pre_processor = std::move(func);
     }
 
-    auto FftAnalyzer::set_postprocessor(processor_func<std::complex<float>, (WINDOW_SIZE / 2) + 1> func) -> void {
-        _post_processor = func;
+    auto DynamicFftAnalyzer::set_postprocessor(postprocessor func) -> void {
+        _post_processor = std::move(func);
     }
 
-    auto FftAnalyzer::analyze(std::array<float, WINDOW_SIZE> const& input)
-        -> std::array<std::complex<float>, (WINDOW_SIZE / 2) + 1> {
-
-        std::array<float, WINDOW_SIZE> buffer = input;
+    auto DynamicFftAnalyzer::analyze(std::span<float const> input, std::span<std::complex<float>> output) -> void {
+        Expects(input.size() == size());
+        Expects(output.size() >= bins());
 
+        // Only a preprocessor needs a copy of its own to modify
+        float const* samples = input.data();
         if (_pre_processor) {
-            (*_pre_processor)(buffer);
+            std::copy(input.begin(), input.end(), _buffer.begin());
+            (*_pre_processor)(_buffer);
+            samples = _buffer.data();
         }
 
-        // Run the actual fft
-        constexpr auto OUTPUT_SIZE = (WINDOW_SIZE / 2) + 1;
-        std::array<kiss_fft_cpx, OUTPUT_SIZE> kiss_output{};
-        kiss_fftr(static_cast<kiss_fftr_cfg>(_kiss_cfg), buffer.data(), kiss_output.data());
-
-        // Convert and return
-        std::array<std::complex<float>, OUTPUT_SIZE> ret{};
-        std::transform(begin(kiss_output), end(kiss_output), begin(ret),
-            [](kiss_fft_cpx in) { return std::complex<float>{in.r, in.i}; });
+        _fft->forward(samples, output.data(), _scratch.data());
 
         if (_post_processor) {
-            (*_post_processor)(ret);
+            (*_post_processor)(output.first(bins()));
         }
+    }
+
+    auto DynamicFftAnalyzer::size() const -> std::size_t {
+        return _fft->size();
+    }
 
-        return ret;
+    auto DynamicFftAnalyzer::bins() const -> std::size_t {
+        return _fft->bins();
     }
 } // namespace wt::analysis
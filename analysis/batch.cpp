@@ -0,0 +1,123 @@
+#include <gsl/assert>
+
+#include <analysis/batch.hpp>
+#include <analysis/hann_window.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+
+namespace wt::analysis {
+
+    namespace {
+        // Windows a worker takes at once, enough to keep the counter cold
+        constexpr std::size_t WINDOW_BATCH = 64;
+
+        // Transforms windows `hop` apart into rows of `spectrogram`, which
+        // hold coefficients or magnitudes
+        template <typename Value>
+        void analyze_windows(RealTransform<float> const& fft, std::span<float const> window,
+            std::span<float const> samples, std::size_t hop, unsigned threads, std::span<Value> spectrogram) {
+            std::size_t const size    = fft.size();
+            std::size_t const bins    = fft.bins();
+            std::size_t const windows = spectrogram.size() / bins;
+
+            std::atomic<std::size_t> next_batch{0};
+            auto worker = [&] {
+                std::vector<float> buffer(size);
+                std::vector<std::complex<float>> scratch(fft.scratch_size());
+                // Magnitudes need the coefficients somewhere first
+                std::vector<std::complex<float>> row(std::is_same_v<Value, float> ? bins : 0);
+
+                while (true) {
+                    std::size_t const first = next_batch.fetch_add(WINDOW_BATCH, std::memory_order_relaxed);
+                    if (first >= windows) {
+                        break;
+                    }
+
+                    std::size_t const last = std::min(first + WINDOW_BATCH, windows);
+                    for (std::size_t i = first; i < last; ++i) {
+                        float const* const input = samples.data() + i * hop;
+                        for (std::size_t j = 0; j < size; ++j) {
+                            buffer[j] = input[j] * window[j];
+                        }
+
+                        if constexpr (std::is_same_v<Value, float>) {
+                            fft.forward(buffer.data(), row.data(), scratch.data());
+                            std::ranges::transform(row, spectrogram.begin() + i * bins,
+                                [](std::complex<float> value) { return std::abs(value); });
+                        } else {
+                            fft.forward(buffer.data(), spectrogram.data() + i * bins, scratch.data());
+                        }
+                    }
+                }
+            };
+
+            // No more workers than batches, the caller is one of them
+            std::size_t const batches = (windows + WINDOW_BATCH - 1) / WINDOW_BATCH;
+            std::size_t const workers = std::clamp<std::size_t>(batches, 1, threads);
+
+            std::vector<std::jthread> pool;
+            pool.reserve(workers - 1);
+            for (std::size_t i = 1; i < workers; ++i) {
+                pool.emplace_back(worker);
+            }
+            worker();
+        }
+    } // namespace
+
+    BatchAnalyzer::BatchAnalyzer(
+        std::size_t window_size, unsigned threads, std::shared_ptr<FftBackend const> const& backend)
+        : BatchAnalyzer{make_hann_coefficients(window_size), threads, backend} {}
+
+    BatchAnalyzer::BatchAnalyzer(
+        std::vector<float> window, unsigned threads, std::shared_ptr<FftBackend const> const& backend)
+        : _window{std::move(window)},
+          _threads{threads},
+          _fft{backend->real_float(_window.size())} {
+        Expects(threads > 0);
+    }
+
+    auto BatchAnalyzer::default_threads() -> unsigned {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    auto BatchAnalyzer::windows(std::size_t samples, std::optional<std::size_t> hop) const -> std::size_t {
+        std::size_t const step = hop.value_or(window_size());
+        Expects(step > 0);
+        return samples < window_size() ? 0 : (samples - window_size()) / step + 1;
+    }
+
+    auto BatchAnalyzer::analyze(std::span<float const> samples, std::span<std::complex<float>> spectrogram,
+        std::optional<std::size_t> hop) const -> void {
+        std::size_t const rows = windows(samples.size(), hop);
+        Expects(spectrogram.size() >= rows * bins());
+
+        analyze_windows(*_fft, _window, samples, hop.value_or(window_size()), _threads,
+            spectrogram.first(rows * bins()));
+    }
+
+    auto BatchAnalyzer::magnitudes(
+        std::span<float const> samples, std::span<float> spectrogram, std::optional<std::size_t> hop) const -> void {
+        std::size_t const rows = windows(samples.size(), hop);
+        Expects(spectrogram.size() >= rows * bins());
+
+        analyze_windows(*_fft, _window, samples, hop.value_or(window_size()), _threads,
+            spectrogram.first(rows * bins()));
+    }
+
+    auto BatchAnalyzer::window_size() const -> std::size_t {
+        return _window.size();
+    }
+
+    auto BatchAnalyzer::bins() const -> std::size_t {
+        return _fft->bins();
+    }
+
+    auto BatchAnalyzer::threads() const -> unsigned {
+        return _threads;
+    }
+} // namespace wt::analysis
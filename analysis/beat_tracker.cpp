@@ -0,0 +1,159 @@
+#include <gsl/assert>
+
+#include <analysis/beat_tracker.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace wt::analysis {
+
+    BeatTracker::BeatTracker(BeatTrackerOptions const& options)
+        : _options{options},
+          _frame_rate{options.sample_rate / static_cast<float>(options.hop)},
+          _min_lag{static_cast<std::size_t>(std::floor(60.0f * _frame_rate / options.max_bpm))},
+          _max_lag{static_cast<std::size_t>(std::ceil(60.0f * _frame_rate / options.min_bpm))},
+          _decay{std::exp(-1.0f / (options.memory_seconds * _frame_rate))},
+          _warmup{static_cast<std::uint64_t>(options.warmup_seconds * _frame_rate)},
+          _correlation(_max_lag + 1),
+          _prior(_max_lag + 1),
+          _centred(2 * _max_lag + 1),
+          _scores(2 * _max_lag + 1),
+          _frame{0},
+          _mean{0.0f},
+          _square{0.0f} {
+        Expects(options.hop > 0);
+        Expects(options.sample_rate > 0);
+        Expects(options.min_bpm > 0 && options.min_bpm < options.max_bpm);
+        Expects(options.prior_bpm > 0);
+        Expects(options.memory_seconds > 0);
+        Expects(_min_lag >= 2);
+
+        // A log normal weight an octave wide around the preferred tempo
+        float const prior_lag = 60.0f * _frame_rate / options.prior_bpm;
+        for (std::size_t lag = _min_lag; lag <= _max_lag; ++lag) {
+            float const octaves = std::log2(static_cast<float>(lag) / prior_lag);
+            _prior[lag]         = std::exp(-0.5f * octaves * octaves);
+        }
+    }
+
+    auto BeatTracker::push(std::uint64_t position, float strength) -> std::optional<BeatEvent> {
+        std::size_t const size = _scores.size();
+
+        if (_frame == 0) {
+            _mean   = strength;
+            _square = strength * strength;
+        } else {
+            _mean += (1.0f - _decay) * (strength - _mean);
+            _square += (1.0f - _decay) * (strength * strength - _square);
+        }
+        float const deviation = std::sqrt(std::max(_square - _mean * _mean, 1e-12f));
+
+        // The autocorrelation of the last `memory_seconds` or so, one new
+        // product per lag
+        float const centred     = strength - _mean;
+        _centred[_frame % size] = centred;
+        for (std::size_t lag = _min_lag; lag <= _max_lag && lag <= _frame; ++lag) {
+            _correlation[lag] = _decay * _correlation[lag] + centred * _centred[(_frame - lag) % size];
+        }
+
+        // The best frame to have had the previous beat on, between half a
+        // period and two back
+        auto const found   = _period();
+        float const period = found.value_or(60.0f * _frame_rate / _options.prior_bpm);
+        auto const lowest  = std::max<std::uint64_t>(1, std::llround(period / 2));
+        auto const highest = std::min<std::uint64_t>(std::llround(period * 2), _frame);
+        double best        = 0.0;
+        for (std::uint64_t back = lowest; back <= highest; ++back) {
+            double const stray = std::log(static_cast<double>(back) / period);
+            best = std::max(best, _scores[(_frame - back) % size] - _options.tightness * stray * stray);
+        }
+        _scores[_frame % size] = strength / deviation + best;
+
+        std::optional<BeatEvent> ret;
+        if (!found) {
+            _next_beat.reset();
+        } else if (_frame + 1 >= _warmup) {
+            if (_next_beat && _frame >= *_next_beat) {
+                // clang-format off
+                ret = BeatEvent{
+                  .position = position,
+                  .seconds  = static_cast<double>(position) / _options.sample_rate,
+                  .bpm      = 60.0f * _frame_rate / period
+                };
+                // clang-format on
+                _next_beat.reset();
+            }
+            if (!_next_beat) {
+                _next_beat = _predict(period);
+            }
+        }
+        ++_frame;
+        return ret;
+    }
+
+    auto BeatTracker::_period() const -> std::optional<float> {
+        std::size_t best_lag = 0;
+        float best           = 0.0f;
+        for (std::size_t lag = _min_lag; lag <= _max_lag; ++lag) {
+            float const weighted = _correlation[lag] * _prior[lag];
+            if (weighted > best) {
+                best     = weighted;
+                best_lag = lag;
+            }
+        }
+        if (best_lag == 0) {
+            return std::nullopt;
+        }
+
+        // The peak of the parabola through the best lag and its neighbours
+        if (best_lag > _min_lag && best_lag < _max_lag) {
+            float const before = _correlation[best_lag - 1] * _prior[best_lag - 1];
+            float const after  = _correlation[best_lag + 1] * _prior[best_lag + 1];
+            float const curve  = before - 2 * best + after;
+            if (curve < 0) {
+                return static_cast<float>(best_lag) + 0.5f * (before - after) / curve;
+            }
+        }
+        return static_cast<float>(best_lag);
+    }
+
+    auto BeatTracker::_predict(float period) const -> std::uint64_t {
+        std::size_t const size = _scores.size();
+        auto const step        = static_cast<std::uint64_t>(std::llround(period));
+        auto const first       = _frame >= step ? _frame - step + 1 : 0;
+
+        std::uint64_t anchor = _frame;
+        for (std::uint64_t frame = first; frame <= _frame; ++frame) {
+            if (_scores[frame % size] > _scores[anchor % size]) {
+                anchor = frame;
+            }
+        }
+
+        // No closer than half a period to the beat just gone
+        std::uint64_t next = anchor + step;
+        while (next < _frame + step / 2) {
+            next += step;
+        }
+        return next;
+    }
+
+    auto BeatTracker::bpm() const -> std::optional<float> {
+        auto const period = _period();
+        if (_frame < _warmup || !period) {
+            return std::nullopt;
+        }
+        return 60.0f * _frame_rate / *period;
+    }
+
+    auto BeatTracker::reset() -> void {
+        std::ranges::fill(_correlation, 0.0f);
+        std::ranges::fill(_centred, 0.0f);
+        std::ranges::fill(_scores, 0.0);
+        _frame  = 0;
+        _mean   = 0.0f;
+        _square = 0.0f;
+        _next_beat.reset();
+    }
+} // namespace wt::analysis
@@ -0,0 +1,166 @@
+#include <gsl/assert>
+
+#include <analysis/constant_q.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+
+namespace wt::analysis {
+
+    namespace {
+        // Start and length of the smallest run of [0, n) holding every
+        // index whose magnitude is at least `floor`, empty for none
+        template <typename Magnitude>
+        std::pair<std::size_t, std::size_t> run_above(std::size_t n, float floor, Magnitude&& magnitude) {
+            std::size_t first = n;
+            std::size_t last  = 0;
+            for (std::size_t j = 0; j < n; ++j) {
+                if (magnitude(j) >= floor) {
+                    first = std::min(first, j);
+                    last  = j;
+                }
+            }
+            return first < n ? std::pair{first, last - first + 1} : std::pair{std::size_t{0}, std::size_t{0}};
+        }
+    } // namespace
+
+    ConstantQ::ConstantQ(ConstantQOptions const& options, std::shared_ptr<FftBackend const> const& backend)
+        : _window_size{options.window_size},
+          _q{static_cast<float>(1.0 / (std::exp2(1.0 / static_cast<double>(options.bins_per_octave)) - 1.0))} {
+        Expects(options.bins_per_octave > 0);
+        Expects(options.window_size >= 2 && options.window_size % 2 == 0);
+        Expects(options.min_hz > 0 && options.min_hz < options.max_hz);
+        Expects(options.max_hz < options.sample_rate / 2);
+        Expects(options.threshold >= 0 && options.threshold < 1);
+
+        std::size_t const size = options.window_size;
+        std::size_t const half = size / 2;
+        auto const per_octave  = static_cast<double>(options.bins_per_octave);
+        double const octaves   = std::log2(static_cast<double>(options.max_hz) / options.min_hz);
+        auto const count       = static_cast<std::size_t>(std::floor(per_octave * octaves)) + 1;
+
+        auto const fft = backend->complex_float(size);
+        std::vector<std::complex<float>> temporal(size);
+        std::vector<std::complex<float>> spectral(size);
+        std::vector<std::complex<float>> scratch(fft->scratch_size());
+
+        _kernels.reserve(count);
+        for (std::size_t k = 0; k < count; ++k) {
+            double const hz   = options.min_hz * std::exp2(static_cast<double>(k) / per_octave);
+            auto const length = std::min(static_cast<std::size_t>(std::ceil(_q * options.sample_rate / hz)), size);
+
+            // The kernel in the middle of the frame, a Hann window summing to
+            // one under a complex sinusoid
+            std::ranges::fill(temporal, std::complex<float>{});
+            std::size_t const start = (size - length) / 2;
+            double const cycle      = 2 * std::numbers::pi * hz / options.sample_rate;
+            for (std::size_t n = 0; n < length; ++n) {
+                auto const at       = static_cast<double>(n);
+                double const hann   = (1.0 - std::cos(2 * std::numbers::pi * at / static_cast<double>(length)))
+                                  / static_cast<double>(length);
+                temporal[start + n] = std::complex<float>{std::polar(hann, cycle * at)};
+            }
+            fft->forward(temporal.data(), spectral.data(), scratch.data());
+
+            // By Parseval the correlation is the sum over the coefficients
+            // of the frame's times the kernel's conjugate, over the size
+            float const peak  = std::abs(*std::ranges::max_element(spectral, {}, [](auto v) { return std::abs(v); }));
+            float const floor = options.threshold * peak;
+            auto const weight = [&](std::size_t j) { return std::conj(spectral[j]) / static_cast<float>(size); };
+
+            Kernel kernel{};
+            kernel.centre_hz = static_cast<float>(hz);
+            kernel.length    = static_cast<std::uint32_t>(length);
+
+            auto const [positive_start, positive_length] =
+                run_above(half + 1, floor, [&](std::size_t j) { return std::abs(spectral[j]); });
+            kernel.positive = {static_cast<std::uint32_t>(positive_start), static_cast<std::uint32_t>(positive_length),
+                static_cast<std::uint32_t>(_weights.size())};
+            for (std::size_t j = positive_start; j < positive_start + positive_length; ++j) {
+                _weights.push_back(weight(j));
+            }
+
+            // Coefficient size - j is the conjugate of coefficient j
+            auto const [negative_start, negative_length] =
+                run_above(half, floor, [&](std::size_t j) { return j == 0 ? 0.0f : std::abs(spectral[size - j]); });
+            kernel.negative = {static_cast<std::uint32_t>(negative_start), static_cast<std::uint32_t>(negative_length),
+                static_cast<std::uint32_t>(_weights.size())};
+            for (std::size_t j = negative_start; j < negative_start + negative_length; ++j) {
+                _weights.push_back(weight(size - j));
+            }
+
+            _kernels.push_back(kernel);
+        }
+    }
+
+    auto ConstantQ::_bin(std::span<std::complex<float> const> spectrum, Kernel const& kernel) const
+        -> std::complex<float> {
+        // Written out, std::complex checks every product for infinities
+        float real = 0.0f;
+        float imag = 0.0f;
+
+        auto const* values  = spectrum.data() + kernel.positive.start;
+        auto const* weights = _weights.data() + kernel.positive.offset;
+        for (std::uint32_t i = 0; i < kernel.positive.length; ++i) {
+            real += values[i].real() * weights[i].real() - values[i].imag() * weights[i].imag();
+            imag += values[i].real() * weights[i].imag() + values[i].imag() * weights[i].real();
+        }
+
+        values  = spectrum.data() + kernel.negative.start;
+        weights = _weights.data() + kernel.negative.offset;
+        for (std::uint32_t i = 0; i < kernel.negative.length; ++i) {
+            real += values[i].real() * weights[i].real() + values[i].imag() * weights[i].imag();
+            imag += values[i].real() * weights[i].imag() - values[i].imag() * weights[i].real();
+        }
+        return {real, imag};
+    }
+
+    auto ConstantQ::transform(std::span<std::complex<float> const> spectrum, std::span<std::complex<float>> output)
+        const -> void {
+        Expects(spectrum.size() >= _window_size / 2 + 1);
+        Expects(output.size() >= _kernels.size());
+
+        for (std::size_t k = 0; k < _kernels.size(); ++k) {
+            output[k] = _bin(spectrum, _kernels[k]);
+        }
+    }
+
+    auto ConstantQ::magnitudes(std::span<std::complex<float> const> spectrum, std::span<float> output) const -> void {
+        Expects(spectrum.size() >= _window_size / 2 + 1);
+        Expects(output.size() >= _kernels.size());
+
+        for (std::size_t k = 0; k < _kernels.size(); ++k) {
+            auto const value = _bin(spectrum, _kernels[k]);
+            output[k]        = std::sqrt(value.real() * value.real() + value.imag() * value.imag());
+        }
+    }
+
+    auto ConstantQ::centre_hz(std::size_t bin) const -> float {
+        Expects(bin < _kernels.size());
+        return _kernels[bin].centre_hz;
+    }
+
+    auto ConstantQ::kernel_length(std::size_t bin) const -> std::size_t {
+        Expects(bin < _kernels.size());
+        return _kernels[bin].length;
+    }
+
+    auto ConstantQ::bins() const -> std::size_t {
+        return _kernels.size();
+    }
+
+    auto ConstantQ::window_size() const -> std::size_t {
+        return _window_size;
+    }
+
+    auto ConstantQ::q() const -> float {
+        return _q;
+    }
+
+    auto ConstantQ::nonzero_weights() const -> std::size_t {
+        return _weights.size();
+    }
+} // namespace wt::analysis
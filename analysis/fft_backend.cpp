@@ -0,0 +1,345 @@
+#include <gsl/assert>
+#include <kiss_fft.h>
+
+#include <analysis/fft_backend.hpp>
+#include <analysis/fft_plan.hpp>
+#include <fourier/fft.h>
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <numbers>
+#include <unordered_map>
+#include <vector>
+
+
+namespace wt::analysis {
+
+    // kissfft is built for float, its buffers are the caller's
+    // std::complex<float> ones
+    static_assert(sizeof(kiss_fft_cpx) == sizeof(std::complex<float>));
+
+    namespace {
+        std::complex<float> multiply(std::complex<float> a, std::complex<float> b) {
+            return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+        }
+
+        void run(kiss_fft_cfg cfg, std::complex<float> const* input, std::complex<float>* output) {
+            kiss_fft(cfg, reinterpret_cast<kiss_fft_cpx const*>(input), reinterpret_cast<kiss_fft_cpx*>(output));
+        }
+
+        // The inverse of the real transforms of one size: the half size
+        // complex inverse and the twiddles that undo the forward split.
+        // Only made once something inverts, and shared like the plans.
+        class KissRealInverse {
+        public:
+            static std::shared_ptr<KissRealInverse const> get(std::size_t size) {
+                static std::mutex mutex;
+                static std::unordered_map<std::size_t, std::shared_ptr<KissRealInverse const>> inverses;
+
+                std::scoped_lock lock{mutex};
+                auto& inverse = inverses[size];
+                if (!inverse) {
+                    inverse = std::make_shared<KissRealInverse const>(size);
+                }
+                return inverse;
+            }
+
+            explicit KissRealInverse(std::size_t size)
+                : _split(size / 2),
+                  _cfg{kiss_fft_alloc(static_cast<int>(size / 2), 1, nullptr, nullptr)} {
+                for (std::size_t k = 0; k < _split.size(); ++k) {
+                    double const phase = -2 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(size);
+                    _split[k]          = {static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase))};
+                }
+            }
+
+            ~KissRealInverse() {
+                kiss_fft_free(_cfg);
+            }
+
+            KissRealInverse(KissRealInverse const&)            = delete;
+            KissRealInverse& operator=(KissRealInverse const&) = delete;
+
+            void inverse(std::complex<float> const* input, float* output, std::complex<float>* scratch) const {
+                // Undoes the plan's split into the spectrum of the even
+                // samples plus i times the odd ones, whose half size inverse
+                // is the samples in pairs
+                std::size_t const half = _split.size();
+                for (std::size_t k = 0; k < half; ++k) {
+                    auto const mirror = std::conj(input[half - k]);
+                    auto const even   = input[k] + mirror;
+                    auto const odd    = multiply(input[k] - mirror, std::conj(_split[k]));
+                    scratch[k]        = {even.real() - odd.imag(), even.imag() + odd.real()};
+                }
+                run(_cfg, scratch, reinterpret_cast<std::complex<float>*>(output));
+            }
+
+        private:
+            std::vector<std::complex<float>> _split;
+            kiss_fft_cfg _cfg;
+        };
+
+        class KissRealFloat : public RealTransform<float> {
+        public:
+            explicit KissRealFloat(std::size_t size) : _plan{FftPlan::get(size)} {}
+
+            void forward(float const* input, std::complex<float>* output, std::complex<float>* scratch) const override {
+                _plan->forward(input, output, scratch);
+            }
+
+            void inverse(std::complex<float> const* input, float* output, std::complex<float>* scratch) const override {
+                std::call_once(_inverse_made, [this] { _inverse = KissRealInverse::get(size()); });
+                _inverse->inverse(input, output, scratch);
+            }
+
+            [[nodiscard]] std::size_t size() const override {
+                return _plan->size();
+            }
+
+            [[nodiscard]] std::size_t scratch_size() const override {
+                return _plan->size() / 2;
+            }
+
+        private:
+            std::shared_ptr<FftPlan const> _plan;
+            mutable std::once_flag _inverse_made;
+            mutable std::shared_ptr<KissRealInverse const> _inverse;
+        };
+
+        // The double transforms lay their float buffers out in the
+        // caller's scratch, `size()` doubles' worth is room for the input,
+        // the float transform's scratch and the output
+
+        class KissRealDouble : public RealTransform<double> {
+        public:
+            explicit KissRealDouble(std::size_t size) : _float{size} {}
+
+            void forward(double const* input, std::complex<double>* output, std::complex<double>* scratch) const override {
+                std::size_t const size = _float.size();
+                auto* const samples    = reinterpret_cast<float*>(scratch);
+                auto* const half       = reinterpret_cast<std::complex<float>*>(samples + size);
+                auto* const bins       = half + _float.scratch_size();
+
+                std::copy(input, input + size, samples);
+                _float.forward(samples, bins, half);
+                std::copy(bins, bins + this->bins(), output);
+            }
+
+            void inverse(std::complex<double> const* input, double* output, std::complex<double>* scratch) const override {
+                std::size_t const size = _float.size();
+                auto* const bins       = reinterpret_cast<std::complex<float>*>(scratch);
+                auto* const half       = bins + this->bins();
+                auto* const samples    = reinterpret_cast<float*>(half + _float.scratch_size());
+
+                std::copy(input, input + this->bins(), bins);
+                _float.inverse(bins, samples, half);
+                std::copy(samples, samples + size, output);
+            }
+
+            [[nodiscard]] std::size_t size() const override {
+                return _float.size();
+            }
+
+            [[nodiscard]] std::size_t scratch_size() const override {
+                return _float.size();
+            }
+
+        private:
+            KissRealFloat _float;
+        };
+
+        class KissComplexFloat : public ComplexTransform<float> {
+        public:
+            explicit KissComplexFloat(std::size_t size)
+                : _size{size},
+                  _forward_cfg{kiss_fft_alloc(static_cast<int>(size), 0, nullptr, nullptr)},
+                  _inverse_cfg{kiss_fft_alloc(static_cast<int>(size), 1, nullptr, nullptr)} {
+                Expects(size >= 1);
+            }
+
+            ~KissComplexFloat() override {
+                kiss_fft_free(_forward_cfg);
+                kiss_fft_free(_inverse_cfg);
+            }
+
+            KissComplexFloat(KissComplexFloat const&)            = delete;
+            KissComplexFloat& operator=(KissComplexFloat const&) = delete;
+
+            // kissfft only writes to its config when the input and output
+            // are the same buffer, which they never are here
+            void forward(std::complex<float> const* input, std::complex<float>* output,
+                std::complex<float>* /*scratch*/) const override {
+                run(_forward_cfg, input, output);
+            }
+
+            void inverse(std::complex<float> const* input, std::complex<float>* output,
+                std::complex<float>* /*scratch*/) const override {
+                run(_inverse_cfg, input, output);
+            }
+
+            [[nodiscard]] std::size_t size() const override {
+                return _size;
+            }
+
+            [[nodiscard]] std::size_t scratch_size() const override {
+                return 0;
+            }
+
+        private:
+            std::size_t _size;
+            kiss_fft_cfg _forward_cfg;
+            kiss_fft_cfg _inverse_cfg;
+        };
+
+        class KissComplexDouble : public ComplexTransform<double> {
+        public:
+            explicit KissComplexDouble(std::size_t size) : _float{size} {}
+
+            void forward(std::complex<double> const* input, std::complex<double>* output,
+                std::complex<double>* scratch) const override {
+                _convert<false>(input, output, scratch);
+            }
+
+            void inverse(std::complex<double> const* input, std::complex<double>* output,
+                std::complex<double>* scratch) const override {
+                _convert<true>(input, output, scratch);
+            }
+
+            [[nodiscard]] std::size_t size() const override {
+                return _float.size();
+            }
+
+            [[nodiscard]] std::size_t scratch_size() const override {
+                return _float.size();
+            }
+
+        private:
+            template <bool Inverse>
+            void _convert(
+                std::complex<double> const* input, std::complex<double>* output, std::complex<double>* scratch) const {
+                std::size_t const size = _float.size();
+                auto* const from       = reinterpret_cast<std::complex<float>*>(scratch);
+                auto* const to         = from + size;
+
+                std::copy(input, input + size, from);
+                if constexpr (Inverse) {
+                    _float.inverse(from, to, nullptr);
+                } else {
+                    _float.forward(from, to, nullptr);
+                }
+                std::copy(to, to + size, output);
+            }
+
+            KissComplexFloat _float;
+        };
+
+        template <typename T>
+        class FourierReal : public RealTransform<T> {
+        public:
+            explicit FourierReal(std::size_t size) : _fft{size} {}
+
+            void forward(T const* input, std::complex<T>* output, std::complex<T>* scratch) const override {
+                _fft.forward(input, output, scratch);
+            }
+
+            void inverse(std::complex<T> const* input, T* output, std::complex<T>* scratch) const override {
+                _fft.inverse(input, output, scratch);
+            }
+
+            [[nodiscard]] std::size_t size() const override {
+                return _fft.size();
+            }
+
+            [[nodiscard]] std::size_t scratch_size() const override {
+                return _fft.size() / 2;
+            }
+
+        private:
+            ft::RealFft<T> _fft;
+        };
+
+        template <typename T>
+        class FourierComplex : public ComplexTransform<T> {
+        public:
+            explicit FourierComplex(std::size_t size) : _fft{size} {}
+
+            void forward(
+                std::complex<T> const* input, std::complex<T>* output, std::complex<T>* /*scratch*/) const override {
+                _fft.forward(input, output);
+            }
+
+            void inverse(
+                std::complex<T> const* input, std::complex<T>* output, std::complex<T>* /*scratch*/) const override {
+                _fft.inverse(input, output);
+            }
+
+            [[nodiscard]] std::size_t size() const override {
+                return _fft.size();
+            }
+
+            [[nodiscard]] std::size_t scratch_size() const override {
+                return 0;
+            }
+
+        private:
+            ft::Fft<T> _fft;
+        };
+    } // namespace
+
+    auto KissFftBackend::name() const -> std::string_view {
+        return "kissfft";
+    }
+
+    auto KissFftBackend::real_float(std::size_t size) const -> std::shared_ptr<RealTransform<float> const> {
+        return std::make_shared<KissRealFloat const>(size);
+    }
+
+    auto KissFftBackend::real_double(std::size_t size) const -> std::shared_ptr<RealTransform<double> const> {
+        return std::make_shared<KissRealDouble const>(size);
+    }
+
+    auto KissFftBackend::complex_float(std::size_t size) const -> std::shared_ptr<ComplexTransform<float> const> {
+        return std::make_shared<KissComplexFloat const>(size);
+    }
+
+    auto KissFftBackend::complex_double(std::size_t size) const -> std::shared_ptr<ComplexTransform<double> const> {
+        return std::make_shared<KissComplexDouble const>(size);
+    }
+
+    auto FourierFftBackend::name() const -> std::string_view {
+        return "wt::ft";
+    }
+
+    auto FourierFftBackend::real_float(std::size_t size) const -> std::shared_ptr<RealTransform<float> const> {
+        return std::make_shared<FourierReal<float> const>(size);
+    }
+
+    auto FourierFftBackend::real_double(std::size_t size) const -> std::shared_ptr<RealTransform<double> const> {
+        return std::make_shared<FourierReal<double> const>(size);
+    }
+
+    auto FourierFftBackend::complex_float(std::size_t size) const -> std::shared_ptr<ComplexTransform<float> const> {
+        return std::make_shared<FourierComplex<float> const>(size);
+    }
+
+    auto FourierFftBackend::complex_double(std::size_t size) const
+        -> std::shared_ptr<ComplexTransform<double> const> {
+        return std::make_shared<FourierComplex<double> const>(size);
+    }
+
+    auto default_fft_backend() -> std::shared_ptr<FftBackend const> {
+        static auto const backend = std::make_shared<KissFftBackend const>();
+        return backend;
+    }
+
+    auto fft_backend_from_string(std::string_view name) -> std::shared_ptr<FftBackend const> {
+        if (name == "kissfft") {
+            return default_fft_backend();
+        }
+        if (name == "fourier") {
+            return std::make_shared<FourierFftBackend const>();
+        }
+        return nullptr;
+    }
+} // namespace wt::analysis
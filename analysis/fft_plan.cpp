@@ -0,0 +1,83 @@
+#include <gsl/assert>
+#include <kiss_fft.h>
+
+#include <analysis/fft_plan.hpp>
+
+#include <cmath>
+#include <mutex>
+#include <numbers>
+#include <unordered_map>
+
+
+namespace wt::analysis {
+
+    // Both are a pair of floats, so kissfft can work on the caller's buffers
+    static_assert(sizeof(kiss_fft_cpx) == sizeof(std::complex<float>));
+
+    namespace {
+        // The complex product without the checks for infinities that
+        // std::complex does on every multiply
+        std::complex<float> multiply(std::complex<float> a, std::complex<float> b) {
+            return {a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real()};
+        }
+    } // namespace
+
+    auto FftPlan::get(std::size_t size) -> std::shared_ptr<FftPlan const> {
+        // Plans are few and small, they live as long as the process
+        static std::mutex mutex;
+        static std::unordered_map<std::size_t, std::shared_ptr<FftPlan const>> plans;
+
+        std::scoped_lock lock{mutex};
+        auto& plan = plans[size];
+        if (!plan) {
+            plan = std::make_shared<FftPlan const>(size);
+        }
+        return plan;
+    }
+
+    FftPlan::FftPlan(std::size_t size)
+        : _size{size},
+          _twiddles(size / 4),
+          _kiss_cfg{kiss_fft_alloc(static_cast<int>(size / 2), 0, nullptr, nullptr)} {
+        Expects(size >= 2 && size % 2 == 0);
+
+        // The same twiddles kiss_fftr splits the half size transform with
+        auto const half = static_cast<double>(size / 2);
+        for (std::size_t i = 0; i < _twiddles.size(); ++i) {
+            double const phase = -std::numbers::pi * (static_cast<double>(i + 1) / half + 0.5);
+            _twiddles[i]       = {static_cast<float>(std::cos(phase)), static_cast<float>(std::sin(phase))};
+        }
+    }
+
+    FftPlan::~FftPlan() {
+        kiss_fft_free(_kiss_cfg);
+    }
+
+    auto FftPlan::forward(float const* input, std::complex<float>* output, std::complex<float>* scratch) const
+        -> void {
+        // The even samples as the real parts and the odd ones as the
+        // imaginary parts make a complex signal of half the length
+        std::size_t const half = _size / 2;
+        kiss_fft(static_cast<kiss_fft_cfg>(_kiss_cfg), reinterpret_cast<kiss_fft_cpx const*>(input),
+            reinterpret_cast<kiss_fft_cpx*>(scratch));
+
+        auto const dc = scratch[0];
+        output[0]     = {dc.real() + dc.imag(), 0.0f};
+        output[half]  = {dc.real() - dc.imag(), 0.0f};
+
+        for (std::size_t k = 1; k <= half / 2; ++k) {
+            auto const even  = scratch[k] + std::conj(scratch[half - k]);
+            auto const odd   = multiply(scratch[k] - std::conj(scratch[half - k]), _twiddles[k - 1]);
+            output[k]        = (even + odd) * 0.5f;
+            output[half - k] = std::conj(even - odd) * 0.5f;
+        }
+    }
+
+    auto FftPlan::size() const -> std::size_t {
+        return _size;
+    }
+
+    auto FftPlan::bins() const -> std::size_t {
+        return _size / 2 + 1;
+    }
+} // namespace wt::analysis
@@ -0,0 +1,179 @@
+#include <gsl/assert>
+
+#include <analysis/filterbank.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+
+namespace wt::analysis {
+
+    namespace {
+        // Where `hz` lies on the scale, the bands are evenly spaced in these
+        // units. Bark is Traunmüller's approximation.
+        double to_scale(BandScale scale, double hz) {
+            switch (scale) {
+            case BandScale::log:
+                return std::log2(hz);
+            case BandScale::mel:
+                return 2595.0 * std::log10(1.0 + hz / 700.0);
+            case BandScale::bark:
+                return 26.81 * hz / (1960.0 + hz) - 0.53;
+            default:
+                return hz;
+            }
+        }
+
+        double from_scale(BandScale scale, double value) {
+            switch (scale) {
+            case BandScale::log:
+                return std::exp2(value);
+            case BandScale::mel:
+                return 700.0 * (std::pow(10.0, value / 2595.0) - 1.0);
+            case BandScale::bark:
+                return 1960.0 * (value + 0.53) / (26.28 - value);
+            default:
+                return value;
+            }
+        }
+    } // namespace
+
+    auto band_scale_from_string(std::string_view name) -> std::optional<BandScale> {
+        for (auto const scale : {BandScale::linear, BandScale::log, BandScale::mel, BandScale::bark}) {
+            if (name == to_string(scale)) {
+                return scale;
+            }
+        }
+        return std::nullopt;
+    }
+
+    auto to_string(BandScale scale) -> std::string_view {
+        switch (scale) {
+        case BandScale::log:
+            return "log";
+        case BandScale::mel:
+            return "mel";
+        case BandScale::bark:
+            return "bark";
+        default:
+            return "linear";
+        }
+    }
+
+    Filterbank::Filterbank(FilterbankOptions const& options) : _bins{options.bins} {
+        Expects(options.bands > 0);
+        Expects(options.bins >= 2);
+        Expects(options.sample_rate > 0);
+        Expects(options.low_hz >= 0 && (options.low_hz > 0 || options.scale != BandScale::log));
+
+        double const nyquist = options.sample_rate / 2.0;
+        double const bin_hz  = nyquist / static_cast<double>(options.bins - 1);
+        double const high_hz = std::min<double>(options.high_hz, nyquist);
+        Expects(options.low_hz < high_hz);
+
+        // Band b rises from point b, peaks at point b + 1 and falls to
+        // point b + 2
+        double const low  = to_scale(options.scale, options.low_hz);
+        double const step = (to_scale(options.scale, high_hz) - low) / static_cast<double>(options.bands + 1);
+
+        _bands.reserve(options.bands);
+        _centres_hz.reserve(options.bands);
+        std::vector<float> weights;
+        for (std::size_t b = 0; b < options.bands; ++b) {
+            double const left      = low + step * static_cast<double>(b);
+            double const centre    = left + step;
+            double const right     = centre + step;
+            double const centre_hz = from_scale(options.scale, centre);
+            _centres_hz.push_back(static_cast<float>(centre_hz));
+
+            auto const first = static_cast<std::size_t>(std::ceil(from_scale(options.scale, left) / bin_hz));
+            auto const last  = std::min(
+                static_cast<std::size_t>(std::floor(from_scale(options.scale, right) / bin_hz)), options.bins - 1);
+
+            std::size_t start = first;
+            weights.clear();
+            for (std::size_t k = first; k <= last; ++k) {
+                double const at     = to_scale(options.scale, static_cast<double>(k) * bin_hz);
+                double const weight = at <= centre ? (at - left) / step : (right - at) / step;
+                if (weight <= 0) {
+                    // Only the ends of the run can be outside the triangle
+                    if (weights.empty()) {
+                        start = k + 1;
+                    }
+                    continue;
+                }
+                weights.push_back(static_cast<float>(weight));
+            }
+
+            // Narrower than a bin, so no bin falls inside
+            if (weights.empty()) {
+                double const position = std::min(centre_hz / bin_hz, static_cast<double>(options.bins - 1));
+                start                 = static_cast<std::size_t>(position);
+                auto const fraction   = static_cast<float>(position - static_cast<double>(start));
+                weights.push_back(1.0f - fraction);
+                if (start + 1 < options.bins) {
+                    weights.push_back(fraction);
+                }
+            }
+
+            float const total = std::accumulate(weights.begin(), weights.end(), 0.0f);
+            for (auto& weight : weights) {
+                weight /= total;
+            }
+
+            // clang-format off
+            _bands.push_back(Band{
+              .start  = static_cast<std::uint32_t>(start),
+              .length = static_cast<std::uint32_t>(weights.size()),
+              .offset = static_cast<std::uint32_t>(_weights.size())
+            });
+            // clang-format on
+            _weights.insert(_weights.end(), weights.begin(), weights.end());
+        }
+    }
+
+    auto Filterbank::apply(std::span<float const> spectrum, std::span<float> bands) const -> void {
+        Expects(bands.size() >= _bands.size());
+        std::fill_n(bands.begin(), _bands.size(), 0.0f);
+        accumulate(spectrum, bands);
+    }
+
+    auto Filterbank::accumulate(std::span<float const> spectrum, std::span<float> bands) const -> void {
+        Expects(spectrum.size() >= _bins);
+        Expects(bands.size() >= _bands.size());
+
+        for (std::size_t b = 0; b < _bands.size(); ++b) {
+            auto const& band           = _bands[b];
+            float const* const values  = spectrum.data() + band.start;
+            float const* const weights = _weights.data() + band.offset;
+
+            float total = 0.0f;
+            for (std::uint32_t i = 0; i < band.length; ++i) {
+                total += values[i] * weights[i];
+            }
+            bands[b] += total;
+        }
+    }
+
+    auto Filterbank::clear(std::vector<float>& bands) const -> void {
+        bands.assign(_bands.size(), 0.0f);
+    }
+
+    auto Filterbank::centre_hz(std::size_t band) const -> float {
+        Expects(band < _centres_hz.size());
+        return _centres_hz[band];
+    }
+
+    auto Filterbank::bands() const -> std::size_t {
+        return _bands.size();
+    }
+
+    auto Filterbank::bins() const -> std::size_t {
+        return _bins;
+    }
+
+    auto Filterbank::nonzero_weights() const -> std::size_t {
+        return _weights.size();
+    }
+} // namespace wt::analysis
@@ -1,16 +1,24 @@
 #ifndef WT_ANALYSIS_H
 #define WT_ANALYSIS_H
 
+#include <analysis/fft_backend.hpp>
+#include <analysis/window_size.hpp>
+
+#include <gsl/assert>
+
+#include <algorithm>
 #include <array>
 #include <complex>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <span>
+#include <vector>
 
 namespace wt::analysis {
-    // Assume that our window size in frames is
-    // 1024 per channel, 2 channels
-    constexpr int WINDOW_SIZE = 2048;
+
+    // Most channels the batched analysis takes, enough for 7.1
+    constexpr std::size_t MAX_CHANNELS = 8;
 
     /**
      * @brief TODO
@@ -18,10 +26,19 @@ namespace wt::analysis {
     template <typename T, std::size_t N = WINDOW_SIZE>
     using processor_func = std::function<void(std::array<T, N>&)>;
 
+    /**
+     * @brief FFT analysis of windows of `Size` samples, with the real FFT
+     * of the backend it is made with. Each only owns its scratch.
+     */
+    template <std::size_t Size = WINDOW_SIZE>
     class FftAnalyzer {
+        static_assert(Size >= 2 && Size % 2 == 0, "the window size must be even");
+
     public:
-        FftAnalyzer();
-        ~FftAnalyzer();
+        static constexpr std::size_t BINS = (Size / 2) + 1;
+
+        /// @param backend where the FFT comes from, kissfft unless given.
+        explicit FftAnalyzer(std::shared_ptr<FftBackend const> const& backend = default_fft_backend());
 
         /**
          * @brief Will actually analyse the data. If post & pre
@@ -31,8 +48,31 @@ namespace wt::analysis {
          * @return the buffer of complex coefficients for the analysed
          * data.
         */
-        std::array<std::complex<float>, (WINDOW_SIZE / 2) + 1> analyze(std::array<float, WINDOW_SIZE> const& input);
+        std::array<std::complex<float>, BINS> analyze(std::array<float, Size> const& input);
 
+        /**
+         * @brief Analyses one window per channel in a single call, writing
+         * each channel's coefficients straight into `outputs`. The pre &
+         * post processing functions run on every channel.
+         * @param inputs the deinterleaved window of each channel, at most
+         * `MAX_CHANNELS` of them.
+         * @param outputs the coefficients of each channel, as many as there
+         * are inputs.
+         */
+        void analyze(
+            std::span<std::array<float, Size> const> inputs, std::span<std::array<std::complex<float>, BINS>> outputs);
+
+        /**
+         * @brief Analyses one window from the caller's samples straight
+         * into the caller's coefficients, neither has to be an array.
+         *
+         * Without processors the FFT reads `input` where it lies and writes
+         * `output` where it lies, nothing is copied. Each processor set
+         * costs one copy, into the analyzer's own buffer it can modify.
+         * @param input `Size` samples.
+         * @param output room for `BINS` coefficients.
+         */
+        void analyze(std::span<float const> input, std::span<std::complex<float>> output);
 
         /**
          * @brief sets the function for pre-processing the data
@@ -40,7 +80,7 @@ namespace wt::analysis {
          * for the window data and able to modify it in place.
          * @param func the processor function, see `processor_func`.
         */
-        void set_preprocessor(processor_func<float> func);
+        void set_preprocessor(processor_func<float, Size> func);
 
         /**
          * @brief sets the function for post-processting the data
@@ -49,14 +89,137 @@ namespace wt::analysis {
          * should modify the data inplace.
          * @param fun the processor function, see `processor_func`.
          */
-        void set_postprocessor(processor_func<std::complex<float>, (WINDOW_SIZE / 2) + 1> function);
+        void set_postprocessor(processor_func<std::complex<float>, BINS> function);
 
     private:
-        std::optional<processor_func<std::complex<float>, (WINDOW_SIZE / 2) + 1>> _post_processor;
-        std::optional<processor_func<float>> _pre_processor;
+        // The samples for the FFT to read: the input itself, or the
+        // buffer holding it preprocessed
+        float const* _prepare(std::span<float const> input);
+
+        // Runs the input through the processors and the FFT into `output`
+        void _transform(std::array<float, Size> const& input, std::array<std::complex<float>, BINS>& output);
+
+        std::optional<processor_func<std::complex<float>, BINS>> _post_processor;
+        std::optional<processor_func<float, Size>> _pre_processor;
 
-        void* _kiss_cfg;
+        std::shared_ptr<RealTransform<float> const> _fft;
+        std::unique_ptr<std::array<float, Size>> _buffer;
+        std::unique_ptr<std::array<std::complex<float>, BINS>> _spectrum;
+        std::vector<std::complex<float>> _scratch;
     };
+
+    /**
+     * @brief FFT analysis of windows of a size picked at run time, so one
+     * build can trade latency for resolution.
+     */
+    class DynamicFftAnalyzer {
+    public:
+        using preprocessor  = std::function<void(std::span<float>)>;
+        using postprocessor = std::function<void(std::span<std::complex<float>>)>;
+
+        /// @param size samples per window, even and at least 2.
+        /// @param backend where the FFT comes from, kissfft unless given.
+        explicit DynamicFftAnalyzer(
+            std::size_t size, std::shared_ptr<FftBackend const> const& backend = default_fft_backend());
+
+        /**
+         * @brief Analyses one window, running the pre & post processing
+         * functions if they are set.
+         * @param input `size()` samples.
+         * @param output room for `bins()` coefficients.
+         */
+        void analyze(std::span<float const> input, std::span<std::complex<float>> output);
+
+        void set_preprocessor(preprocessor func);
+        void set_postprocessor(postprocessor func);
+
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] std::size_t bins() const;
+
+    private:
+        std::optional<preprocessor> _pre_processor;
+        std::optional<postprocessor> _post_processor;
+
+        std::shared_ptr<RealTransform<float> const> _fft;
+        std::vector<float> _buffer;
+        std::vector<std::complex<float>> _scratch;
+    };
+
+    template <std::size_t Size>
+    FftAnalyzer<Size>::FftAnalyzer(std::shared_ptr<FftBackend const> const& backend)
+        : _fft{backend->real_float(Size)},
+          _buffer{std::make_unique<std::array<float, Size>>()},
+          _spectrum{std::make_unique<std::array<std::complex<float>, BINS>>()},
+          _scratch(_fft->scratch_size()) {}
+
+    template <std::size_t Size>
+    auto FftAnalyzer<Size>::set_preprocessor(processor_func<float, Size> func) -> void {
+        _pre_processor = func;
+    }
+
+    template <std::size_t Size>
+    auto FftAnalyzer<Size>::set_postprocessor(processor_func<std::complex<float>, BINS> func) -> void {
+        _post_processor = func;
+    }
+
+    template <std::size_t Size>
+    auto FftAnalyzer<Size>::_prepare(std::span<float const> input) -> float const* {
+        if (!_pre_processor) {
+            return input.data();
+        }
+
+        auto& buffer = *_buffer;
+        std::copy(input.begin(), input.end(), buffer.begin());
+        (*_pre_processor)(buffer);
+        return buffer.data();
+    }
+
+    template <std::size_t Size>
+    auto FftAnalyzer<Size>::_transform(
+        std::array<float, Size> const& input, std::array<std::complex<float>, BINS>& output) -> void {
+        _fft->forward(_prepare(input), output.data(), _scratch.data());
+
+        if (_post_processor) {
+            (*_post_processor)(output);
+        }
+    }
+
+    template <std::size_t Size>
+    auto FftAnalyzer<Size>::analyze(std::span<float const> input, std::span<std::complex<float>> output) -> void {
+        Expects(input.size() == Size);
+        Expects(output.size() >= BINS);
+
+        if (!_post_processor) {
+            _fft->forward(_prepare(input), output.data(), _scratch.data());
+            return;
+        }
+
+        // The postprocessor takes an array, which the caller's span may not be
+        auto& spectrum = *_spectrum;
+        _fft->forward(_prepare(input), spectrum.data(), _scratch.data());
+        (*_post_processor)(spectrum);
+        std::copy(spectrum.begin(), spectrum.end(), output.begin());
+    }
+
+    template <std::size_t Size>
+    auto FftAnalyzer<Size>::analyze(std::array<float, Size> const& input) -> std::array<std::complex<float>, BINS> {
+        std::array<std::complex<float>, BINS> ret;
+        _transform(input, ret);
+        return ret;
+    }
+
+    template <std::size_t Size>
+    auto FftAnalyzer<Size>::analyze(std::span<std::array<float, Size> const> inputs,
+        std::span<std::array<std::complex<float>, BINS>> outputs) -> void {
+        Expects(inputs.size() <= MAX_CHANNELS);
+        Expects(inputs.size() == outputs.size());
+
+        // Every channel goes through the same scratch, nothing is returned
+        // by value
+        for (std::size_t channel = 0; channel < inputs.size(); ++channel) {
+            _transform(inputs[channel], outputs[channel]);
+        }
+    }
 } // namespace wt::analysis
 
 #endif // WT_ANALYSIS_H
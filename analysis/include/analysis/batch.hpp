@@ -0,0 +1,78 @@
+#ifndef WT_ANALYSIS_BATCH_H
+#define WT_ANALYSIS_BATCH_H
+
+#include <analysis/fft_backend.hpp>
+#include <analysis/window_size.hpp>
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace wt::analysis {
+
+    /**
+     * @brief Analyses every window of a block of samples at once, spread
+     * over worker threads, into one contiguous spectrogram.
+     *
+     * Windows start every `hop` samples from the start of the block, back
+     * to back if no hop is given. Row `i` of the spectrogram holds the
+     * `bins()` values of window `i`, and rows are stored back to back.
+     * Workers take batches of windows off a shared counter and each
+     * window has its own row, so the result does not depend on the
+     * thread count.
+     *
+     * Every worker owns its buffer and scratch for the whole call. The
+     * transform is immutable, so workers share it instead of each making
+     * a copy.
+     */
+    class BatchAnalyzer {
+    public:
+        /**
+         * @brief Hann windowed analysis.
+         * @param window_size samples per window, even.
+         * @param threads workers per call, the calling thread included.
+         * @param backend where the FFT comes from, kissfft unless given.
+         */
+        explicit BatchAnalyzer(std::size_t window_size = WINDOW_SIZE, unsigned threads = default_threads(),
+            std::shared_ptr<FftBackend const> const& backend = default_fft_backend());
+
+        /**
+         * @brief Analysis with a window of the caller's.
+         * @param window multiplied into every window before it is
+         * transformed, its size is the window size.
+         */
+        BatchAnalyzer(std::vector<float> window, unsigned threads,
+            std::shared_ptr<FftBackend const> const& backend = default_fft_backend());
+
+        /// @brief One worker per core, or one if the core count is unknown.
+        [[nodiscard]] static unsigned default_threads();
+
+        /// @brief Whole windows in a block of `samples` samples.
+        [[nodiscard]] std::size_t windows(std::size_t samples, std::optional<std::size_t> hop = std::nullopt) const;
+
+        /**
+         * @brief Transforms every window of `samples`.
+         * @param spectrogram room for `windows(samples.size(), hop)` rows.
+         */
+        void analyze(std::span<float const> samples, std::span<std::complex<float>> spectrogram,
+            std::optional<std::size_t> hop = std::nullopt) const;
+
+        /// @brief The same, keeping only the magnitude of each coefficient.
+        void magnitudes(std::span<float const> samples, std::span<float> spectrogram,
+            std::optional<std::size_t> hop = std::nullopt) const;
+
+        [[nodiscard]] std::size_t window_size() const;
+        [[nodiscard]] std::size_t bins() const;
+        [[nodiscard]] unsigned threads() const;
+
+    private:
+        std::vector<float> _window;
+        unsigned _threads;
+        std::shared_ptr<RealTransform<float> const> _fft;
+    };
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_BATCH_H
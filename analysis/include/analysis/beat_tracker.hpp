@@ -0,0 +1,116 @@
+#ifndef WT_ANALYSIS_BEAT_TRACKER_H
+#define WT_ANALYSIS_BEAT_TRACKER_H
+
+#include <analysis/stft.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace wt::analysis {
+
+    /// @brief A beat, on time with the frame it falls in.
+    struct BeatEvent {
+        /// @brief Stream position of the frame, as given to `push`.
+        std::uint64_t position;
+        double seconds;
+
+        /// @brief The tempo the beat was predicted with.
+        float bpm;
+    };
+
+    struct BeatTrackerOptions {
+        /// @brief Frames of audio from one analysis frame to the next.
+        std::size_t hop{THREE_QUARTER_OVERLAP};
+
+        float sample_rate{48000.0f};
+
+        /// @brief The tempos to look for, and the one to prefer, which
+        /// settles between a tempo and its double or half.
+        float min_bpm{60.0f};
+        float max_bpm{200.0f};
+        float prior_bpm{120.0f};
+
+        /// @brief How long the tempo estimate remembers, it follows a change
+        /// of tempo over about this long.
+        float memory_seconds{8.0f};
+
+        /// @brief Audio to hear before the first beat.
+        float warmup_seconds{4.0f};
+
+        /// @brief How strongly beats keep to the tempo rather than the
+        /// onsets.
+        float tightness{100.0f};
+    };
+
+    /**
+     * @brief Streaming tempo and beat tracker over an onset strength per
+     * analysis frame, such as `OnsetDetector::strength()`.
+     *
+     * The tempo is the lag with the strongest autocorrelation of the onset
+     * strength, weighted towards `prior_bpm`. The autocorrelation decays
+     * rather than being recomputed, so each frame adds one product per lag.
+     *
+     * The beats follow Ellis' dynamic programming tracker run forwards: a
+     * frame scores its onset strength plus the best score about a beat
+     * period back, less a penalty for straying from the period. After each
+     * beat the next is predicted a period after the best scoring frame of
+     * the last period, and emitted on the frame it falls in, so beats come
+     * on time rather than after the fact.
+     *
+     * Nothing repeating, such as silence, has no tempo and no beats.
+     *
+     * A frame costs O(lags), a few hundred operations, and the tracker holds
+     * only two beat periods of history.
+     */
+    class BeatTracker {
+    public:
+        explicit BeatTracker(BeatTrackerOptions const& options = {});
+
+        /**
+         * @brief Takes the next frame's onset strength.
+         * @param position stream position to stamp the frame with.
+         * @return a beat on this frame, if any.
+         */
+        std::optional<BeatEvent> push(std::uint64_t position, float strength);
+
+        /// @brief The tempo, once warmed up and while there is one.
+        [[nodiscard]] std::optional<float> bpm() const;
+
+        /// @brief Forgets the frames so far, for a jump in the stream.
+        void reset();
+
+    private:
+        // Beat period in frames, interpolated between lags, none while the
+        // strength does not repeat
+        [[nodiscard]] std::optional<float> _period() const;
+
+        // The frame of the beat after the current frame's, a period after
+        // the best scoring frame of the last period
+        [[nodiscard]] std::uint64_t _predict(float period) const;
+
+        BeatTrackerOptions _options;
+        float _frame_rate;
+        std::size_t _min_lag;
+        std::size_t _max_lag;
+        float _decay;
+        std::uint64_t _warmup;
+
+        // Autocorrelation and tempo weight per lag, from 0 to `_max_lag`
+        std::vector<float> _correlation;
+        std::vector<float> _prior;
+
+        // Centred strengths and beat scores of the last frames, frame t at
+        // t % size
+        std::vector<float> _centred;
+        std::vector<double> _scores;
+
+        std::uint64_t _frame;
+        float _mean;
+        float _square;
+        std::optional<std::uint64_t> _next_beat;
+    };
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_BEAT_TRACKER_H
@@ -0,0 +1,117 @@
+#ifndef WT_ANALYSIS_CONSTANT_Q_H
+#define WT_ANALYSIS_CONSTANT_Q_H
+
+#include <analysis/fft_backend.hpp>
+#include <analysis/window_size.hpp>
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace wt::analysis {
+
+    struct ConstantQOptions {
+        /// @brief Bins per octave, 12 for semitones, 24 or 48 to see
+        /// between them.
+        std::size_t bins_per_octave{12};
+
+        /// @brief Centre of the lowest bin, the next are a
+        /// `1 / bins_per_octave` octave apart up to `max_hz`.
+        float min_hz{55.0f};
+        float max_hz{16000.0f};
+
+        float sample_rate{48000.0f};
+
+        /// @brief Samples per transformed frame. The lowest bins need
+        /// `Q * sample_rate / min_hz` samples to be truly constant Q, those
+        /// that would need more than this are cut to it and come out wider.
+        std::size_t window_size{WINDOW_SIZE * 4};
+
+        /// @brief Kernel coefficients smaller than this fraction of the
+        /// kernel's largest are left out, trading accuracy for work.
+        float threshold{0.005f};
+    };
+
+    /**
+     * @brief Constant-Q transform, bins evenly spaced in pitch, each as
+     * many cycles long as the others.
+     *
+     * Bin k correlates the frame with a Hann windowed complex sinusoid at
+     * its centre frequency, `Q` cycles long. That correlation is worked out
+     * from the frame's FFT rather than the samples: the FFT of every such
+     * kernel is worked out once, and being a narrow peak, only the run of
+     * coefficients around it above `threshold` is kept. A frame then costs
+     * one complex multiply-add per kept coefficient, `nonzero_weights()`,
+     * the same every frame, on top of the FFT it shares with everything
+     * else.
+     *
+     * The spectra must be of unwindowed frames, the kernels have their own
+     * windows. For streaming, transform the frames of an `Stft` made with
+     * a flat window of `window_size()` ones.
+     *
+     * A sine of amplitude A at a bin's centre comes out at about A / 2.
+     */
+    class ConstantQ {
+    public:
+        /// @param backend where the FFT that makes the kernels comes from,
+        /// kissfft unless given.
+        explicit ConstantQ(
+            ConstantQOptions const& options, std::shared_ptr<FftBackend const> const& backend = default_fft_backend());
+
+        /**
+         * @brief The constant-Q coefficients of one frame.
+         * @param spectrum the frame's `window_size() / 2 + 1` FFT
+         * coefficients.
+         * @param output room for `bins()` coefficients.
+         */
+        void transform(std::span<std::complex<float> const> spectrum, std::span<std::complex<float>> output) const;
+
+        /// @brief The magnitudes of `transform`.
+        void magnitudes(std::span<std::complex<float> const> spectrum, std::span<float> output) const;
+
+        /// @brief Centre frequency of `bin`.
+        [[nodiscard]] float centre_hz(std::size_t bin) const;
+
+        /// @brief Samples in the kernel of `bin`, fewer for higher bins.
+        [[nodiscard]] std::size_t kernel_length(std::size_t bin) const;
+
+        [[nodiscard]] std::size_t bins() const;
+        [[nodiscard]] std::size_t window_size() const;
+        [[nodiscard]] float q() const;
+
+        /// @brief Kernel coefficients kept across all bins, the work per
+        /// frame.
+        [[nodiscard]] std::size_t nonzero_weights() const;
+
+    private:
+        // A run of `length` coefficients from `start`, each multiplied by
+        // the weight at `offset` on
+        struct Run {
+            std::uint32_t start;
+            std::uint32_t length;
+            std::uint32_t offset;
+        };
+
+        // The kernel of a low bin reaches into the negative frequencies,
+        // which a real frame's spectrum holds as the conjugates of the
+        // positive ones, so those are a second run over the conjugates
+        struct Kernel {
+            Run positive;
+            Run negative;
+            float centre_hz;
+            std::uint32_t length;
+        };
+
+        std::complex<float> _bin(std::span<std::complex<float> const> spectrum, Kernel const& kernel) const;
+
+        std::size_t _window_size;
+        float _q;
+        std::vector<Kernel> _kernels;
+        std::vector<std::complex<float>> _weights;
+    };
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_CONSTANT_Q_H
@@ -0,0 +1,161 @@
+#ifndef WT_ANALYSIS_FFT_BACKEND_H
+#define WT_ANALYSIS_FFT_BACKEND_H
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+namespace wt::analysis {
+
+    /**
+     * @brief A real FFT of one size from some backend.
+     *
+     * Transforms are immutable once made, so any number of threads can run
+     * one at once, each with its own scratch.
+     */
+    template <typename T>
+    class RealTransform {
+    public:
+        virtual ~RealTransform() = default;
+
+        /**
+         * @brief Transforms `size()` samples into `bins()` coefficients.
+         * @param scratch room for `scratch_size()` values, the caller's own.
+         */
+        virtual void forward(T const* input, std::complex<T>* output, std::complex<T>* scratch) const = 0;
+
+        /**
+         * @brief Transforms `bins()` coefficients back into `size()`
+         * samples, without the 1 / size scaling, so the inverse of the
+         * forward transform is the input times `size()`.
+         * @param scratch room for `scratch_size()` values, the caller's own.
+         */
+        virtual void inverse(std::complex<T> const* input, T* output, std::complex<T>* scratch) const = 0;
+
+        [[nodiscard]] virtual std::size_t size() const = 0;
+
+        /// @brief Scratch values the transforms need, either way.
+        [[nodiscard]] virtual std::size_t scratch_size() const = 0;
+
+        [[nodiscard]] std::size_t bins() const {
+            return size() / 2 + 1;
+        }
+    };
+
+    /// @brief A complex FFT of one size from some backend, as `RealTransform`.
+    template <typename T>
+    class ComplexTransform {
+    public:
+        virtual ~ComplexTransform() = default;
+
+        /// @brief Transforms `size()` values, `input` and `output` must not
+        /// overlap.
+        virtual void forward(std::complex<T> const* input, std::complex<T>* output, std::complex<T>* scratch) const = 0;
+
+        /// @brief The inverse, without the 1 / size scaling.
+        virtual void inverse(std::complex<T> const* input, std::complex<T>* output, std::complex<T>* scratch) const = 0;
+
+        [[nodiscard]] virtual std::size_t size() const = 0;
+        [[nodiscard]] virtual std::size_t scratch_size() const = 0;
+    };
+
+    /**
+     * @brief Makes the FFTs for the analysis, so the library the transforms
+     * come from can be picked without touching what runs them.
+     *
+     * Each call makes a new transform, keep it rather than asking again per
+     * window. A backend is immutable and can be shared between threads.
+     */
+    class FftBackend {
+    public:
+        virtual ~FftBackend() = default;
+
+        [[nodiscard]] virtual std::string_view name() const = 0;
+
+        /// @param size samples per transform, even and at least 2, and any
+        /// further restriction the backend has.
+        [[nodiscard]] virtual std::shared_ptr<RealTransform<float> const> real_float(std::size_t size) const = 0;
+        [[nodiscard]] virtual std::shared_ptr<RealTransform<double> const> real_double(std::size_t size) const = 0;
+
+        /// @param size values per transform, at least 1, and any further
+        /// restriction the backend has.
+        [[nodiscard]] virtual std::shared_ptr<ComplexTransform<float> const> complex_float(
+            std::size_t size) const = 0;
+        [[nodiscard]] virtual std::shared_ptr<ComplexTransform<double> const> complex_double(
+            std::size_t size) const = 0;
+
+        /// @brief `real_float` or `real_double`, for code templated on the
+        /// precision.
+        template <typename T>
+        [[nodiscard]] std::shared_ptr<RealTransform<T> const> real(std::size_t size) const {
+            static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "FFTs are float or double");
+            if constexpr (std::is_same_v<T, float>) {
+                return real_float(size);
+            } else {
+                return real_double(size);
+            }
+        }
+
+        template <typename T>
+        [[nodiscard]] std::shared_ptr<ComplexTransform<T> const> complex(std::size_t size) const {
+            static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "FFTs are float or double");
+            if constexpr (std::is_same_v<T, float>) {
+                return complex_float(size);
+            } else {
+                return complex_double(size);
+            }
+        }
+    };
+
+    /**
+     * @brief Transforms from kissfft, any size.
+     *
+     * kissfft is built for one scalar type, float. The float transforms run
+     * on the caller's buffers, the double ones convert to float and back
+     * through the scratch, so they have float's precision. The real forward
+     * transform is the shared `FftPlan` of its size, and its inverse is
+     * made the first time one is run, shared between transforms likewise.
+     */
+    class KissFftBackend : public FftBackend {
+    public:
+        [[nodiscard]] std::string_view name() const override;
+
+        [[nodiscard]] std::shared_ptr<RealTransform<float> const> real_float(std::size_t size) const override;
+        [[nodiscard]] std::shared_ptr<RealTransform<double> const> real_double(std::size_t size) const override;
+        [[nodiscard]] std::shared_ptr<ComplexTransform<float> const> complex_float(
+            std::size_t size) const override;
+        [[nodiscard]] std::shared_ptr<ComplexTransform<double> const> complex_double(
+            std::size_t size) const override;
+    };
+
+    /**
+     * @brief Transforms from the in-tree `wt::ft` radix-2 FFT, natively at
+     * either precision.
+     *
+     * Complex sizes must be powers of two and real sizes twice one, any
+     * other throws `std::invalid_argument`.
+     */
+    class FourierFftBackend : public FftBackend {
+    public:
+        [[nodiscard]] std::string_view name() const override;
+
+        [[nodiscard]] std::shared_ptr<RealTransform<float> const> real_float(std::size_t size) const override;
+        [[nodiscard]] std::shared_ptr<RealTransform<double> const> real_double(std::size_t size) const override;
+        [[nodiscard]] std::shared_ptr<ComplexTransform<float> const> complex_float(
+            std::size_t size) const override;
+        [[nodiscard]] std::shared_ptr<ComplexTransform<double> const> complex_double(
+            std::size_t size) const override;
+    };
+
+    /// @brief The backend analyzers use unless given one, kissfft.
+    std::shared_ptr<FftBackend const> default_fft_backend();
+
+    /// @brief A backend by the name the user knows it by, "kissfft" or
+    /// "fourier" for the in-tree FFT.
+    /// @return the backend, or nullptr for any other name.
+    std::shared_ptr<FftBackend const> fft_backend_from_string(std::string_view name);
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_FFT_BACKEND_H
@@ -0,0 +1,53 @@
+#ifndef WT_ANALYSIS_FFT_PLAN_H
+#define WT_ANALYSIS_FFT_PLAN_H
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace wt::analysis {
+
+    /**
+     * @brief An immutable real FFT of one size: the complex plan of half
+     * the size and the twiddles that split its output into the real
+     * transform's.
+     *
+     * Nothing in a plan changes once it is made, so any number of threads
+     * can run one at once, each with its own scratch. Plans come from a
+     * process-wide cache, every analyzer of a size shares one.
+     */
+    class FftPlan {
+    public:
+        /**
+         * @brief The cached plan for `size`, made on first use. Thread safe.
+         * @param size samples per transform, even and at least 2.
+         */
+        static std::shared_ptr<FftPlan const> get(std::size_t size);
+
+        explicit FftPlan(std::size_t size);
+        ~FftPlan();
+
+        FftPlan(FftPlan const&)            = delete;
+        FftPlan& operator=(FftPlan const&) = delete;
+
+        /**
+         * @brief Transforms `size()` real samples into `bins()` coefficients,
+         * the same as kissfft's real transform.
+         * @param input the samples.
+         * @param output where the coefficients go.
+         * @param scratch room for `size() / 2` values, the caller's own.
+         */
+        void forward(float const* input, std::complex<float>* output, std::complex<float>* scratch) const;
+
+        [[nodiscard]] std::size_t size() const;
+        [[nodiscard]] std::size_t bins() const;
+
+    private:
+        std::size_t _size;
+        std::vector<std::complex<float>> _twiddles;
+        void* _kiss_cfg;
+    };
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_FFT_PLAN_H
@@ -0,0 +1,99 @@
+#ifndef WT_ANALYSIS_FILTERBANK_H
+#define WT_ANALYSIS_FILTERBANK_H
+
+#include <analysis/window_size.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace wt::analysis {
+
+    /// @brief How the bands of a filterbank are spaced in frequency.
+    enum class BandScale { linear, log, mel, bark };
+
+    /// @brief The scale named `name`, as `to_string` spells it.
+    std::optional<BandScale> band_scale_from_string(std::string_view name);
+
+    std::string_view to_string(BandScale scale);
+
+    struct FilterbankOptions {
+        BandScale scale{BandScale::log};
+
+        /// @brief Bands to split the spectrum into.
+        std::size_t bands{100};
+
+        /// @brief Coefficients per spectrum, half the window size plus one.
+        std::size_t bins{WINDOW_SIZE / 2 + 1};
+
+        /// @brief Rate of the analysed audio, which fixes each bin's frequency.
+        float sample_rate{48000.0f};
+
+        /// @brief The frequencies the bands span, the top clamped to Nyquist.
+        float low_hz{20.0f};
+        float high_hz{20000.0f};
+    };
+
+    /**
+     * @brief Groups the bins of a spectrum into bands evenly spaced on a
+     * linear, log, mel or Bark scale.
+     *
+     * Each band is a triangle on the scale, rising from the centre of the
+     * band below to its own centre and falling to the centre of the band
+     * above, with weights summing to one so a band is a weighted mean of
+     * its bins. A band narrower than a bin, as the lowest log bands are,
+     * interpolates between the two bins either side of its centre rather
+     * than coming out empty.
+     *
+     * The weights are worked out once. Each band keeps only the run of
+     * bins it covers, as a start, a length and an offset into one array
+     * of weights, so applying the bank costs one multiply-add per nonzero
+     * weight, about two per bin, whatever the band count.
+     */
+    class Filterbank {
+    public:
+        using result_type = std::vector<float>;
+
+        explicit Filterbank(FilterbankOptions const& options);
+
+        /**
+         * @brief The bands of `spectrum`.
+         * @param spectrum `bins()` magnitudes, or any per bin value.
+         * @param bands room for `bands()` values.
+         */
+        void apply(std::span<float const> spectrum, std::span<float> bands) const;
+
+        /// @brief Adds the bands of `spectrum` onto `bands`, summing the
+        /// channels of a frame this way sums their bands.
+        void accumulate(std::span<float const> spectrum, std::span<float> bands) const;
+
+        /// @brief Sizes `bands` for `accumulate` and empties it.
+        void clear(std::vector<float>& bands) const;
+
+        /// @brief Frequency of the peak of `band`.
+        [[nodiscard]] float centre_hz(std::size_t band) const;
+
+        [[nodiscard]] std::size_t bands() const;
+        [[nodiscard]] std::size_t bins() const;
+
+        /// @brief Weights stored across all bands.
+        [[nodiscard]] std::size_t nonzero_weights() const;
+
+    private:
+        struct Band {
+            std::uint32_t start;
+            std::uint32_t length;
+            std::uint32_t offset;
+        };
+
+        std::size_t _bins;
+        std::vector<Band> _bands;
+        std::vector<float> _weights;
+        std::vector<float> _centres_hz;
+    };
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_FILTERBANK_H
@@ -1,25 +1,25 @@
 #ifndef WT_ANALYSIS_HANN_WINDOW_H
 #define WT_ANALYSIS_HANN_WINDOW_H
 
+#include <analysis/windows.hpp>
+
 #include <array>
-#include <cmath>
+#include <cstddef>
+#include <vector>
 
 namespace wt::analysis {
 
+    /// @brief A copy of the Hann table, see `windows.hpp`.
     template <std::size_t Size>
-    std::array<float, Size> make_hann_coefficients() {
+    constexpr std::array<float, Size> make_hann_coefficients() {
         static_assert(Size > 0, "hann coefficient array must have more than 0 items!");
+        return WINDOW_TABLE<Hann, Size>.coefficients;
+    }
 
-        constexpr float TWO_PI = 6.28318530718;
-
-        std::array<float, Size> ret{};
-        
-        for (std::size_t i = 0; i < Size; ++i) {
-            ret[i] = 0.5f * (1 - std::cos((i * TWO_PI) / static_cast<float>(Size - 1)));
-        }
-
-        return ret;
+    /// @brief The same coefficients for a size picked at run time.
+    inline std::vector<float> make_hann_coefficients(std::size_t size) {
+        return make_window<Hann>(size);
     }
 }
 
-#endif // WT_ANALYSIS_HANN_WINDOW_H
\ No newline at end of file
+#endif // WT_ANALYSIS_HANN_WINDOW_H
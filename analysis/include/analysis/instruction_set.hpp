@@ -0,0 +1,18 @@
+#ifndef WT_ANALYSIS_INSTRUCTION_SET_H
+#define WT_ANALYSIS_INSTRUCTION_SET_H
+
+#include <string_view>
+
+namespace wt::kernels {
+
+    /// @brief The instruction sets the kernels have implementations for,
+    /// each a superset of the one before.
+    enum class InstructionSet { scalar, sse2, avx2, avx512 };
+
+    /// @brief The widest instruction set this CPU and OS support.
+    InstructionSet detect_instruction_set();
+
+    std::string_view to_string(InstructionSet instruction_set);
+} // namespace wt::kernels
+
+#endif // WT_ANALYSIS_INSTRUCTION_SET_H
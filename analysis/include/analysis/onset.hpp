@@ -0,0 +1,111 @@
+#ifndef WT_ANALYSIS_ONSET_H
+#define WT_ANALYSIS_ONSET_H
+
+#include <analysis/stft.hpp>
+#include <analysis/window_size.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace wt::analysis {
+
+    /// @brief A note or hit starting.
+    struct OnsetEvent {
+        /// @brief Stream position of the frame it was found in, as given to
+        /// `push`.
+        std::uint64_t position;
+        double seconds;
+
+        /// @brief The frame's spectral flux, how sudden it was.
+        float strength;
+    };
+
+    struct OnsetOptions {
+        /// @brief Coefficients per frame.
+        std::size_t bins{WINDOW_SIZE / 2 + 1};
+
+        float sample_rate{48000.0f};
+
+        /// @brief Magnitudes are compressed as `log(1 + compression * m)`,
+        /// so quiet parts count nearly as much as loud ones.
+        float compression{100.0f};
+
+        /// @brief Analysis frames the adaptive threshold averages over.
+        std::size_t threshold_frames{16};
+
+        /// @brief How far above the average flux a peak has to be, as a
+        /// ratio and as an absolute floor for near silence.
+        float threshold_ratio{1.5f};
+        float threshold_floor{0.001f};
+
+        /// @brief Shortest gap between two onsets.
+        float min_gap_seconds{0.05f};
+    };
+
+    /**
+     * @brief Streaming spectral flux onset detector.
+     *
+     * Each frame's flux is how much its compressed magnitudes rose since the
+     * frame before, summed over the bins and averaged. A frame is an onset
+     * when its flux is a peak, above the frames either side, and over the
+     * average of the frames before it by `threshold_ratio`. Telling a peak
+     * needs the next frame, so onsets come a frame late, stamped with their
+     * own frame's position.
+     *
+     * A frame costs O(bins), and the detector holds only the last frame's
+     * magnitudes and `threshold_frames` fluxes.
+     */
+    class OnsetDetector {
+    public:
+        explicit OnsetDetector(OnsetOptions const& options = {});
+
+        /**
+         * @brief Takes the next frame's magnitudes.
+         * @param position stream position to stamp the frame with.
+         * @param magnitudes `bins()` magnitudes, a full scale sine about one.
+         * @return the onset found in the frame before, if any.
+         */
+        std::optional<OnsetEvent> push(std::uint64_t position, std::span<float const> magnitudes);
+
+        /// @brief Takes the next frame of an `Stft`, the magnitudes of its
+        /// channels summed and scaled to the window size.
+        std::optional<OnsetEvent> push(std::uint64_t position, StftFrame const& frame);
+
+        /// @brief Flux of the latest frame, the onset strength to track beats
+        /// with.
+        [[nodiscard]] float strength() const;
+
+        /// @brief Forgets the frames so far, for a jump in the stream.
+        void reset();
+
+        [[nodiscard]] std::size_t bins() const;
+
+    private:
+        OnsetOptions _options;
+        std::uint64_t _min_gap;
+
+        std::vector<float> _previous;
+        std::vector<float> _magnitudes;
+        bool _primed;
+
+        // The last `threshold_frames` fluxes, oldest at `_head`
+        std::vector<float> _fluxes;
+        std::size_t _head;
+        std::size_t _count;
+
+        // The two frames before this one, the candidate peak the latest
+        struct Frame {
+            std::uint64_t position;
+            float flux;
+            float threshold;
+        };
+        std::optional<Frame> _before;
+        std::optional<Frame> _candidate;
+        std::optional<std::uint64_t> _last_onset;
+    };
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_ONSET_H
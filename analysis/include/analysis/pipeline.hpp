@@ -0,0 +1,359 @@
+#ifndef WT_ANALYSIS_PIPELINE_H
+#define WT_ANALYSIS_PIPELINE_H
+
+#include <analysis/fft_backend.hpp>
+#include <analysis/spectrum_kernels.hpp>
+#include <analysis/window_size.hpp>
+#include <analysis/windows.hpp>
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace wt::analysis {
+
+    /// @brief A stage run on every sample as it is copied in for the FFT,
+    /// such as a window.
+    template <typename Stage>
+    concept SampleStage = requires(Stage const& stage, std::size_t index, float sample) {
+        { stage.sample(index, sample) } -> std::convertible_to<float>;
+    };
+
+    /// @brief The stage that turns each coefficient into one value, such
+    /// as its magnitude. A pipeline has at most one, the magnitude if none.
+    template <typename Stage>
+    concept DetectStage = requires(Stage const& stage, std::complex<float> coefficient) {
+        { stage.detect(coefficient) } -> std::convertible_to<float>;
+    };
+
+    /// @brief A detection the spectrum kernels have a vector version of,
+    /// which runs fused with a weighting.
+    template <typename Stage>
+    concept KernelDetectStage = DetectStage<Stage> && requires {
+        { Stage::KERNEL } -> std::convertible_to<decltype(&wt::kernels::SpectrumKernels::magnitude)>;
+    };
+
+    /// @brief A stage run on every detected bin, such as a weighting.
+    template <typename Stage>
+    concept BinStage = requires(Stage const& stage, std::size_t bin, float value) {
+        { stage.bin(bin, value) } -> std::convertible_to<float>;
+    };
+
+    /// @brief The last stage, which gathers the bins into its own result one
+    /// at a time, such as fewer, wider bands. Without one the result is
+    /// every bin.
+    template <typename Stage>
+    concept ReduceStage =
+        requires(Stage const& stage, typename Stage::result_type& result, std::size_t bin, float value) {
+            stage.clear(result);
+            stage.add(result, bin, value);
+        };
+
+    /// @brief A last stage that gathers a whole row of bins at once, such
+    /// as a `Filterbank`, for reductions that are not one bin at a time.
+    template <typename Stage>
+    concept RowReduceStage =
+        requires(Stage const& stage, typename Stage::result_type& result, std::span<float const> row) {
+            stage.clear(result);
+            stage.accumulate(row, result);
+        };
+
+    /// @brief Multiplies the samples by a window.
+    template <std::size_t Size>
+    struct Windowing {
+        std::array<float, Size> coefficients;
+
+        [[nodiscard]] float sample(std::size_t index, float sample) const {
+            return sample * coefficients[index];
+        }
+    };
+
+    /// @brief Windowing with one of the tables in `windows.hpp`.
+    template <typename Window, std::size_t Size>
+    Windowing<Size> windowing() {
+        return Windowing<Size>{WINDOW_TABLE<Window, Size>.coefficients};
+    }
+
+    template <std::size_t Size>
+    Windowing<Size> hann_windowing() {
+        return windowing<Hann, Size>();
+    }
+
+    struct Magnitude {
+        static constexpr auto KERNEL = &wt::kernels::SpectrumKernels::magnitude;
+
+        [[nodiscard]] float detect(std::complex<float> coefficient) const {
+            return std::sqrt(coefficient.real() * coefficient.real() + coefficient.imag() * coefficient.imag());
+        }
+    };
+
+    /// @brief The squared magnitude, which saves the square root.
+    struct Power {
+        static constexpr auto KERNEL = &wt::kernels::SpectrumKernels::power;
+
+        [[nodiscard]] float detect(std::complex<float> coefficient) const {
+            return coefficient.real() * coefficient.real() + coefficient.imag() * coefficient.imag();
+        }
+    };
+
+    /// @brief Multiplies every bin by its own gain.
+    template <std::size_t Bins>
+    struct Weighting {
+        std::array<float, Bins> gains;
+
+        [[nodiscard]] float bin(std::size_t bin, float value) const {
+            return value * gains[bin];
+        }
+    };
+
+    template <typename Stage>
+    constexpr bool IS_WEIGHTING = false;
+
+    template <std::size_t Bins>
+    constexpr bool IS_WEIGHTING<Weighting<Bins>> = true;
+
+    /// @brief Averages runs of `Bins / Bands` neighbouring bins into
+    /// `Bands` bands, leaving out the bins past the last whole run.
+    template <std::size_t Bins, std::size_t Bands>
+    struct LinearBinning {
+        static_assert(Bins >= Bands, "cannot make more bands than there are bins");
+        static constexpr std::size_t WIDTH = Bins / Bands;
+
+        using result_type = std::array<float, Bands>;
+
+        void clear(result_type& result) const {
+            result.fill(0.0f);
+        }
+
+        void add(result_type& result, std::size_t bin, float value) const {
+            if (bin < Bands * WIDTH) {
+                result[bin / WIDTH] += value / WIDTH;
+            }
+        }
+    };
+
+    /// @brief The samples a sample stage is sized for, 0 for any.
+    template <typename Stage>
+    constexpr std::size_t STAGE_SAMPLES = 0;
+
+    template <std::size_t Size>
+    constexpr std::size_t STAGE_SAMPLES<Windowing<Size>> = Size;
+
+    /// @brief The bins a bin or reduce stage is sized for, 0 for any.
+    template <typename Stage>
+    constexpr std::size_t STAGE_BINS = 0;
+
+    template <std::size_t Bins>
+    constexpr std::size_t STAGE_BINS<Weighting<Bins>> = Bins;
+
+    template <std::size_t Bins, std::size_t Bands>
+    constexpr std::size_t STAGE_BINS<LinearBinning<Bins, Bands>> = Bins;
+
+    /**
+     * @brief Window, FFT, detection, weighting and binning composed at
+     * compile time into a single pass each side of the FFT.
+     *
+     * Every stage is a plain object the compiler sees through: the sample
+     * stages run in the copy the FFT reads from, and detection, the bin
+     * stages and the reduction run in one loop over the coefficients.
+     * No stage is called through a pointer, only the FFT of the backend
+     * the pipeline is made with, and nothing is allocated after
+     * construction. Stages of each kind run in the order given.
+     *
+     * A `Magnitude` or `Power` whose only bin stage is a `Weighting` runs
+     * as one of the spectrum kernels instead, vectorised for the CPU, see
+     * `SpectrumKernels` for how close that is to the scalar stages.
+     *
+     * `FftAnalyzer` with its processor functions stays for anything
+     * picked at run time.
+     */
+    template <std::size_t Size, typename... Stages>
+    class Pipeline {
+        static_assert(Size >= 2 && Size % 2 == 0, "the window size must be even");
+        static_assert((static_cast<std::size_t>(DetectStage<Stages>) + ... + 0) <= 1,
+            "a pipeline detects the coefficients once");
+        static_assert(((STAGE_SAMPLES<Stages> == 0 || STAGE_SAMPLES<Stages> == Size) && ...),
+            "a windowing must be as long as the pipeline's window");
+        static_assert(((STAGE_BINS<Stages> == 0 || STAGE_BINS<Stages> == Size / 2 + 1) && ...),
+            "a weighting or binning must be sized for the pipeline's bins");
+
+        // The last stage, or void for none
+        using Last = std::tuple_element_t<sizeof...(Stages), std::tuple<void, Stages...>>;
+
+    public:
+        static constexpr std::size_t BINS = (Size / 2) + 1;
+        static constexpr bool ROW_REDUCES = RowReduceStage<Last>;
+        static constexpr bool REDUCES     = ReduceStage<Last> || ROW_REDUCES;
+        static constexpr bool USES_KERNEL = (static_cast<int>(KernelDetectStage<Stages>) + ... + 0) == 1
+                                         && (static_cast<int>(BinStage<Stages>) + ... + 0) == 1
+                                         && (static_cast<int>(IS_WEIGHTING<Stages>) + ... + 0) == 1;
+
+        using result_type = typename decltype([] {
+            if constexpr (REDUCES) {
+                return std::type_identity<typename Last::result_type>{};
+            } else {
+                return std::type_identity<std::array<float, BINS>>{};
+            }
+        }())::type;
+
+        explicit Pipeline(Stages... stages) : Pipeline{default_fft_backend(), std::move(stages)...} {}
+
+        /// @param backend where the FFT `run` does comes from.
+        explicit Pipeline(std::shared_ptr<FftBackend const> const& backend, Stages... stages)
+            : _stages{std::move(stages)...},
+              _fft{backend->real_float(Size)},
+              _buffer(Size),
+              _spectrum(BINS),
+              _scratch(_fft->scratch_size()),
+              _kernels{&wt::kernels::spectrum_kernels()},
+              _row(USES_KERNEL || ROW_REDUCES ? BINS : 0) {}
+
+        /// @brief Runs every stage over one window into `result`.
+        void run(std::span<float const, Size> input, result_type& result) {
+            for (std::size_t i = 0; i < Size; ++i) {
+                _buffer[i] = _sample(i, input[i]);
+            }
+            _fft->forward(_buffer.data(), _spectrum.data(), _scratch.data());
+
+            clear(result);
+            accumulate(std::span<std::complex<float> const, BINS>{_spectrum.data(), BINS}, result);
+        }
+
+        /// @brief Empties the result, for `accumulate` to add to.
+        void clear(result_type& result) const {
+            if constexpr (REDUCES) {
+                std::get<sizeof...(Stages) - 1>(_stages).clear(result);
+            } else {
+                result.fill(0.0f);
+            }
+        }
+
+        /// @brief Runs the stages after the FFT over coefficients computed
+        /// elsewhere, adding them onto `result`. Adding up the channels of
+        /// a frame this way sums their bands.
+        void accumulate(std::span<std::complex<float> const, BINS> spectrum, result_type& result) {
+            if constexpr (USES_KERNEL) {
+                _detect_weighted(spectrum);
+            } else if constexpr (ROW_REDUCES) {
+                for (std::size_t k = 0; k < BINS; ++k) {
+                    _row[k] = _bin(k, _detect(spectrum[k]));
+                }
+            }
+
+            if constexpr (ROW_REDUCES) {
+                std::get<sizeof...(Stages) - 1>(_stages).accumulate(std::span<float const>{_row}, result);
+            } else {
+                for (std::size_t k = 0; k < BINS; ++k) {
+                    float const value = USES_KERNEL ? _row[k] : _bin(k, _detect(spectrum[k]));
+                    if constexpr (REDUCES) {
+                        std::get<sizeof...(Stages) - 1>(_stages).add(result, k, value);
+                    } else {
+                        result[k] += value;
+                    }
+                }
+            }
+        }
+
+    private:
+        float _sample(std::size_t index, float sample) const {
+            std::apply(
+                [&](auto const&... stage) {
+                    ((sample = [&](auto const& current) {
+                        if constexpr (SampleStage<std::remove_cvref_t<decltype(current)>>) {
+                            return static_cast<float>(current.sample(index, sample));
+                        } else {
+                            return sample;
+                        }
+                    }(stage)),
+                        ...);
+                },
+                _stages);
+            return sample;
+        }
+
+        // Detection and weighting in one vector kernel, into `_row`
+        void _detect_weighted(std::span<std::complex<float> const, BINS> spectrum) {
+            auto kernel          = &wt::kernels::SpectrumKernels::magnitude;
+            float const* weights = nullptr;
+            std::apply(
+                [&](auto const&... stage) {
+                    (
+                        [&](auto const& current) {
+                            using Stage = std::remove_cvref_t<decltype(current)>;
+                            if constexpr (KernelDetectStage<Stage>) {
+                                kernel = Stage::KERNEL;
+                            } else if constexpr (IS_WEIGHTING<Stage>) {
+                                weights = current.gains.data();
+                            }
+                        }(stage),
+                        ...);
+                },
+                _stages);
+            (_kernels->*kernel)(_row.data(), spectrum.data(), weights, BINS);
+        }
+
+        float _detect(std::complex<float> coefficient) const {
+            float value = 0.0f;
+            bool found  = false;
+            std::apply(
+                [&](auto const&... stage) {
+                    (
+                        [&](auto const& current) {
+                            if constexpr (DetectStage<std::remove_cvref_t<decltype(current)>>) {
+                                value = current.detect(coefficient);
+                                found = true;
+                            }
+                        }(stage),
+                        ...);
+                },
+                _stages);
+            return found ? value : Magnitude{}.detect(coefficient);
+        }
+
+        float _bin(std::size_t bin, float value) const {
+            std::apply(
+                [&](auto const&... stage) {
+                    ((value = [&](auto const& current) {
+                        if constexpr (BinStage<std::remove_cvref_t<decltype(current)>>) {
+                            return static_cast<float>(current.bin(bin, value));
+                        } else {
+                            return value;
+                        }
+                    }(stage)),
+                        ...);
+                },
+                _stages);
+            return value;
+        }
+
+        std::tuple<Stages...> _stages;
+        std::shared_ptr<RealTransform<float> const> _fft;
+        std::vector<float> _buffer;
+        std::vector<std::complex<float>> _spectrum;
+        std::vector<std::complex<float>> _scratch;
+        wt::kernels::SpectrumKernels const* _kernels;
+        std::vector<float> _row;
+    };
+
+    /// @brief Builds a pipeline over windows of `Size` samples, deducing
+    /// the stage types.
+    template <std::size_t Size, typename... Stages>
+    Pipeline<Size, Stages...> make_pipeline(Stages... stages) {
+        return Pipeline<Size, Stages...>{std::move(stages)...};
+    }
+
+    /// @brief The same, with the FFT from `backend`.
+    template <std::size_t Size, typename... Stages>
+    Pipeline<Size, Stages...> make_pipeline(std::shared_ptr<FftBackend const> const& backend, Stages... stages) {
+        return Pipeline<Size, Stages...>{backend, std::move(stages)...};
+    }
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_PIPELINE_H
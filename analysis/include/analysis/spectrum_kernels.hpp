@@ -0,0 +1,51 @@
+#ifndef WT_ANALYSIS_SPECTRUM_KERNELS_H
+#define WT_ANALYSIS_SPECTRUM_KERNELS_H
+
+#include <analysis/instruction_set.hpp>
+
+#include <complex>
+#include <cstddef>
+
+namespace wt::kernels {
+
+    /// @brief Power the decibel kernel clamps to before taking the log,
+    /// -200 dB, so silence comes out finite.
+    constexpr float DECIBEL_FLOOR_POWER = 1e-20f;
+
+    /**
+     * @brief Kernels turning FFT coefficients into one value per bin with
+     * a weighting curve applied in the same pass, for one instruction set.
+     * All of them take unaligned pointers of any length, `n` counts bins.
+     *
+     * Accuracy, for finite coefficients whose parts are between 1e-18 and
+     * 1e18 in magnitude (an FFT of full scale samples tops out at the
+     * window size), outside which the squares underflow or overflow:
+     *  - `power` is the rounded sum of squares, within 2 ulp of
+     *    `std::norm` times the weight.
+     *  - `magnitude` takes a correctly rounded square root of that sum,
+     *    within 2 ulp of `std::abs` times the weight.
+     *  - `decibels` uses a polynomial log2 with an error below 1.5e-5,
+     *    so it is within 1e-4 dB of `10 * log10` of the weighted power.
+     */
+    struct SpectrumKernels {
+        InstructionSet instruction_set;
+
+        /// dst[k] = |src[k]| * weights[k]
+        void (*magnitude)(float* dst, std::complex<float> const* src, float const* weights, std::size_t n);
+        /// dst[k] = |src[k]|^2 * weights[k]
+        void (*power)(float* dst, std::complex<float> const* src, float const* weights, std::size_t n);
+        /// dst[k] = 10 log10(max(|src[k]|^2 * weights[k], DECIBEL_FLOOR_POWER))
+        void (*decibels)(float* dst, std::complex<float> const* src, float const* weights, std::size_t n);
+    };
+
+    /// @brief The kernels for the detected instruction set, chosen once
+    /// on first use.
+    SpectrumKernels const& spectrum_kernels();
+
+    /// @brief The kernels for a given instruction set, used by tests and
+    /// benchmarks to compare implementations.
+    /// @return the kernels, or nullptr if the CPU cannot run them.
+    SpectrumKernels const* spectrum_kernels_for(InstructionSet instruction_set);
+} // namespace wt::kernels
+
+#endif // WT_ANALYSIS_SPECTRUM_KERNELS_H
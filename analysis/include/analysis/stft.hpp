@@ -0,0 +1,166 @@
+#ifndef WT_ANALYSIS_STFT_H
+#define WT_ANALYSIS_STFT_H
+
+#include <analysis/fft_backend.hpp>
+#include <analysis/window_size.hpp>
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace wt::analysis {
+
+    /// @brief Hop for windows of `window_size` frames overlapping by half.
+    constexpr std::size_t half_overlap(std::size_t window_size) {
+        return window_size / 2;
+    }
+
+    /// @brief Hop for windows of `window_size` frames overlapping by three
+    /// quarters.
+    constexpr std::size_t three_quarter_overlap(std::size_t window_size) {
+        return window_size / 4;
+    }
+
+    /// @brief Hop for `WINDOW_SIZE` windows overlapping by half, only for
+    /// windows of that size.
+    constexpr std::size_t HALF_OVERLAP = half_overlap(WINDOW_SIZE);
+
+    /// @brief Hop for `WINDOW_SIZE` windows overlapping by three quarters,
+    /// only for windows of that size.
+    constexpr std::size_t THREE_QUARTER_OVERLAP = three_quarter_overlap(WINDOW_SIZE);
+
+    /// @brief One window of the stream, analysed.
+    struct StftFrame {
+        /// @brief Position in the stream of the window's first frame, always
+        /// a multiple of the hop.
+        std::uint64_t position;
+
+        /// @brief Coefficients per channel.
+        std::size_t bins;
+
+        /// @brief The coefficients of every channel back to back, valid
+        /// until the next frame.
+        std::span<std::complex<float> const> spectra;
+
+        [[nodiscard]] std::span<std::complex<float> const> spectrum(std::size_t channel) const {
+            return spectra.subspan(channel * bins, bins);
+        }
+    };
+
+    /**
+     * @brief Short-time Fourier transform of a stream of interleaved frames.
+     *
+     * The stream is cut into windows of `window_size` frames starting every
+     * `hop` frames, the first at position zero, whatever size the chunks
+     * pushed are. The same stream always gives the same frames, one every
+     * `hop` frames of audio.
+     *
+     * Every channel keeps its history twice over, `window_size` samples
+     * apart, so the latest window is always contiguous. A frame pushed is
+     * written twice and a hop only windows and transforms, nothing is
+     * shifted or copied.
+     */
+    class Stft {
+    public:
+        /**
+         * @brief Hann windowed transform.
+         * @param channels interleaved channels per frame, at most
+         * `MAX_CHANNELS`.
+         * @param hop frames from one window to the next, from 1 to
+         * `window_size`, half of `window_size` if not given.
+         * @param window_size frames per window, even.
+         * @param backend where the FFT comes from, kissfft unless given.
+         */
+        explicit Stft(std::size_t channels, std::optional<std::size_t> hop = std::nullopt,
+            std::size_t window_size = WINDOW_SIZE,
+            std::shared_ptr<FftBackend const> const& backend = default_fft_backend());
+
+        /**
+         * @brief Transform with a window of the caller's.
+         * @param window multiplied into every window before it is
+         * transformed, its size is the window size.
+         */
+        Stft(std::size_t channels, std::size_t hop, std::vector<float> window,
+            std::shared_ptr<FftBackend const> const& backend = default_fft_backend());
+
+        Stft(Stft const&)            = delete;
+        Stft& operator=(Stft const&) = delete;
+
+        /**
+         * @brief Appends interleaved frames to the stream, calling
+         * `on_frame` with a `StftFrame` for each window they complete, in
+         * order.
+         * @param frames the samples, a whole number of frames.
+         */
+        template <typename OnFrame>
+        void push(std::span<float const> frames, OnFrame&& on_frame);
+
+        /// @brief Forgets the stream, the next frame pushed is position zero.
+        void reset();
+
+        /// @brief Position of the next frame to push.
+        [[nodiscard]] std::uint64_t position() const;
+
+        [[nodiscard]] std::size_t channels() const;
+        [[nodiscard]] std::size_t hop() const;
+        [[nodiscard]] std::size_t window_size() const;
+        [[nodiscard]] std::size_t bins() const;
+
+    private:
+        // Writes whole frames into the history, never past a window's end
+        void _append(float const* frames, std::size_t n_frames);
+
+        // Transforms the latest window of every channel into `_spectra`
+        void _analyse();
+
+        std::size_t _channels;
+        std::size_t _hop;
+        std::vector<float> _window;
+        std::shared_ptr<RealTransform<float> const> _fft;
+
+        // Channel c's samples at [c * 2 * size, (c + 1) * 2 * size), each
+        // at `_head` and `_head + size`
+        std::vector<float> _history;
+        std::size_t _head;
+
+        std::uint64_t _position;
+        // One past the last frame of the next window
+        std::uint64_t _window_end;
+
+        std::vector<float> _windowed;
+        std::vector<std::complex<float>> _scratch;
+        std::vector<std::complex<float>> _spectra;
+    };
+
+    template <typename OnFrame>
+    void Stft::push(std::span<float const> frames, OnFrame&& on_frame) {
+        std::size_t const n_frames = frames.size() / _channels;
+
+        std::size_t done = 0;
+        while (done < n_frames) {
+            auto const until_window = static_cast<std::size_t>(_window_end - _position);
+            auto const chunk        = std::min(n_frames - done, until_window);
+            _append(frames.data() + done * _channels, chunk);
+            done += chunk;
+
+            if (_position == _window_end) {
+                _analyse();
+                // clang-format off
+                on_frame(StftFrame{
+                  .position = _window_end - window_size(),
+                  .bins     = bins(),
+                  .spectra  = _spectra
+                });
+                // clang-format on
+                _window_end += _hop;
+            }
+        }
+    }
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_STFT_H
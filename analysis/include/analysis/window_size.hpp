@@ -0,0 +1,13 @@
+#ifndef WT_ANALYSIS_WINDOW_SIZE_H
+#define WT_ANALYSIS_WINDOW_SIZE_H
+
+#include <cstddef>
+
+namespace wt::analysis {
+    /// @brief Frames per analysis window unless a size is asked for, which
+    /// the audio tap and the analysis share. 2048 frames is about 43ms at
+    /// 48kHz, with bins about 23Hz apart.
+    constexpr std::size_t WINDOW_SIZE = 2048;
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_WINDOW_SIZE_H
@@ -0,0 +1,216 @@
+#ifndef WT_ANALYSIS_WINDOWS_H
+#define WT_ANALYSIS_WINDOWS_H
+
+#include <array>
+#include <cstddef>
+#include <numbers>
+#include <ratio>
+#include <vector>
+
+namespace wt::analysis {
+
+    namespace detail {
+        // The standard maths functions are not constexpr. These are, and give
+        // the same bits at compile time and run time, so a table and a window
+        // made at run time agree exactly.
+
+        // Taylor series of cos and sin nested Horner style, the terms they
+        // leave out are below a double's precision for |x| <= pi / 4.
+        // Written out rather than looped, a table costs the compiler a
+        // quarter of the constexpr operations.
+
+        // clang-format off
+        constexpr double cos_kernel(double x) {
+            double const x2 = x * x;
+            return 1 - x2 / 2 * (1 - x2 / 12 * (1 - x2 / 30 * (1 - x2 / 56
+                 * (1 - x2 / 90 * (1 - x2 / 132 * (1 - x2 / 182 * (1 - x2 / 240)))))));
+        }
+
+        constexpr double sin_kernel(double x) {
+            double const x2 = x * x;
+            return x * (1 - x2 / 6 * (1 - x2 / 20 * (1 - x2 / 42 * (1 - x2 / 72
+                 * (1 - x2 / 110 * (1 - x2 / 156 * (1 - x2 / 210 * (1 - x2 / 272))))))));
+        }
+        // clang-format on
+
+        constexpr double cos(double x) {
+            // Down to within pi / 4 of a quarter turn, where cos is the
+            // kernel of the remainder or of sin, up to a sign
+            constexpr double QUARTER_TURN = std::numbers::pi / 2;
+            x                             = x < 0 ? -x : x;
+            auto const quarters           = static_cast<long long>(x / QUARTER_TURN + 0.5);
+            double const rest             = x - static_cast<double>(quarters) * QUARTER_TURN;
+            switch (quarters % 4) {
+            case 0:
+                return cos_kernel(rest);
+            case 1:
+                return -sin_kernel(rest);
+            case 2:
+                return -cos_kernel(rest);
+            default:
+                return sin_kernel(rest);
+            }
+        }
+
+        /// @brief The modified Bessel function of the first kind, order zero,
+        /// of the square root of `square`, to `terms` terms of its series
+        /// and at least sixteen. The series only has even powers, so the
+        /// root is never taken.
+        constexpr double bessel_i0_of_square(double square, std::size_t terms) {
+            // Sums (x^2 / 4)^k / k!^2 nested Horner style from the last term,
+            // the first sixteen written out like the cos and sin kernels
+            double const q = square / 4;
+            double tail    = 1.0;
+            for (auto k = static_cast<double>(terms); k > 16; --k) {
+                tail = 1 + q / (k * k) * tail;
+            }
+            // clang-format off
+            return 1 + q * (1 + q / 4 * (1 + q / 9 * (1 + q / 16 * (1 + q / 25 * (1 + q / 36 * (1 + q / 49
+                 * (1 + q / 64 * (1 + q / 81 * (1 + q / 100 * (1 + q / 121 * (1 + q / 144 * (1 + q / 169
+                 * (1 + q / 196 * (1 + q / 225 * (1 + q / 256 * tail)))))))))))))));
+            // clang-format on
+        }
+
+        // Sum of cosines at the harmonics of the window's length with
+        // alternating signs, the form of every window here but Kaiser's
+        template <std::size_t Terms>
+        constexpr double cosine_sum(double const (&terms)[Terms], std::size_t n, std::size_t size) {
+            if (size == 1) {
+                return 1.0;
+            }
+            // One cosine, the harmonics follow from the recurrence
+            // cos(k x) = 2 cos(x) cos((k - 1) x) - cos((k - 2) x). Run on
+            // x + pi, whose harmonics carry the alternating signs.
+            double const phase = 2 * std::numbers::pi * static_cast<double>(n) / static_cast<double>(size - 1);
+            double const first = -cos(phase);
+            double previous    = 1.0;
+            double current     = first;
+            double sum         = terms[0];
+            for (std::size_t k = 1; k < Terms; ++k) {
+                sum += terms[k] * current;
+                double const next = 2 * first * current - previous;
+                previous          = current;
+                current           = next;
+            }
+            return sum;
+        }
+    } // namespace detail
+
+    // The windows are symmetric, the first and last coefficients are the
+    // window's ends. `coefficient(n, size)` is coefficient n of `size`,
+    // tables and run time windows only work out the first half.
+
+    struct Hann {
+        static constexpr double coefficient(std::size_t n, std::size_t size) {
+            return detail::cosine_sum<2>({0.5, 0.5}, n, size);
+        }
+    };
+
+    struct Hamming {
+        static constexpr double coefficient(std::size_t n, std::size_t size) {
+            return detail::cosine_sum<2>({0.54, 0.46}, n, size);
+        }
+    };
+
+    /// @brief The four term Blackman-Harris, sidelobes 92dB down.
+    struct BlackmanHarris {
+        static constexpr double coefficient(std::size_t n, std::size_t size) {
+            return detail::cosine_sum<4>({0.35875, 0.48829, 0.14128, 0.01168}, n, size);
+        }
+    };
+
+    /// @brief A flat top, for reading amplitudes: a sine anywhere in a bin
+    /// comes out within a hundredth of a dB.
+    struct FlatTop {
+        static constexpr double coefficient(std::size_t n, std::size_t size) {
+            return detail::cosine_sum<5>({0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368}, n, size);
+        }
+    };
+
+    /**
+     * @brief Kaiser window, `Beta` trading the main lobe's width for
+     * sidelobe level, as a `std::ratio`. The default 8.6 is about as
+     * selective as Blackman-Harris.
+     */
+    template <typename Beta = std::ratio<86, 10>>
+    struct Kaiser {
+        static constexpr double BETA = static_cast<double>(Beta::num) / static_cast<double>(Beta::den);
+
+        // Past 8 + 3 BETA / 2 terms the series is below a double's precision
+        static constexpr auto TERMS = static_cast<std::size_t>(9 + 3 * BETA / 2);
+
+        // The denominator of every coefficient
+        static constexpr double I0_BETA = detail::bessel_i0_of_square(BETA * BETA, TERMS);
+
+        static constexpr double coefficient(std::size_t n, std::size_t size) {
+            if (size == 1) {
+                return 1.0;
+            }
+            double const x = 2.0 * static_cast<double>(n) / static_cast<double>(size - 1) - 1.0;
+            return detail::bessel_i0_of_square(BETA * BETA * (1.0 - x * x), TERMS) / I0_BETA;
+        }
+    };
+
+    /// @brief A window's coefficients and the gains to correct for it.
+    template <std::size_t Size>
+    struct WindowTable {
+        /// @brief Aligned for the widest vector loads.
+        alignas(64) std::array<float, Size> coefficients;
+
+        /// @brief The mean coefficient, the factor a windowed sine's peak
+        /// is scaled by. Divide by it to read amplitudes.
+        double coherent_gain;
+
+        /// @brief Equivalent noise bandwidth in bins, how much more noise
+        /// power a bin lets in than with no window. Divide noise powers by
+        /// it.
+        double enbw;
+    };
+
+    template <typename Window, std::size_t Size>
+    constexpr WindowTable<Size> make_window_table() {
+        static_assert(Size > 0, "a window needs at least one coefficient");
+
+        WindowTable<Size> ret{};
+        // Through a pointer, a compiler counts every call to the array's
+        // subscript against its constexpr limits
+        float* const coefficients = ret.coefficients.data();
+        double sum                = 0.0;
+        double squares            = 0.0;
+        for (std::size_t i = 0; i < Size / 2; ++i) {
+            double const coefficient = Window::coefficient(i, Size);
+            coefficients[i]          = coefficients[Size - 1 - i] = static_cast<float>(coefficient);
+            sum += coefficient;
+            squares += coefficient * coefficient;
+        }
+        sum *= 2;
+        squares *= 2;
+        if constexpr (Size % 2 == 1) {
+            double const middle    = Window::coefficient(Size / 2, Size);
+            coefficients[Size / 2] = static_cast<float>(middle);
+            sum += middle;
+            squares += middle * middle;
+        }
+        ret.coherent_gain = sum / Size;
+        ret.enbw          = Size * squares / (sum * sum);
+        return ret;
+    }
+
+    /// @brief The table of `Window` at `Size`, worked out by the compiler
+    /// and kept in read only data, nothing is computed at run time.
+    template <typename Window, std::size_t Size>
+    inline constexpr WindowTable<Size> WINDOW_TABLE = make_window_table<Window, Size>();
+
+    /// @brief The coefficients of `Window` for a size picked at run time,
+    /// the same values as its table.
+    template <typename Window>
+    std::vector<float> make_window(std::size_t size) {
+        std::vector<float> ret(size);
+        for (std::size_t i = 0; i < (size + 1) / 2; ++i) {
+            ret[i] = ret[size - 1 - i] = static_cast<float>(Window::coefficient(i, size));
+        }
+        return ret;
+    }
+} // namespace wt::analysis
+
+#endif // WT_ANALYSIS_WINDOWS_H
@@ -0,0 +1,83 @@
+#include <analysis/instruction_set.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define WT_KERNELS_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+#ifdef WT_KERNELS_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    // cpuid tells us what the CPU has, xgetbv whether the OS saves the
+    // wider registers on a context switch
+    wt::kernels::InstructionSet detect_msvc() {
+        int info[4] = {};
+        __cpuid(info, 0);
+        int const max_leaf = info[0];
+
+        __cpuid(info, 1);
+        bool const has_sse2    = (info[3] & (1 << 26)) != 0;
+        bool const has_osxsave = (info[2] & (1 << 27)) != 0;
+        if (!has_osxsave || max_leaf < 7) {
+            return has_sse2 ? wt::kernels::InstructionSet::sse2 : wt::kernels::InstructionSet::scalar;
+        }
+
+        unsigned long long const xcr0 = _xgetbv(0);
+        bool const os_avx             = (xcr0 & 0x6) == 0x6;
+        bool const os_avx512          = (xcr0 & 0xE6) == 0xE6;
+
+        __cpuidex(info, 7, 0);
+        bool const has_avx2    = (info[1] & (1 << 5)) != 0;
+        bool const has_avx512f = (info[1] & (1 << 16)) != 0;
+
+        if (has_avx512f && os_avx512) {
+            return wt::kernels::InstructionSet::avx512;
+        }
+        if (has_avx2 && os_avx) {
+            return wt::kernels::InstructionSet::avx2;
+        }
+        return has_sse2 ? wt::kernels::InstructionSet::sse2 : wt::kernels::InstructionSet::scalar;
+    }
+#endif
+#endif // WT_KERNELS_X86
+} // namespace
+
+namespace wt::kernels {
+
+    InstructionSet detect_instruction_set() {
+#if defined(WT_KERNELS_X86) && defined(_MSC_VER) && !defined(__clang__)
+        return detect_msvc();
+#elif defined(WT_KERNELS_X86)
+        // These also check that the OS enabled the wider registers
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return InstructionSet::avx512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return InstructionSet::avx2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return InstructionSet::sse2;
+        }
+        return InstructionSet::scalar;
+#else
+        return InstructionSet::scalar;
+#endif
+    }
+
+    std::string_view to_string(InstructionSet instruction_set) {
+        switch (instruction_set) {
+        case InstructionSet::sse2:
+            return "sse2";
+        case InstructionSet::avx2:
+            return "avx2";
+        case InstructionSet::avx512:
+            return "avx512";
+        default:
+            return "scalar";
+        }
+    }
+} // namespace wt::kernels
@@ -0,0 +1,108 @@
+#include <gsl/assert>
+
+#include <analysis/onset.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+
+namespace wt::analysis {
+
+    OnsetDetector::OnsetDetector(OnsetOptions const& options)
+        : _options{options},
+          _min_gap{static_cast<std::uint64_t>(options.min_gap_seconds * options.sample_rate)},
+          _previous(options.bins),
+          _magnitudes(options.bins),
+          _primed{false},
+          _fluxes(options.threshold_frames),
+          _head{0},
+          _count{0} {
+        Expects(options.bins > 1);
+        Expects(options.sample_rate > 0);
+        Expects(options.threshold_frames > 0);
+    }
+
+    auto OnsetDetector::push(std::uint64_t position, std::span<float const> magnitudes) -> std::optional<OnsetEvent> {
+        Expects(magnitudes.size() >= _options.bins);
+
+        // Only the rises count, a note ending is not an onset
+        float flux = 0.0f;
+        for (std::size_t k = 0; k < _options.bins; ++k) {
+            float const compressed = std::log1p(_options.compression * magnitudes[k]);
+            flux += std::max(0.0f, compressed - _previous[k]);
+            _previous[k] = compressed;
+        }
+        flux = _primed ? flux / static_cast<float>(_options.bins) : 0.0f;
+        _primed = true;
+
+        float const mean =
+            _count > 0 ? std::accumulate(_fluxes.begin(), _fluxes.begin() + _count, 0.0f) / static_cast<float>(_count)
+                       : 0.0f;
+        Frame const current{position, flux, _options.threshold_ratio * mean + _options.threshold_floor};
+
+        std::optional<OnsetEvent> ret;
+        if (_candidate) {
+            float const before = _before ? _before->flux : 0.0f;
+            bool const peak    = _candidate->flux > before && _candidate->flux >= current.flux
+                           && _candidate->flux > _candidate->threshold;
+            bool const apart = !_last_onset || _candidate->position >= *_last_onset + _min_gap;
+            if (peak && apart) {
+                // clang-format off
+                ret = OnsetEvent{
+                  .position = _candidate->position,
+                  .seconds  = static_cast<double>(_candidate->position) / _options.sample_rate,
+                  .strength = _candidate->flux
+                };
+                // clang-format on
+                _last_onset = _candidate->position;
+            }
+        }
+        _before    = _candidate;
+        _candidate = current;
+
+        if (_count < _fluxes.size()) {
+            _fluxes[(_head + _count++) % _fluxes.size()] = flux;
+        } else {
+            _fluxes[_head] = flux;
+            _head          = (_head + 1) % _fluxes.size();
+        }
+        return ret;
+    }
+
+    auto OnsetDetector::push(std::uint64_t position, StftFrame const& frame) -> std::optional<OnsetEvent> {
+        Expects(frame.bins == _options.bins);
+
+        // A full scale sine under a Hann window peaks at a quarter of the
+        // window size
+        std::size_t const channels = frame.spectra.size() / frame.bins;
+        float const scale          = 4.0f / static_cast<float>((frame.bins - 1) * 2);
+        std::ranges::fill(_magnitudes, 0.0f);
+        for (std::size_t c = 0; c < channels; ++c) {
+            auto const spectrum = frame.spectrum(c);
+            for (std::size_t k = 0; k < frame.bins; ++k) {
+                auto const value = spectrum[k];
+                _magnitudes[k] += std::sqrt(value.real() * value.real() + value.imag() * value.imag()) * scale;
+            }
+        }
+        return push(position, _magnitudes);
+    }
+
+    auto OnsetDetector::strength() const -> float {
+        return _candidate ? _candidate->flux : 0.0f;
+    }
+
+    auto OnsetDetector::reset() -> void {
+        std::ranges::fill(_previous, 0.0f);
+        _primed = false;
+        _head   = 0;
+        _count  = 0;
+        _before.reset();
+        _candidate.reset();
+        _last_onset.reset();
+    }
+
+    auto OnsetDetector::bins() const -> std::size_t {
+        return _options.bins;
+    }
+} // namespace wt::analysis
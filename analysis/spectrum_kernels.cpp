@@ -0,0 +1,281 @@
+#include <analysis/spectrum_kernels.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define WT_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// GCC and Clang only emit wider instructions in functions that ask for
+// them, MSVC emits any intrinsic it is given.
+#if defined(__GNUC__) || defined(__clang__)
+#define WT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define WT_TARGET(isa)
+#endif
+
+namespace {
+
+    enum class Detect { magnitude, power, decibels };
+
+    // 10 log10(x) = TEN_LOG10_2 * log2(x)
+    constexpr float TEN_LOG10_2 = 3.01029995664f;
+
+    // log2(1 + t) ~ t * (C1 + t * (C2 + t * (C3 + t * (C4 + t * C5)))) on
+    // [0, 1), a minimax fit with a largest error of 1.45e-5
+    constexpr float LOG2_C1 = 1.44196570f;
+    constexpr float LOG2_C2 = -0.709663808f;
+    constexpr float LOG2_C3 = 0.417600334f;
+    constexpr float LOG2_C4 = -0.196276784f;
+    constexpr float LOG2_C5 = 0.0463889539f;
+
+    constexpr std::uint32_t MANTISSA_MASK = 0x007FFFFF;
+    constexpr std::uint32_t ONE_BITS      = 0x3F800000;
+
+    // MARK: Scalar kernels, also used for the vector tails
+
+    // Splits a positive normal float into its exponent and a mantissa in
+    // [1, 2), the polynomial does the mantissa's log
+    float fast_log2(float x) {
+        auto const bits      = std::bit_cast<std::uint32_t>(x);
+        auto const exponent  = static_cast<float>(static_cast<std::int32_t>(bits >> 23) - 127);
+        float const t        = std::bit_cast<float>((bits & MANTISSA_MASK) | ONE_BITS) - 1.0f;
+        float const mantissa = ((((LOG2_C5 * t + LOG2_C4) * t + LOG2_C3) * t + LOG2_C2) * t + LOG2_C1) * t;
+        return exponent + mantissa;
+    }
+
+    template <Detect D>
+    void detect_scalar(float* dst, std::complex<float> const* src, float const* weights, std::size_t n) {
+        for (std::size_t k = 0; k < n; ++k) {
+            float const power = src[k].real() * src[k].real() + src[k].imag() * src[k].imag();
+            if constexpr (D == Detect::magnitude) {
+                dst[k] = std::sqrt(power) * weights[k];
+            } else if constexpr (D == Detect::power) {
+                dst[k] = power * weights[k];
+            } else {
+                dst[k] = TEN_LOG10_2 * fast_log2(std::max(power * weights[k], wt::kernels::DECIBEL_FLOOR_POWER));
+            }
+        }
+    }
+
+    constexpr wt::kernels::SpectrumKernels SCALAR_KERNELS{
+        wt::kernels::InstructionSet::scalar,
+        detect_scalar<Detect::magnitude>,
+        detect_scalar<Detect::power>,
+        detect_scalar<Detect::decibels>,
+    };
+
+#ifdef WT_KERNELS_X86
+
+    // MARK: SSE2 kernels, 4 bins per step
+
+    // The squared magnitudes of the 4 coefficients at `src`
+    WT_TARGET("sse2") __m128 power_sse2(float const* src) {
+        __m128 const a  = _mm_loadu_ps(src);
+        __m128 const b  = _mm_loadu_ps(src + 4);
+        __m128 const re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 const im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        return _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+    }
+
+    WT_TARGET("sse2") __m128 log2_sse2(__m128 x) {
+        __m128i const bits     = _mm_castps_si128(x);
+        __m128 const exponent  = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+        __m128i const mantissa = _mm_or_si128(
+            _mm_and_si128(bits, _mm_set1_epi32(MANTISSA_MASK)), _mm_set1_epi32(static_cast<int>(ONE_BITS)));
+        __m128 const t = _mm_sub_ps(_mm_castsi128_ps(mantissa), _mm_set1_ps(1.0f));
+
+        __m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(LOG2_C5), t), _mm_set1_ps(LOG2_C4));
+        p        = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(LOG2_C3));
+        p        = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(LOG2_C2));
+        p        = _mm_add_ps(_mm_mul_ps(p, t), _mm_set1_ps(LOG2_C1));
+        return _mm_add_ps(exponent, _mm_mul_ps(p, t));
+    }
+
+    template <Detect D>
+    WT_TARGET("sse2")
+    void detect_sse2(float* dst, std::complex<float> const* src, float const* weights, std::size_t n) {
+        auto const* values = reinterpret_cast<float const*>(src);
+        std::size_t k      = 0;
+        for (; k + 4 <= n; k += 4) {
+            __m128 const power = power_sse2(values + 2 * k);
+            __m128 const w     = _mm_loadu_ps(weights + k);
+            if constexpr (D == Detect::magnitude) {
+                _mm_storeu_ps(dst + k, _mm_mul_ps(_mm_sqrt_ps(power), w));
+            } else if constexpr (D == Detect::power) {
+                _mm_storeu_ps(dst + k, _mm_mul_ps(power, w));
+            } else {
+                __m128 const floored = _mm_max_ps(_mm_mul_ps(power, w), _mm_set1_ps(wt::kernels::DECIBEL_FLOOR_POWER));
+                _mm_storeu_ps(dst + k, _mm_mul_ps(_mm_set1_ps(TEN_LOG10_2), log2_sse2(floored)));
+            }
+        }
+        detect_scalar<D>(dst + k, src + k, weights + k, n - k);
+    }
+
+    // MARK: AVX2 kernels, 8 bins per step
+
+    // The squared magnitudes of the 8 coefficients at `src`
+    WT_TARGET("avx2") __m256 power_avx2(float const* src) {
+        __m256 const a  = _mm256_loadu_ps(src);
+        __m256 const b  = _mm256_loadu_ps(src + 8);
+        __m256 const re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 const im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+        // The shuffles work per 128 bit lane, which leaves the pairs of
+        // bins out of order across lanes
+        __m256d const power = _mm256_castps_pd(_mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im)));
+        return _mm256_castpd_ps(_mm256_permute4x64_pd(power, 0xD8));
+    }
+
+    WT_TARGET("avx2") __m256 log2_avx2(__m256 x) {
+        __m256i const bits = _mm256_castps_si256(x);
+        __m256 const exponent =
+            _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+        __m256i const mantissa = _mm256_or_si256(
+            _mm256_and_si256(bits, _mm256_set1_epi32(MANTISSA_MASK)), _mm256_set1_epi32(static_cast<int>(ONE_BITS)));
+        __m256 const t = _mm256_sub_ps(_mm256_castsi256_ps(mantissa), _mm256_set1_ps(1.0f));
+
+        __m256 p = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(LOG2_C5), t), _mm256_set1_ps(LOG2_C4));
+        p        = _mm256_add_ps(_mm256_mul_ps(p, t), _mm256_set1_ps(LOG2_C3));
+        p        = _mm256_add_ps(_mm256_mul_ps(p, t), _mm256_set1_ps(LOG2_C2));
+        p        = _mm256_add_ps(_mm256_mul_ps(p, t), _mm256_set1_ps(LOG2_C1));
+        return _mm256_add_ps(exponent, _mm256_mul_ps(p, t));
+    }
+
+    template <Detect D>
+    WT_TARGET("avx2")
+    void detect_avx2(float* dst, std::complex<float> const* src, float const* weights, std::size_t n) {
+        auto const* values = reinterpret_cast<float const*>(src);
+        std::size_t k      = 0;
+        for (; k + 8 <= n; k += 8) {
+            __m256 const power = power_avx2(values + 2 * k);
+            __m256 const w     = _mm256_loadu_ps(weights + k);
+            if constexpr (D == Detect::magnitude) {
+                _mm256_storeu_ps(dst + k, _mm256_mul_ps(_mm256_sqrt_ps(power), w));
+            } else if constexpr (D == Detect::power) {
+                _mm256_storeu_ps(dst + k, _mm256_mul_ps(power, w));
+            } else {
+                __m256 const floored =
+                    _mm256_max_ps(_mm256_mul_ps(power, w), _mm256_set1_ps(wt::kernels::DECIBEL_FLOOR_POWER));
+                _mm256_storeu_ps(dst + k, _mm256_mul_ps(_mm256_set1_ps(TEN_LOG10_2), log2_avx2(floored)));
+            }
+        }
+        detect_scalar<D>(dst + k, src + k, weights + k, n - k);
+    }
+
+    // MARK: AVX-512 kernels, 16 bins per step
+
+    // GCC 12 flags the deliberately undefined registers inside its own
+    // AVX-512 intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+    // The squared magnitudes of the 16 coefficients at `src`
+    WT_TARGET("avx512f") __m512 power_avx512(float const* src) {
+        // Indices 0-15 pick from the first register, 16-31 from the second
+        __m512i const even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        __m512i const odd  = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+
+        __m512 const a  = _mm512_loadu_ps(src);
+        __m512 const b  = _mm512_loadu_ps(src + 16);
+        __m512 const re = _mm512_permutex2var_ps(a, even, b);
+        __m512 const im = _mm512_permutex2var_ps(a, odd, b);
+        return _mm512_add_ps(_mm512_mul_ps(re, re), _mm512_mul_ps(im, im));
+    }
+
+    WT_TARGET("avx512f") __m512 log2_avx512(__m512 x) {
+        __m512i const bits = _mm512_castps_si512(x);
+        __m512 const exponent =
+            _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(127)));
+        __m512i const mantissa = _mm512_or_si512(
+            _mm512_and_si512(bits, _mm512_set1_epi32(MANTISSA_MASK)), _mm512_set1_epi32(static_cast<int>(ONE_BITS)));
+        __m512 const t = _mm512_sub_ps(_mm512_castsi512_ps(mantissa), _mm512_set1_ps(1.0f));
+
+        __m512 p = _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(LOG2_C5), t), _mm512_set1_ps(LOG2_C4));
+        p        = _mm512_add_ps(_mm512_mul_ps(p, t), _mm512_set1_ps(LOG2_C3));
+        p        = _mm512_add_ps(_mm512_mul_ps(p, t), _mm512_set1_ps(LOG2_C2));
+        p        = _mm512_add_ps(_mm512_mul_ps(p, t), _mm512_set1_ps(LOG2_C1));
+        return _mm512_add_ps(exponent, _mm512_mul_ps(p, t));
+    }
+
+    template <Detect D>
+    WT_TARGET("avx512f")
+    void detect_avx512(float* dst, std::complex<float> const* src, float const* weights, std::size_t n) {
+        auto const* values = reinterpret_cast<float const*>(src);
+        std::size_t k      = 0;
+        for (; k + 16 <= n; k += 16) {
+            __m512 const power = power_avx512(values + 2 * k);
+            __m512 const w     = _mm512_loadu_ps(weights + k);
+            if constexpr (D == Detect::magnitude) {
+                _mm512_storeu_ps(dst + k, _mm512_mul_ps(_mm512_sqrt_ps(power), w));
+            } else if constexpr (D == Detect::power) {
+                _mm512_storeu_ps(dst + k, _mm512_mul_ps(power, w));
+            } else {
+                __m512 const floored =
+                    _mm512_max_ps(_mm512_mul_ps(power, w), _mm512_set1_ps(wt::kernels::DECIBEL_FLOOR_POWER));
+                _mm512_storeu_ps(dst + k, _mm512_mul_ps(_mm512_set1_ps(TEN_LOG10_2), log2_avx512(floored)));
+            }
+        }
+        detect_scalar<D>(dst + k, src + k, weights + k, n - k);
+    }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+    constexpr wt::kernels::SpectrumKernels SSE2_KERNELS{
+        wt::kernels::InstructionSet::sse2,
+        detect_sse2<Detect::magnitude>,
+        detect_sse2<Detect::power>,
+        detect_sse2<Detect::decibels>,
+    };
+
+    constexpr wt::kernels::SpectrumKernels AVX2_KERNELS{
+        wt::kernels::InstructionSet::avx2,
+        detect_avx2<Detect::magnitude>,
+        detect_avx2<Detect::power>,
+        detect_avx2<Detect::decibels>,
+    };
+
+    constexpr wt::kernels::SpectrumKernels AVX512_KERNELS{
+        wt::kernels::InstructionSet::avx512,
+        detect_avx512<Detect::magnitude>,
+        detect_avx512<Detect::power>,
+        detect_avx512<Detect::decibels>,
+    };
+
+#endif // WT_KERNELS_X86
+} // namespace
+
+namespace wt::kernels {
+
+    SpectrumKernels const& spectrum_kernels() {
+        static SpectrumKernels const& selected = *spectrum_kernels_for(detect_instruction_set());
+        return selected;
+    }
+
+    SpectrumKernels const* spectrum_kernels_for(InstructionSet instruction_set) {
+        if (static_cast<int>(instruction_set) > static_cast<int>(detect_instruction_set())) {
+            return nullptr;
+        }
+
+        switch (instruction_set) {
+#ifdef WT_KERNELS_X86
+        case InstructionSet::sse2:
+            return &SSE2_KERNELS;
+        case InstructionSet::avx2:
+            return &AVX2_KERNELS;
+        case InstructionSet::avx512:
+            return &AVX512_KERNELS;
+#endif
+        default:
+            return &SCALAR_KERNELS;
+        }
+    }
+} // namespace wt::kernels
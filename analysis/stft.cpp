@@ -0,0 +1,89 @@
+#include <gsl/assert>
+
+#include <analysis/analysis.hpp>
+#include <analysis/hann_window.hpp>
+#include <analysis/stft.hpp>
+
+#include <utility>
+
+
+namespace wt::analysis {
+
+    Stft::Stft(std::size_t channels, std::optional<std::size_t> hop, std::size_t window_size,
+        std::shared_ptr<FftBackend const> const& backend)
+        : Stft{channels, hop.value_or(half_overlap(window_size)), make_hann_coefficients(window_size), backend} {}
+
+    Stft::Stft(std::size_t channels, std::size_t hop, std::vector<float> window,
+        std::shared_ptr<FftBackend const> const& backend)
+        : _channels{channels},
+          _hop{hop},
+          _window{std::move(window)},
+          _fft{backend->real_float(_window.size())},
+          _history(channels * 2 * _window.size(), 0.0f),
+          _head{0},
+          _position{0},
+          _window_end{_window.size()},
+          _windowed(_window.size()),
+          _scratch(_fft->scratch_size()),
+          _spectra(channels * _fft->bins()) {
+        Expects(channels > 0 && channels <= MAX_CHANNELS);
+        Expects(hop > 0 && hop <= _window.size());
+    }
+
+    auto Stft::reset() -> void {
+        _head       = 0;
+        _position   = 0;
+        _window_end = window_size();
+    }
+
+    auto Stft::position() const -> std::uint64_t {
+        return _position;
+    }
+
+    auto Stft::channels() const -> std::size_t {
+        return _channels;
+    }
+
+    auto Stft::hop() const -> std::size_t {
+        return _hop;
+    }
+
+    auto Stft::window_size() const -> std::size_t {
+        return _window.size();
+    }
+
+    auto Stft::bins() const -> std::size_t {
+        return _fft->bins();
+    }
+
+    auto Stft::_append(float const* frames, std::size_t n_frames) -> void {
+        std::size_t const size = window_size();
+        for (std::size_t c = 0; c < _channels; ++c) {
+            float* const history = _history.data() + c * 2 * size;
+
+            std::size_t head = _head;
+            for (std::size_t i = 0; i < n_frames; ++i) {
+                float const sample   = frames[i * _channels + c];
+                history[head]        = sample;
+                history[head + size] = sample;
+                head                 = head + 1 == size ? 0 : head + 1;
+            }
+        }
+
+        _head      = (_head + n_frames) % size;
+        _position += n_frames;
+    }
+
+    auto Stft::_analyse() -> void {
+        // The oldest sample of the window is where the next one goes
+        std::size_t const size = window_size();
+        for (std::size_t c = 0; c < _channels; ++c) {
+            float const* const window = _history.data() + c * 2 * size + _head;
+            for (std::size_t i = 0; i < size; ++i) {
+                _windowed[i] = window[i] * _window[i];
+            }
+
+            _fft->forward(_windowed.data(), _spectra.data() + c * bins(), _scratch.data());
+        }
+    }
+} // namespace wt::analysis
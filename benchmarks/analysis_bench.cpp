@@ -0,0 +1,45 @@
+#include <analysis/analysis.hpp>
+
+#include "bench_util.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+using namespace wt::analysis;
+using wt::bench::make_noise;
+
+namespace {
+    constexpr std::size_t BINS = WINDOW_SIZE / 2 + 1;
+
+    // The window copied into an array, analysed and returned by value
+    void BM_analyze_by_value(benchmark::State& state) {
+        auto const samples = make_noise(WINDOW_SIZE);
+        FftAnalyzer<> analyzer;
+
+        std::array<float, WINDOW_SIZE> window;
+        for (auto _ : state) {
+            std::ranges::copy(samples, window.begin());
+            auto const spectrum = analyzer.analyze(window);
+            benchmark::DoNotOptimize(spectrum.data());
+        }
+    }
+    BENCHMARK(BM_analyze_by_value);
+
+    // The FFT reading and writing the caller's storage where it lies
+    void BM_analyze_into_spans(benchmark::State& state) {
+        auto const samples = make_noise(WINDOW_SIZE);
+        FftAnalyzer<> analyzer;
+
+        std::vector<std::complex<float>> spectrum(BINS);
+        for (auto _ : state) {
+            analyzer.analyze(samples, spectrum);
+            benchmark::DoNotOptimize(spectrum.data());
+        }
+    }
+    BENCHMARK(BM_analyze_into_spans);
+} // namespace
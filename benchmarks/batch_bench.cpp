@@ -0,0 +1,37 @@
+#include <analysis/batch.hpp>
+
+#include "bench_util.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace wt::analysis;
+using wt::bench::make_noise;
+
+namespace {
+    constexpr std::size_t SAMPLE_RATE = 48000;
+
+    // A minute of three quarter overlapped windows, argument is the thread
+    // count, windows_per_s should grow with it up to the core count
+    void BM_batch_magnitudes(benchmark::State& state) {
+        auto const samples = make_noise(SAMPLE_RATE * 60);
+        BatchAnalyzer const analyzer{WINDOW_SIZE, static_cast<unsigned>(state.range(0))};
+
+        std::size_t const windows = analyzer.windows(samples.size(), WINDOW_SIZE / 4);
+        std::vector<float> spectrogram(windows * analyzer.bins());
+        for (auto _ : state) {
+            analyzer.magnitudes(samples, spectrogram, WINDOW_SIZE / 4);
+            benchmark::DoNotOptimize(spectrogram.data());
+        }
+        state.counters["windows_per_s"] =
+            benchmark::Counter(static_cast<double>(windows), benchmark::Counter::kIsIterationInvariantRate);
+    }
+    BENCHMARK(BM_batch_magnitudes)
+        ->RangeMultiplier(2)
+        ->Range(1, static_cast<std::int64_t>(BatchAnalyzer::default_threads()))
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+} // namespace
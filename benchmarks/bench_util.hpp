@@ -0,0 +1,24 @@
+#ifndef WT_BENCH_UTIL_H
+#define WT_BENCH_UTIL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wt::bench {
+
+    /// @brief `size` samples of white noise in [`low`, `high`), the same on
+    /// every run so timings compare across builds.
+    template <typename T = float>
+    std::vector<T> make_noise(std::size_t size, T low = T{-1}, T high = T{1}) {
+        std::vector<T> ret(size);
+        std::uint32_t state = 1;
+        for (auto& sample : ret) {
+            state  = state * 1664525 + 1013904223;
+            sample = static_cast<T>(state >> 8) / (1 << 24) * (high - low) + low;
+        }
+        return ret;
+    }
+} // namespace wt::bench
+
+#endif // WT_BENCH_UTIL_H
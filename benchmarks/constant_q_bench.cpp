@@ -0,0 +1,124 @@
+#include <analysis/constant_q.hpp>
+#include <analysis/fft_plan.hpp>
+
+#include "bench_util.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+using namespace wt::analysis;
+using wt::bench::make_noise;
+
+namespace {
+    constexpr float SAMPLE_RATE = 48000.0f;
+
+    ConstantQ make_constant_q(benchmark::State const& state) {
+        ConstantQOptions options;
+        options.bins_per_octave = static_cast<std::size_t>(state.range(0));
+        return ConstantQ{options};
+    }
+
+    // The reference, every bin correlated with its kernel sample by sample,
+    // its windowed sinusoids worked out up front as the kernels are
+    class NaiveConstantQ {
+    public:
+        explicit NaiveConstantQ(ConstantQ const& cq) : _window_size{cq.window_size()}, _kernels(cq.bins()) {
+            for (std::size_t k = 0; k < cq.bins(); ++k) {
+                std::size_t const length = cq.kernel_length(k);
+                double const cycle       = 2 * std::numbers::pi * cq.centre_hz(k) / SAMPLE_RATE;
+                for (std::size_t n = 0; n < length; ++n) {
+                    double const hann = (1.0 - std::cos(2 * std::numbers::pi * n / length)) / length;
+                    _kernels[k].push_back(std::complex<float>{std::polar(hann, -cycle * n)});
+                }
+            }
+        }
+
+        void magnitudes(std::vector<float> const& frame, std::vector<float>& output) const {
+            for (std::size_t k = 0; k < _kernels.size(); ++k) {
+                auto const& kernel      = _kernels[k];
+                std::size_t const start = (_window_size - kernel.size()) / 2;
+                float real              = 0.0f;
+                float imag              = 0.0f;
+                for (std::size_t n = 0; n < kernel.size(); ++n) {
+                    real += frame[start + n] * kernel[n].real();
+                    imag += frame[start + n] * kernel[n].imag();
+                }
+                output[k] = std::sqrt(real * real + imag * imag);
+            }
+        }
+
+    private:
+        std::size_t _window_size;
+        std::vector<std::vector<std::complex<float>>> _kernels;
+    };
+
+    void report(benchmark::State& state, ConstantQ const& cq) {
+        state.counters["bins"]            = static_cast<double>(cq.bins());
+        state.counters["nonzero_weights"] = static_cast<double>(cq.nonzero_weights());
+        state.counters["frames_per_s"]    = benchmark::Counter(1.0, benchmark::Counter::kIsIterationInvariantRate);
+    }
+
+    // One frame through the FFT and the sparse kernels, argument is the
+    // bins per octave
+    void BM_constant_q(benchmark::State& state) {
+        auto const cq    = make_constant_q(state);
+        auto const frame = make_noise(cq.window_size());
+        auto const plan  = FftPlan::get(cq.window_size());
+
+        std::vector<std::complex<float>> spectrum(plan->bins());
+        std::vector<std::complex<float>> scratch(cq.window_size() / 2);
+        std::vector<float> output(cq.bins());
+        for (auto _ : state) {
+            plan->forward(frame.data(), spectrum.data(), scratch.data());
+            cq.magnitudes(spectrum, output);
+            benchmark::DoNotOptimize(output.data());
+        }
+        report(state, cq);
+    }
+    BENCHMARK(BM_constant_q)->Arg(12)->Arg(24)->Arg(48)->Unit(benchmark::kMicrosecond);
+
+    // The sparse kernels alone, on a spectrum the visualiser already has
+    void BM_constant_q_kernels(benchmark::State& state) {
+        auto const cq    = make_constant_q(state);
+        auto const frame = make_noise(cq.window_size());
+        auto const plan  = FftPlan::get(cq.window_size());
+
+        std::vector<std::complex<float>> spectrum(plan->bins());
+        std::vector<std::complex<float>> scratch(cq.window_size() / 2);
+        plan->forward(frame.data(), spectrum.data(), scratch.data());
+        std::vector<float> output(cq.bins());
+        for (auto _ : state) {
+            cq.magnitudes(spectrum, output);
+            benchmark::DoNotOptimize(output.data());
+        }
+        report(state, cq);
+    }
+    BENCHMARK(BM_constant_q_kernels)->Arg(12)->Arg(24)->Arg(48)->Unit(benchmark::kMicrosecond);
+
+    void BM_naive_constant_q(benchmark::State& state) {
+        auto const cq    = make_constant_q(state);
+        auto const frame = make_noise(cq.window_size());
+        NaiveConstantQ const naive{cq};
+
+        std::vector<float> output(cq.bins());
+        for (auto _ : state) {
+            naive.magnitudes(frame, output);
+            benchmark::DoNotOptimize(output.data());
+        }
+        report(state, cq);
+    }
+    BENCHMARK(BM_naive_constant_q)->Arg(12)->Arg(24)->Arg(48)->Unit(benchmark::kMicrosecond);
+
+    // Working out the kernels, once per transform
+    void BM_constant_q_setup(benchmark::State& state) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(make_constant_q(state).nonzero_weights());
+        }
+    }
+    BENCHMARK(BM_constant_q_setup)->Arg(12)->Arg(24)->Arg(48)->Unit(benchmark::kMillisecond);
+} // namespace
@@ -0,0 +1,90 @@
+#include <analysis/fft_backend.hpp>
+
+#include "bench_util.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace wt::analysis;
+using wt::bench::make_noise;
+
+namespace {
+    void set_counters(benchmark::State& state, std::size_t size) {
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(size));
+    }
+
+    // One real forward transform of `state.range(0)` samples per iteration
+    template <typename Backend, typename T>
+    void BM_real_forward(benchmark::State& state) {
+        auto const size    = static_cast<std::size_t>(state.range(0));
+        auto const fft     = Backend{}.template real<T>(size);
+        auto const samples = make_noise<T>(size);
+        std::vector<std::complex<T>> spectrum(fft->bins());
+        std::vector<std::complex<T>> scratch(fft->scratch_size());
+
+        for (auto _ : state) {
+            fft->forward(samples.data(), spectrum.data(), scratch.data());
+            benchmark::DoNotOptimize(spectrum.data());
+            benchmark::ClobberMemory();
+        }
+        set_counters(state, size);
+    }
+
+    template <typename Backend, typename T>
+    void BM_real_inverse(benchmark::State& state) {
+        auto const size  = static_cast<std::size_t>(state.range(0));
+        auto const fft   = Backend{}.template real<T>(size);
+        auto const noise = make_noise<T>(2 * fft->bins());
+        std::vector<std::complex<T>> spectrum(fft->bins());
+        for (std::size_t k = 0; k < spectrum.size(); ++k) {
+            spectrum[k] = {noise[2 * k], noise[2 * k + 1]};
+        }
+        std::vector<T> samples(size);
+        std::vector<std::complex<T>> scratch(fft->scratch_size());
+
+        for (auto _ : state) {
+            fft->inverse(spectrum.data(), samples.data(), scratch.data());
+            benchmark::DoNotOptimize(samples.data());
+            benchmark::ClobberMemory();
+        }
+        set_counters(state, size);
+    }
+
+    template <typename Backend, typename T>
+    void BM_complex_forward(benchmark::State& state) {
+        auto const size  = static_cast<std::size_t>(state.range(0));
+        auto const fft   = Backend{}.template complex<T>(size);
+        auto const noise = make_noise<T>(2 * size);
+        std::vector<std::complex<T>> input(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            input[i] = {noise[2 * i], noise[2 * i + 1]};
+        }
+        std::vector<std::complex<T>> output(size);
+        std::vector<std::complex<T>> scratch(fft->scratch_size());
+
+        for (auto _ : state) {
+            fft->forward(input.data(), output.data(), scratch.data());
+            benchmark::DoNotOptimize(output.data());
+            benchmark::ClobberMemory();
+        }
+        set_counters(state, size);
+    }
+
+    // From a short window to the longest the constant-Q takes
+    BENCHMARK(BM_real_forward<KissFftBackend, float>)->RangeMultiplier(4)->Range(256, 16384);
+    BENCHMARK(BM_real_forward<FourierFftBackend, float>)->RangeMultiplier(4)->Range(256, 16384);
+    BENCHMARK(BM_real_forward<KissFftBackend, double>)->RangeMultiplier(4)->Range(256, 16384);
+    BENCHMARK(BM_real_forward<FourierFftBackend, double>)->RangeMultiplier(4)->Range(256, 16384);
+
+    BENCHMARK(BM_real_inverse<KissFftBackend, float>)->RangeMultiplier(4)->Range(256, 16384);
+    BENCHMARK(BM_real_inverse<FourierFftBackend, float>)->RangeMultiplier(4)->Range(256, 16384);
+
+    BENCHMARK(BM_complex_forward<KissFftBackend, float>)->RangeMultiplier(4)->Range(256, 16384);
+    BENCHMARK(BM_complex_forward<FourierFftBackend, float>)->RangeMultiplier(4)->Range(256, 16384);
+    BENCHMARK(BM_complex_forward<KissFftBackend, double>)->RangeMultiplier(4)->Range(256, 16384);
+    BENCHMARK(BM_complex_forward<FourierFftBackend, double>)->RangeMultiplier(4)->Range(256, 16384);
+} // namespace
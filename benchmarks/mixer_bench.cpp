@@ -0,0 +1,123 @@
+#include <mixer.hpp>
+#include <tone_source.hpp>
+#include <wav_writer.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <numbers>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace wt;
+using wt::support::ToneSource;
+
+namespace {
+    constexpr std::uint32_t CHANNELS    = ToneSource::CHANNELS;
+    constexpr std::uint32_t SAMPLE_RATE = ToneSource::SAMPLE_RATE;
+
+    // A 10ms period, what a low latency device typically asks for
+    constexpr std::uint32_t PERIOD = 480;
+
+    // A few seconds of 16 bit stereo at 44.1kHz, so every stream is both
+    // decoded and resampled to the device rate
+    std::filesystem::path const& tone_file() {
+        static std::filesystem::path const path = [] {
+            constexpr std::uint32_t rate   = 44100;
+            constexpr std::uint32_t frames = rate * 5;
+
+            std::vector<std::int16_t> samples(std::size_t{frames} * CHANNELS);
+            for (std::uint32_t i = 0; i < frames; ++i) {
+                auto const sample = static_cast<std::int16_t>(
+                    10000 * std::sin(2 * std::numbers::pi_v<double> * 440 * i / rate));
+                samples[i * 2]     = sample;
+                samples[i * 2 + 1] = sample;
+            }
+
+            auto const path = std::filesystem::temp_directory_path() / "mixer_bench.wav";
+            support::write_wav(path, support::WavFormat{1, CHANNELS, 16, rate}, std::as_bytes(std::span{samples}));
+            return path;
+        }();
+        return path;
+    }
+
+    MixerOptions options(std::size_t streams) {
+        MixerOptions ret;
+        ret.sample_rate            = SAMPLE_RATE;
+        ret.channels               = CHANNELS;
+        ret.max_streams            = streams;
+        ret.playback.backend       = ma_backend_null;
+        ret.playback.period_frames = PERIOD;
+        ret.playback.periods       = 3;
+        return ret;
+    }
+
+    // The callback alone: how long one period of N streams takes to copy
+    // into their taps and add up. Reported as how many streams one core
+    // could mix down in real time.
+    void BM_mix_down(benchmark::State& state) {
+        auto const streams = static_cast<std::size_t>(state.range(0));
+        Mixer mixer{options(streams)};
+        for (std::size_t i = 0; i < streams; ++i) {
+            mixer.add(std::make_unique<ToneSource>(1, 0.5f));
+        }
+
+        std::vector<float> output(PERIOD * CHANNELS);
+        for (auto _ : state) {
+            mixer.mix(output.data(), PERIOD);
+            benchmark::DoNotOptimize(output.data());
+        }
+
+        double const audio_seconds = static_cast<double>(PERIOD) / SAMPLE_RATE;
+        state.counters["realtime_streams"] = benchmark::Counter(
+            static_cast<double>(state.iterations() * streams) * audio_seconds, benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_mix_down)->RangeMultiplier(2)->Range(1, 256);
+
+    // The whole pipeline in real time on the null device: N files decoded
+    // and resampled on their own threads, mixed in the callback and
+    // analysed on the workers. The largest N still `sustained` is how many
+    // 48kHz stereo streams this machine keeps up with.
+    void BM_decoded_streams(benchmark::State& state) {
+        auto const streams = static_cast<std::size_t>(state.range(0));
+        for (auto _ : state) {
+            Mixer mixer{options(streams)};
+            for (std::size_t i = 0; i < streams; ++i) {
+                if (!mixer.add(tone_file().string())) {
+                    state.SkipWithError("could not open the test file");
+                    return;
+                }
+            }
+            if (!mixer.start()) {
+                state.SkipWithError("could not open the null device");
+                return;
+            }
+
+            // Let the decoders fill up before counting
+            std::this_thread::sleep_for(std::chrono::milliseconds{200});
+            mixer.reset_callback_stats();
+            std::this_thread::sleep_for(std::chrono::seconds{1});
+
+            auto const stats  = mixer.callback_stats();
+            auto const period = std::chrono::duration<double>{static_cast<double>(PERIOD) / SAMPLE_RATE};
+            auto const p99    = std::chrono::duration<double>{stats.duration.quantile(0.99)};
+
+            state.counters["callbacks"]  = static_cast<double>(stats.callbacks);
+            state.counters["underflows"] = static_cast<double>(stats.underflows);
+            state.counters["p99_load"]   = p99 / period;
+            state.counters["sustained"]  = stats.underflows == 0 && stats.budget_overruns == 0 ? 1 : 0;
+        }
+    }
+    BENCHMARK(BM_decoded_streams)
+        ->RangeMultiplier(2)
+        ->Range(1, 64)
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+} // namespace
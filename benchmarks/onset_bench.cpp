@@ -0,0 +1,54 @@
+#include <analysis/beat_tracker.hpp>
+#include <analysis/onset.hpp>
+
+#include "bench_util.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+using namespace wt::analysis;
+using wt::bench::make_noise;
+
+namespace {
+    constexpr std::size_t BINS = WINDOW_SIZE / 2 + 1;
+
+    // Frames of magnitudes to cycle through
+    std::vector<std::vector<float>> make_frames() {
+        auto const noise = make_noise(64 * BINS, 0.0f, 1.0f);
+        std::vector<std::vector<float>> ret;
+        for (std::size_t i = 0; i < noise.size(); i += BINS) {
+            ret.emplace_back(noise.begin() + i, noise.begin() + i + BINS);
+        }
+        return ret;
+    }
+
+    // One analysis frame through the onset detector, O(bins)
+    void BM_onset_detector(benchmark::State& state) {
+        auto const frames = make_frames();
+        OnsetDetector detector;
+        std::uint64_t position = 0;
+        for (auto _ : state) {
+            auto const onset = detector.push(position, frames[(position / THREE_QUARTER_OVERLAP) % frames.size()]);
+            benchmark::DoNotOptimize(onset);
+            position += THREE_QUARTER_OVERLAP;
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+    BENCHMARK(BM_onset_detector);
+
+    // One onset strength through the beat tracker, O(lags)
+    void BM_beat_tracker(benchmark::State& state) {
+        BeatTracker tracker;
+        std::uint64_t position = 0;
+        for (auto _ : state) {
+            auto const frame = position / THREE_QUARTER_OVERLAP;
+            auto const beat  = tracker.push(position, frame % 47 == 0 ? 1.0f : 0.01f * static_cast<float>(frame % 7));
+            benchmark::DoNotOptimize(beat);
+            position += THREE_QUARTER_OVERLAP;
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    }
+    BENCHMARK(BM_beat_tracker);
+} // namespace
@@ -0,0 +1,129 @@
+#include <analysis/analysis.hpp>
+#include <analysis/hann_window.hpp>
+#include <analysis/pipeline.hpp>
+
+#include "bench_util.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <functional>
+
+using namespace wt::analysis;
+using wt::bench::make_noise;
+
+namespace {
+    constexpr std::size_t BINS  = WINDOW_SIZE / 2 + 1;
+    constexpr std::size_t BANDS = 100;
+
+    std::array<float, WINDOW_SIZE> make_window() {
+        auto const noise = make_noise(WINDOW_SIZE);
+        std::array<float, WINDOW_SIZE> ret;
+        std::ranges::copy(noise, ret.begin());
+        return ret;
+    }
+
+    // Window to bars through the processor functions: a copy, a window
+    // called through std::function, the FFT, then a loop each for the
+    // magnitude, the weighting and the binning
+    void BM_dynamic_processors(benchmark::State& state) {
+        auto const window  = make_window();
+        auto const hann    = make_hann_coefficients<WINDOW_SIZE>();
+        auto const weights = make_hann_coefficients<BINS>();
+
+        FftAnalyzer<> analyzer;
+        analyzer.set_preprocessor([&](std::array<float, WINDOW_SIZE>& buffer) {
+            for (std::size_t i = 0; i < WINDOW_SIZE; ++i) {
+                buffer[i] *= hann[i];
+            }
+        });
+
+        std::array<std::complex<float>, BINS> spectrum;
+        std::array<float, BINS> magnitudes;
+        std::array<float, BANDS> bars;
+        for (auto _ : state) {
+            analyzer.analyze(std::span{&window, 1}, std::span{&spectrum, 1});
+            std::ranges::transform(spectrum, magnitudes.begin(), [](std::complex<float> in) { return std::abs(in); });
+            for (std::size_t k = 0; k < BINS; ++k) {
+                magnitudes[k] *= weights[k];
+            }
+
+            constexpr std::size_t width = BINS / BANDS;
+            for (std::size_t i = 0; i < BANDS; ++i) {
+                float total = 0;
+                for (std::size_t j = 0; j < width; ++j) {
+                    total += magnitudes[i * width + j];
+                }
+                bars[i] = total / width;
+            }
+            benchmark::DoNotOptimize(bars.data());
+        }
+    }
+    BENCHMARK(BM_dynamic_processors);
+
+    // The same bars through the pipeline, one pass each side of the FFT
+    void BM_static_pipeline(benchmark::State& state) {
+        auto const window = make_window();
+
+        auto pipeline = make_pipeline<WINDOW_SIZE>(hann_windowing<WINDOW_SIZE>(), Magnitude{},
+            Weighting<BINS>{make_hann_coefficients<BINS>()}, LinearBinning<BINS, BANDS>{});
+
+        std::array<float, BANDS> bars;
+        for (auto _ : state) {
+            pipeline.run(window, bars);
+            benchmark::DoNotOptimize(bars.data());
+        }
+    }
+    BENCHMARK(BM_static_pipeline);
+
+    // The stages after the FFT alone, where the two differ the most
+    void BM_dynamic_post_fft(benchmark::State& state) {
+        FftAnalyzer<> analyzer;
+        auto const spectrum = analyzer.analyze(make_window());
+        auto const weights  = make_hann_coefficients<BINS>();
+
+        std::function<void(std::array<float, BINS>&)> weighting = [&](std::array<float, BINS>& buffer) {
+            for (std::size_t k = 0; k < BINS; ++k) {
+                buffer[k] *= weights[k];
+            }
+        };
+
+        std::array<float, BINS> magnitudes;
+        std::array<float, BANDS> bars;
+        for (auto _ : state) {
+            std::ranges::transform(spectrum, magnitudes.begin(), [](std::complex<float> in) { return std::abs(in); });
+            weighting(magnitudes);
+
+            constexpr std::size_t width = BINS / BANDS;
+            for (std::size_t i = 0; i < BANDS; ++i) {
+                float total = 0;
+                for (std::size_t j = 0; j < width; ++j) {
+                    total += magnitudes[i * width + j];
+                }
+                bars[i] = total / width;
+            }
+            benchmark::DoNotOptimize(bars.data());
+        }
+    }
+    BENCHMARK(BM_dynamic_post_fft);
+
+    void BM_static_post_fft(benchmark::State& state) {
+        FftAnalyzer<> analyzer;
+        auto const spectrum = analyzer.analyze(make_window());
+
+        auto pipeline = make_pipeline<WINDOW_SIZE>(
+            Magnitude{}, Weighting<BINS>{make_hann_coefficients<BINS>()}, LinearBinning<BINS, BANDS>{});
+
+        std::array<float, BANDS> bars;
+        for (auto _ : state) {
+            pipeline.clear(bars);
+            pipeline.accumulate(spectrum, bars);
+            benchmark::DoNotOptimize(bars.data());
+        }
+    }
+    BENCHMARK(BM_static_post_fft);
+} // namespace
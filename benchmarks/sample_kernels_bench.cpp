@@ -0,0 +1,83 @@
+#include <sample_kernels.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace wt::kernels;
+
+namespace {
+    // One device period of stereo audio at a typical period size
+    constexpr std::size_t SAMPLES = 2 * 1024;
+
+    template <typename Kernel>
+    void register_kernel(std::string const& name, Kernel&& run) {
+        for (auto const isa :
+            {InstructionSet::scalar, InstructionSet::sse2, InstructionSet::avx2, InstructionSet::avx512}) {
+            auto const* kernels = kernels_for(isa);
+            if (kernels == nullptr) {
+                continue;
+            }
+
+            // Reported items per second are samples per second
+            benchmark::RegisterBenchmark((name + "/" + std::string{to_string(isa)}).c_str(),
+                [kernels, run](benchmark::State& state) {
+                    for (auto _ : state) {
+                        run(*kernels);
+                    }
+                    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * SAMPLES));
+                });
+        }
+    }
+
+    std::vector<std::int16_t> s16_source(SAMPLES, 1234);
+    std::vector<std::int32_t> s32_source(SAMPLES, 123456789);
+    std::vector<float> f32_source(SAMPLES, 0.5f);
+    std::vector<std::int16_t> s16_destination(SAMPLES);
+    std::vector<std::int32_t> s32_destination(SAMPLES);
+    std::vector<float> f32_destination(SAMPLES);
+    std::vector<float> f32_left(SAMPLES / 2);
+    std::vector<float> f32_right(SAMPLES / 2);
+
+    int const registered = [] {
+        register_kernel("s16_to_f32", [](SampleKernels const& k) {
+            k.s16_to_f32(f32_destination.data(), s16_source.data(), SAMPLES, 0.8f);
+            benchmark::DoNotOptimize(f32_destination.data());
+        });
+        register_kernel("s32_to_f32", [](SampleKernels const& k) {
+            k.s32_to_f32(f32_destination.data(), s32_source.data(), SAMPLES, 0.8f);
+            benchmark::DoNotOptimize(f32_destination.data());
+        });
+        register_kernel("gain_f32", [](SampleKernels const& k) {
+            k.gain_f32(f32_destination.data(), f32_source.data(), SAMPLES, 0.8f);
+            benchmark::DoNotOptimize(f32_destination.data());
+        });
+        register_kernel("gain_s16", [](SampleKernels const& k) {
+            k.gain_s16(s16_destination.data(), s16_source.data(), SAMPLES, 0.8f);
+            benchmark::DoNotOptimize(s16_destination.data());
+        });
+        register_kernel("gain_s32", [](SampleKernels const& k) {
+            k.gain_s32(s32_destination.data(), s32_source.data(), SAMPLES, 0.8f);
+            benchmark::DoNotOptimize(s32_destination.data());
+        });
+        register_kernel("deinterleave_stereo", [](SampleKernels const& k) {
+            float* const planes[] = {f32_left.data(), f32_right.data()};
+            k.deinterleave(planes, f32_source.data(), SAMPLES / 2, 2);
+            benchmark::DoNotOptimize(f32_left.data());
+            benchmark::DoNotOptimize(f32_right.data());
+        });
+        register_kernel("mix_f32", [](SampleKernels const& k) {
+            k.mix_f32(f32_destination.data(), f32_source.data(), SAMPLES, 0.8f);
+            benchmark::DoNotOptimize(f32_destination.data());
+        });
+        register_kernel("mid_side", [](SampleKernels const& k) {
+            k.mid_side(f32_left.data(), f32_right.data(), f32_source.data(), f32_source.data() + SAMPLES / 2,
+                SAMPLES / 2);
+            benchmark::DoNotOptimize(f32_left.data());
+            benchmark::DoNotOptimize(f32_right.data());
+        });
+        return 0;
+    }();
+} // namespace
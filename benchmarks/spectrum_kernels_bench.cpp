@@ -0,0 +1,99 @@
+#include <analysis/hann_window.hpp>
+#include <analysis/spectrum_kernels.hpp>
+#include <analysis/window_size.hpp>
+
+#include "bench_util.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace wt::kernels;
+
+namespace {
+    // The coefficients of one analysis window
+    constexpr std::size_t BINS = wt::analysis::WINDOW_SIZE / 2 + 1;
+
+    std::vector<std::complex<float>> make_coefficients() {
+        auto const noise = wt::bench::make_noise(2 * BINS, -100.0f, 100.0f);
+        std::vector<std::complex<float>> ret(BINS);
+        for (std::size_t k = 0; k < BINS; ++k) {
+            ret[k] = {noise[2 * k], noise[2 * k + 1]};
+        }
+        return ret;
+    }
+
+    std::vector<std::complex<float>> const coefficients = make_coefficients();
+    std::vector<float> const weights                    = wt::analysis::make_hann_coefficients(BINS);
+    std::vector<float> destination(BINS);
+
+    template <typename Kernel>
+    void register_kernel(std::string const& name, Kernel&& run) {
+        for (auto const isa :
+            {InstructionSet::scalar, InstructionSet::sse2, InstructionSet::avx2, InstructionSet::avx512}) {
+            auto const* kernels = spectrum_kernels_for(isa);
+            if (kernels == nullptr) {
+                continue;
+            }
+
+            // Reported items per second are bins per second
+            benchmark::RegisterBenchmark((name + "/" + std::string{to_string(isa)}).c_str(),
+                [kernels, run](benchmark::State& state) {
+                    for (auto _ : state) {
+                        run(*kernels);
+                    }
+                    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * BINS));
+                });
+        }
+    }
+
+    // What the render loop did: std::abs per bin, then the weights in a
+    // second loop
+    void BM_two_loop_magnitude(benchmark::State& state) {
+        for (auto _ : state) {
+            std::ranges::transform(
+                coefficients, destination.begin(), [](std::complex<float> in) { return std::abs(in); });
+            for (std::size_t k = 0; k < BINS; ++k) {
+                destination[k] *= weights[k];
+            }
+            benchmark::DoNotOptimize(destination.data());
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * BINS));
+    }
+    BENCHMARK(BM_two_loop_magnitude);
+
+    // The same for decibels, through std::log10
+    void BM_two_loop_decibels(benchmark::State& state) {
+        for (auto _ : state) {
+            std::ranges::transform(
+                coefficients, destination.begin(), [](std::complex<float> in) { return std::norm(in); });
+            for (std::size_t k = 0; k < BINS; ++k) {
+                destination[k] = 10 * std::log10(std::max(destination[k] * weights[k], DECIBEL_FLOOR_POWER));
+            }
+            benchmark::DoNotOptimize(destination.data());
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * BINS));
+    }
+    BENCHMARK(BM_two_loop_decibels);
+
+    int const registered = [] {
+        register_kernel("magnitude", [](SpectrumKernels const& k) {
+            k.magnitude(destination.data(), coefficients.data(), weights.data(), BINS);
+            benchmark::DoNotOptimize(destination.data());
+        });
+        register_kernel("power", [](SpectrumKernels const& k) {
+            k.power(destination.data(), coefficients.data(), weights.data(), BINS);
+            benchmark::DoNotOptimize(destination.data());
+        });
+        register_kernel("decibels", [](SpectrumKernels const& k) {
+            k.decibels(destination.data(), coefficients.data(), weights.data(), BINS);
+            benchmark::DoNotOptimize(destination.data());
+        });
+        return 0;
+    }();
+} // namespace
@@ -0,0 +1,87 @@
+#include <analysis/analysis.hpp>
+#include <analysis/hann_window.hpp>
+#include <analysis/stft.hpp>
+
+#include "bench_util.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+using namespace wt::analysis;
+using wt::bench::make_noise;
+
+namespace {
+    constexpr std::size_t CHANNELS    = 2;
+    constexpr std::size_t SAMPLE_RATE = 48000;
+
+    // A second of audio, pushed in 10ms chunks as the render loop would
+    constexpr std::size_t FRAMES = SAMPLE_RATE;
+    constexpr std::size_t CHUNK  = SAMPLE_RATE / 100;
+
+    void report(benchmark::State& state, std::size_t frames_out) {
+        state.counters["frames_per_s"] = benchmark::Counter(
+            static_cast<double>(frames_out), benchmark::Counter::kIsIterationInvariantRate);
+        state.counters["realtime_x"] = benchmark::Counter(
+            static_cast<double>(FRAMES) / SAMPLE_RATE, benchmark::Counter::kIsIterationInvariantRate);
+    }
+
+    // The streaming STFT over a second of stereo, argument is the hop
+    void BM_stft(benchmark::State& state) {
+        auto const samples = make_noise(FRAMES * CHANNELS);
+        auto const hop     = static_cast<std::size_t>(state.range(0));
+
+        Stft stft{CHANNELS, hop};
+        std::size_t frames_out = 0;
+        for (auto _ : state) {
+            stft.reset();
+            frames_out = 0;
+            for (std::size_t i = 0; i < FRAMES; i += CHUNK) {
+                stft.push(std::span{samples}.subspan(i * CHANNELS, CHUNK * CHANNELS), [&](StftFrame const& frame) {
+                    benchmark::DoNotOptimize(frame.spectra.data());
+                    ++frames_out;
+                });
+            }
+        }
+        report(state, frames_out);
+    }
+    BENCHMARK(BM_stft)->Arg(HALF_OVERLAP)->Arg(THREE_QUARTER_OVERLAP);
+
+    // What the STFT replaces: every hop deinterleaves the whole window
+    // again and hands it to the analyzer, which copies it once more
+    void BM_recopy_per_hop(benchmark::State& state) {
+        auto const samples = make_noise(FRAMES * CHANNELS);
+        auto const hop     = static_cast<std::size_t>(state.range(0));
+        auto const hann    = make_hann_coefficients<WINDOW_SIZE>();
+
+        FftAnalyzer<> analyzer;
+        analyzer.set_preprocessor([&](std::array<float, WINDOW_SIZE>& buffer) {
+            for (std::size_t i = 0; i < WINDOW_SIZE; ++i) {
+                buffer[i] *= hann[i];
+            }
+        });
+
+        std::vector<std::array<float, WINDOW_SIZE>> windows(CHANNELS);
+        std::vector<std::array<std::complex<float>, WINDOW_SIZE / 2 + 1>> spectra(CHANNELS);
+        std::size_t frames_out = 0;
+        for (auto _ : state) {
+            frames_out = 0;
+            for (std::size_t start = 0; start + WINDOW_SIZE <= FRAMES; start += hop) {
+                for (std::size_t i = 0; i < WINDOW_SIZE; ++i) {
+                    for (std::size_t c = 0; c < CHANNELS; ++c) {
+                        windows[c][i] = samples[(start + i) * CHANNELS + c];
+                    }
+                }
+                analyzer.analyze(windows, spectra);
+                benchmark::DoNotOptimize(spectra.data());
+                ++frames_out;
+            }
+        }
+        report(state, frames_out);
+    }
+    BENCHMARK(BM_recopy_per_hop)->Arg(HALF_OVERLAP)->Arg(THREE_QUARTER_OVERLAP);
+} // namespace
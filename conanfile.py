@@ -6,6 +6,7 @@ class WavyTuneConan(ConanFile):
     generators = "CMakeDeps", "CMakeToolchain"
 
     def requirements(self):
+        self.requires("benchmark/1.9.1")
         self.requires("cxxopts/3.2.0")
         self.requires("fmt/11.2.0")
         self.requires("glew/2.2.0")
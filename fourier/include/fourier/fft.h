@@ -0,0 +1,92 @@
+#ifndef FOURIER_FFT_H
+#define FOURIER_FFT_H
+
+// Includes from the std
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wt
+{
+  namespace ft
+  {
+    /// Iterative radix-2 FFT of one power of two size.
+    ///
+    /// The bit reversal and the twiddles of every stage are worked out
+    /// when it is made, each stage's twiddles next to each other so the
+    /// butterflies read them in order. Nothing changes after that, so any
+    /// number of threads can transform with one at once.
+    /// @tparam T is float or double.
+    template <typename T> class Fft
+    {
+    public:
+      /// @param size points per transform, a power of two.
+      /// @throws std::invalid_argument for any other size.
+      explicit Fft(std::size_t size);
+
+      /// Forward transform, e^-i, of `size()` points from `input` to
+      /// `output`, which must not overlap.
+      void forward(const std::complex<T> *input,
+                   std::complex<T> *output) const;
+
+      /// Inverse transform, e^+i, without the 1 / size scaling.
+      void inverse(const std::complex<T> *input,
+                   std::complex<T> *output) const;
+
+      std::size_t size() const { return size_; }
+
+    private:
+      template <bool Inverse>
+      void transform_(const std::complex<T> *input,
+                      std::complex<T> *output) const;
+
+      std::size_t size_;
+      std::vector<std::uint32_t> reversed_;
+
+      // The twiddles of the stage with butterflies `half` apart start at
+      // `half - 1`
+      std::vector<std::complex<T>> twiddles_;
+    };
+
+    /// FFT of real signals of one even size, through a complex FFT of half
+    /// the size, with the even samples as the real parts and the odd ones
+    /// as the imaginary parts.
+    /// @tparam T is float or double.
+    template <typename T> class RealFft
+    {
+    public:
+      /// @param size samples per transform, twice a power of two.
+      /// @throws std::invalid_argument for any other size.
+      explicit RealFft(std::size_t size);
+
+      /// The `bins()` coefficients of `size()` samples.
+      /// @param scratch room for `size() / 2` values, the caller's own.
+      void forward(const T *input, std::complex<T> *output,
+                   std::complex<T> *scratch) const;
+
+      /// The `size()` samples of `bins()` coefficients, without the
+      /// 1 / size scaling.
+      /// @param scratch room for `size() / 2` values, the caller's own.
+      void inverse(const std::complex<T> *input, T *output,
+                   std::complex<T> *scratch) const;
+
+      std::size_t size() const { return half_.size() * 2; }
+      std::size_t bins() const { return half_.size() + 1; }
+
+    private:
+      Fft<T> half_;
+
+      // e^-i2pi k / size, splitting the half size transform into the real
+      // one
+      std::vector<std::complex<T>> split_;
+    };
+
+    extern template class Fft<float>;
+    extern template class Fft<double>;
+    extern template class RealFft<float>;
+    extern template class RealFft<double>;
+  } // namespace ft
+} // namespace wt
+
+#endif // FOURIER_FFT_H
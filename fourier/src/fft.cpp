@@ -0,0 +1,194 @@
+#include <fourier/fft.h>
+
+#include <numbers>
+#include <stdexcept>
+
+namespace wt
+{
+  namespace ft
+  {
+    namespace
+    {
+      // The complex product written out, std::complex checks every product
+      // for infinities
+      template <typename T>
+      inline std::complex<T> multiply(std::complex<T> a, std::complex<T> b)
+      {
+        return {a.real() * b.real() - a.imag() * b.imag(),
+                a.real() * b.imag() + a.imag() * b.real()};
+      }
+
+      bool is_power_of_two(std::size_t n)
+      {
+        return n > 0 && (n & (n - 1)) == 0;
+      }
+    } // namespace
+
+    template <typename T> Fft<T>::Fft(std::size_t size) : size_{size}
+    {
+      if (!is_power_of_two(size))
+      {
+        throw std::invalid_argument("the FFT size must be a power of two");
+      }
+
+      std::size_t bits = 0;
+      while ((static_cast<std::size_t>(1) << bits) < size)
+      {
+        ++bits;
+      }
+      reversed_.resize(size);
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        std::size_t reversed = 0;
+        for (std::size_t bit = 0; bit < bits; ++bit)
+        {
+          reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        reversed_[i] = static_cast<std::uint32_t>(reversed);
+      }
+
+      // Worked out in double whatever T is
+      twiddles_.reserve(size > 1 ? size - 1 : 0);
+      for (std::size_t half = 1; half < size; half *= 2)
+      {
+        for (std::size_t j = 0; j < half; ++j)
+        {
+          const double phase = -std::numbers::pi * static_cast<double>(j) /
+                               static_cast<double>(half);
+          twiddles_.emplace_back(static_cast<T>(std::cos(phase)),
+                                 static_cast<T>(std::sin(phase)));
+        }
+      }
+    }
+
+    template <typename T>
+    template <bool Inverse>
+    void Fft<T>::transform_(const std::complex<T> *input,
+                            std::complex<T> *output) const
+    {
+      const std::size_t n = size_;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        output[reversed_[i]] = input[i];
+      }
+
+      // The first two stages need no multiplies, their twiddles are 1 and -i
+      for (std::size_t start = 0; n >= 2 && start < n; start += 2)
+      {
+        const auto a = output[start];
+        const auto b = output[start + 1];
+        output[start] = a + b;
+        output[start + 1] = a - b;
+      }
+      for (std::size_t start = 0; n >= 4 && start < n; start += 4)
+      {
+        const auto a = output[start + 1];
+        const auto b = output[start + 3];
+        // b times -i going forwards, +i going backwards
+        const std::complex<T> turned =
+            Inverse ? std::complex<T>{-b.imag(), b.real()}
+                    : std::complex<T>{b.imag(), -b.real()};
+        const auto c = output[start];
+        const auto d = output[start + 2];
+        output[start] = c + d;
+        output[start + 2] = c - d;
+        output[start + 1] = a + turned;
+        output[start + 3] = a - turned;
+      }
+
+      for (std::size_t half = 4; half < n; half *= 2)
+      {
+        const std::complex<T> *twiddles = twiddles_.data() + half - 1;
+        for (std::size_t start = 0; start < n; start += 2 * half)
+        {
+          std::complex<T> *low = output + start;
+          std::complex<T> *high = low + half;
+          for (std::size_t j = 0; j < half; ++j)
+          {
+            const auto twiddle =
+                Inverse ? std::conj(twiddles[j]) : twiddles[j];
+            const auto b = multiply(high[j], twiddle);
+            const auto a = low[j];
+            low[j] = a + b;
+            high[j] = a - b;
+          }
+        }
+      }
+    }
+
+    template <typename T>
+    void Fft<T>::forward(const std::complex<T> *input,
+                         std::complex<T> *output) const
+    {
+      transform_<false>(input, output);
+    }
+
+    template <typename T>
+    void Fft<T>::inverse(const std::complex<T> *input,
+                         std::complex<T> *output) const
+    {
+      transform_<true>(input, output);
+    }
+
+    template <typename T>
+    RealFft<T>::RealFft(std::size_t size)
+        : half_{size % 2 == 0 ? size / 2 : 0}, split_(size / 2)
+    {
+      for (std::size_t k = 0; k < split_.size(); ++k)
+      {
+        const double phase = -2 * std::numbers::pi * static_cast<double>(k) /
+                             static_cast<double>(size);
+        split_[k] = {static_cast<T>(std::cos(phase)),
+                     static_cast<T>(std::sin(phase))};
+      }
+    }
+
+    template <typename T>
+    void RealFft<T>::forward(const T *input, std::complex<T> *output,
+                             std::complex<T> *scratch) const
+    {
+      // A real array is an array of complex pairs
+      const std::size_t half = half_.size();
+      half_.forward(reinterpret_cast<const std::complex<T> *>(input), scratch);
+
+      const auto dc = scratch[0];
+      output[0] = {dc.real() + dc.imag(), 0};
+      output[half] = {dc.real() - dc.imag(), 0};
+
+      // The transforms of the even and the odd samples are the conjugate
+      // symmetric and antisymmetric parts of the half size transform
+      for (std::size_t k = 1; k <= half / 2; ++k)
+      {
+        const auto mirror = std::conj(scratch[half - k]);
+        const auto even = scratch[k] + mirror;
+        const auto difference = scratch[k] - mirror;
+        const auto odd = multiply(
+            std::complex<T>{difference.imag(), -difference.real()}, split_[k]);
+        output[k] = (even + odd) * T{0.5};
+        output[half - k] = std::conj(even - odd) * T{0.5};
+      }
+    }
+
+    template <typename T>
+    void RealFft<T>::inverse(const std::complex<T> *input, T *output,
+                             std::complex<T> *scratch) const
+    {
+      // The half size spectrum of the even samples plus i times the odd
+      // ones, the forward split run backwards
+      const std::size_t half = half_.size();
+      for (std::size_t k = 0; k < half; ++k)
+      {
+        const auto mirror = std::conj(input[half - k]);
+        const auto even = input[k] + mirror;
+        const auto odd = multiply(input[k] - mirror, std::conj(split_[k]));
+        scratch[k] = {even.real() - odd.imag(), even.imag() + odd.real()};
+      }
+      half_.inverse(scratch, reinterpret_cast<std::complex<T> *>(output));
+    }
+
+    template class Fft<float>;
+    template class Fft<double>;
+    template class RealFft<float>;
+    template class RealFft<double>;
+  } // namespace ft
+} // namespace wt
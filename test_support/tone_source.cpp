@@ -0,0 +1,82 @@
+#include "tone_source.hpp"
+
+#include <analysis/window_size.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+
+namespace {
+    // One cycle of sine over an analysis window
+    std::array<float, wt::analysis::WINDOW_SIZE> const& sine_table() {
+        static auto const table = [] {
+            std::array<float, wt::analysis::WINDOW_SIZE> ret{};
+            for (std::size_t i = 0; i < ret.size(); ++i) {
+                ret[i] = static_cast<float>(std::sin(2 * std::numbers::pi * static_cast<double>(i) / ret.size()));
+            }
+            return ret;
+        }();
+        return table;
+    }
+} // namespace
+
+namespace wt::support {
+
+    ToneSource::ToneSource(std::uint32_t cycles, float level, std::uint64_t frames, bool starved)
+        : _cycles{cycles},
+          _level{level},
+          _frames{frames},
+          _starved{starved},
+          _position{0} {}
+
+    void ToneSource::start() {}
+
+    std::uint32_t ToneSource::read(void* output, std::uint32_t frames, float gain) {
+        auto const& table       = sine_table();
+        auto* samples           = static_cast<float*>(output);
+        std::uint32_t const end = static_cast<std::uint32_t>(
+            std::min<std::uint64_t>(_starved ? frames / 2 : frames, _frames - _position));
+        for (std::uint32_t i = 0; i < end; ++i, ++_position) {
+            samples[i * 2]     = table[(_position * _cycles) % table.size()] * gain;
+            samples[i * 2 + 1] = _level * gain;
+        }
+        return end;
+    }
+
+    bool ToneSource::finished() const {
+        return _position == _frames;
+    }
+
+    bool ToneSource::seek(std::uint64_t, std::uint32_t) {
+        return false;
+    }
+
+    void ToneSource::take_seek() {}
+
+    std::span<std::byte const> ToneSource::take_primer() {
+        return {};
+    }
+
+    std::uint64_t ToneSource::position() const {
+        return _position;
+    }
+
+    FifoWatermark ToneSource::watermark() const {
+        return FifoWatermark{};
+    }
+
+    void ToneSource::reset_watermark() {}
+
+    ma_format ToneSource::format() const {
+        return ma_format_f32;
+    }
+
+    std::uint32_t ToneSource::channels() const {
+        return CHANNELS;
+    }
+
+    std::uint32_t ToneSource::sample_rate() const {
+        return SAMPLE_RATE;
+    }
+} // namespace wt::support
@@ -0,0 +1,51 @@
+#ifndef TEST_SUPPORT_TONE_SOURCE_H
+#define TEST_SUPPORT_TONE_SOURCE_H
+
+#include <audio_source.hpp>
+
+#include <cstdint>
+#include <limits>
+
+namespace wt::support {
+
+    /**
+     * @brief A 48kHz stereo source for tests and benchmarks, with no file
+     * or decoder behind it: a sine wave that completes `cycles` cycles per
+     * analysis window on the left channel and a constant on the right.
+     *
+     * The sine comes out of a table, so producing it costs next to nothing
+     * next to what is being measured. Starved sources hand out fewer frames
+     * than asked for without ending.
+     */
+    class ToneSource : public AudioSource {
+    public:
+        static constexpr std::uint32_t CHANNELS    = 2;
+        static constexpr std::uint32_t SAMPLE_RATE = 48000;
+        static constexpr std::uint64_t ENDLESS     = std::numeric_limits<std::uint64_t>::max();
+
+        /// @param frames how long the source plays, for ever by default.
+        ToneSource(std::uint32_t cycles, float level, std::uint64_t frames = ENDLESS, bool starved = false);
+
+        void start() override;
+        std::uint32_t read(void* output, std::uint32_t frames, float gain) override;
+        [[nodiscard]] bool finished() const override;
+        bool seek(std::uint64_t frame, std::uint32_t primer_frames) override;
+        void take_seek() override;
+        std::span<std::byte const> take_primer() override;
+        [[nodiscard]] std::uint64_t position() const override;
+        [[nodiscard]] FifoWatermark watermark() const override;
+        void reset_watermark() override;
+        [[nodiscard]] ma_format format() const override;
+        [[nodiscard]] std::uint32_t channels() const override;
+        [[nodiscard]] std::uint32_t sample_rate() const override;
+
+    private:
+        std::uint32_t _cycles;
+        float _level;
+        std::uint64_t _frames;
+        bool _starved;
+        std::uint64_t _position;
+    };
+} // namespace wt::support
+
+#endif // TEST_SUPPORT_TONE_SOURCE_H
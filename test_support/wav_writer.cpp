@@ -0,0 +1,56 @@
+#include "wav_writer.hpp"
+
+#include <fstream>
+#include <string_view>
+
+namespace {
+    void append(std::vector<std::byte>& out, std::string_view id) {
+        for (char c : id) {
+            out.push_back(static_cast<std::byte>(c));
+        }
+    }
+
+    void append(std::vector<std::byte>& out, std::uint32_t value, std::size_t bytes) {
+        for (std::size_t i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<std::byte>((value >> (8 * i)) & 0xFF));
+        }
+    }
+} // namespace
+
+namespace wt::support {
+
+    std::vector<std::byte> make_wav(
+        WavFormat const& format, std::span<std::byte const> data, std::uint32_t extra_chunk_bytes) {
+        std::uint32_t const block_align = format.channels * format.bits / 8;
+        std::uint32_t const extra       = extra_chunk_bytes > 0 ? 8 + extra_chunk_bytes + (extra_chunk_bytes & 1) : 0;
+        auto const data_bytes           = static_cast<std::uint32_t>(data.size());
+
+        std::vector<std::byte> out;
+        append(out, "RIFF");
+        append(out, 4 + extra + 24 + 8 + data_bytes, 4);
+        append(out, "WAVE");
+        if (extra_chunk_bytes > 0) {
+            append(out, "LIST");
+            append(out, extra_chunk_bytes, 4);
+            out.resize(out.size() + extra_chunk_bytes + (extra_chunk_bytes & 1));
+        }
+        append(out, "fmt ");
+        append(out, 16, 4);
+        append(out, format.tag, 2);
+        append(out, format.channels, 2);
+        append(out, format.sample_rate, 4);
+        append(out, format.sample_rate * block_align, 4);
+        append(out, block_align, 2);
+        append(out, format.bits, 2);
+        append(out, "data");
+        append(out, data_bytes, 4);
+        out.insert(out.end(), data.begin(), data.end());
+        return out;
+    }
+
+    void write_wav(std::filesystem::path const& path, WavFormat const& format, std::span<std::byte const> data) {
+        auto const bytes = make_wav(format, data);
+        std::ofstream out{path, std::ios::binary};
+        out.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+} // namespace wt::support
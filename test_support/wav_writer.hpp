@@ -0,0 +1,34 @@
+#ifndef TEST_SUPPORT_WAV_WRITER_H
+#define TEST_SUPPORT_WAV_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace wt::support {
+
+    /// @brief The "fmt " chunk of a WAV file.
+    struct WavFormat {
+        /// @brief 1 for integer PCM, 3 for IEEE float.
+        std::uint16_t tag;
+        std::uint16_t channels;
+        std::uint16_t bits;
+        std::uint32_t sample_rate;
+    };
+
+    /**
+     * @brief A RIFF WAV file in memory: the header, then `data` as the data
+     * chunk as it is.
+     * @param extra_chunk_bytes the size of a chunk to put before "fmt ",
+     * none by default, as parsers have to skip.
+     */
+    std::vector<std::byte> make_wav(
+        WavFormat const& format, std::span<std::byte const> data, std::uint32_t extra_chunk_bytes = 0);
+
+    /// @brief Writes `make_wav(format, data)` to `path`.
+    void write_wav(std::filesystem::path const& path, WavFormat const& format, std::span<std::byte const> data);
+} // namespace wt::support
+
+#endif // TEST_SUPPORT_WAV_WRITER_H
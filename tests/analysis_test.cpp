@@ -0,0 +1,170 @@
+#include <analysis/analysis.hpp>
+#include <analysis/fft_plan.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <numbers>
+#include <span>
+#include <thread>
+#include <vector>
+
+using namespace wt::analysis;
+
+namespace {
+    using Window   = std::array<float, WINDOW_SIZE>;
+    using Spectrum = std::array<std::complex<float>, WINDOW_SIZE / 2 + 1>;
+
+    Window make_tone(std::size_t bin) {
+        Window ret{};
+        for (std::size_t i = 0; i < ret.size(); ++i) {
+            ret[i] = std::sin(2 * std::numbers::pi_v<float> * bin * i / WINDOW_SIZE);
+        }
+        return ret;
+    }
+} // namespace
+
+TEST(AnalysisTests, batched_matches_single_windows) {
+    FftAnalyzer<> analyzer;
+    std::vector<Window> const inputs{make_tone(10), make_tone(50), make_tone(200)};
+    std::vector<Spectrum> outputs(inputs.size());
+    analyzer.analyze(inputs, outputs);
+
+    for (std::size_t channel = 0; channel < inputs.size(); ++channel) {
+        EXPECT_EQ(outputs[channel], analyzer.analyze(inputs[channel])) << "channel " << channel;
+    }
+}
+
+TEST(AnalysisTests, batched_keeps_channels_apart) {
+    FftAnalyzer<> analyzer;
+    std::vector<Window> const inputs{make_tone(10), make_tone(50)};
+    std::vector<Spectrum> outputs(inputs.size());
+    analyzer.analyze(inputs, outputs);
+
+    EXPECT_GT(std::abs(outputs[0][10]), WINDOW_SIZE / 4);
+    EXPECT_LT(std::abs(outputs[0][50]), 1.0f);
+    EXPECT_GT(std::abs(outputs[1][50]), WINDOW_SIZE / 4);
+    EXPECT_LT(std::abs(outputs[1][10]), 1.0f);
+}
+
+TEST(AnalysisTests, batched_runs_the_processors_per_channel) {
+    FftAnalyzer<> analyzer;
+    int pre_calls  = 0;
+    int post_calls = 0;
+    analyzer.set_preprocessor([&](Window&) { ++pre_calls; });
+    analyzer.set_postprocessor([&](Spectrum&) { ++post_calls; });
+
+    std::vector<Window> const inputs(MAX_CHANNELS);
+    std::vector<Spectrum> outputs(MAX_CHANNELS);
+    analyzer.analyze(inputs, outputs);
+    EXPECT_EQ(pre_calls, MAX_CHANNELS);
+    EXPECT_EQ(post_calls, MAX_CHANNELS);
+}
+
+TEST(AnalysisTests, analyzes_into_the_callers_spans) {
+    FftAnalyzer<> analyzer;
+    Window const tone = make_tone(10);
+
+    std::vector<float> const input(tone.begin(), tone.end());
+    std::vector<std::complex<float>> output(FftAnalyzer<>::BINS);
+    analyzer.analyze(input, output);
+    EXPECT_TRUE(std::ranges::equal(output, analyzer.analyze(tone)));
+}
+
+TEST(AnalysisTests, spans_go_through_the_processors) {
+    FftAnalyzer<> analyzer;
+    analyzer.set_preprocessor([](Window& buffer) { std::ranges::fill(buffer, 1.0f); });
+    analyzer.set_postprocessor([](Spectrum& buffer) { buffer[1] = 3.0f; });
+
+    std::vector<float> const input(WINDOW_SIZE, 0.5f);
+    std::vector<std::complex<float>> output(FftAnalyzer<>::BINS);
+    analyzer.analyze(input, output);
+
+    EXPECT_FLOAT_EQ(output[0].real(), WINDOW_SIZE);
+    EXPECT_EQ(output[1], std::complex<float>(3.0f));
+    EXPECT_EQ(input[0], 0.5f);
+}
+
+TEST(AnalysisTests, plans_are_shared_per_size) {
+    auto const plan = FftPlan::get(512);
+    EXPECT_EQ(plan, FftPlan::get(512));
+    EXPECT_NE(plan, FftPlan::get(1024));
+    EXPECT_EQ(plan->size(), 512);
+    EXPECT_EQ(plan->bins(), 257);
+}
+
+TEST(AnalysisTests, plan_matches_a_direct_transform) {
+    // Odd sizes of the half transform take kissfft's other radixes
+    for (std::size_t const size : {2, 8, 30, 512}) {
+        std::vector<float> input(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            input[i] = std::sin(0.37f * i) + 0.25f * std::cos(1.3f * i);
+        }
+
+        std::vector<std::complex<float>> output(size / 2 + 1);
+        std::vector<std::complex<float>> scratch(size / 2);
+        FftPlan::get(size)->forward(input.data(), output.data(), scratch.data());
+
+        for (std::size_t k = 0; k < output.size(); ++k) {
+            std::complex<double> expected{};
+            for (std::size_t n = 0; n < size; ++n) {
+                expected += std::polar(static_cast<double>(input[n]), -2 * std::numbers::pi * k * n / size);
+            }
+            EXPECT_NEAR(output[k].real(), expected.real(), 1e-3) << "size " << size << " bin " << k;
+            EXPECT_NEAR(output[k].imag(), expected.imag(), 1e-3) << "size " << size << " bin " << k;
+        }
+    }
+}
+
+TEST(AnalysisTests, sized_analyzers_agree) {
+    std::array<float, 512> input{};
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        input[i] = std::sin(2 * std::numbers::pi_v<float> * 20 * i / 512);
+    }
+
+    FftAnalyzer<512> fixed;
+    DynamicFftAnalyzer dynamic{512};
+    EXPECT_EQ(dynamic.bins(), FftAnalyzer<512>::BINS);
+
+    std::vector<std::complex<float>> output(dynamic.bins());
+    dynamic.analyze(input, output);
+    auto const expected = fixed.analyze(input);
+    EXPECT_TRUE(std::ranges::equal(output, expected));
+    EXPECT_GT(std::abs(output[20]), 512 / 4);
+}
+
+TEST(AnalysisTests, dynamic_runs_the_processors) {
+    DynamicFftAnalyzer analyzer{8192};
+    analyzer.set_preprocessor([](std::span<float> buffer) { std::ranges::fill(buffer, 1.0f); });
+    analyzer.set_postprocessor([](std::span<std::complex<float>> buffer) { EXPECT_EQ(buffer.size(), 4097); });
+
+    std::vector<float> const input(8192);
+    std::vector<std::complex<float>> output(analyzer.bins());
+    analyzer.analyze(input, output);
+    EXPECT_FLOAT_EQ(output[0].real(), 8192);
+}
+
+TEST(AnalysisTests, analyzers_share_a_plan_across_threads) {
+    Window const input      = make_tone(10);
+    Spectrum const expected = FftAnalyzer<>{}.analyze(input);
+
+    std::vector<std::jthread> threads;
+    std::vector<int> matches(8);
+    for (std::size_t t = 0; t < matches.size(); ++t) {
+        threads.emplace_back([&, t] {
+            FftAnalyzer<> analyzer;
+            for (int i = 0; i < 50; ++i) {
+                matches[t] += analyzer.analyze(input) == expected;
+            }
+        });
+    }
+    threads.clear();
+
+    for (int const count : matches) {
+        EXPECT_EQ(count, 50);
+    }
+}
@@ -0,0 +1,108 @@
+#include <audio_input.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace wt;
+
+namespace {
+    constexpr std::uint32_t CHANNELS    = 2;
+    constexpr std::uint32_t SAMPLE_RATE = 48000;
+
+    // Counts frames on the left channel and down on the right, so any
+    // gap or repeat shows up in the tap
+    std::unique_ptr<SyntheticInput> counting_input() {
+        return std::make_unique<SyntheticInput>(
+            PcmFormat{ma_format_f32, CHANNELS, SAMPLE_RATE}, 128, [](std::span<float> frames, std::uint64_t first) {
+                for (std::size_t i = 0; i < frames.size() / CHANNELS; ++i) {
+                    frames[i * 2]     = static_cast<float>(first + i);
+                    frames[i * 2 + 1] = -static_cast<float>(first + i);
+                }
+            });
+    }
+
+    bool wait_for_frames(AudioInput const& input, std::uint64_t frames) {
+        auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{2};
+        while (input.tap()->write_position() < frames) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{2});
+        }
+        return true;
+    }
+} // namespace
+
+TEST(AudioInputTests, synthetic_frames_reach_the_tap_in_order) {
+    AudioInput input{counting_input()};
+    EXPECT_EQ(input.tap(), nullptr);
+    ASSERT_TRUE(input.start());
+    ASSERT_NE(input.tap(), nullptr);
+    EXPECT_EQ(input.tap()->channels(), CHANNELS);
+    ASSERT_TRUE(wait_for_frames(input, 1024));
+
+    std::vector<float> frames(1024 * CHANNELS);
+    ASSERT_TRUE(input.tap()->read(0, frames));
+    for (std::size_t i = 0; i < frames.size() / CHANNELS; ++i) {
+        ASSERT_EQ(frames[i * 2], static_cast<float>(i));
+        ASSERT_EQ(frames[i * 2 + 1], -static_cast<float>(i));
+    }
+    EXPECT_GE(input.source().callback_stats().callbacks, 1024 / 128);
+}
+
+TEST(AudioInputTests, synthetic_frames_make_channel_windows) {
+    AudioInput input{counting_input()};
+    ASSERT_TRUE(input.start());
+    ASSERT_TRUE(wait_for_frames(input, WINDOW_SIZE));
+
+    auto windows = std::make_unique<ChannelWindows>();
+    input.current_channel_windows(*windows);
+    ASSERT_EQ(windows->channel_count, CHANNELS);
+
+    // The window is the latest one, and whole
+    auto const last = windows->channels[0].back();
+    EXPECT_GE(last, static_cast<float>(WINDOW_SIZE - 1));
+    EXPECT_EQ(windows->channels[0].front(), last - (WINDOW_SIZE - 1));
+    EXPECT_EQ(windows->channels[1].back(), -last);
+}
+
+TEST(AudioInputTests, captures_silence_from_the_null_backend) {
+    // clang-format off
+    auto device = std::make_unique<CaptureDevice>(CaptureOptions{
+      .channels      = CHANNELS,
+      .sample_rate   = SAMPLE_RATE,
+      .period_frames = 128,
+      .backend       = ma_backend_null
+    });
+    // clang-format on
+    auto const* capture = device.get();
+
+    AudioInput input{std::move(device)};
+    ASSERT_TRUE(input.start());
+    EXPECT_EQ(capture->format(), (PcmFormat{ma_format_f32, CHANNELS, SAMPLE_RATE}));
+    ASSERT_TRUE(capture->device_latency());
+    ASSERT_TRUE(wait_for_frames(input, 1024));
+
+    std::vector<float> frames(1024 * CHANNELS, 1.0f);
+    ASSERT_TRUE(input.tap()->read(0, frames));
+    for (float const sample : frames) {
+        ASSERT_EQ(sample, 0.0f);
+    }
+    EXPECT_GT(capture->callback_stats().callbacks, 0);
+}
+
+TEST(AudioInputTests, refuses_loopback_where_the_backend_has_none) {
+    // clang-format off
+    AudioInput input{std::make_unique<CaptureDevice>(CaptureOptions{
+      .mode    = CaptureMode::loopback,
+      .backend = ma_backend_null
+    })};
+    // clang-format on
+    EXPECT_FALSE(input.start());
+    EXPECT_EQ(input.tap(), nullptr);
+}
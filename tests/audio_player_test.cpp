@@ -0,0 +1,252 @@
+#include <audio.hpp>
+#include <wav_writer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace wt;
+
+namespace {
+    // Writes a second of stereo 32 bit float silence at 48kHz
+    std::filesystem::path write_silence() {
+        constexpr std::uint32_t rate = 48000;
+
+        auto const path = std::filesystem::temp_directory_path() / "audio_player_test.wav";
+        support::write_wav(path, support::WavFormat{3, 2, 32, rate}, std::vector<std::byte>(rate * 2 * sizeof(float)));
+        return path;
+    }
+
+    // Writes `frames` stereo 32 bit float frames at 48kHz, every sample
+    // `level`
+    std::filesystem::path write_level(std::string const& name, std::size_t frames, float level) {
+        std::vector<float> const samples(frames * 2, level);
+        auto const path = std::filesystem::temp_directory_path() / name;
+        support::write_wav(path, support::WavFormat{3, 2, 32, 48000}, std::as_bytes(std::span{samples}));
+        return path;
+    }
+
+    // Writes `frames` stereo 32 bit float frames at 48kHz, frame `i`
+    // holding `(i + 1) / 2^18` so a sample tells which frame it was
+    std::filesystem::path write_ramp(std::string const& name, std::size_t frames) {
+        std::vector<float> samples(frames * 2);
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = static_cast<float>(i / 2 + 1) / (1 << 18);
+        }
+        auto const path = std::filesystem::temp_directory_path() / name;
+        support::write_wav(path, support::WavFormat{3, 2, 32, 48000}, std::as_bytes(std::span{samples}));
+        return path;
+    }
+} // namespace
+
+TEST(AudioPlayerTests, reports_no_latency_before_playing) {
+    AudioPlayer player{AudioPlayerOptions{.backend = ma_backend_null}};
+    EXPECT_FALSE(player.device_latency());
+}
+
+TEST(AudioPlayerTests, opens_the_requested_periods) {
+    auto const path = write_silence();
+    {
+        // clang-format off
+        AudioPlayer player{AudioPlayerOptions{
+          .period_frames = 256,
+          .periods       = 2,
+          .backend       = ma_backend_null
+        }};
+        // clang-format on
+        ASSERT_TRUE(player.play(path.string()));
+
+        auto const latency = player.device_latency();
+        ASSERT_TRUE(latency);
+        EXPECT_EQ(latency->period_frames, 256);
+        EXPECT_EQ(latency->periods, 2);
+        EXPECT_EQ(latency->sample_rate, 48000);
+        EXPECT_FALSE(latency->exclusive);
+        EXPECT_EQ(latency->buffer, std::chrono::microseconds{1'000'000 * 512 / 48000});
+
+        // The null backend runs callbacks in real time, a period is about 5ms
+        auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{1};
+        while (player.callback_stats().callbacks == 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        }
+        EXPECT_GT(player.callback_stats().callbacks, 0);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(AudioPlayerTests, windows_are_of_what_is_heard) {
+    auto const path = write_silence();
+    {
+        // clang-format off
+        AudioPlayer player{AudioPlayerOptions{
+          .period_frames = 256,
+          .periods       = 2,
+          .backend       = ma_backend_null
+        }};
+        // clang-format on
+        ASSERT_TRUE(player.play(path.string()));
+        EXPECT_EQ(player.playback_clock().latency(), std::chrono::nanoseconds{1'000'000'000ll * 512 / 48000});
+
+        auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{2};
+        while (player.playback_clock().audible_position().value_or(0) < WINDOW_SIZE
+               && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        }
+
+        auto const now     = std::chrono::steady_clock::now();
+        auto const windows = std::make_unique<ChannelWindows>();
+        player.audible_channel_windows(*windows, now);
+        ASSERT_EQ(windows->channel_count, 2);
+
+        // The device only holds 512 frames ahead, so the window ends at the
+        // newest frame and its middle is heard a little before now
+        auto const heard = player.playback_clock().audible_time(windows->position + WINDOW_SIZE / 2);
+        ASSERT_TRUE(heard);
+        EXPECT_LE(*heard, now + std::chrono::milliseconds{1});
+        EXPECT_GT(*heard, now - std::chrono::milliseconds{25});
+
+        auto const latest = player.current_window();
+        EXPECT_EQ(latest.size, WINDOW_SIZE);
+        EXPECT_GT(latest.position, windows->position);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(AudioPlayerTests, reports_a_track_that_fails_to_load) {
+    auto const path = write_silence();
+    {
+        AudioPlayer player{AudioPlayerOptions{.backend = ma_backend_null}};
+        ASSERT_TRUE(player.play(path.string()));
+        EXPECT_FALSE(player.load_failed());
+
+        auto const wait_for_load = [&] {
+            auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{2};
+            while (player.has_queued() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            }
+        };
+
+        // The device is running, so the file opens in the background
+        EXPECT_TRUE(player.play((std::filesystem::temp_directory_path() / "no_such_track.wav").string()));
+        wait_for_load();
+        EXPECT_TRUE(player.load_failed());
+
+        player.queue(path.string());
+        wait_for_load();
+        EXPECT_FALSE(player.load_failed());
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(AudioPlayerTests, queued_track_starts_on_the_frame_after_the_last) {
+    constexpr std::size_t FIRST_FRAMES = 4800;
+    auto const first  = write_level("audio_player_test_first.wav", FIRST_FRAMES, 0.5f);
+    auto const second = write_level("audio_player_test_second.wav", 48000, -0.25f);
+    {
+        // clang-format off
+        AudioPlayer player{AudioPlayerOptions{
+          .period_frames = 256,
+          .periods       = 2,
+          .backend       = ma_backend_null
+        }};
+        // clang-format on
+        ASSERT_TRUE(player.play(first.string()));
+        ASSERT_TRUE(player.queue(second.string()));
+
+        // Well past the switch, and still in the tap's history
+        std::size_t const frames = FIRST_FRAMES + 2400;
+        auto const deadline      = std::chrono::steady_clock::now() + std::chrono::seconds{2};
+        while (player.tap()->write_position() < frames && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        }
+        std::vector<float> samples(frames * 2);
+        ASSERT_TRUE(player.tap()->read(0, samples));
+
+        // Every frame of the first track exactly once, then the second's
+        // from its first, at the same volume
+        float const level = samples.front();
+        EXPECT_GT(level, 0.0f);
+        auto const switched = std::ranges::find_if(samples, [&](float sample) { return sample != level; });
+        EXPECT_EQ(static_cast<std::size_t>(switched - samples.begin()), FIRST_FRAMES * 2);
+        ASSERT_NE(switched, samples.end());
+        EXPECT_EQ(*switched, -level / 2);
+        EXPECT_TRUE(std::all_of(switched, samples.end(), [&](float sample) { return sample == -level / 2; }));
+
+        // The first track is freed on the next queue, which fails to load,
+        // leaving only the second
+        EXPECT_EQ(player.source_count(), 2);
+        player.queue((std::filesystem::temp_directory_path() / "no_such_track.wav").string());
+        auto const load_deadline = std::chrono::steady_clock::now() + std::chrono::seconds{2};
+        while (player.has_queued() && std::chrono::steady_clock::now() < load_deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        }
+        EXPECT_EQ(player.source_count(), 1);
+    }
+    std::filesystem::remove(first);
+    std::filesystem::remove(second);
+}
+
+TEST(AudioPlayerTests, seeks_while_paused) {
+    auto const path = write_ramp("audio_player_test_ramp.wav", 96000);
+    {
+        // clang-format off
+        AudioPlayer player{AudioPlayerOptions{
+          .period_frames = 256,
+          .periods       = 2,
+          .backend       = ma_backend_null
+        }};
+        // clang-format on
+        ASSERT_TRUE(player.play(path.string()));
+
+        auto const wait_for = [](auto const& done) {
+            auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{2};
+            while (!done() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            }
+        };
+        wait_for([&] { return player.tap()->write_position() > 0; });
+
+        // The volume the tap is written at, from the first frame's sample
+        std::vector<float> first(2);
+        ASSERT_TRUE(player.tap()->read(0, first));
+        float const gain = first[0] * (1 << 18);
+
+        // Let the callback in flight finish, so the device is paused
+        player.pause();
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        std::uint64_t const paused_at = player.tap()->write_position();
+
+        // The tap still gets the window before the new position
+        ASSERT_TRUE(player.seek(std::chrono::milliseconds{1000}));
+        wait_for([&] { return player.tap()->write_position() == paused_at + WINDOW_SIZE; });
+        ASSERT_EQ(player.tap()->write_position(), paused_at + WINDOW_SIZE);
+        EXPECT_EQ(player.position(), std::chrono::milliseconds{1000});
+
+        std::vector<float> primer(WINDOW_SIZE * 2);
+        ASSERT_TRUE(player.tap()->read(paused_at, primer));
+        EXPECT_FLOAT_EQ(primer.front(), gain * (48000 - WINDOW_SIZE + 1) / (1 << 18));
+        EXPECT_FLOAT_EQ(primer.back(), gain * 48000 / (1 << 18));
+
+        // The source refilled while paused, so resuming plays on from the
+        // new position without falling short
+        player.reset_callback_stats();
+        player.unpause();
+        wait_for([&] { return player.tap()->write_position() >= paused_at + WINDOW_SIZE + 4800; });
+
+        std::vector<float> resumed(2);
+        ASSERT_TRUE(player.tap()->read(paused_at + WINDOW_SIZE, resumed));
+        EXPECT_FLOAT_EQ(resumed[0], gain * 48001 / (1 << 18));
+        EXPECT_GT(player.callback_stats().callbacks, 0);
+        EXPECT_EQ(player.callback_stats().underflows, 0);
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,86 @@
+#include <analysis/analysis.hpp>
+#include <analysis/batch.hpp>
+#include <analysis/hann_window.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <numbers>
+#include <span>
+#include <vector>
+
+using namespace wt::analysis;
+
+namespace {
+    std::vector<float> make_sweep(std::size_t samples) {
+        std::vector<float> ret(samples);
+        for (std::size_t i = 0; i < samples; ++i) {
+            float const t = static_cast<float>(i) / samples;
+            ret[i]        = std::sin(2 * std::numbers::pi_v<float> * (10 + 200 * t) * i / 512);
+        }
+        return ret;
+    }
+} // namespace
+
+TEST(BatchTests, counts_whole_windows) {
+    BatchAnalyzer const analyzer{512, 1};
+    EXPECT_EQ(analyzer.windows(511), 0);
+    EXPECT_EQ(analyzer.windows(512), 1);
+    EXPECT_EQ(analyzer.windows(2047), 3);
+    EXPECT_EQ(analyzer.windows(2048, 128), 13);
+}
+
+TEST(BatchTests, matches_the_analyzer_on_each_window) {
+    auto const samples = make_sweep(20000);
+    BatchAnalyzer const batch{512, 3};
+    std::size_t const windows = batch.windows(samples.size(), 100);
+
+    std::vector<std::complex<float>> spectrogram(windows * batch.bins());
+    batch.analyze(samples, spectrogram, 100);
+
+    auto const hann = make_hann_coefficients<512>();
+    FftAnalyzer<512> analyzer;
+    analyzer.set_preprocessor([&](std::array<float, 512>& buffer) {
+        std::ranges::transform(buffer, hann, buffer.begin(), std::multiplies<>{});
+    });
+
+    std::vector<std::complex<float>> expected(batch.bins());
+    for (std::size_t i = 0; i < windows; ++i) {
+        analyzer.analyze(std::span{samples}.subspan(i * 100, 512), expected);
+        auto const row = std::span{spectrogram}.subspan(i * batch.bins(), batch.bins());
+        EXPECT_TRUE(std::ranges::equal(row, expected)) << "window " << i;
+    }
+}
+
+TEST(BatchTests, does_not_depend_on_the_thread_count) {
+    auto const samples = make_sweep(100000);
+
+    BatchAnalyzer const single{512, 1};
+    std::vector<float> expected(single.windows(samples.size()) * single.bins());
+    single.magnitudes(samples, expected);
+
+    for (unsigned const threads : {2, 5, 16}) {
+        BatchAnalyzer const batch{512, threads};
+        std::vector<float> spectrogram(expected.size(), -1.0f);
+        batch.magnitudes(samples, spectrogram);
+        EXPECT_EQ(spectrogram, expected) << threads << " threads";
+    }
+}
+
+TEST(BatchTests, magnitudes_are_of_the_coefficients) {
+    auto const samples = make_sweep(4096);
+    BatchAnalyzer const batch{std::vector<float>(256, 1.0f), 2};
+    std::size_t const cells = batch.windows(samples.size(), 64) * batch.bins();
+
+    std::vector<std::complex<float>> coefficients(cells);
+    std::vector<float> magnitudes(cells);
+    batch.analyze(samples, coefficients, 64);
+    batch.magnitudes(samples, magnitudes, 64);
+    for (std::size_t i = 0; i < cells; ++i) {
+        EXPECT_EQ(magnitudes[i], std::abs(coefficients[i])) << "cell " << i;
+    }
+}
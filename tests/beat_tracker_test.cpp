@@ -0,0 +1,135 @@
+#include <analysis/beat_tracker.hpp>
+#include <analysis/onset.hpp>
+#include <analysis/stft.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+using namespace wt::analysis;
+
+namespace {
+    constexpr std::size_t HOP        = THREE_QUARTER_OVERLAP;
+    constexpr double FRAME_RATE      = 48000.0 / HOP;
+    constexpr std::uint32_t SEED     = 1;
+    constexpr double SECONDS_PER_MIN = 60.0;
+
+    // Onset strengths with a hit every beat at `bpm`, over a little noise
+    std::vector<float> make_pulse(double bpm, double seconds) {
+        std::vector<float> ret(static_cast<std::size_t>(seconds * FRAME_RATE));
+        std::uint32_t state = SEED;
+        for (auto& strength : ret) {
+            state    = state * 1664525 + 1013904223;
+            strength = 0.05f * static_cast<float>(state >> 8) / (1 << 24);
+        }
+        double const period = FRAME_RATE * SECONDS_PER_MIN / bpm;
+        for (double at = 0; at < static_cast<double>(ret.size()); at += period) {
+            ret[static_cast<std::size_t>(std::lround(at)) % ret.size()] += 1.0f;
+        }
+        return ret;
+    }
+
+    std::vector<BeatEvent> track(BeatTracker& tracker, std::vector<float> const& strengths) {
+        std::vector<BeatEvent> ret;
+        for (std::size_t frame = 0; frame < strengths.size(); ++frame) {
+            if (auto const beat = tracker.push(frame * HOP, strengths[frame])) {
+                ret.push_back(*beat);
+            }
+        }
+        return ret;
+    }
+} // namespace
+
+TEST(BeatTrackerTests, finds_the_tempo) {
+    for (double const bpm : {90.0, 120.0, 150.0}) {
+        BeatTracker tracker;
+        track(tracker, make_pulse(bpm, 20));
+        ASSERT_TRUE(tracker.bpm()) << bpm;
+        EXPECT_NEAR(*tracker.bpm(), bpm, bpm * 0.02) << bpm;
+    }
+}
+
+TEST(BeatTrackerTests, beats_land_on_the_hits) {
+    double const bpm    = 120.0;
+    double const period = FRAME_RATE * SECONDS_PER_MIN / bpm;
+    BeatTracker tracker;
+    auto const beats = track(tracker, make_pulse(bpm, 20));
+
+    // None before the warm up, then one a beat
+    ASSERT_FALSE(beats.empty());
+    EXPECT_GE(beats.front().seconds, 3.5);
+    EXPECT_NEAR(static_cast<double>(beats.size()), (20 - beats.front().seconds) * bpm / SECONDS_PER_MIN, 2);
+
+    for (auto const& beat : beats) {
+        double const frame = static_cast<double>(beat.position / HOP);
+        double const phase = std::remainder(frame, period);
+        EXPECT_LE(std::abs(phase), 2.0) << "beat at " << beat.seconds << "s";
+        EXPECT_NEAR(beat.bpm, bpm, 2.0);
+        EXPECT_DOUBLE_EQ(beat.seconds, static_cast<double>(beat.position) / 48000);
+    }
+}
+
+TEST(BeatTrackerTests, follows_a_change_of_tempo) {
+    auto strengths    = make_pulse(100.0, 15);
+    auto const faster = make_pulse(130.0, 15);
+    strengths.insert(strengths.end(), faster.begin(), faster.end());
+
+    BeatTracker tracker;
+    auto const beats = track(tracker, strengths);
+    ASSERT_TRUE(tracker.bpm());
+    EXPECT_NEAR(*tracker.bpm(), 130.0, 3.0);
+
+    ASSERT_GE(beats.size(), 2);
+    EXPECT_NEAR(beats.back().seconds - beats[beats.size() - 2].seconds, SECONDS_PER_MIN / 130.0, 0.03);
+}
+
+TEST(BeatTrackerTests, silence_has_no_beats) {
+    BeatTracker tracker;
+    EXPECT_TRUE(track(tracker, std::vector<float>(static_cast<std::size_t>(10 * FRAME_RATE))).empty());
+    EXPECT_EQ(tracker.bpm(), std::nullopt);
+}
+
+TEST(BeatTrackerTests, starts_over_after_a_reset) {
+    auto const strengths = make_pulse(120.0, 10);
+    BeatTracker tracker;
+    auto const first = track(tracker, strengths);
+    tracker.reset();
+    EXPECT_EQ(tracker.bpm(), std::nullopt);
+
+    auto const again = track(tracker, strengths);
+    ASSERT_EQ(again.size(), first.size());
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        EXPECT_EQ(again[i].position, first[i].position);
+    }
+}
+
+TEST(BeatTrackerTests, tracks_a_click_track_through_the_stft) {
+    // A click every half second, 120bpm, for 12 seconds
+    std::vector<float> samples(48000 * 12);
+    for (std::size_t i = 0; i < samples.size(); i += 24000) {
+        for (std::size_t j = 0; j < 256; ++j) {
+            samples[i + j] = 0.8f * std::sin(2 * std::numbers::pi_v<float> * 2000 * j / 48000);
+        }
+    }
+
+    Stft stft{1, HOP};
+    OnsetDetector onsets;
+    BeatTracker tracker;
+    std::vector<BeatEvent> beats;
+    stft.push(samples, [&](StftFrame const& frame) {
+        onsets.push(frame.position, frame);
+        if (auto const beat = tracker.push(frame.position, onsets.strength())) {
+            beats.push_back(*beat);
+        }
+    });
+
+    ASSERT_TRUE(tracker.bpm());
+    EXPECT_NEAR(*tracker.bpm(), 120.0f, 2.0f);
+    ASSERT_GE(beats.size(), 10);
+    for (std::size_t i = 1; i < beats.size(); ++i) {
+        EXPECT_NEAR(beats[i].seconds - beats[i - 1].seconds, 0.5, 0.03) << "beat " << i;
+    }
+}
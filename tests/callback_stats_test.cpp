@@ -0,0 +1,83 @@
+#include <callback_stats.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+using namespace wt;
+using namespace std::chrono_literals;
+
+namespace {
+    CallbackStats::clock::time_point at(std::chrono::microseconds offset) {
+        return CallbackStats::clock::time_point{1s + offset};
+    }
+} // namespace
+
+TEST(CallbackStatsTests, buckets_are_powers_of_two_microseconds) {
+    EXPECT_EQ(LatencyHistogram::bucket_of(500ns), 0);
+    EXPECT_EQ(LatencyHistogram::bucket_of(1us), 1);
+    EXPECT_EQ(LatencyHistogram::bucket_of(3us), 2);
+    EXPECT_EQ(LatencyHistogram::bucket_of(4us), 3);
+    EXPECT_EQ(LatencyHistogram::bucket_of(10s), LatencyHistogram::BUCKETS - 1);
+
+    EXPECT_EQ(LatencyHistogram::upper_bound(0), 1us);
+    EXPECT_EQ(LatencyHistogram::upper_bound(3), 8us);
+}
+
+TEST(CallbackStatsTests, counts_frames_and_underflows) {
+    CallbackStats stats;
+    stats.record(at(0us), at(10us), 10ms, 480, 480, false);
+    stats.record(at(10ms), at(10ms + 20us), 10ms, 480, 100, true);
+
+    auto const snapshot = stats.snapshot();
+    EXPECT_EQ(snapshot.callbacks, 2);
+    EXPECT_EQ(snapshot.frames_requested, 960);
+    EXPECT_EQ(snapshot.frames_delivered, 580);
+    EXPECT_EQ(snapshot.underflows, 1);
+    EXPECT_EQ(snapshot.budget_overruns, 0);
+    EXPECT_EQ(snapshot.duration.total(), 2);
+    EXPECT_EQ(snapshot.duration.max, 20us);
+}
+
+TEST(CallbackStatsTests, flags_callbacks_over_budget) {
+    CallbackStats stats;
+    stats.record(at(0us), at(12ms), 10ms, 480, 480, false);
+    EXPECT_EQ(stats.snapshot().budget_overruns, 1);
+}
+
+TEST(CallbackStatsTests, measures_jitter_against_the_period) {
+    CallbackStats stats;
+    stats.record(at(0us), at(5us), 10ms, 480, 480, false);
+    stats.record(at(10ms), at(10ms + 5us), 10ms, 480, 480, false);
+    stats.record(at(23ms), at(23ms + 5us), 10ms, 480, 480, false);
+
+    auto const jitter = stats.snapshot().jitter;
+    EXPECT_EQ(jitter.total(), 2);
+    EXPECT_EQ(jitter.counts[0], 1);
+    EXPECT_EQ(jitter.max, 3ms);
+}
+
+TEST(CallbackStatsTests, quantiles_bound_the_durations) {
+    CallbackStats stats;
+    for (int i = 0; i < 99; ++i) {
+        stats.record(at(0us), at(3us), 10ms, 480, 480, false);
+    }
+    stats.record(at(0us), at(900us), 10ms, 480, 480, false);
+
+    auto const duration = stats.snapshot().duration;
+    EXPECT_EQ(duration.quantile(0.5), 4us);
+    EXPECT_EQ(duration.quantile(0.99), 4us);
+    EXPECT_EQ(duration.quantile(1.0), 900us);
+}
+
+TEST(CallbackStatsTests, reset_zeroes_everything) {
+    CallbackStats stats;
+    stats.record(at(0us), at(12ms), 10ms, 480, 0, true);
+    stats.reset();
+
+    auto const snapshot = stats.snapshot();
+    EXPECT_EQ(snapshot.callbacks, 0);
+    EXPECT_EQ(snapshot.underflows, 0);
+    EXPECT_EQ(snapshot.duration.total(), 0);
+    EXPECT_EQ(snapshot.duration.quantile(0.5), 0ns);
+}
@@ -0,0 +1,133 @@
+#include <analysis/constant_q.hpp>
+#include <analysis/fft_plan.hpp>
+#include <analysis/stft.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <span>
+#include <vector>
+
+using namespace wt::analysis;
+
+namespace {
+    constexpr float SAMPLE_RATE = 48000.0f;
+
+    std::vector<float> make_tone(float hz, std::size_t size) {
+        std::vector<float> ret(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            ret[i] = std::cos(2 * std::numbers::pi_v<double> * hz * i / SAMPLE_RATE);
+        }
+        return ret;
+    }
+
+    std::vector<std::complex<float>> fft(std::span<float const> frame) {
+        auto const plan = FftPlan::get(frame.size());
+        std::vector<std::complex<float>> ret(plan->bins());
+        std::vector<std::complex<float>> scratch(frame.size() / 2);
+        plan->forward(frame.data(), ret.data(), scratch.data());
+        return ret;
+    }
+
+    // Every bin correlated with its kernel sample by sample
+    std::vector<std::complex<double>> naive_constant_q(ConstantQ const& cq, std::span<float const> frame) {
+        std::vector<std::complex<double>> ret(cq.bins());
+        for (std::size_t k = 0; k < cq.bins(); ++k) {
+            std::size_t const length = cq.kernel_length(k);
+            std::size_t const start  = (frame.size() - length) / 2;
+            double const cycle       = 2 * std::numbers::pi * cq.centre_hz(k) / SAMPLE_RATE;
+            for (std::size_t n = 0; n < length; ++n) {
+                double const hann = (1.0 - std::cos(2 * std::numbers::pi * n / length)) / length;
+                ret[k] += std::polar(frame[start + n] * hann, -cycle * n);
+            }
+        }
+        return ret;
+    }
+} // namespace
+
+TEST(ConstantQTests, bins_are_evenly_spaced_in_pitch) {
+    for (std::size_t const per_octave : {12, 24, 48}) {
+        ConstantQOptions options;
+        options.bins_per_octave = per_octave;
+        ConstantQ const cq{options};
+
+        // 55Hz to 16kHz is a little over eight octaves
+        EXPECT_EQ(cq.bins(), per_octave * 8 + static_cast<std::size_t>(per_octave * std::log2(16000.0 / 14080)) + 1);
+        EXPECT_FLOAT_EQ(cq.centre_hz(0), 55.0f);
+        for (std::size_t k = per_octave; k < cq.bins(); ++k) {
+            EXPECT_NEAR(cq.centre_hz(k), 2 * cq.centre_hz(k - per_octave), 1e-3f * cq.centre_hz(k)) << "bin " << k;
+            EXPECT_LE(cq.kernel_length(k), cq.kernel_length(k - 1)) << "bin " << k;
+        }
+    }
+}
+
+TEST(ConstantQTests, a_tone_peaks_at_its_bin) {
+    ConstantQ const cq{ConstantQOptions{.bins_per_octave = 24}};
+    std::vector<float> output(cq.bins());
+
+    for (std::size_t const bin : {40, 100, 150, 190}) {
+        auto const frame = make_tone(cq.centre_hz(bin), cq.window_size());
+        cq.magnitudes(fft(frame), output);
+
+        auto const peak = std::ranges::max_element(output) - output.begin();
+        EXPECT_EQ(peak, bin);
+        EXPECT_NEAR(output[bin], 0.5f, 0.01f) << "bin " << bin;
+    }
+}
+
+TEST(ConstantQTests, matches_a_naive_transform) {
+    ConstantQ const cq{ConstantQOptions{.bins_per_octave = 24}};
+
+    std::vector<float> frame(cq.window_size());
+    for (std::size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = 0.5f * std::cos(2 * std::numbers::pi_v<double> * 97.0 * i / SAMPLE_RATE)
+                 + 0.3f * std::sin(2 * std::numbers::pi_v<double> * 1234.5 * i / SAMPLE_RATE)
+                 + 0.2f * std::cos(2 * std::numbers::pi_v<double> * 9000.0 * i / SAMPLE_RATE + 1.0);
+    }
+
+    std::vector<std::complex<float>> output(cq.bins());
+    cq.transform(fft(frame), output);
+    auto const expected = naive_constant_q(cq, frame);
+
+    // The kernels leave out coefficients below half a percent of their peak
+    for (std::size_t k = 0; k < cq.bins(); ++k) {
+        EXPECT_NEAR(output[k].real(), expected[k].real(), 5e-3) << "bin " << k;
+        EXPECT_NEAR(output[k].imag(), expected[k].imag(), 5e-3) << "bin " << k;
+    }
+}
+
+TEST(ConstantQTests, keeps_few_weights) {
+    ConstantQ const cq{ConstantQOptions{.bins_per_octave = 48}};
+    std::size_t const dense = cq.bins() * (cq.window_size() / 2 + 1);
+    EXPECT_LT(cq.nonzero_weights() * 20, dense);
+
+    ConstantQOptions exact;
+    exact.bins_per_octave = 48;
+    exact.threshold       = 0.0f;
+    EXPECT_LT(cq.nonzero_weights(), ConstantQ{exact}.nonzero_weights());
+}
+
+TEST(ConstantQTests, transforms_every_stft_frame) {
+    ConstantQ const cq{ConstantQOptions{}};
+    Stft stft{1, cq.window_size() / 4, std::vector<float>(cq.window_size(), 1.0f)};
+
+    auto const samples = make_tone(440.0f, cq.window_size() * 3);
+    std::vector<float> output(cq.bins());
+    std::size_t frames = 0;
+    stft.push(samples, [&](StftFrame const& frame) {
+        cq.magnitudes(frame.spectrum(0), output);
+
+        // A4 is three octaves above A1, bin 36 at 12 per octave
+        EXPECT_EQ(std::ranges::max_element(output) - output.begin(), 36) << "frame " << frame.position;
+
+        auto const window = std::span{samples}.subspan(frame.position, cq.window_size());
+        std::vector<float> expected(cq.bins());
+        cq.magnitudes(fft(window), expected);
+        EXPECT_EQ(output, expected) << "frame " << frame.position;
+        ++frames;
+    });
+    EXPECT_EQ(frames, 9);
+}
@@ -0,0 +1,212 @@
+#include <analysis/analysis.hpp>
+#include <analysis/batch.hpp>
+#include <analysis/constant_q.hpp>
+#include <analysis/fft_backend.hpp>
+#include <analysis/stft.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+using namespace wt::analysis;
+
+namespace {
+    std::vector<std::shared_ptr<FftBackend const>> backends() {
+        return {std::make_shared<KissFftBackend const>(), std::make_shared<FourierFftBackend const>()};
+    }
+
+    template <typename T>
+    std::vector<T> make_signal(std::size_t size) {
+        std::vector<T> ret(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            ret[i] = static_cast<T>(std::sin(0.37 * i) + 0.25 * std::cos(1.3 * i));
+        }
+        return ret;
+    }
+
+    template <typename T>
+    std::vector<std::complex<T>> direct_transform(std::vector<std::complex<T>> const& input, std::size_t bins) {
+        std::vector<std::complex<T>> ret(bins);
+        for (std::size_t k = 0; k < bins; ++k) {
+            std::complex<double> sum{};
+            for (std::size_t n = 0; n < input.size(); ++n) {
+                sum += std::complex<double>{input[n]}
+                     * std::polar(1.0, -2 * std::numbers::pi * static_cast<double>(k * n % input.size()) / input.size());
+            }
+            ret[k] = std::complex<T>{sum};
+        }
+        return ret;
+    }
+
+    // Real forward against a direct DFT, and back to the input times the size
+    template <typename T>
+    void check_real(FftBackend const& backend, double tolerance) {
+        for (std::size_t const size : {2, 4, 8, 64, 1024}) {
+            auto const fft   = backend.real<T>(size);
+            auto const input = make_signal<T>(size);
+            ASSERT_EQ(fft->size(), size);
+            ASSERT_EQ(fft->bins(), size / 2 + 1);
+
+            std::vector<std::complex<T>> spectrum(fft->bins());
+            std::vector<std::complex<T>> scratch(fft->scratch_size());
+            fft->forward(input.data(), spectrum.data(), scratch.data());
+
+            auto const expected = direct_transform(std::vector<std::complex<T>>{input.begin(), input.end()}, fft->bins());
+            for (std::size_t k = 0; k < spectrum.size(); ++k) {
+                EXPECT_NEAR(spectrum[k].real(), expected[k].real(), tolerance) << backend.name() << " " << size;
+                EXPECT_NEAR(spectrum[k].imag(), expected[k].imag(), tolerance) << backend.name() << " " << size;
+            }
+
+            std::vector<T> output(size);
+            fft->inverse(spectrum.data(), output.data(), scratch.data());
+            for (std::size_t i = 0; i < size; ++i) {
+                EXPECT_NEAR(output[i], input[i] * static_cast<T>(size), tolerance) << backend.name() << " " << size;
+            }
+        }
+    }
+
+    template <typename T>
+    void check_complex(FftBackend const& backend, double tolerance) {
+        for (std::size_t const size : {1, 2, 4, 16, 512}) {
+            auto const fft  = backend.complex<T>(size);
+            auto const real = make_signal<T>(2 * size);
+            std::vector<std::complex<T>> input(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                input[i] = {real[2 * i], real[2 * i + 1]};
+            }
+
+            std::vector<std::complex<T>> spectrum(size);
+            std::vector<std::complex<T>> scratch(fft->scratch_size());
+            fft->forward(input.data(), spectrum.data(), scratch.data());
+
+            auto const expected = direct_transform(input, size);
+            for (std::size_t k = 0; k < size; ++k) {
+                EXPECT_NEAR(spectrum[k].real(), expected[k].real(), tolerance) << backend.name() << " " << size;
+                EXPECT_NEAR(spectrum[k].imag(), expected[k].imag(), tolerance) << backend.name() << " " << size;
+            }
+
+            std::vector<std::complex<T>> output(size);
+            fft->inverse(spectrum.data(), output.data(), scratch.data());
+            for (std::size_t i = 0; i < size; ++i) {
+                EXPECT_NEAR(output[i].real(), input[i].real() * static_cast<T>(size), tolerance) << backend.name();
+                EXPECT_NEAR(output[i].imag(), input[i].imag() * static_cast<T>(size), tolerance) << backend.name();
+            }
+        }
+    }
+} // namespace
+
+TEST(FftBackendTests, real_transforms_match_a_direct_transform) {
+    for (auto const& backend : backends()) {
+        check_real<float>(*backend, 5e-3);
+    }
+    check_real<double>(FourierFftBackend{}, 1e-9);
+
+    // The kissfft double transforms run at float precision
+    check_real<double>(KissFftBackend{}, 5e-3);
+}
+
+TEST(FftBackendTests, complex_transforms_match_a_direct_transform) {
+    for (auto const& backend : backends()) {
+        check_complex<float>(*backend, 5e-3);
+    }
+    check_complex<double>(FourierFftBackend{}, 1e-9);
+    check_complex<double>(KissFftBackend{}, 5e-3);
+}
+
+TEST(FftBackendTests, kissfft_takes_any_even_size) {
+    // 30 is a half transform of 15, kissfft's radix 3 and 5
+    auto const fft   = KissFftBackend{}.real_float(30);
+    auto const input = make_signal<float>(30);
+    std::vector<std::complex<float>> spectrum(fft->bins());
+    std::vector<std::complex<float>> scratch(fft->scratch_size());
+    std::vector<float> output(30);
+    fft->forward(input.data(), spectrum.data(), scratch.data());
+    fft->inverse(spectrum.data(), output.data(), scratch.data());
+
+    for (std::size_t i = 0; i < output.size(); ++i) {
+        EXPECT_NEAR(output[i], input[i] * 30, 1e-3);
+    }
+}
+
+TEST(FftBackendTests, fourier_needs_powers_of_two) {
+    FourierFftBackend const backend;
+    EXPECT_THROW((void) backend.real_float(30), std::invalid_argument);
+    EXPECT_THROW((void) backend.real_double(3), std::invalid_argument);
+    EXPECT_THROW((void) backend.complex_float(12), std::invalid_argument);
+    EXPECT_NO_THROW((void) backend.real_float(2));
+    EXPECT_NO_THROW((void) backend.complex_double(1));
+}
+
+TEST(FftBackendTests, analyzers_agree_across_backends) {
+    std::array<float, WINDOW_SIZE> input{};
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        input[i] = std::sin(2 * std::numbers::pi_v<float> * 40.5f * i / WINDOW_SIZE);
+    }
+
+    FftAnalyzer<> kiss{std::make_shared<KissFftBackend const>()};
+    FftAnalyzer<> fourier{std::make_shared<FourierFftBackend const>()};
+    auto const expected = kiss.analyze(input);
+    auto const actual   = fourier.analyze(input);
+
+    for (std::size_t k = 0; k < expected.size(); ++k) {
+        EXPECT_NEAR(actual[k].real(), expected[k].real(), 2e-2) << "bin " << k;
+        EXPECT_NEAR(actual[k].imag(), expected[k].imag(), 2e-2) << "bin " << k;
+    }
+
+    DynamicFftAnalyzer dynamic{WINDOW_SIZE, std::make_shared<FourierFftBackend const>()};
+    std::vector<std::complex<float>> output(dynamic.bins());
+    dynamic.analyze(input, output);
+    for (std::size_t k = 0; k < expected.size(); ++k) {
+        EXPECT_EQ(output[k], actual[k]) << "bin " << k;
+    }
+}
+
+TEST(FftBackendTests, stft_batch_and_constant_q_take_a_backend) {
+    auto const fourier = fft_backend_from_string("fourier");
+    ASSERT_NE(fourier, nullptr);
+    EXPECT_EQ(fourier->name(), "wt::ft");
+    EXPECT_EQ(fft_backend_from_string("kissfft"), default_fft_backend());
+    EXPECT_EQ(fft_backend_from_string("fftw"), nullptr);
+
+    auto const input = make_signal<float>(WINDOW_SIZE);
+
+    // One window each, kissfft's and the in-tree FFT's
+    std::vector<std::complex<float>> expected(WINDOW_SIZE / 2 + 1);
+    Stft{1, std::nullopt, WINDOW_SIZE}.push(input, [&](StftFrame const& frame) {
+        std::ranges::copy(frame.spectrum(0), expected.begin());
+    });
+
+    std::vector<std::complex<float>> streamed(expected.size());
+    Stft{1, std::nullopt, WINDOW_SIZE, fourier}.push(input, [&](StftFrame const& frame) {
+        std::ranges::copy(frame.spectrum(0), streamed.begin());
+    });
+
+    std::vector<std::complex<float>> batched(expected.size());
+    BatchAnalyzer{WINDOW_SIZE, 1, fourier}.analyze(input, batched);
+
+    for (std::size_t k = 0; k < expected.size(); ++k) {
+        EXPECT_NEAR(std::abs(streamed[k] - expected[k]), 0.0f, 1e-3f) << "bin " << k;
+        EXPECT_EQ(batched[k], streamed[k]) << "bin " << k;
+    }
+
+    // The kernels come out of either FFT the same, to float precision
+    ConstantQOptions const options{.window_size = WINDOW_SIZE};
+    ConstantQ const kiss_cq{options};
+    ConstantQ const fourier_cq{options, fourier};
+    ASSERT_EQ(fourier_cq.bins(), kiss_cq.bins());
+
+    std::vector<float> kiss_bins(kiss_cq.bins());
+    std::vector<float> fourier_bins(fourier_cq.bins());
+    kiss_cq.magnitudes(expected, kiss_bins);
+    fourier_cq.magnitudes(expected, fourier_bins);
+    for (std::size_t k = 0; k < kiss_bins.size(); ++k) {
+        EXPECT_NEAR(fourier_bins[k], kiss_bins[k], 1e-3f * (1.0f + kiss_bins[k])) << "bin " << k;
+    }
+}
@@ -0,0 +1,171 @@
+#include <analysis/filterbank.hpp>
+#include <analysis/pipeline.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <span>
+#include <vector>
+
+using namespace wt::analysis;
+
+namespace {
+    constexpr std::size_t BINS = WINDOW_SIZE / 2 + 1;
+
+    constexpr std::array<BandScale, 4> SCALES{BandScale::linear, BandScale::log, BandScale::mel, BandScale::bark};
+
+    FilterbankOptions options_for(BandScale scale) {
+        FilterbankOptions options;
+        options.scale = scale;
+        return options;
+    }
+
+    // The weight of every bin in every band, read back one bin at a time
+    std::vector<std::vector<float>> dense_weights(Filterbank const& bank) {
+        std::vector<std::vector<float>> ret(bank.bands(), std::vector<float>(bank.bins()));
+        std::vector<float> impulse(bank.bins());
+        std::vector<float> bands(bank.bands());
+        for (std::size_t k = 0; k < bank.bins(); ++k) {
+            impulse[k] = 1.0f;
+            bank.apply(impulse, bands);
+            for (std::size_t b = 0; b < bank.bands(); ++b) {
+                ret[b][k] = bands[b];
+            }
+            impulse[k] = 0.0f;
+        }
+        return ret;
+    }
+} // namespace
+
+TEST(FilterbankTests, bands_are_weighted_means) {
+    for (auto const scale : SCALES) {
+        Filterbank const bank{options_for(scale)};
+        ASSERT_EQ(bank.bands(), 100);
+
+        std::vector<float> const flat(BINS, 2.0f);
+        std::vector<float> bands(bank.bands());
+        bank.apply(flat, bands);
+        for (std::size_t b = 0; b < bands.size(); ++b) {
+            EXPECT_NEAR(bands[b], 2.0f, 1e-5f) << to_string(scale) << " band " << b;
+        }
+    }
+}
+
+TEST(FilterbankTests, centres_rise_across_the_range) {
+    for (auto const scale : SCALES) {
+        Filterbank const bank{options_for(scale)};
+        EXPECT_GT(bank.centre_hz(0), 20.0f) << to_string(scale);
+        EXPECT_LT(bank.centre_hz(bank.bands() - 1), 20000.0f) << to_string(scale);
+        for (std::size_t b = 1; b < bank.bands(); ++b) {
+            EXPECT_GT(bank.centre_hz(b), bank.centre_hz(b - 1)) << to_string(scale) << " band " << b;
+        }
+    }
+}
+
+TEST(FilterbankTests, stores_only_the_nonzero_weights) {
+    for (auto const scale : SCALES) {
+        Filterbank const bank{options_for(scale)};
+        // Neighbouring triangles overlap, so each bin is in two bands at
+        // most, and the narrow bands add at most two weights each
+        EXPECT_LE(bank.nonzero_weights(), 2 * BINS + 2 * bank.bands()) << to_string(scale);
+
+        auto const dense    = dense_weights(bank);
+        std::size_t nonzero = 0;
+        for (auto const& band : dense) {
+            nonzero += static_cast<std::size_t>(std::ranges::count_if(band, [](float weight) { return weight > 0; }));
+        }
+        EXPECT_LE(nonzero, bank.nonzero_weights()) << to_string(scale);
+    }
+}
+
+TEST(FilterbankTests, a_tone_lands_in_the_nearest_band) {
+    Filterbank const bank{FilterbankOptions{}};
+    float const bin_hz = 48000.0f / WINDOW_SIZE;
+
+    for (std::size_t const bin : {10, 50, 200, 700}) {
+        std::vector<float> spectrum(BINS);
+        spectrum[bin] = 1.0f;
+        std::vector<float> bands(bank.bands());
+        bank.apply(spectrum, bands);
+
+        auto const peak = std::ranges::max_element(bands) - bands.begin();
+        float const hz  = bin * bin_hz;
+        std::vector<float> distances(bank.bands());
+        for (std::size_t b = 0; b < bank.bands(); ++b) {
+            distances[b] = std::abs(std::log2(bank.centre_hz(b) / hz));
+        }
+        auto const nearest = std::ranges::min_element(distances) - distances.begin();
+
+        // Between two centres the wider band has the smaller weights, so it
+        // can lose to the narrower one either side
+        EXPECT_LE(std::abs(peak - nearest), 1) << "bin " << bin;
+    }
+}
+
+TEST(FilterbankTests, accumulate_adds_onto_the_bands) {
+    Filterbank const bank{options_for(BandScale::mel)};
+    std::vector<float> spectrum(BINS);
+    for (std::size_t k = 0; k < BINS; ++k) {
+        spectrum[k] = std::sin(0.01f * k) + 1.0f;
+    }
+
+    std::vector<float> once(bank.bands());
+    bank.apply(spectrum, once);
+
+    std::vector<float> twice;
+    bank.clear(twice);
+    ASSERT_EQ(twice.size(), bank.bands());
+    bank.accumulate(spectrum, twice);
+    bank.accumulate(spectrum, twice);
+    for (std::size_t b = 0; b < once.size(); ++b) {
+        EXPECT_FLOAT_EQ(twice[b], 2 * once[b]) << "band " << b;
+    }
+}
+
+TEST(FilterbankTests, reduces_a_pipeline) {
+    std::array<float, WINDOW_SIZE> input{};
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        input[i] = std::sin(2 * std::numbers::pi_v<float> * 37 * i / WINDOW_SIZE);
+    }
+
+    Filterbank const bank{options_for(BandScale::bark)};
+    auto pipeline = make_pipeline<WINDOW_SIZE>(Magnitude{}, bank);
+    static_assert(decltype(pipeline)::ROW_REDUCES);
+
+    std::vector<float> bands;
+    pipeline.run(input, bands);
+    ASSERT_EQ(bands.size(), bank.bands());
+
+    auto unreduced = make_pipeline<WINDOW_SIZE>(Magnitude{});
+    std::array<float, BINS> magnitudes{};
+    unreduced.run(input, magnitudes);
+    std::vector<float> expected(bank.bands());
+    bank.apply(magnitudes, expected);
+
+    for (std::size_t b = 0; b < bands.size(); ++b) {
+        EXPECT_NEAR(bands[b], expected[b], 1e-4f * std::max(1.0f, expected[b])) << "band " << b;
+    }
+}
+
+TEST(FilterbankTests, takes_the_band_count_at_run_time) {
+    for (std::size_t const count : {1, 16, 64, 300}) {
+        FilterbankOptions options;
+        options.bands = count;
+        Filterbank const bank{options};
+        EXPECT_EQ(bank.bands(), count);
+
+        std::vector<float> bands;
+        bank.clear(bands);
+        EXPECT_EQ(bands.size(), count);
+    }
+}
+
+TEST(FilterbankTests, scales_round_trip_through_their_names) {
+    for (auto const scale : SCALES) {
+        EXPECT_EQ(band_scale_from_string(to_string(scale)), scale);
+    }
+    EXPECT_EQ(band_scale_from_string("octave"), std::nullopt);
+}
@@ -0,0 +1,108 @@
+#include <history_ring.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace wt;
+
+namespace {
+    // Fills `frames` stereo frames where both channels hold the frame position
+    std::vector<float> make_frames(std::uint64_t first_position, std::size_t frames) {
+        std::vector<float> ret;
+        ret.reserve(frames * 2);
+        for (std::size_t i = 0; i < frames; ++i) {
+            ret.push_back(static_cast<float>(first_position + i));
+            ret.push_back(static_cast<float>(first_position + i));
+        }
+        return ret;
+    }
+} // namespace
+
+TEST(HistoryRingTests, rounds_capacity_to_power_of_two) {
+    HistoryRing ring{2, 1000};
+    EXPECT_EQ(ring.capacity(), 1024);
+    EXPECT_EQ(ring.channels(), 2);
+}
+
+TEST(HistoryRingTests, reads_do_not_consume) {
+    HistoryRing ring{2, 16};
+    ring.write(make_frames(0, 8));
+
+    std::array<float, 8> first{};
+    std::array<float, 8> second{};
+    ASSERT_EQ(ring.read_latest(first), 4);
+    ASSERT_EQ(ring.read_latest(second), 4);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(first[0], 4.0f);
+    EXPECT_EQ(first[7], 7.0f);
+}
+
+TEST(HistoryRingTests, reads_by_position_across_wrap) {
+    HistoryRing ring{2, 16};
+    ring.write(make_frames(0, 12));
+    ring.write(make_frames(12, 12));
+
+    std::array<float, 10> out{};
+    ASSERT_TRUE(ring.read(14, out));
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        EXPECT_EQ(out[i], static_cast<float>(14 + i / 2));
+    }
+}
+
+TEST(HistoryRingTests, fails_overwritten_and_future_reads) {
+    HistoryRing ring{2, 16};
+    ring.write(make_frames(0, 40));
+    EXPECT_EQ(ring.write_position(), 40);
+    EXPECT_EQ(ring.oldest_position(), 24);
+
+    std::array<float, 4> out{};
+    EXPECT_FALSE(ring.read(23, out));
+    EXPECT_TRUE(ring.read(24, out));
+    EXPECT_FALSE(ring.read(39, out));
+}
+
+TEST(HistoryRingTests, not_enough_history_yet) {
+    HistoryRing ring{2, 16};
+    ring.write(make_frames(0, 2));
+
+    std::array<float, 8> out{};
+    EXPECT_FALSE(ring.read_latest(out).has_value());
+}
+
+TEST(HistoryRingTests, concurrent_readers_never_see_torn_windows) {
+    HistoryRing ring{2, 256};
+    std::atomic_bool done = false;
+
+    std::thread producer{[&] {
+        for (std::uint64_t position = 0; position < 200'000; position += 37) {
+            ring.write(make_frames(position, 37));
+        }
+        done = true;
+    }};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.emplace_back([&] {
+            std::array<float, 128> out{};
+            while (!done) {
+                auto const position = ring.read_latest(out);
+                if (!position) {
+                    continue;
+                }
+                for (std::size_t j = 0; j < out.size(); ++j) {
+                    ASSERT_EQ(out[j], static_cast<float>(*position + j / 2));
+                }
+            }
+        });
+    }
+
+    producer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+}
@@ -0,0 +1,62 @@
+#include <mapped_pcm_source.hpp>
+#include <wav_writer.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace wt;
+
+namespace {
+    // A WAV at 44.1kHz holding `data_bytes` of silence
+    std::vector<std::byte> make_wav(std::uint16_t tag, std::uint16_t channels, std::uint16_t bits,
+        std::uint32_t data_bytes, std::uint32_t extra_chunk_bytes = 0) {
+        return support::make_wav(
+            support::WavFormat{tag, channels, bits, 44100}, std::vector<std::byte>(data_bytes), extra_chunk_bytes);
+    }
+} // namespace
+
+TEST(MappedPcmSourceTests, parses_16_bit_pcm) {
+    auto const wav    = make_wav(1, 2, 16, 400);
+    auto const layout = parse_wav(wav);
+    ASSERT_TRUE(layout);
+    EXPECT_EQ(layout->format, ma_format_s16);
+    EXPECT_EQ(layout->channels, 2);
+    EXPECT_EQ(layout->sample_rate, 44100);
+    EXPECT_EQ(layout->data_offset, 44);
+    EXPECT_EQ(layout->frames, 100);
+}
+
+TEST(MappedPcmSourceTests, parses_float_pcm) {
+    auto const layout = parse_wav(make_wav(3, 1, 32, 64));
+    ASSERT_TRUE(layout);
+    EXPECT_EQ(layout->format, ma_format_f32);
+    EXPECT_EQ(layout->frames, 16);
+}
+
+TEST(MappedPcmSourceTests, skips_unknown_chunks) {
+    auto const layout = parse_wav(make_wav(1, 2, 16, 40, 10));
+    ASSERT_TRUE(layout);
+    EXPECT_EQ(layout->data_offset, 44 + 18);
+    EXPECT_EQ(layout->frames, 10);
+}
+
+TEST(MappedPcmSourceTests, clamps_data_to_the_file) {
+    auto wav = make_wav(1, 2, 16, 400);
+    wav.resize(wav.size() - 100);
+
+    auto const layout = parse_wav(wav);
+    ASSERT_TRUE(layout);
+    EXPECT_EQ(layout->frames, 75);
+}
+
+TEST(MappedPcmSourceTests, rejects_formats_it_cannot_play_in_place) {
+    // 24 bit samples and unaligned 32 bit data both need a decoder
+    EXPECT_FALSE(parse_wav(make_wav(1, 2, 24, 60)));
+    EXPECT_FALSE(parse_wav(make_wav(3, 1, 32, 64, 2)));
+
+    std::vector<std::byte> not_a_wav(64);
+    EXPECT_FALSE(parse_wav(not_a_wav));
+}
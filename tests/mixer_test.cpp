@@ -0,0 +1,128 @@
+#include <mixer.hpp>
+#include <tone_source.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace wt;
+using wt::support::ToneSource;
+
+namespace {
+    constexpr std::uint32_t CHANNELS    = ToneSource::CHANNELS;
+    constexpr std::uint32_t SAMPLE_RATE = ToneSource::SAMPLE_RATE;
+    constexpr std::uint32_t PERIOD      = 480;
+
+    MixerOptions options(std::size_t max_streams = 4) {
+        // clang-format off
+        return MixerOptions{
+          .sample_rate        = SAMPLE_RATE,
+          .channels           = CHANNELS,
+          .max_streams        = max_streams,
+          .analysis_threads   = 2,
+          .analysis_interval  = std::chrono::milliseconds{1}
+        };
+        // clang-format on
+    }
+
+    // Mixes whole periods until `frames` frames have gone through
+    std::vector<float> mix_frames(Mixer& mixer, std::uint32_t frames) {
+        std::vector<float> output(std::size_t{frames} * CHANNELS);
+        for (std::uint32_t done = 0; done < frames; done += PERIOD) {
+            mixer.mix(output.data() + std::size_t{done} * CHANNELS, std::min(PERIOD, frames - done));
+        }
+        return output;
+    }
+
+    bool wait_for_spectrum(Mixer const& mixer, Mixer::StreamId stream, StreamSpectrum& spectrum) {
+        auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+        while (!mixer.spectrum(stream, spectrum)) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        return true;
+    }
+
+    std::size_t loudest_bin(std::span<float const> magnitudes) {
+        return static_cast<std::size_t>(std::distance(magnitudes.begin(), std::ranges::max_element(magnitudes)));
+    }
+} // namespace
+
+TEST(MixerTests, adds_every_stream_into_the_output) {
+    Mixer mixer{options()};
+    auto const first  = mixer.add(std::make_unique<ToneSource>(0, 0.25f, SAMPLE_RATE), 1.0f);
+    auto const second = mixer.add(std::make_unique<ToneSource>(0, 0.5f, SAMPLE_RATE), 0.5f);
+    ASSERT_TRUE(first && second);
+    EXPECT_NE(*first, *second);
+    EXPECT_EQ(mixer.stream_count(), 2);
+
+    mixer.set_master_gain(2.0f);
+    auto const output = mix_frames(mixer, PERIOD);
+    for (std::uint32_t i = 0; i < PERIOD; ++i) {
+        ASSERT_FLOAT_EQ(output[i * 2 + 1], 1.0f) << "frame " << i;
+    }
+
+    // Each tap holds its own stream at its own gain, before the master
+    std::vector<float> latest(2);
+    ASSERT_TRUE(mixer.tap(*first).read_latest(latest));
+    EXPECT_FLOAT_EQ(latest[1], 0.25f);
+    ASSERT_TRUE(mixer.tap(*second).read_latest(latest));
+    EXPECT_FLOAT_EQ(latest[1], 0.25f);
+}
+
+TEST(MixerTests, analyses_each_stream_on_its_own) {
+    Mixer mixer{options()};
+    auto const low  = mixer.add(std::make_unique<ToneSource>(32, 0.0f, SAMPLE_RATE));
+    auto const high = mixer.add(std::make_unique<ToneSource>(256, 0.0f, SAMPLE_RATE));
+    ASSERT_TRUE(low && high);
+    mix_frames(mixer, 4 * WINDOW_SIZE);
+
+    StreamSpectrum spectrum;
+    ASSERT_TRUE(wait_for_spectrum(mixer, *low, spectrum));
+    EXPECT_EQ(spectrum.channels, CHANNELS);
+    EXPECT_EQ(loudest_bin(spectrum.channel(0)), 32);
+
+    ASSERT_TRUE(wait_for_spectrum(mixer, *high, spectrum));
+    EXPECT_EQ(loudest_bin(spectrum.channel(0)), 256);
+}
+
+TEST(MixerTests, reuses_the_slots_of_removed_streams) {
+    Mixer mixer{options(1)};
+    auto const first = mixer.add(std::make_unique<ToneSource>(8, 0.0f, 3 * WINDOW_SIZE));
+    ASSERT_TRUE(first);
+    EXPECT_FALSE(mixer.add(std::make_unique<ToneSource>(8, 0.0f, 100)));
+
+    mix_frames(mixer, 4 * WINDOW_SIZE);
+    EXPECT_TRUE(mixer.finished(*first));
+
+    StreamSpectrum spectrum;
+    ASSERT_TRUE(wait_for_spectrum(mixer, *first, spectrum));
+
+    // The new stream starts without a spectrum, and never gets one of the
+    // old stream's audio
+    EXPECT_TRUE(mixer.remove(*first));
+    EXPECT_FALSE(mixer.remove(*first));
+    EXPECT_EQ(mixer.stream_count(), 0);
+    auto const second = mixer.add(std::make_unique<ToneSource>(8, 0.0f, 100));
+    ASSERT_TRUE(second);
+    EXPECT_EQ(*second, *first);
+    EXPECT_FALSE(mixer.spectrum(*second, spectrum));
+}
+
+TEST(MixerTests, counts_streams_running_short) {
+    Mixer mixer{options()};
+    ASSERT_TRUE(mixer.add(std::make_unique<ToneSource>(0, 0.5f, SAMPLE_RATE)));
+    ASSERT_TRUE(mixer.add(std::make_unique<ToneSource>(0, 0.5f, SAMPLE_RATE, true)));
+    mix_frames(mixer, 3 * PERIOD);
+
+    auto const stats = mixer.callback_stats();
+    EXPECT_EQ(stats.callbacks, 3);
+    EXPECT_EQ(stats.underflows, 3);
+}
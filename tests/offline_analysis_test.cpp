@@ -0,0 +1,98 @@
+#include <offline_analysis.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <numbers>
+
+using namespace wt::offline;
+
+namespace {
+    DecodedTrack make_sine(std::uint32_t sample_rate, float frequency, std::size_t samples) {
+        DecodedTrack track{sample_rate, std::vector<float>(samples)};
+        for (std::size_t i = 0; i < samples; ++i) {
+            track.samples[i] = std::sin(2 * std::numbers::pi_v<float> * frequency * i / sample_rate);
+        }
+        return track;
+    }
+} // namespace
+
+TEST(OfflineAnalysisTests, slices_whole_windows_by_hop) {
+    auto const spectrogram = analyze_track(make_sine(48000, 1000, 2048 + 1024 * 9 + 100), 1024, 1);
+    EXPECT_EQ(spectrogram.windows(), 10);
+    EXPECT_EQ(spectrogram.bins, 2048 / 2 + 1);
+
+    EXPECT_EQ(analyze_track(make_sine(48000, 1000, 2000), 1024, 1).windows(), 0);
+}
+
+TEST(OfflineAnalysisTests, takes_the_window_size_at_run_time) {
+    // 1500Hz is bin 16 of a 512 point FFT at 48kHz, and bin 256 of 8192
+    auto const small = analyze_track(make_sine(48000, 1500, 4096), 256, 1, 512);
+    EXPECT_EQ(small.window_size, 512);
+    EXPECT_EQ(small.bins, 257);
+    EXPECT_EQ(small.windows(), (4096 - 512) / 256 + 1);
+    auto const small_row = small.row(0);
+    EXPECT_EQ(std::distance(small_row.begin(), std::max_element(small_row.begin(), small_row.end())), 16);
+
+    auto const large = analyze_track(make_sine(48000, 1500, 8192), 1024, 2, 8192);
+    EXPECT_EQ(large.bins, 4097);
+    ASSERT_EQ(large.windows(), 1);
+    auto const large_row = large.row(0);
+    EXPECT_EQ(std::distance(large_row.begin(), std::max_element(large_row.begin(), large_row.end())), 256);
+}
+
+TEST(OfflineAnalysisTests, peaks_at_the_tone) {
+    // 1500Hz lands exactly on bin 64 of a 2048 point FFT at 48kHz
+    auto const spectrogram = analyze_track(make_sine(48000, 1500, 8192), 2048, 1);
+    for (std::size_t i = 0; i < spectrogram.windows(); ++i) {
+        auto const row = spectrogram.row(i);
+        EXPECT_EQ(std::distance(row.begin(), std::max_element(row.begin(), row.end())), 64);
+    }
+}
+
+TEST(OfflineAnalysisTests, does_not_depend_on_thread_count) {
+    auto const track  = make_sine(44100, 440, 44100 * 3);
+    auto const single = analyze_track(track, 512, 1);
+    auto const pooled = analyze_track(track, 512, 4);
+    EXPECT_EQ(single.magnitudes, pooled.magnitudes);
+}
+
+TEST(OfflineAnalysisTests, round_trips_through_a_file) {
+    auto const spectrogram = analyze_track(make_sine(44100, 440, 16384), 1024, 2);
+    auto const path        = std::filesystem::temp_directory_path() / "offline_analysis_test.wtsg";
+
+    ASSERT_TRUE(write_spectrogram(spectrogram, path.string()));
+    auto const loaded = read_spectrogram(path.string());
+    std::filesystem::remove(path);
+
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->sample_rate, 44100);
+    EXPECT_EQ(loaded->window_size, 2048);
+    EXPECT_EQ(loaded->hop, 1024);
+    EXPECT_EQ(loaded->magnitudes, spectrogram.magnitudes);
+}
+
+TEST(OfflineAnalysisTests, rejects_a_file_shorter_than_its_header_says) {
+    auto const spectrogram = analyze_track(make_sine(44100, 440, 16384), 1024, 2);
+    auto const path        = std::filesystem::temp_directory_path() / "offline_analysis_test_short.wtsg";
+    ASSERT_TRUE(write_spectrogram(spectrogram, path.string()));
+
+    // One float short of the last window
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - sizeof(float));
+    EXPECT_FALSE(read_spectrogram(path.string()));
+
+    // A window count whose size overflows, after the 24 bytes before it
+    {
+        std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+        std::uint64_t const windows = std::uint64_t{1} << 62;
+        file.seekp(24);
+        file.write(reinterpret_cast<char const*>(&windows), sizeof(windows));
+    }
+    EXPECT_FALSE(read_spectrogram(path.string()));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,134 @@
+#include <analysis/onset.hpp>
+#include <analysis/stft.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <optional>
+#include <span>
+#include <vector>
+
+using namespace wt::analysis;
+
+namespace {
+    constexpr std::size_t BINS = WINDOW_SIZE / 2 + 1;
+    constexpr std::size_t HOP  = THREE_QUARTER_OVERLAP;
+
+    // Frame numbers of the onsets found, over frames that are silent but
+    // for a burst across every bin on each of `bursts`
+    std::vector<std::uint64_t> detect_bursts(
+        OnsetDetector& detector, std::size_t frames, std::vector<std::size_t> const& bursts) {
+        std::vector<float> const silence(BINS);
+        std::vector<float> const burst(BINS, 0.5f);
+
+        std::vector<std::uint64_t> ret;
+        for (std::size_t frame = 0; frame < frames; ++frame) {
+            bool const loud = std::ranges::find(bursts, frame) != bursts.end();
+            if (auto const onset = detector.push(frame * HOP, loud ? burst : silence)) {
+                ret.push_back(onset->position / HOP);
+            }
+        }
+        return ret;
+    }
+} // namespace
+
+TEST(OnsetTests, finds_bursts_a_frame_late) {
+    OnsetDetector detector;
+    std::vector<float> const silence(BINS);
+    std::vector<float> const burst(BINS, 0.5f);
+
+    for (std::uint64_t frame = 0; frame < 10; ++frame) {
+        EXPECT_EQ(detector.push(frame * HOP, silence), std::nullopt);
+    }
+    EXPECT_EQ(detector.push(10 * HOP, burst), std::nullopt);
+    EXPECT_GT(detector.strength(), 0.0f);
+
+    auto const onset = detector.push(11 * HOP, silence);
+    ASSERT_TRUE(onset);
+    EXPECT_EQ(onset->position, 10 * HOP);
+    EXPECT_DOUBLE_EQ(onset->seconds, 10.0 * HOP / 48000);
+    EXPECT_GT(onset->strength, 1.0f);
+}
+
+TEST(OnsetTests, a_held_note_is_one_onset) {
+    OnsetDetector detector;
+    std::vector<float> note(BINS);
+    note[100] = 1.0f;
+    note[200] = 0.5f;
+
+    std::size_t onsets = 0;
+    for (std::uint64_t frame = 0; frame < 100; ++frame) {
+        onsets += detector.push(frame * HOP, frame < 20 ? std::vector<float>(BINS) : note).has_value();
+    }
+    EXPECT_EQ(onsets, 1);
+}
+
+TEST(OnsetTests, keeps_onsets_apart) {
+    OnsetOptions options;
+    options.min_gap_seconds = 0.1f;
+    OnsetDetector detector{options};
+
+    // Bursts every other frame, about 20ms apart
+    EXPECT_EQ(detect_bursts(detector, 40, {10, 12, 14, 30}), (std::vector<std::uint64_t>{10, 30}));
+}
+
+TEST(OnsetTests, adapts_to_a_busy_passage) {
+    OnsetDetector detector;
+
+    // Ten loud frames in a row raise the threshold, so the quieter burst
+    // right after is not enough, the same burst after a rest is
+    std::vector<float> const silence(BINS);
+    std::vector<float> const quiet(BINS, 0.01f);
+    std::vector<std::uint64_t> found;
+    for (std::uint64_t frame = 0; frame < 80; ++frame) {
+        std::vector<float> magnitudes = silence;
+        if (frame >= 10 && frame < 20) {
+            magnitudes.assign(BINS, frame % 2 ? 1.0f : 0.2f);
+        } else if (frame == 22 || frame == 60) {
+            magnitudes = quiet;
+        }
+        if (auto const onset = detector.push(frame * HOP, magnitudes)) {
+            found.push_back(onset->position / HOP);
+        }
+    }
+    EXPECT_EQ(std::ranges::count(found, 22), 0);
+    EXPECT_EQ(std::ranges::count(found, 60), 1);
+}
+
+TEST(OnsetTests, starts_over_after_a_reset) {
+    OnsetDetector detector;
+    auto const first = detect_bursts(detector, 30, {10, 20});
+    detector.reset();
+    EXPECT_EQ(detector.strength(), 0.0f);
+    EXPECT_EQ(detect_bursts(detector, 30, {10, 20}), first);
+    EXPECT_EQ(first, (std::vector<std::uint64_t>{10, 20}));
+}
+
+TEST(OnsetTests, finds_clicks_in_stft_frames) {
+    // A click every quarter second
+    std::vector<float> samples(48000 * 2);
+    for (std::size_t i = 0; i < samples.size(); i += 12000) {
+        for (std::size_t j = 0; j < 64; ++j) {
+            samples[i + j] = std::sin(2 * std::numbers::pi_v<float> * 3000 * j / 48000);
+        }
+    }
+
+    Stft stft{1, THREE_QUARTER_OVERLAP};
+    OnsetDetector detector;
+    std::vector<std::uint64_t> onsets;
+    stft.push(samples, [&](StftFrame const& frame) {
+        if (auto const onset = detector.push(frame.position + WINDOW_SIZE / 2, frame)) {
+            onsets.push_back(onset->position);
+        }
+    });
+
+    // The first window a click is in, up to a hop later
+    ASSERT_EQ(onsets.size(), 7);
+    for (std::size_t i = 0; i < onsets.size(); ++i) {
+        auto const click = (i + 1) * 12000;
+        EXPECT_GE(onsets[i] + WINDOW_SIZE / 2, click) << "onset " << i;
+        EXPECT_LE(onsets[i], click + WINDOW_SIZE / 2) << "onset " << i;
+    }
+}
@@ -0,0 +1,190 @@
+#include <pcm_cache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+using namespace wt;
+
+namespace {
+    constexpr std::uint32_t CHANNELS    = 2;
+    constexpr std::uint32_t SAMPLE_RATE = 48000;
+    constexpr std::uint64_t FRAMES      = 3000;
+
+    // Every entry takes a header page plus its samples
+    constexpr std::uint64_t ENTRY_BYTES = 4096 + FRAMES * CHANNELS * sizeof(float);
+
+    std::filesystem::path fresh_directory() {
+        auto const path = std::filesystem::temp_directory_path() / "pcm_cache_test";
+        std::filesystem::remove_all(path);
+        return path;
+    }
+
+    PcmCacheKey key(std::uint64_t hash) {
+        return PcmCacheKey{hash, 0, 0};
+    }
+
+    // Produces FRAMES frames counting up from `first`, in uneven chunks
+    PcmCache::Producer counting(float first) {
+        return [first, written = std::uint64_t{0}](std::span<float> out) mutable -> std::int64_t {
+            std::uint64_t const frames = std::min<std::uint64_t>({out.size() / CHANNELS, 700, FRAMES - written});
+            for (std::size_t i = 0; i < frames * CHANNELS; ++i) {
+                out[i] = first + static_cast<float>(written * CHANNELS + i);
+            }
+            written += frames;
+            return static_cast<std::int64_t>(frames);
+        };
+    }
+} // namespace
+
+TEST(PcmCacheTests, hashes_depend_on_every_byte) {
+    std::vector<std::byte> bytes(1001, std::byte{7});
+    auto const original = hash_contents(bytes);
+    EXPECT_EQ(hash_contents(bytes), original);
+
+    bytes.back() = std::byte{8};
+    EXPECT_NE(hash_contents(bytes), original);
+
+    bytes.back() = std::byte{7};
+    bytes.push_back(std::byte{0});
+    EXPECT_NE(hash_contents(bytes), original);
+}
+
+TEST(PcmCacheTests, plays_back_what_was_written) {
+    PcmCache cache{fresh_directory(), ENTRY_BYTES * 4};
+    EXPECT_EQ(cache.open(key(1), std::chrono::milliseconds{10}), nullptr);
+
+    ASSERT_TRUE(cache.write(key(1), CHANNELS, SAMPLE_RATE, counting(0)));
+    EXPECT_EQ(cache.size_bytes(), ENTRY_BYTES);
+
+    auto source = cache.open(key(1), std::chrono::milliseconds{10});
+    ASSERT_NE(source, nullptr);
+    EXPECT_EQ(source->format(), ma_format_f32);
+    EXPECT_EQ(source->channels(), CHANNELS);
+    EXPECT_EQ(source->sample_rate(), SAMPLE_RATE);
+
+    source->start();
+    std::vector<float> played(FRAMES * CHANNELS);
+    EXPECT_EQ(source->read(played.data(), FRAMES, 1.0f), FRAMES);
+    for (std::size_t i = 0; i < played.size(); ++i) {
+        ASSERT_EQ(played[i], static_cast<float>(i));
+    }
+    EXPECT_TRUE(source->finished());
+}
+
+TEST(PcmCacheTests, seeks_inside_an_entry) {
+    PcmCache cache{fresh_directory(), ENTRY_BYTES * 4};
+    ASSERT_TRUE(cache.write(key(1), CHANNELS, SAMPLE_RATE, counting(0)));
+
+    auto source = cache.open(key(1), std::chrono::milliseconds{10});
+    ASSERT_NE(source, nullptr);
+    source->start();
+
+    std::vector<float> played(100 * CHANNELS);
+    ASSERT_EQ(source->read(played.data(), 100, 1.0f), 100);
+    ASSERT_TRUE(source->seek(2000, 300));
+    EXPECT_EQ(source->position(), 2000);
+
+    // The read after the seek starts at the new frame, with the frames
+    // before it handed out once as the primer
+    ASSERT_EQ(source->read(played.data(), 100, 1.0f), 100);
+    EXPECT_EQ(played.front(), static_cast<float>(2000 * CHANNELS));
+    EXPECT_EQ(source->position(), 2100);
+
+    auto const primer = source->take_primer();
+    ASSERT_EQ(primer.size(), 300 * CHANNELS * sizeof(float));
+    float first = 0.0f;
+    std::memcpy(&first, primer.data(), sizeof(first));
+    EXPECT_EQ(first, static_cast<float>(1700 * CHANNELS));
+    EXPECT_TRUE(source->take_primer().empty());
+
+    // Past the end clamps to it
+    ASSERT_TRUE(source->seek(FRAMES * 2, 0));
+    EXPECT_EQ(source->read(played.data(), 100, 1.0f), 0);
+    EXPECT_TRUE(source->finished());
+}
+
+TEST(PcmCacheTests, evicts_the_least_recently_played) {
+    PcmCache cache{fresh_directory(), ENTRY_BYTES * 2};
+    ASSERT_TRUE(cache.write(key(1), CHANNELS, SAMPLE_RATE, counting(0)));
+    ASSERT_TRUE(cache.write(key(2), CHANNELS, SAMPLE_RATE, counting(0)));
+
+    // Playing the first makes the second the oldest
+    EXPECT_NE(cache.open(key(1), std::chrono::milliseconds{10}), nullptr);
+    ASSERT_TRUE(cache.write(key(3), CHANNELS, SAMPLE_RATE, counting(0)));
+
+    EXPECT_TRUE(cache.contains(key(1)));
+    EXPECT_FALSE(cache.contains(key(2)));
+    EXPECT_TRUE(cache.contains(key(3)));
+    EXPECT_EQ(cache.size_bytes(), ENTRY_BYTES * 2);
+}
+
+TEST(PcmCacheTests, keeps_entries_across_instances) {
+    auto const directory = fresh_directory();
+    {
+        PcmCache cache{directory, ENTRY_BYTES * 4};
+        ASSERT_TRUE(cache.write(key(1), CHANNELS, SAMPLE_RATE, counting(0)));
+    }
+
+    PcmCache cache{directory, ENTRY_BYTES * 4};
+    EXPECT_TRUE(cache.contains(key(1)));
+    EXPECT_EQ(cache.size_bytes(), ENTRY_BYTES);
+    EXPECT_NE(cache.open(key(1), std::chrono::milliseconds{10}), nullptr);
+}
+
+TEST(PcmCacheTests, abandoned_writes_leave_nothing) {
+    auto const directory = fresh_directory();
+    PcmCache cache{directory, ENTRY_BYTES * 4};
+    EXPECT_FALSE(cache.write(key(1), CHANNELS, SAMPLE_RATE, [](std::span<float>) -> std::int64_t { return -1; }));
+    EXPECT_FALSE(cache.contains(key(1)));
+    EXPECT_TRUE(std::filesystem::is_empty(directory));
+}
+
+TEST(PcmCacheTests, rejects_truncated_entries) {
+    auto const directory = fresh_directory();
+    PcmCache cache{directory, ENTRY_BYTES * 4};
+    ASSERT_TRUE(cache.write(key(1), CHANNELS, SAMPLE_RATE, counting(0)));
+
+    std::ifstream file{directory / key(1).file_name(), std::ios::binary};
+    std::vector<std::byte> bytes(ENTRY_BYTES);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+    auto const layout = parse_cache_entry(bytes);
+    ASSERT_TRUE(layout);
+    EXPECT_EQ(layout->data_offset % 4096, 0);
+    EXPECT_EQ(layout->frames, FRAMES);
+
+    bytes.resize(bytes.size() - 1);
+    EXPECT_FALSE(parse_cache_entry(bytes));
+}
+
+TEST(PcmCacheTests, rejects_frame_counts_that_overflow) {
+    auto const directory = fresh_directory();
+    PcmCache cache{directory, ENTRY_BYTES * 4};
+    ASSERT_TRUE(cache.write(key(1), CHANNELS, SAMPLE_RATE, counting(0)));
+
+    std::ifstream file{directory / key(1).file_name(), std::ios::binary};
+    std::vector<std::byte> bytes(ENTRY_BYTES);
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+    // Times two channels of four bytes this wraps around to zero bytes
+    std::uint64_t const frames = std::uint64_t{1} << 62;
+    std::memcpy(bytes.data() + 16, &frames, sizeof(frames));
+    EXPECT_FALSE(parse_cache_entry(bytes));
+}
+
+TEST(PcmCacheTests, abandons_producers_that_overrun_the_chunk) {
+    auto const directory = fresh_directory();
+    PcmCache cache{directory, ENTRY_BYTES * 4};
+    EXPECT_FALSE(cache.write(key(1), CHANNELS, SAMPLE_RATE,
+        [](std::span<float> frames) -> std::int64_t { return static_cast<std::int64_t>(frames.size()); }));
+    EXPECT_FALSE(cache.contains(key(1)));
+}
@@ -0,0 +1,177 @@
+#include <analysis/analysis.hpp>
+#include <analysis/hann_window.hpp>
+#include <analysis/pipeline.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <numbers>
+
+using namespace wt::analysis;
+
+namespace {
+    constexpr std::size_t BINS = WINDOW_SIZE / 2 + 1;
+
+    using Window = std::array<float, WINDOW_SIZE>;
+
+    Window make_tone(float bin) {
+        Window ret;
+        for (std::size_t i = 0; i < WINDOW_SIZE; ++i) {
+            ret[i] = std::sin(2 * std::numbers::pi_v<float> * bin * i / WINDOW_SIZE)
+                   + 0.25f * std::cos(2 * std::numbers::pi_v<float> * bin * 7 * i / WINDOW_SIZE);
+        }
+        return ret;
+    }
+
+    // The same bars through the dynamic analyzer, the way they were made
+    // before the pipeline
+    std::array<float, 100> dynamic_bars(Window const& window) {
+        auto const hann    = make_hann_coefficients<WINDOW_SIZE>();
+        auto const weights = make_hann_coefficients<BINS>();
+
+        FftAnalyzer<> analyzer;
+        analyzer.set_preprocessor([&](Window& buffer) {
+            for (std::size_t i = 0; i < WINDOW_SIZE; ++i) {
+                buffer[i] *= hann[i];
+            }
+        });
+        auto const spectrum = analyzer.analyze(window);
+
+        std::array<float, 100> ret{};
+        constexpr std::size_t width = BINS / 100;
+        for (std::size_t i = 0; i < 100; ++i) {
+            for (std::size_t j = 0; j < width; ++j) {
+                ret[i] += std::abs(spectrum[i * width + j]) * weights[i * width + j];
+            }
+            ret[i] /= width;
+        }
+        return ret;
+    }
+} // namespace
+
+TEST(PipelineTests, matches_the_dynamic_analyzer) {
+    auto const window = make_tone(10.5f);
+
+    auto pipeline = make_pipeline<WINDOW_SIZE>(hann_windowing<WINDOW_SIZE>(), Magnitude{},
+        Weighting<BINS>{make_hann_coefficients<BINS>()}, LinearBinning<BINS, 100>{});
+    static_assert(std::is_same_v<decltype(pipeline)::result_type, std::array<float, 100>>);
+
+    std::array<float, 100> bars;
+    pipeline.run(window, bars);
+
+    auto const expected = dynamic_bars(window);
+    for (std::size_t i = 0; i < bars.size(); ++i) {
+        EXPECT_NEAR(bars[i], expected[i], 1e-4f * (1 + expected[i])) << "band " << i;
+    }
+}
+
+TEST(PipelineTests, without_stages_gives_the_magnitudes) {
+    auto const window = make_tone(10);
+
+    Pipeline<WINDOW_SIZE> pipeline;
+    static_assert(!decltype(pipeline)::REDUCES);
+
+    std::array<float, BINS> magnitudes;
+    pipeline.run(window, magnitudes);
+
+    FftAnalyzer<> analyzer;
+    auto const spectrum = analyzer.analyze(window);
+    for (std::size_t k = 0; k < BINS; ++k) {
+        EXPECT_FLOAT_EQ(magnitudes[k], std::abs(spectrum[k])) << "bin " << k;
+    }
+}
+
+TEST(PipelineTests, power_squares_the_magnitude) {
+    auto const window = make_tone(10);
+
+    auto magnitude = make_pipeline<WINDOW_SIZE>(hann_windowing<WINDOW_SIZE>());
+    auto power     = make_pipeline<WINDOW_SIZE>(hann_windowing<WINDOW_SIZE>(), Power{});
+
+    std::array<float, BINS> magnitudes;
+    std::array<float, BINS> powers;
+    magnitude.run(window, magnitudes);
+    power.run(window, powers);
+
+    for (std::size_t k = 0; k < BINS; ++k) {
+        EXPECT_NEAR(powers[k], magnitudes[k] * magnitudes[k], 1e-4f * (1 + powers[k])) << "bin " << k;
+    }
+}
+
+TEST(PipelineTests, accumulates_channels_into_one_result) {
+    auto const left  = make_tone(10);
+    auto const right = make_tone(40);
+
+    FftAnalyzer<> analyzer;
+    auto const left_spectrum  = analyzer.analyze(left);
+    auto const right_spectrum = analyzer.analyze(right);
+
+    auto pipeline = make_pipeline<WINDOW_SIZE>(LinearBinning<BINS, 100>{});
+    std::array<float, 100> both;
+    pipeline.clear(both);
+    pipeline.accumulate(left_spectrum, both);
+    pipeline.accumulate(right_spectrum, both);
+
+    std::array<float, 100> left_only;
+    std::array<float, 100> right_only;
+    pipeline.clear(left_only);
+    pipeline.accumulate(left_spectrum, left_only);
+    pipeline.clear(right_only);
+    pipeline.accumulate(right_spectrum, right_only);
+
+    for (std::size_t i = 0; i < both.size(); ++i) {
+        EXPECT_NEAR(both[i], left_only[i] + right_only[i], 1e-3f * (1 + both[i])) << "band " << i;
+    }
+}
+
+TEST(PipelineTests, runs_stages_of_a_kind_in_order) {
+    struct Add {
+        float amount;
+        [[nodiscard]] float bin(std::size_t, float value) const {
+            return value + amount;
+        }
+    };
+    struct Double {
+        [[nodiscard]] float bin(std::size_t, float value) const {
+            return value * 2;
+        }
+    };
+
+    Window const silence{};
+    auto add_first = make_pipeline<WINDOW_SIZE>(Add{1}, Double{});
+    auto add_last  = make_pipeline<WINDOW_SIZE>(Double{}, Add{1});
+
+    std::array<float, BINS> first;
+    std::array<float, BINS> last;
+    add_first.run(silence, first);
+    add_last.run(silence, last);
+    EXPECT_EQ(first[3], 2.0f);
+    EXPECT_EQ(last[3], 1.0f);
+}
+
+TEST(PipelineTests, weighted_detection_runs_as_a_kernel) {
+    // The same weighting, but not one the pipeline knows to hand to a kernel
+    struct Gains {
+        std::array<float, BINS> gains;
+        [[nodiscard]] float bin(std::size_t bin, float value) const {
+            return value * gains[bin];
+        }
+    };
+
+    auto const window  = make_tone(10.5f);
+    auto const weights = make_hann_coefficients<BINS>();
+
+    auto fused  = make_pipeline<WINDOW_SIZE>(hann_windowing<WINDOW_SIZE>(), Power{}, Weighting<BINS>{weights});
+    auto scalar = make_pipeline<WINDOW_SIZE>(hann_windowing<WINDOW_SIZE>(), Power{}, Gains{weights});
+    static_assert(decltype(fused)::USES_KERNEL);
+    static_assert(!decltype(scalar)::USES_KERNEL);
+
+    std::array<float, BINS> expected;
+    std::array<float, BINS> actual;
+    fused.run(window, actual);
+    scalar.run(window, expected);
+    for (std::size_t k = 0; k < BINS; ++k) {
+        EXPECT_NEAR(actual[k], expected[k], 1e-6f * expected[k]) << "bin " << k;
+    }
+}
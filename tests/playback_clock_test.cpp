@@ -0,0 +1,96 @@
+#include <playback_clock.hpp>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+
+using namespace wt;
+using namespace std::chrono_literals;
+
+namespace {
+    // 480 frames at 48kHz, a 10ms period
+    constexpr std::uint32_t SAMPLE_RATE = 48000;
+    constexpr std::uint32_t PERIOD      = 480;
+
+    PlaybackClock::clock::time_point at(std::chrono::microseconds offset) {
+        return PlaybackClock::clock::time_point{1s + offset};
+    }
+} // namespace
+
+TEST(PlaybackClockTests, knows_nothing_before_the_first_tick) {
+    PlaybackClock clock;
+    clock.start(SAMPLE_RATE, 20ms);
+    EXPECT_FALSE(clock.audible_position(at(0us)));
+    EXPECT_FALSE(clock.audible_time(0));
+}
+
+TEST(PlaybackClockTests, frames_are_heard_one_latency_after_their_callback) {
+    PlaybackClock clock;
+    clock.start(SAMPLE_RATE, 20ms);
+    for (std::uint64_t i = 0; i < 10; ++i) {
+        clock.tick(i * PERIOD, PERIOD, at(i * 10ms));
+    }
+
+    // Nothing is heard until the first callback's audio comes out
+    EXPECT_FALSE(clock.audible_position(at(19ms)));
+    EXPECT_EQ(clock.audible_position(at(20ms)), 0);
+    EXPECT_EQ(clock.audible_position(at(55ms)), 48 * 35);
+    EXPECT_EQ(clock.audible_time(PERIOD * 3), at(50ms));
+}
+
+TEST(PlaybackClockTests, stops_at_the_last_frame_handed_over) {
+    PlaybackClock clock;
+    clock.start(SAMPLE_RATE, 20ms);
+    clock.tick(0, PERIOD, at(0us));
+    clock.tick(PERIOD, PERIOD, at(10ms));
+
+    EXPECT_EQ(clock.audible_position(at(1s)), 2 * PERIOD);
+}
+
+TEST(PlaybackClockTests, late_callbacks_barely_move_it) {
+    PlaybackClock clock;
+    clock.start(SAMPLE_RATE, 20ms);
+
+    // Every other callback runs 2ms late, as a busy scheduler would
+    for (std::uint64_t i = 0; i < 200; ++i) {
+        auto const late = i % 2 == 1 ? 2ms : 0ms;
+        clock.tick(i * PERIOD, PERIOD, at(i * 10ms + late));
+    }
+
+    auto const heard = clock.audible_time(0);
+    ASSERT_TRUE(heard);
+    EXPECT_GE(*heard, at(20ms));
+    EXPECT_LT(*heard, at(21ms));
+}
+
+TEST(PlaybackClockTests, follows_an_early_callback_at_once) {
+    PlaybackClock clock;
+    clock.start(SAMPLE_RATE, 20ms);
+    clock.tick(0, PERIOD, at(5ms));
+    clock.tick(PERIOD, PERIOD, at(10ms));
+
+    EXPECT_EQ(clock.audible_time(0), at(20ms));
+}
+
+TEST(PlaybackClockTests, starts_over_after_a_pause) {
+    PlaybackClock clock;
+    clock.start(SAMPLE_RATE, 20ms);
+    clock.tick(0, PERIOD, at(0us));
+    clock.tick(PERIOD, PERIOD, at(10ms));
+
+    // No frames go into the tap while paused, the next ones come a second on
+    clock.tick(2 * PERIOD, PERIOD, at(1s + 20ms));
+    EXPECT_EQ(clock.audible_time(2 * PERIOD), at(1s + 40ms));
+    EXPECT_EQ(clock.audible_position(at(1s + 45ms)), 2 * PERIOD + 240);
+}
+
+TEST(PlaybackClockTests, skips_frames_the_tap_got_but_the_device_did_not) {
+    PlaybackClock clock;
+    clock.start(SAMPLE_RATE, 20ms);
+    clock.tick(0, PERIOD, at(0us));
+
+    // After a seek the tap is handed a window of primer before the audio
+    clock.tick(PERIOD + 2048, PERIOD, at(10ms));
+    EXPECT_EQ(clock.audible_time(PERIOD + 2048), at(30ms));
+}
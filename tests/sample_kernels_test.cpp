@@ -0,0 +1,191 @@
+#include <sample_kernels.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace wt::kernels;
+
+namespace {
+    // Odd length and a one sample offset so every vector width hits an
+    // unaligned start and a scalar tail
+    constexpr std::size_t SAMPLES = 1037;
+    constexpr std::size_t OFFSET  = 1;
+
+    template <typename T>
+    std::vector<T> random_samples(T low, T high) {
+        std::mt19937 engine{42};
+        std::vector<T> ret(SAMPLES + OFFSET);
+        if constexpr (std::is_floating_point_v<T>) {
+            std::uniform_real_distribution<T> dist{low, high};
+            for (auto& sample : ret) {
+                sample = dist(engine);
+            }
+        } else {
+            std::uniform_int_distribution<std::int64_t> dist{low, high};
+            for (auto& sample : ret) {
+                sample = static_cast<T>(dist(engine));
+            }
+        }
+        return ret;
+    }
+
+    std::vector<SampleKernels const*> vector_kernels() {
+        std::vector<SampleKernels const*> ret;
+        for (auto const isa : {InstructionSet::sse2, InstructionSet::avx2, InstructionSet::avx512}) {
+            if (auto const* kernels = kernels_for(isa)) {
+                ret.push_back(kernels);
+            }
+        }
+        return ret;
+    }
+} // namespace
+
+TEST(SampleKernelsTests, scalar_always_available) {
+    ASSERT_NE(kernels_for(InstructionSet::scalar), nullptr);
+    EXPECT_EQ(kernels().instruction_set, detect_instruction_set());
+}
+
+TEST(SampleKernelsTests, s16_to_f32_matches_scalar) {
+    auto const source   = random_samples<std::int16_t>(-32768, 32767);
+    auto const& scalar  = *kernels_for(InstructionSet::scalar);
+    std::vector<float> expected(SAMPLES);
+    scalar.s16_to_f32(expected.data(), source.data() + OFFSET, SAMPLES, 0.5f);
+    EXPECT_FLOAT_EQ(expected[0], source[OFFSET] / 65536.0f);
+
+    for (auto const* kernels : vector_kernels()) {
+        std::vector<float> actual(SAMPLES + OFFSET);
+        kernels->s16_to_f32(actual.data() + OFFSET, source.data() + OFFSET, SAMPLES, 0.5f);
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            ASSERT_EQ(actual[i + OFFSET], expected[i]) << to_string(kernels->instruction_set) << " sample " << i;
+        }
+    }
+}
+
+TEST(SampleKernelsTests, s32_to_f32_matches_scalar) {
+    auto const source = random_samples<std::int32_t>(
+        std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int32_t>::max());
+    auto const& scalar = *kernels_for(InstructionSet::scalar);
+    std::vector<float> expected(SAMPLES);
+    scalar.s32_to_f32(expected.data(), source.data() + OFFSET, SAMPLES, 1.0f);
+
+    for (auto const* kernels : vector_kernels()) {
+        std::vector<float> actual(SAMPLES);
+        kernels->s32_to_f32(actual.data(), source.data() + OFFSET, SAMPLES, 1.0f);
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            ASSERT_EQ(actual[i], expected[i]) << to_string(kernels->instruction_set) << " sample " << i;
+        }
+    }
+}
+
+TEST(SampleKernelsTests, gain_f32_scales_every_sample_in_place) {
+    auto const source  = random_samples<float>(-1.0f, 1.0f);
+    auto const& scalar = *kernels_for(InstructionSet::scalar);
+    std::vector<float> expected(SAMPLES);
+    scalar.gain_f32(expected.data(), source.data() + OFFSET, SAMPLES, 0.25f);
+
+    for (auto const* kernels : vector_kernels()) {
+        auto actual = source;
+        kernels->gain_f32(actual.data() + OFFSET, actual.data() + OFFSET, SAMPLES, 0.25f);
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            ASSERT_EQ(actual[i + OFFSET], expected[i]) << to_string(kernels->instruction_set) << " sample " << i;
+        }
+    }
+}
+
+TEST(SampleKernelsTests, gain_s16_saturates) {
+    auto const source  = random_samples<std::int16_t>(-32768, 32767);
+    auto const& scalar = *kernels_for(InstructionSet::scalar);
+    std::vector<std::int16_t> expected(SAMPLES);
+    scalar.gain_s16(expected.data(), source.data() + OFFSET, SAMPLES, 2.0f);
+
+    std::int16_t const loud = 20000;
+    std::int16_t clipped    = 0;
+    scalar.gain_s16(&clipped, &loud, 1, 2.0f);
+    EXPECT_EQ(clipped, 32767);
+
+    for (auto const* kernels : vector_kernels()) {
+        std::vector<std::int16_t> actual(SAMPLES);
+        kernels->gain_s16(actual.data(), source.data() + OFFSET, SAMPLES, 2.0f);
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            ASSERT_EQ(actual[i], expected[i]) << to_string(kernels->instruction_set) << " sample " << i;
+        }
+    }
+}
+
+TEST(SampleKernelsTests, gain_s32_saturates) {
+    auto const source = random_samples<std::int32_t>(
+        std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int32_t>::max());
+    auto const& scalar = *kernels_for(InstructionSet::scalar);
+    std::vector<std::int32_t> expected(SAMPLES);
+    scalar.gain_s32(expected.data(), source.data() + OFFSET, SAMPLES, 1.5f);
+
+    for (auto const* kernels : vector_kernels()) {
+        std::vector<std::int32_t> actual(SAMPLES);
+        kernels->gain_s32(actual.data(), source.data() + OFFSET, SAMPLES, 1.5f);
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            ASSERT_EQ(actual[i], expected[i]) << to_string(kernels->instruction_set) << " sample " << i;
+        }
+    }
+}
+
+TEST(SampleKernelsTests, deinterleaves_every_layout) {
+    auto const source = random_samples<float>(-1.0f, 1.0f);
+    for (std::uint32_t channels = 1; channels <= 8; ++channels) {
+        std::size_t const frames = SAMPLES / channels;
+
+        for (auto const* kernels : vector_kernels()) {
+            std::vector<std::vector<float>> planes(channels, std::vector<float>(frames));
+            std::vector<float*> destinations;
+            for (auto& plane : planes) {
+                destinations.push_back(plane.data());
+            }
+
+            kernels->deinterleave(destinations.data(), source.data() + OFFSET, frames, channels);
+            for (std::size_t i = 0; i < frames; ++i) {
+                for (std::uint32_t c = 0; c < channels; ++c) {
+                    ASSERT_EQ(planes[c][i], source[OFFSET + i * channels + c])
+                        << to_string(kernels->instruction_set) << " channels " << channels << " frame " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(SampleKernelsTests, mid_side_matches_scalar) {
+    auto const left    = random_samples<float>(-1.0f, 1.0f);
+    auto const right   = random_samples<float>(-0.5f, 0.5f);
+    auto const& scalar = *kernels_for(InstructionSet::scalar);
+    std::vector<float> mid(SAMPLES);
+    std::vector<float> side(SAMPLES);
+    scalar.mid_side(mid.data(), side.data(), left.data() + OFFSET, right.data() + OFFSET, SAMPLES);
+    EXPECT_FLOAT_EQ(mid[0], (left[OFFSET] + right[OFFSET]) / 2);
+    EXPECT_FLOAT_EQ(side[0], (left[OFFSET] - right[OFFSET]) / 2);
+
+    for (auto const* kernels : vector_kernels()) {
+        std::vector<float> actual_mid(SAMPLES);
+        std::vector<float> actual_side(SAMPLES);
+        kernels->mid_side(actual_mid.data(), actual_side.data(), left.data() + OFFSET, right.data() + OFFSET, SAMPLES);
+        EXPECT_EQ(actual_mid, mid) << to_string(kernels->instruction_set);
+        EXPECT_EQ(actual_side, side) << to_string(kernels->instruction_set);
+    }
+}
+
+TEST(SampleKernelsTests, mix_f32_adds_onto_the_destination) {
+    auto const source  = random_samples<float>(-1.0f, 1.0f);
+    auto const mix     = random_samples<float>(-0.5f, 0.5f);
+    auto const& scalar = *kernels_for(InstructionSet::scalar);
+    auto expected      = mix;
+    scalar.mix_f32(expected.data() + OFFSET, source.data() + OFFSET, SAMPLES, 0.5f);
+    EXPECT_FLOAT_EQ(expected[OFFSET], mix[OFFSET] + source[OFFSET] * 0.5f);
+    EXPECT_EQ(expected[0], mix[0]);
+
+    for (auto const* kernels : vector_kernels()) {
+        auto actual = mix;
+        kernels->mix_f32(actual.data() + OFFSET, source.data() + OFFSET, SAMPLES, 0.5f);
+        EXPECT_EQ(actual, expected) << to_string(kernels->instruction_set);
+    }
+}
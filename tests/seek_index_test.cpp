@@ -0,0 +1,152 @@
+#include <seek_index.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace wt;
+
+namespace {
+    // MPEG 1 layer III, 128kbps, 44.1kHz, stereo, no CRC or padding
+    constexpr std::size_t FRAME_BYTES = 417;
+    constexpr std::size_t MAIN_BYTES  = FRAME_BYTES - 4 - 32;
+
+    // Appends a silent frame that borrows `main_data_begin` bytes from the
+    // frames before it
+    void append_frame(std::vector<std::byte>& out, std::uint32_t main_data_begin) {
+        std::size_t const start = out.size();
+        out.resize(start + FRAME_BYTES);
+        out[start]     = std::byte{0xFF};
+        out[start + 1] = std::byte{0xFB};
+        out[start + 2] = std::byte{0x90};
+        out[start + 3] = std::byte{0x00};
+        out[start + 4] = static_cast<std::byte>(main_data_begin >> 1);
+        out[start + 5] = static_cast<std::byte>((main_data_begin & 1) << 7);
+    }
+
+    std::vector<std::byte> make_stream(std::size_t frames, std::uint32_t main_data_begin) {
+        std::vector<std::byte> out;
+        for (std::size_t i = 0; i < frames; ++i) {
+            append_frame(out, i == 0 ? 0 : main_data_begin);
+        }
+        return out;
+    }
+} // namespace
+
+TEST(SeekIndexTests, counts_every_frame) {
+    auto const index = scan_mp3(make_stream(100, 0), 8);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(index->sample_rate, 44100);
+    EXPECT_EQ(index->frames, 100 * 1152);
+    ASSERT_EQ(index->points.size(), 13);
+
+    // Without a reservoir every frame decodes on its own
+    EXPECT_EQ(index->points[1], (SeekPoint{8 * 1152, 8 * FRAME_BYTES}));
+}
+
+TEST(SeekIndexTests, starts_early_enough_to_fill_the_reservoir) {
+    // Each frame borrows more than it holds itself, so decoding has to
+    // start one frame before a point to decode from it
+    auto const index = scan_mp3(make_stream(100, MAIN_BYTES - 50), 8);
+    ASSERT_TRUE(index);
+    ASSERT_EQ(index->points.size(), 13);
+    EXPECT_EQ(index->points[0], (SeekPoint{0, 0}));
+    EXPECT_EQ(index->points[1], (SeekPoint{8 * 1152, 7 * FRAME_BYTES}));
+
+    // A reservoir of more than a frame takes two
+    auto const deep = scan_mp3(make_stream(100, MAIN_BYTES + 50), 8);
+    ASSERT_TRUE(deep);
+    EXPECT_EQ(deep->points[1], (SeekPoint{8 * 1152, 6 * FRAME_BYTES}));
+}
+
+TEST(SeekIndexTests, skips_tags_and_junk) {
+    std::vector<std::byte> bytes{std::byte{'I'}, std::byte{'D'}, std::byte{'3'}, std::byte{4}, std::byte{0},
+        std::byte{0}, std::byte{0}, std::byte{0}, std::byte{1}, std::byte{0}};
+    bytes.resize(bytes.size() + 128 + 37, std::byte{0xFF});
+
+    auto const stream = make_stream(20, 0);
+    bytes.insert(bytes.end(), stream.begin(), stream.end());
+    for (char c : {'T', 'A', 'G'}) {
+        bytes.push_back(static_cast<std::byte>(c));
+    }
+
+    auto const index = scan_mp3(bytes, 8);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(index->frames, 20 * 1152);
+    EXPECT_EQ(index->points[0].byte_offset, 10 + 128 + 37);
+}
+
+TEST(SeekIndexTests, rejects_other_files) {
+    std::vector<std::byte> const noise(4096, std::byte{0x5A});
+    EXPECT_FALSE(scan_mp3(noise));
+}
+
+TEST(SeekIndexTests, finds_the_point_at_or_before) {
+    SeekIndex const index{44100, 10000, {{0, 0}, {1152, 400}, {2304, 800}}};
+    EXPECT_EQ(index.find(0)->frame, 0);
+    EXPECT_EQ(index.find(1151)->frame, 0);
+    EXPECT_EQ(index.find(1152)->frame, 1152);
+    EXPECT_EQ(index.find(9999)->frame, 2304);
+    EXPECT_EQ(SeekIndex{}.find(10), nullptr);
+}
+
+TEST(SeekIndexTests, keeps_the_index_next_to_the_file) {
+    auto const path = (std::filesystem::temp_directory_path() / "seek_index_test.mp3").string();
+    {
+        auto const stream = make_stream(50, 0);
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<char const*>(stream.data()), static_cast<std::streamsize>(stream.size()));
+    }
+    std::filesystem::remove(seek_index_path(path));
+
+    auto const scanned = load_seek_index(path);
+    ASSERT_NE(scanned, nullptr);
+    ASSERT_TRUE(std::filesystem::exists(seek_index_path(path)));
+
+    auto const loaded = read_seek_index(path);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->frames, scanned->frames);
+    EXPECT_EQ(loaded->points, scanned->points);
+
+    // A changed file no longer matches its index
+    {
+        std::ofstream file{path, std::ios::binary | std::ios::app};
+        file.put('x');
+    }
+    EXPECT_FALSE(read_seek_index(path));
+
+    std::filesystem::remove(seek_index_path(path));
+    std::filesystem::remove(path);
+}
+
+TEST(SeekIndexTests, rescans_an_index_shorter_than_its_header_says) {
+    auto const path = (std::filesystem::temp_directory_path() / "seek_index_test_short.mp3").string();
+    {
+        auto const stream = make_stream(50, 0);
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<char const*>(stream.data()), static_cast<std::streamsize>(stream.size()));
+    }
+    std::filesystem::remove(seek_index_path(path));
+    auto const scanned = load_seek_index(path);
+    ASSERT_NE(scanned, nullptr);
+
+    // A point count whose size overflows, after the 40 bytes before it
+    {
+        std::fstream file{seek_index_path(path), std::ios::binary | std::ios::in | std::ios::out};
+        std::uint64_t const points = std::uint64_t{1} << 62;
+        file.seekp(40);
+        file.write(reinterpret_cast<char const*>(&points), sizeof(points));
+    }
+    EXPECT_FALSE(read_seek_index(path));
+
+    auto const rescanned = load_seek_index(path);
+    ASSERT_NE(rescanned, nullptr);
+    EXPECT_EQ(rescanned->points, scanned->points);
+
+    std::filesystem::remove(seek_index_path(path));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,139 @@
+#include <analysis/spectrum_kernels.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+using namespace wt::kernels;
+
+namespace {
+    // Odd length and a one bin offset so every vector width hits an
+    // unaligned start and a scalar tail
+    constexpr std::size_t BINS   = 1037;
+    constexpr std::size_t OFFSET = 1;
+
+    // Coefficients with magnitudes spread over 1e-6 to 1e4, the range of
+    // an FFT of audio
+    std::vector<std::complex<float>> random_coefficients() {
+        std::mt19937 engine{42};
+        std::uniform_real_distribution<float> exponent{-6.0f, 4.0f};
+        std::uniform_real_distribution<float> phase{0.0f, 6.2831853f};
+        std::vector<std::complex<float>> ret(BINS + OFFSET);
+        for (auto& coefficient : ret) {
+            coefficient = std::polar(std::pow(10.0f, exponent(engine)), phase(engine));
+        }
+        return ret;
+    }
+
+    std::vector<float> random_weights() {
+        std::mt19937 engine{7};
+        std::uniform_real_distribution<float> dist{0.0f, 2.0f};
+        std::vector<float> ret(BINS + OFFSET);
+        for (auto& weight : ret) {
+            weight = dist(engine);
+        }
+        return ret;
+    }
+
+    std::vector<SpectrumKernels const*> vector_kernels() {
+        std::vector<SpectrumKernels const*> ret;
+        for (auto const isa : {InstructionSet::sse2, InstructionSet::avx2, InstructionSet::avx512}) {
+            if (auto const* kernels = spectrum_kernels_for(isa)) {
+                ret.push_back(kernels);
+            }
+        }
+        return ret;
+    }
+
+    using Kernel = void (*SpectrumKernels::*)(float*, std::complex<float> const*, float const*, std::size_t);
+
+    // The compiler may fuse a multiply and an add in one build and not in
+    // another, so the implementations agree to rounding rather than bit
+    // for bit
+    void expect_matches_scalar(Kernel kernel, float relative, float absolute) {
+        auto const source  = random_coefficients();
+        auto const weights = random_weights();
+        auto const& scalar = *spectrum_kernels_for(InstructionSet::scalar);
+        std::vector<float> expected(BINS);
+        (scalar.*kernel)(expected.data(), source.data() + OFFSET, weights.data() + OFFSET, BINS);
+
+        for (auto const* kernels : vector_kernels()) {
+            std::vector<float> actual(BINS + OFFSET);
+            (kernels->*kernel)(actual.data() + OFFSET, source.data() + OFFSET, weights.data() + OFFSET, BINS);
+            for (std::size_t k = 0; k < BINS; ++k) {
+                ASSERT_NEAR(actual[k + OFFSET], expected[k], relative * std::abs(expected[k]) + absolute)
+                    << to_string(kernels->instruction_set) << " bin " << k;
+            }
+        }
+    }
+} // namespace
+
+TEST(SpectrumKernelsTests, scalar_always_available) {
+    ASSERT_NE(spectrum_kernels_for(InstructionSet::scalar), nullptr);
+    EXPECT_EQ(spectrum_kernels().instruction_set, detect_instruction_set());
+}
+
+TEST(SpectrumKernelsTests, vectors_match_scalar) {
+    expect_matches_scalar(&SpectrumKernels::magnitude, 1e-6f, 0.0f);
+    expect_matches_scalar(&SpectrumKernels::power, 1e-6f, 0.0f);
+    expect_matches_scalar(&SpectrumKernels::decibels, 0.0f, 5e-5f);
+}
+
+TEST(SpectrumKernelsTests, magnitude_is_within_two_ulp) {
+    auto const source  = random_coefficients();
+    auto const weights = random_weights();
+    std::vector<float> magnitudes(BINS);
+    spectrum_kernels().magnitude(magnitudes.data(), source.data(), weights.data(), BINS);
+
+    for (std::size_t k = 0; k < BINS; ++k) {
+        float const expected = std::abs(source[k]) * weights[k];
+        float const ulp      = std::nextafter(expected, INFINITY) - expected;
+        EXPECT_NEAR(magnitudes[k], expected, 2 * ulp) << "bin " << k;
+    }
+}
+
+TEST(SpectrumKernelsTests, power_is_within_two_ulp) {
+    auto const source  = random_coefficients();
+    auto const weights = random_weights();
+    std::vector<float> powers(BINS);
+    spectrum_kernels().power(powers.data(), source.data(), weights.data(), BINS);
+
+    for (std::size_t k = 0; k < BINS; ++k) {
+        auto const expected = static_cast<float>(std::norm(std::complex<double>{source[k]}) * weights[k]);
+        float const ulp     = std::nextafter(expected, INFINITY) - expected;
+        EXPECT_NEAR(powers[k], expected, 2 * ulp) << "bin " << k;
+    }
+}
+
+TEST(SpectrumKernelsTests, decibels_are_within_the_bound) {
+    auto const source  = random_coefficients();
+    auto const weights = random_weights();
+
+    for (auto const isa :
+        {InstructionSet::scalar, InstructionSet::sse2, InstructionSet::avx2, InstructionSet::avx512}) {
+        auto const* kernels = spectrum_kernels_for(isa);
+        if (kernels == nullptr) {
+            continue;
+        }
+
+        std::vector<float> decibels(BINS);
+        kernels->decibels(decibels.data(), source.data(), weights.data(), BINS);
+        for (std::size_t k = 0; k < BINS; ++k) {
+            double const power = std::max(std::norm(std::complex<double>{source[k]}) * weights[k], 1e-20);
+            EXPECT_NEAR(decibels[k], 10 * std::log10(power), 1e-4) << to_string(isa) << " bin " << k;
+        }
+    }
+}
+
+TEST(SpectrumKernelsTests, silence_is_the_floor) {
+    std::vector<std::complex<float>> const silence(BINS);
+    std::vector<float> const weights(BINS, 1.0f);
+    std::vector<float> decibels(BINS);
+    spectrum_kernels().decibels(decibels.data(), silence.data(), weights.data(), BINS);
+    for (float const value : decibels) {
+        ASSERT_NEAR(value, -200.0f, 1e-3f);
+    }
+}
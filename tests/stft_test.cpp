@@ -0,0 +1,166 @@
+#include <analysis/analysis.hpp>
+#include <analysis/hann_window.hpp>
+#include <analysis/stft.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <numbers>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+using namespace wt::analysis;
+
+namespace {
+    using Window   = std::array<float, WINDOW_SIZE>;
+    using Spectrum = std::array<std::complex<float>, WINDOW_SIZE / 2 + 1>;
+
+    struct Frame {
+        std::uint64_t position;
+        std::vector<Spectrum> spectra;
+    };
+
+    // Interleaved frames with a tone at `bin` on the left channel and at
+    // twice that on the right
+    std::vector<float> make_stereo_tone(std::size_t bin, std::size_t frames) {
+        std::vector<float> ret(frames * 2);
+        for (std::size_t i = 0; i < frames; ++i) {
+            ret[i * 2]     = std::sin(2 * std::numbers::pi_v<float> * bin * i / WINDOW_SIZE);
+            ret[i * 2 + 1] = std::sin(2 * std::numbers::pi_v<float> * bin * 2 * i / WINDOW_SIZE);
+        }
+        return ret;
+    }
+
+    std::vector<Frame> run(Stft& stft, std::span<float const> samples, std::size_t chunk_frames) {
+        std::vector<Frame> frames;
+        auto const chunk = chunk_frames * stft.channels();
+        for (std::size_t i = 0; i < samples.size(); i += chunk) {
+            stft.push(samples.subspan(i, std::min(chunk, samples.size() - i)), [&](StftFrame const& frame) {
+                Frame copy{frame.position, std::vector<Spectrum>(stft.channels())};
+                for (std::size_t c = 0; c < stft.channels(); ++c) {
+                    std::ranges::copy(frame.spectrum(c), copy.spectra[c].begin());
+                }
+                frames.push_back(std::move(copy));
+            });
+        }
+        return frames;
+    }
+} // namespace
+
+TEST(StftTests, frames_start_every_hop) {
+    auto const samples = make_stereo_tone(10, 10000);
+
+    Stft half{2, HALF_OVERLAP};
+    auto const halves = run(half, samples, 10000);
+    ASSERT_EQ(halves.size(), (10000 - WINDOW_SIZE) / HALF_OVERLAP + 1);
+    for (std::size_t i = 0; i < halves.size(); ++i) {
+        EXPECT_EQ(halves[i].position, i * HALF_OVERLAP);
+    }
+
+    Stft quarters{2, THREE_QUARTER_OVERLAP};
+    EXPECT_EQ(run(quarters, samples, 10000).size(), (10000 - WINDOW_SIZE) / THREE_QUARTER_OVERLAP + 1);
+    EXPECT_EQ(quarters.position(), 10000);
+}
+
+TEST(StftTests, frames_do_not_depend_on_the_chunks_pushed) {
+    auto const samples = make_stereo_tone(10, 6000);
+
+    Stft whole{2, THREE_QUARTER_OVERLAP};
+    auto const expected = run(whole, samples, 6000);
+
+    for (std::size_t const chunk : {1, 37, 512, 2048}) {
+        Stft stft{2, THREE_QUARTER_OVERLAP};
+        auto const frames = run(stft, samples, chunk);
+        ASSERT_EQ(frames.size(), expected.size()) << "chunk " << chunk;
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            EXPECT_EQ(frames[i].position, expected[i].position);
+            EXPECT_EQ(frames[i].spectra, expected[i].spectra) << "chunk " << chunk << " frame " << i;
+        }
+    }
+}
+
+TEST(StftTests, matches_the_analyzer_on_each_window) {
+    auto const samples = make_stereo_tone(10, 5000);
+    Stft stft{2, HALF_OVERLAP};
+    auto const frames = run(stft, samples, 100);
+    ASSERT_FALSE(frames.empty());
+
+    auto const hann = make_hann_coefficients<WINDOW_SIZE>();
+    FftAnalyzer<> analyzer;
+    analyzer.set_preprocessor([&](Window& buffer) {
+        for (std::size_t i = 0; i < WINDOW_SIZE; ++i) {
+            buffer[i] *= hann[i];
+        }
+    });
+
+    for (auto const& frame : frames) {
+        for (std::size_t c = 0; c < 2; ++c) {
+            Window window;
+            for (std::size_t i = 0; i < WINDOW_SIZE; ++i) {
+                window[i] = samples[(frame.position + i) * 2 + c];
+            }
+            EXPECT_EQ(frame.spectra[c], analyzer.analyze(window)) << "frame " << frame.position << " channel " << c;
+        }
+    }
+}
+
+TEST(StftTests, keeps_channels_apart) {
+    Stft stft{2, HALF_OVERLAP, std::vector<float>(WINDOW_SIZE, 1.0f)};
+    auto const frames = run(stft, make_stereo_tone(10, WINDOW_SIZE), WINDOW_SIZE);
+    ASSERT_EQ(frames.size(), 1);
+
+    EXPECT_GT(std::abs(frames[0].spectra[0][10]), WINDOW_SIZE / 4);
+    EXPECT_LT(std::abs(frames[0].spectra[0][20]), 1.0f);
+    EXPECT_GT(std::abs(frames[0].spectra[1][20]), WINDOW_SIZE / 4);
+    EXPECT_LT(std::abs(frames[0].spectra[1][10]), 1.0f);
+}
+
+TEST(StftTests, starts_over_after_a_reset) {
+    auto const samples = make_stereo_tone(10, 3000);
+    Stft stft{2, HALF_OVERLAP};
+    auto const first = run(stft, samples, 3000);
+
+    stft.reset();
+    EXPECT_EQ(stft.position(), 0);
+    auto const again = run(stft, samples, 3000);
+    ASSERT_EQ(again.size(), first.size());
+    EXPECT_EQ(again[0].position, 0);
+    EXPECT_EQ(again[0].spectra, first[0].spectra);
+}
+
+TEST(StftTests, takes_the_window_size_at_run_time) {
+    Stft stft{1, 128, 512};
+    EXPECT_EQ(stft.window_size(), 512);
+    EXPECT_EQ(stft.bins(), 257);
+
+    // Bin 8 of 512 is bin 32 of 2048
+    std::vector<float> samples(1024);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = std::sin(2 * std::numbers::pi_v<float> * 32 * i / WINDOW_SIZE);
+    }
+
+    std::size_t frames = 0;
+    stft.push(samples, [&](StftFrame const& frame) {
+        EXPECT_EQ(frame.position, frames * 128);
+        auto const spectrum = frame.spectrum(0);
+        EXPECT_EQ(spectrum.size(), 257);
+        auto const peak = std::ranges::max_element(spectrum, {}, [](auto value) { return std::abs(value); });
+        EXPECT_EQ(peak - spectrum.begin(), 8);
+        ++frames;
+    });
+    EXPECT_EQ(frames, (1024 - 512) / 128 + 1);
+}
+
+TEST(StftTests, overlaps_by_half_of_its_own_window_by_default) {
+    EXPECT_EQ(Stft{2}.hop(), HALF_OVERLAP);
+
+    Stft const small{2, std::nullopt, 512};
+    EXPECT_EQ(small.hop(), half_overlap(512));
+    EXPECT_EQ(small.window_size(), 512);
+}
@@ -0,0 +1,93 @@
+#include <analysis/fft_plan.hpp>
+#include <analysis/hann_window.hpp>
+#include <analysis/window_size.hpp>
+#include <analysis/windows.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <numbers>
+#include <vector>
+
+using namespace wt::analysis;
+
+namespace {
+    // Worked out by the compiler, or this would not build
+    static_assert(WINDOW_TABLE<Hann, 9>.coefficients[0] == 0.0f);
+    static_assert(WINDOW_TABLE<Hann, 9>.coefficients[4] == 1.0f);
+    static_assert(WINDOW_TABLE<Kaiser<>, 9>.coefficients[4] == 1.0f);
+    static_assert(make_hann_coefficients<WINDOW_SIZE>()[0] == 0.0f);
+
+    constexpr std::size_t SIZE = 4096;
+
+    template <typename Window>
+    void expect_gains(double coherent_gain, double enbw, double tolerance) {
+        auto const& table = WINDOW_TABLE<Window, SIZE>;
+        EXPECT_NEAR(table.coherent_gain, coherent_gain, tolerance);
+        EXPECT_NEAR(table.enbw, enbw, tolerance);
+    }
+
+    // The windowed spectrum's largest magnitude over the coherent gain,
+    // for a sine of amplitude one `offset` bins past bin 100
+    template <typename Window>
+    float read_amplitude(double offset) {
+        auto const& table = WINDOW_TABLE<Window, SIZE>;
+        std::vector<float> samples(SIZE);
+        for (std::size_t i = 0; i < SIZE; ++i) {
+            samples[i] = static_cast<float>(std::sin(2 * std::numbers::pi * (100 + offset) * i / SIZE))
+                       * table.coefficients[i];
+        }
+
+        std::vector<std::complex<float>> spectrum(SIZE / 2 + 1);
+        std::vector<std::complex<float>> scratch(SIZE / 2);
+        FftPlan::get(SIZE)->forward(samples.data(), spectrum.data(), scratch.data());
+        float const peak = std::abs(*std::ranges::max_element(spectrum, {}, [](auto v) { return std::abs(v); }));
+        return static_cast<float>(2 * peak / (SIZE * table.coherent_gain));
+    }
+} // namespace
+
+TEST(WindowsTests, match_the_standard_maths) {
+    auto const& hann    = WINDOW_TABLE<Hann, SIZE>.coefficients;
+    auto const& hamming = WINDOW_TABLE<Hamming, SIZE>.coefficients;
+    auto const& kaiser  = WINDOW_TABLE<Kaiser<std::ratio<6>>, SIZE>.coefficients;
+    for (std::size_t i = 0; i < SIZE; ++i) {
+        double const phase = 2 * std::numbers::pi * i / (SIZE - 1);
+        double const x     = 2.0 * i / (SIZE - 1) - 1.0;
+        EXPECT_NEAR(hann[i], 0.5 - 0.5 * std::cos(phase), 1e-7) << i;
+        EXPECT_NEAR(hamming[i], 0.54 - 0.46 * std::cos(phase), 1e-7) << i;
+        EXPECT_NEAR(kaiser[i], std::cyl_bessel_i(0.0, 6 * std::sqrt(1 - x * x)) / std::cyl_bessel_i(0.0, 6.0), 1e-7)
+            << i;
+    }
+}
+
+TEST(WindowsTests, run_time_windows_match_the_tables) {
+    EXPECT_TRUE(std::ranges::equal(make_window<BlackmanHarris>(SIZE), WINDOW_TABLE<BlackmanHarris, SIZE>.coefficients));
+    EXPECT_TRUE(std::ranges::equal(make_window<FlatTop>(SIZE), WINDOW_TABLE<FlatTop, SIZE>.coefficients));
+    EXPECT_TRUE(std::ranges::equal(make_window<Kaiser<>>(SIZE), WINDOW_TABLE<Kaiser<>, SIZE>.coefficients));
+    EXPECT_TRUE(std::ranges::equal(make_hann_coefficients(WINDOW_SIZE), make_hann_coefficients<WINDOW_SIZE>()));
+}
+
+TEST(WindowsTests, tables_are_aligned) {
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(WINDOW_TABLE<Hann, SIZE>.coefficients.data()) % 64, 0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(WINDOW_TABLE<FlatTop, 1025>.coefficients.data()) % 64, 0);
+}
+
+TEST(WindowsTests, have_the_textbook_gains) {
+    expect_gains<Hann>(0.5, 1.5, 1e-3);
+    expect_gains<Hamming>(0.54, 1.363, 1e-3);
+    expect_gains<BlackmanHarris>(0.35875, 2.004, 1e-3);
+    expect_gains<FlatTop>(0.2156, 3.77, 1e-2);
+}
+
+TEST(WindowsTests, flat_top_reads_amplitudes_between_bins) {
+    for (double const offset : {0.0, 0.25, 0.5}) {
+        EXPECT_NEAR(read_amplitude<FlatTop>(offset), 1.0f, 2e-3f) << offset;
+    }
+
+    // Hann loses up to 1.4dB half way between bins
+    EXPECT_NEAR(read_amplitude<Hann>(0.0), 1.0f, 2e-3f);
+    EXPECT_LT(read_amplitude<Hann>(0.5), 0.86f);
+}
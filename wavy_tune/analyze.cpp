@@ -0,0 +1,92 @@
+#include "offline_analysis.hpp"
+
+#include <cxxopts.hpp>
+#include <fmt/base.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace {
+
+    struct ProgramArgs {
+        std::string audio_path;
+        std::string output_path;
+        std::uint32_t hop;
+        std::size_t window_size;
+        unsigned threads;
+    };
+
+    auto parse_program_args(int argc, char** argv) -> std::optional<ProgramArgs> {
+        cxxopts::Options options("WavyAnalyze", "Precomputes the spectrogram of an audio file");
+
+        // clang-format off
+        options.add_options()
+          ("h,help", "Show help")
+          ("a,audio-file", "Audio file", cxxopts::value<std::string>())
+          ("o,output", "Spectrogram output file", cxxopts::value<std::string>())
+          ("s,hop", "Samples between consecutive windows", cxxopts::value<std::uint32_t>()->default_value("1024"))
+          ("w,window", "Samples per window, 512 for low latency up to 8192 for resolution",
+            cxxopts::value<std::size_t>()->default_value("2048"))
+          ("t,threads", "Worker threads, 0 for one per core", cxxopts::value<unsigned>()->default_value("0"));
+        // clang-format on
+
+        auto result = options.parse(argc, argv);
+        if (result.count("help") || !result.count("audio-file") || !result.count("output")) {
+            std::cout << options.help() << std::endl;
+            return std::nullopt;
+        }
+
+        ProgramArgs args;
+        args.audio_path  = result["audio-file"].as<std::string>();
+        args.output_path = result["output"].as<std::string>();
+        args.hop         = std::max<std::uint32_t>(result["hop"].as<std::uint32_t>(), 1);
+        args.window_size = std::max<std::size_t>(result["window"].as<std::size_t>() / 2 * 2, 2);
+        args.threads     = result["threads"].as<unsigned>();
+        if (args.threads == 0) {
+            args.threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        return args;
+    }
+} // namespace
+
+// Runs the analysis pipeline over a whole file with no window and no audio
+// device, as fast as the cores allow
+int main(int argc, char** argv) {
+    auto const args = parse_program_args(argc, argv);
+    if (!args) {
+        return 0;
+    }
+
+    auto const decode_start = std::chrono::steady_clock::now();
+    auto const track        = wt::offline::decode_file(args->audio_path);
+    if (!track) {
+        fmt::println("Could not load audio file: {:s}", args->audio_path);
+        return -1;
+    }
+
+    auto const analysis_start = std::chrono::steady_clock::now();
+    auto const spectrogram    = wt::offline::analyze_track(*track, args->hop, args->threads, args->window_size);
+    auto const analysis_end   = std::chrono::steady_clock::now();
+
+    if (!wt::offline::write_spectrogram(spectrogram, args->output_path)) {
+        fmt::println("Could not write spectrogram: {:s}", args->output_path);
+        return -1;
+    }
+
+    using seconds               = std::chrono::duration<double>;
+    double const decode_time    = seconds{analysis_start - decode_start}.count();
+    double const analysis_time  = seconds{analysis_end - analysis_start}.count();
+    double const track_duration = static_cast<double>(track->samples.size()) / track->sample_rate;
+
+    fmt::println("decoded {:.1f}s of audio in {:.3f}s", track_duration, decode_time);
+    fmt::println("analysed {} windows on {} threads in {:.3f}s: {:.0f} windows/sec, {:.0f}x realtime",
+        spectrogram.windows(), args->threads, analysis_time, spectrogram.windows() / analysis_time,
+        track_duration / analysis_time);
+    return 0;
+}
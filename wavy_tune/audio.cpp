@@ -1,4 +1,9 @@
 #include "audio.hpp"
+#include "mapped_file.hpp"
+#include "mapped_pcm_source.hpp"
+#include "sample_kernels.hpp"
+#include "seek_index.hpp"
+#include "streaming_decoder.hpp"
 
 #include <cstring>
 #include <fmt/base.h>
@@ -11,13 +16,25 @@ extern "C" {
 #include <miniaudio.h>
 }
 
+#include <algorithm>
 #include <array>
+#include <cctype>
+#include <chrono>
 #include <cstdint>
+#include <filesystem>
+#include <future>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <ostream>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
+#include <vector>
 
 template <>
 struct fmt::formatter<ma_format> {
@@ -54,15 +71,111 @@ namespace {
     wt::AudioUserData make_default_user_data(wt::AudioPlayer* parent_instance) {
         // clang-format off
         return wt::AudioUserData{
-          .decoder  = wt::DecoderPtr(new ma_decoder, [](auto* ptr) { ma_decoder_uninit(ptr); }),
-          .buffer   = wt::RingBufferPtr(new ma_pcm_rb, [](auto* ptr) { ma_pcm_rb_uninit(ptr); }),
-          .instance = parent_instance
+          .source     = nullptr,
+          .next       = nullptr,
+          .switch_now = false,
+          .callbacks  = 0,
+          .stats      = {},
+          .clock      = {},
+          .tap        = nullptr,
+          .instance   = parent_instance,
+          .is_playing = false
         };
         // clang-format on
     }
 
+    /// @brief Opens a decoder with `init`, converting to `target` if given.
+    /// Otherwise it keeps the source format, unless that is not one the
+    /// sample kernels handle, in which case it asks for f32.
+    /// @param init initialises a decoder from a config, file or memory.
+    /// @param target the format the decoder has to output, if any.
+    /// @param keep_alive whatever the decoder reads from, released with it.
+    template <typename Init>
+    wt::DecoderPtr open_decoder(
+        Init&& init, std::optional<wt::PcmFormat> const& target, std::shared_ptr<void const> keep_alive = nullptr) {
+        wt::DecoderPtr decoder{new ma_decoder, [keep_alive](ma_decoder* ptr) {
+                                   ma_decoder_uninit(ptr);
+                                   delete ptr;
+                               }};
+
+        if (target) {
+            ma_decoder_config const config =
+                ma_decoder_config_init(target->format, target->channels, target->sample_rate);
+            if (init(&config, decoder.get()) != MA_SUCCESS) {
+                delete decoder.release();
+                return nullptr;
+            }
+            return decoder;
+        }
+
+        if (init(nullptr, decoder.get()) != MA_SUCCESS) {
+            delete decoder.release();
+            return nullptr;
+        }
+
+        // The sample kernels handle s16, s32 and f32, let miniaudio
+        // convert anything else to f32 on the decode thread
+        auto const format = decoder->outputFormat;
+        if (format == ma_format_s16 || format == ma_format_s32 || format == ma_format_f32) {
+            return decoder;
+        }
+
+        ma_decoder_uninit(decoder.get());
+        ma_decoder_config const config = ma_decoder_config_init(ma_format_f32, 0, 0);
+        if (init(&config, decoder.get()) != MA_SUCCESS) {
+            delete decoder.release();
+            return nullptr;
+        }
+        return decoder;
+    }
+
+    std::uint32_t frames_for(std::chrono::milliseconds duration, std::uint32_t sample_rate) {
+        return std::max<std::uint32_t>(
+            static_cast<std::uint32_t>(duration.count() * sample_rate / 1000), wt::WINDOW_SIZE);
+    }
+
+    bool is_mp3(std::string const& file_name) {
+        auto extension = std::filesystem::path{file_name}.extension().string();
+        std::ranges::transform(extension, extension.begin(), [](unsigned char c) { return std::tolower(c); });
+        return extension == ".mp3";
+    }
+
+    /// @brief Streams `decoder` through a FIFO. MP3s have no seek table,
+    /// so they also get an index of the file, built on a background thread
+    /// the first time and kept next to the file after that.
+    std::unique_ptr<wt::AudioSource> make_streaming_source(
+        std::string const& file_name, wt::DecoderPtr decoder, std::uint32_t fifo_frames) {
+        auto source = std::make_unique<wt::StreamingDecoder>(std::move(decoder), fifo_frames);
+        if (!is_mp3(file_name)) {
+            return source;
+        }
+
+        auto reopen = [file_name](std::uint64_t byte_offset, wt::PcmFormat const& format) -> wt::DecoderPtr {
+            auto file = wt::MappedFile::open(file_name);
+            if (!file || byte_offset >= file->bytes().size()) {
+                return nullptr;
+            }
+
+            auto const bytes = file->bytes().subspan(byte_offset);
+            return open_decoder(
+                [&](ma_decoder_config const* config, ma_decoder* ptr) {
+                    // Mid-stream there are no tags to tell what the data is
+                    ma_decoder_config mp3 = *config;
+                    mp3.encodingFormat    = ma_encoding_format_mp3;
+                    return ma_decoder_init_memory(bytes.data(), bytes.size(), &mp3, ptr);
+                },
+                format, file);
+        };
+        source->use_seek_index(std::async(std::launch::async, wt::load_seek_index, file_name).share(), reopen);
+        return source;
+    }
+
     wt::DevicePtr make_default_device() {
-        return wt::DevicePtr{new ma_device, ma_device_uninit};
+        // Zeroed, so that uninitialising a device that never opened is a no-op
+        return wt::DevicePtr{new ma_device{}, [](ma_device* ptr) {
+                                 ma_device_uninit(ptr);
+                                 delete ptr;
+                             }};
     }
 
     wt::DeviceConfigPtr make_default_device_config() {
@@ -75,263 +188,457 @@ namespace {
     }
 
     /**
-     * Multiplies the outpub audio samples by the volume.
+     * Converts the 0-255 volume into a gain for the output samples.
      *
-     * @param device the device
-     * @param output the output buffer pointer
-     * @param n_frames the number of frames
      * @param vol the volume
+     * @return the gain, 1.0 at a volume of 127
      */
-    void multiply_volume(ma_device* device, void* output, ma_uint64 n_frames, std::uint8_t vol) {
-        Expects(output != nullptr);
-        Expects(device != nullptr);
-        Expects(vol <= 255);
-        Expects(vol >= 0);
-
-        // TODO : Go through "frames_read" frames * channel count in "pOutput"
+    float volume_gain(std::uint8_t vol) {
         float constexpr max_volume = 127.0f;
-        float const volume_level   = vol / max_volume;
-
-        // TODO : Change volume by scaling down the values in output (might be int, or float)
-        auto const format = device->playback.format;
-        if (format == ma_format_s32) { // signed 32-bit ints
-            std::int32_t* buffer = static_cast<std::int32_t*>(output);
-            for (ma_uint64 i = 0; i < n_frames * device->playback.channels; ++i) {
-                buffer[i] = static_cast<std::int32_t>(volume_level * buffer[i]);
-            }
-        } else if (format == ma_format_f32) { // signed 32-bit floats
-            float* buffer = static_cast<float*>(output);
-            for (ma_uint64 i = 0; i < n_frames; ++i) {
-                buffer[i] *= volume_level;
-            }
-        }
+        return vol / max_volume;
     }
 
-    void s32_to_f32(void* destination, void* source, std::size_t size) {
-        static_assert(sizeof(ma_float) == sizeof(ma_int32));
-
-        // Running buffer to convert values
-        constexpr std::size_t buffer_size = 512;
-        const auto int_sample_bytes       = ma_get_bytes_per_sample(ma_format_s32);
-        const auto float_sample_bytes     = ma_get_bytes_per_sample(ma_format_f32);
-
-        // calculate how many runs of the buffer we need
-        std::size_t const whole_buffers = size / buffer_size;
-        std::size_t const remaining     = size - (whole_buffers * buffer_size);
-        Expects(remaining < buffer_size);
-
-        std::array<float, buffer_size> buffer{};
-        std::size_t buffer_offset = 0;
-        for (std::size_t i = 0; i < whole_buffers; ++i, buffer_offset += buffer_size) {
-
-            // convert each one of them
-            for (std::size_t j = 0; j < buffer_size; ++j) {
-                buffer[j] = static_cast<ma_int32*>(source)[buffer_offset + j] / 2147483648.0f;
-            }
-            memcpy(static_cast<float*>(destination) + buffer_offset, buffer.data(), buffer_size * int_sample_bytes);
+    /// @brief Marks a device callback as running for as long as it is in
+    /// scope, see `AudioUserData::callbacks`.
+    class CallbackScope {
+    public:
+        explicit CallbackScope(std::atomic<std::uint64_t>& callbacks) : _callbacks{callbacks} {
+            _callbacks.fetch_add(1);
         }
 
-        for (std::size_t j = 0; j < remaining; ++j) {
-            buffer[j] = static_cast<ma_int32*>(source)[buffer_offset + j] / 2147483648.0f;
+        ~CallbackScope() {
+            _callbacks.fetch_add(1);
         }
-        memcpy(static_cast<float*>(destination) + buffer_offset, buffer.data(), remaining * float_sample_bytes);
-    }
-
-    void s16_to_f32(void* destination, void* source, std::size_t size) {
-        // Running buffer to convert values
-        constexpr std::size_t BUFFER_SIZE = 512;
-        constexpr float MAX_VALUE         = std::numeric_limits<std::int16_t>::max();
-        const auto in_sample_bytes        = ma_get_bytes_per_sample(ma_format_s16);
-        const auto out_float_bytes        = ma_get_bytes_per_sample(ma_format_f32);
-
-        // calculate how many runs of the buffer we need
-        std::size_t const whole_buffers = size / BUFFER_SIZE;
-        std::size_t const remaining     = size - (whole_buffers * BUFFER_SIZE);
-        Expects(remaining < BUFFER_SIZE);
 
-        std::array<float, BUFFER_SIZE> buffer{};
-        std::size_t buffer_offset = 0;
-        for (std::size_t i = 0; i < whole_buffers; ++i, buffer_offset += BUFFER_SIZE) {
+        CallbackScope(CallbackScope const&)            = delete;
+        CallbackScope& operator=(CallbackScope const&) = delete;
 
-            // convert each one of them
-            for (std::size_t j = 0; j < BUFFER_SIZE; ++j) {
-                buffer[j] = static_cast<ma_int16*>(source)[buffer_offset + j] / MAX_VALUE;
-            }
-            memcpy(static_cast<float*>(destination) + buffer_offset, buffer.data(), BUFFER_SIZE * in_sample_bytes);
-        }
+    private:
+        std::atomic<std::uint64_t>& _callbacks;
+    };
 
-        for (std::size_t j = 0; j < remaining; ++j) {
-            buffer[j] = static_cast<ma_int16*>(source)[buffer_offset + j] / MAX_VALUE;
-        }
-        memcpy(static_cast<float*>(destination) + buffer_offset, buffer.data(), remaining * out_float_bytes);
-    }
-
-    /// @brief Writes audio data to the buffer. This function converts
+    /// @brief Writes audio data to the analysis tap. This function converts
     /// the input audio format to f32.
-    /// @param ring_buffer the ring buffer to write data to.
+    /// @param tap the history ring to write data to.
     /// @param data the audio data to write.
     /// @param frames the number of frames.
     /// @param input_channels the number of channels.
     /// @param input_format the format of the audio data.
-    [[nodiscard]] bool write_to_buffer(
-        ma_pcm_rb* ring_buffer, void* data, ma_uint32 frames, ma_uint32 input_channels, ma_format input_format) {
-        Expects(ring_buffer != nullptr);
+    /// @param gain scales the samples on the way in.
+    void write_to_tap(wt::HistoryRing& tap, void const* data, ma_uint32 frames, ma_uint32 input_channels,
+        ma_format input_format, float gain = 1.0f) {
         Expects(data != nullptr);
         Expects(frames > 0);
 
         // TODO : This should probably not be an error, but I do not
         // TODO : want to handle this case right now
-        Expects(ring_buffer->channels == input_channels);
-
-        void* destination    = nullptr;
-        ma_uint32 write_size = frames;
+        Expects(tap.channels() == input_channels);
+
+        // Convert straight into the tap's storage, no staging buffer
+        auto const& kernels = wt::kernels::kernels();
+        tap.write_with(frames, [&](float* destination, std::size_t first, std::size_t n_frames) {
+            std::size_t const offset  = first * input_channels;
+            std::size_t const samples = n_frames * input_channels;
+
+            switch (input_format) {
+            case ma_format_f32:
+                if (gain == 1.0f) {
+                    std::memcpy(destination, static_cast<float const*>(data) + offset, samples * sizeof(float));
+                } else {
+                    kernels.gain_f32(destination, static_cast<float const*>(data) + offset, samples, gain);
+                }
+                break;
+            case ma_format_s32:
+                kernels.s32_to_f32(destination, static_cast<std::int32_t const*>(data) + offset, samples, gain);
+                break;
+            case ma_format_s16:
+                kernels.s16_to_f32(destination, static_cast<std::int16_t const*>(data) + offset, samples, gain);
+                break;
+            default:
+                // open_decoder only lets the formats above through
+                Expects(false);
+            }
+        });
+    }
+} // namespace
 
-        ma_result const result = ma_pcm_rb_acquire_write(ring_buffer, &write_size, &destination);
-        Expects(destination != nullptr);
+namespace wt {
 
-        if (result != MA_SUCCESS) {
-            return false;
+    ContextPtr make_context(std::optional<ma_backend> backend) {
+        if (!backend) {
+            return nullptr;
         }
 
-
-        if (write_size == 0) {
-            // Should be something else;
-            return true;
+        ContextPtr context{new ma_context, [](ma_context* ptr) {
+                                   ma_context_uninit(ptr);
+                                   delete ptr;
+                               }};
+        if (ma_context_init(&*backend, 1, nullptr, context.get()) != MA_SUCCESS) {
+            delete context.release();
+            return nullptr;
         }
+        return context;
+    }
 
-        switch (input_format) {
-        case ma_format_s32:
-            s32_to_f32(destination, data, write_size * input_channels);
-            break;
-        case ma_format_s16:
-            s16_to_f32(destination, data, write_size * input_channels);
-            break;
-        case ma_format_f32:
-            memcpy(destination, data, write_size * ma_get_bytes_per_sample(ma_format_f32) * input_channels);
-            break;
-        default:
-            throw std::runtime_error{"writing format {} to pcm_rm is not supported"};
+    std::unique_ptr<AudioSource> open_source(std::string const& file_name, AudioPlayerOptions const& options,
+        std::optional<PcmFormat> target, PcmCache* cache) {
+        // Cached tracks are f32, only a device playing f32 takes them as is
+        std::optional<PcmCacheKey> cache_key;
+        if (cache != nullptr && (!target || target->format == ma_format_f32)) {
+            cache_key = PcmCache::key_for(file_name, target);
+        }
+        if (cache_key) {
+            if (auto source = cache->open(*cache_key, options.decode_ahead)) {
+                return source;
+            }
         }
 
-        return ma_pcm_rb_commit_write(ring_buffer, write_size) == MA_SUCCESS;
-    }
-
-    /// Reads from the F32 buffer into data
-    [[nodiscard]] ma_uint32 read_from_buffer(ma_pcm_rb* buffer, void* data, ma_uint32 frames) {
-        Expects(buffer != nullptr);
-        Expects(buffer->channels > 0);
-        Expects(data != nullptr);
+        // A miss decodes as usual while the cache decodes its own copy on
+        // the side. Ask for f32 here too, so the device opens in the format
+        // the next play of this track comes out of the cache in
+        auto const decode_cached = [&] {
+            if (cache_key) {
+                cache->fill(file_name, *cache_key);
+                target = target.value_or(PcmFormat{ma_format_f32, 0, 0});
+            }
+        };
 
+        if (!options.memory_map) {
+            decode_cached();
+            auto decoder = open_decoder(
+                [&](ma_decoder_config const* config, ma_decoder* ptr) {
+                    return ma_decoder_init_file(file_name.c_str(), config, ptr);
+                },
+                target);
+            if (!decoder) {
+                return nullptr;
+            }
 
-        void* source        = nullptr;
-        ma_uint32 read_size = frames;
-        ma_result result    = ma_pcm_rb_acquire_read(buffer, &read_size, &source);
+            auto const fifo_frames = frames_for(options.decode_ahead, decoder->outputSampleRate);
+            return make_streaming_source(file_name, std::move(decoder), fifo_frames);
+        }
 
-        if (result != MA_SUCCESS) {
-            return 0;
+        auto file = MappedFile::open(file_name);
+        if (!file) {
+            return nullptr;
         }
 
-        if (read_size == 0) {
-            // TODO : Should probably return something else
-            return 0;
+        // Uncompressed samples need no decoding at all, play them in place
+        // as long as the device takes them as they are
+        auto const layout = parse_wav(file->bytes());
+        if (layout && (!target || *target == PcmFormat{layout->format, layout->channels, layout->sample_rate})) {
+            auto const prefetch_frames = frames_for(options.decode_ahead, layout->sample_rate);
+            return std::make_unique<MappedPcmSource>(std::move(file), *layout, prefetch_frames);
         }
 
-        memcpy(data, source, read_size * ma_get_bytes_per_sample(buffer->format) * buffer->channels);
+        // Anything else is still decoded, but from the mapping rather
+        // than through read calls
+        decode_cached();
+        auto const bytes = file->bytes();
+        auto decoder     = open_decoder(
+            [&](ma_decoder_config const* config, ma_decoder* ptr) {
+                return ma_decoder_init_memory(bytes.data(), bytes.size(), config, ptr);
+            },
+            target, file);
+        if (!decoder) {
+            return nullptr;
+        }
 
-        result = ma_pcm_rb_commit_read(buffer, read_size);
-        Expects((result == MA_SUCCESS) || (result == MA_AT_END));
-        return read_size;
+        file->advise_sequential();
+        auto const fifo_frames = frames_for(options.decode_ahead, decoder->outputSampleRate);
+        return make_streaming_source(file_name, std::move(decoder), fifo_frames);
     }
-} // namespace
-
-namespace wt {
 
     /* Static Methods */
     void AudioPlayer::data_callback(ma_device* device, void* output, const void* /* input */, ma_uint32 frame_count) {
         wt::AudioUserData* user_data = (wt::AudioUserData*) device->pUserData;
-        Expects(user_data->decoder);
-        Expects(user_data->buffer);
+        Expects(user_data->tap);
         Expects(user_data->instance != nullptr);
 
         if (user_data == NULL) {
             return;
         }
 
-        // Pausing works by zeroing out the output buffer
+        CallbackScope const scope{user_data->callbacks};
+        auto const started = CallbackStats::clock::now();
+        auto const period  = std::chrono::nanoseconds{1'000'000'000ull * frame_count / device->sampleRate};
+
+        float const gain            = volume_gain(user_data->instance->_volume.load());
+        ma_uint32 const frame_bytes = ma_get_bytes_per_frame(device->playback.format, device->playback.channels);
+
+        // After a seek the tap gets the audio leading up to the new
+        // position first, at the volume it would have played at, so it
+        // holds a whole window from there at once
+        auto const prime_tap = [&](AudioSource& primed) {
+            auto const primer = primed.take_primer();
+            if (!primer.empty()) {
+                write_to_tap(*user_data->tap, primer.data(), static_cast<ma_uint32>(primer.size() / frame_bytes),
+                    device->playback.channels, device->playback.format, gain);
+            }
+        };
+
+        // Pausing works by zeroing out the output buffer. A seek still
+        // lands, so the source refills from there before playback resumes.
         if (!user_data->is_playing) {
-            auto const buffer_size = device->playback.channels * frame_count;
-            memset(output, 0, frame_count * ma_get_bytes_per_frame(device->playback.format, device->playback.channels));
+            if (auto* paused = user_data->source.load()) {
+                paused->take_seek();
+                prime_tap(*paused);
+            }
+            memset(output, 0, frame_count * frame_bytes);
+            user_data->stats.record(started, CallbackStats::clock::now(), period, frame_count, 0, false);
             return;
         }
 
-        ma_uint64 frames_read = 0;
-        ma_decoder_read_pcm_frames(user_data->decoder.get(), output, frame_count, &frames_read);
+        // A track started with play() cuts the current one off right here
+        if (user_data->switch_now.exchange(false)) {
+            if (auto* next = user_data->next.exchange(nullptr)) {
+                user_data->source.store(next);
+            }
+        }
+
+        // Decoding and page faults happen on the source's own thread, here
+        // we only copy out of it, applying the volume on the way. Frames
+        // it could not provide stay silent.
+        AudioSource* source       = user_data->source.load();
+        AudioSource* const primed = source;
+        ma_uint32 frames_read     = 0;
+        while (source != nullptr && frames_read < frame_count) {
+            frames_read += source->read(
+                static_cast<std::uint8_t*>(output) + frames_read * frame_bytes, frame_count - frames_read, gain);
+            if (frames_read == frame_count || !source->finished()) {
+                break;
+            }
+
+            // Gapless: the queued track carries on from the very next frame
+            source = user_data->next.exchange(nullptr);
+            if (source != nullptr) {
+                user_data->source.store(source);
+            }
+        }
+
+        if (primed != nullptr) {
+            prime_tap(*primed);
+        }
 
-        std::uint8_t const volume = user_data->instance->_volume.load();
+        // The clock learns which tap frames this period holds only once
+        // they are in the tap, so it never points readers past them
         if (frames_read > 0) {
-            multiply_volume(device, output, frames_read, volume);
-            write_to_buffer(
-                user_data->buffer.get(), output, frames_read, device->playback.channels, device->playback.format);
+            auto const position = user_data->tap->write_position();
+            write_to_tap(*user_data->tap, output, frames_read, device->playback.channels, device->playback.format);
+            user_data->clock.tick(position, frames_read, started);
         }
+
+        // Falling short is only a problem if the track has not ended
+        bool const underflow = frames_read < frame_count && source != nullptr && !source->finished();
+        user_data->stats.record(started, CallbackStats::clock::now(), period, frame_count, frames_read, underflow);
     }
     /* End Static Methods */
 
-    AudioPlayer::AudioPlayer()
-        : _user_data{make_default_user_data(this)},
+    AudioPlayer::AudioPlayer(AudioPlayerOptions options)
+        : _options{options},
+          _cache{options.cache_directory
+                     ? std::make_unique<PcmCache>(*options.cache_directory, options.cache_budget_bytes)
+                     : nullptr},
+          _user_data{make_default_user_data(this)},
           _device{make_default_device()},
           _device_config{make_default_device_config()},
+          _device_started{false},
           _current_file{""},
-          _volume{50} {}
+          _volume{50},
+          _loading{false},
+          _load_failed{false} {}
+
+    AudioPlayer::~AudioPlayer() {
+        // Stop the loader and the device before the sources they use go
+        if (_loader.joinable()) {
+            _loader.request_stop();
+            _loader.join();
+        }
+        _device.reset();
+    }
 
     bool AudioPlayer::play(std::string const& file_name) {
         Expects(_device);
         Expects(_device_config);
-        Expects(_user_data.decoder);
 
         _current_file = file_name;
 
-        ma_result result = MA_SUCCESS;
-        result           = ma_decoder_init_file(_current_file.c_str(), NULL, _user_data.decoder.get());
-        if (result != MA_SUCCESS) {
+        // The device keeps running across tracks, only the first one opens it
+        if (_device_started) {
+            _load_next(file_name, true);
+            _reclaim();
+            return true;
+        }
+
+        auto source = open_source(_current_file, _options, std::nullopt, _cache.get());
+        if (!source) {
             fmt::println("Could not load audio file: {:s}", _current_file);
             return false;
         }
 
+        return _start_device(std::move(source));
+    }
 
-        _device_config->playback.format   = _user_data.decoder->outputFormat;
-        _device_config->playback.channels = _user_data.decoder->outputChannels;
-        _device_config->sampleRate        = _user_data.decoder->outputSampleRate;
+    bool AudioPlayer::queue(std::string const& file_name) {
+        if (!_device_started) {
+            return play(file_name);
+        }
+
+        _load_next(file_name, false);
+        _reclaim();
+        return true;
+    }
+
+    bool AudioPlayer::has_queued() const {
+        return _loading.load() || _user_data.next.load() != nullptr;
+    }
+
+    bool AudioPlayer::load_failed() const {
+        return _load_failed.load();
+    }
+
+    std::size_t AudioPlayer::source_count() const {
+        std::scoped_lock lock{_sources_mutex};
+        return _sources.size();
+    }
+
+    bool AudioPlayer::_start_device(std::unique_ptr<AudioSource> source) {
+        _device_config->playback.format   = source->format();
+        _device_config->playback.channels = source->channels();
+        _device_config->sampleRate        = source->sample_rate();
         _device_config->dataCallback      = data_callback;
         _device_config->pUserData         = &_user_data;
 
-        // TODO : We probably wanna make sure we only do these things
-        // TODO : once, even if we play a different file
-        result = ma_pcm_rb_init(ma_format_f32, _device_config->playback.channels, wt::WINDOW_SIZE, nullptr, nullptr,
-            _user_data.buffer.get());
-        if (result != MA_SUCCESS) {
-            fmt::println("could not initialize queue");
-            return false;
+        _device_config->periodSizeInFrames = _options.period_frames;
+        _device_config->periods            = _options.periods;
+        _device_config->performanceProfile =
+            _options.low_latency ? ma_performance_profile_low_latency : ma_performance_profile_conservative;
+        _device_config->playback.shareMode = _options.exclusive ? ma_share_mode_exclusive : ma_share_mode_shared;
+
+        // The tap always holds at least one analysis window, whatever the budget
+        std::size_t const history_frames = _options.history.count() * _device_config->sampleRate / 1000;
+        _user_data.tap                   = std::make_unique<HistoryRing>(
+            _device_config->playback.channels, std::max<std::size_t>(history_frames, wt::WINDOW_SIZE));
+
+        // Prime the source before the device asks for its first period
+        source->start();
+        _user_data.source.store(source.get());
+        {
+            std::scoped_lock lock{_sources_mutex};
+            _sources.push_back(std::move(source));
         }
 
-        if (ma_device_init(NULL, _device_config.get(), _device.get()) != MA_SUCCESS) {
-            fmt::println("failed to open playback device");
-            ma_decoder_uninit(_user_data.decoder.get());
-            ma_pcm_rb_uninit(_user_data.buffer.get());
+        auto const fail = [this](std::string_view message) {
+            fmt::println("{:s}", message);
+            _user_data.source.store(nullptr);
+            std::scoped_lock lock{_sources_mutex};
+            _sources.clear();
             return false;
+        };
+
+        _context = make_context(_options.backend);
+        if (_options.backend && !_context) {
+            return fail("failed to open the requested audio backend");
         }
 
+        ma_result result = ma_device_init(_context.get(), _device_config.get(), _device.get());
+        if (result != MA_SUCCESS && _options.exclusive) {
+            // Exclusive mode is often refused when something else is playing
+            fmt::println("exclusive mode refused, falling back to shared mode");
+            _device_config->playback.shareMode = ma_share_mode_shared;
+
+            result = ma_device_init(_context.get(), _device_config.get(), _device.get());
+        }
+        if (result != MA_SUCCESS) {
+            return fail("failed to open playback device");
+        }
+
+        // Audio written by a callback waits behind the whole device buffer
+        auto const& playback      = _device->playback;
+        auto const buffer_frames  = std::uint64_t{playback.internalPeriodSizeInFrames} * playback.internalPeriods;
+        auto const buffer_latency = std::chrono::nanoseconds{
+            1'000'000'000ull * buffer_frames / std::max<std::uint32_t>(playback.internalSampleRate, 1)};
+        _user_data.clock.start(_device->sampleRate,
+            _options.output_latency ? std::chrono::nanoseconds{*_options.output_latency} : buffer_latency);
+
         if (ma_device_start(_device.get()) != MA_SUCCESS) {
-            fmt::println("failed to start playback device");
             ma_device_uninit(_device.get());
-            ma_decoder_uninit(_user_data.decoder.get());
-            ma_pcm_rb_uninit(_user_data.buffer.get());
-            return false;
+            return fail("failed to start playback device");
         }
 
+        _device_started       = true;
         _user_data.is_playing = true;
         return true;
     }
 
+    void AudioPlayer::_load_next(std::string file_name, bool switch_now) {
+        // Every later track is converted to what the device was opened with
+        PcmFormat const device_format{
+            _device_config->playback.format, _device_config->playback.channels, _device_config->sampleRate};
+
+        // Let a load still in flight publish first, the new one replaces it
+        if (_loader.joinable()) {
+            _loader.join();
+        }
+
+        _loading     = true;
+        _load_failed = false;
+        _loader      = std::jthread{[this, device_format, switch_now, file_name = std::move(file_name)] {
+            auto source = open_source(file_name, _options, device_format, _cache.get());
+            if (!source) {
+                fmt::println("Could not load audio file: {:s}", file_name);
+                _load_failed = true;
+                _loading     = false;
+                return;
+            }
+
+            // Published under the lock, so `_reclaim` never sees the source
+            // in `_sources` before it is reachable through `next`
+            source->start();
+            {
+                std::scoped_lock lock{_sources_mutex};
+                _user_data.next.store(source.get());
+                if (switch_now) {
+                    _user_data.switch_now.store(true);
+                }
+                _sources.push_back(std::move(source));
+            }
+            _loading = false;
+        }};
+    }
+
+    void AudioPlayer::_reclaim() {
+        std::scoped_lock lock{_sources_mutex};
+
+        auto const unreachable = [this](AudioSource const* source) {
+            return source != _user_data.source.load() && source != _user_data.next.load();
+        };
+
+        std::vector<AudioSource const*> dropped;
+        for (auto const& source : _sources) {
+            if (unreachable(source.get())) {
+                dropped.push_back(source.get());
+            }
+        }
+        if (dropped.empty()) {
+            return;
+        }
+
+        // A callback that was running during the check may be using a
+        // source it had just taken off `next`, wait for it to return. Any
+        // later callback can only find sources through the pointers.
+        auto const entered = _user_data.callbacks.load();
+        if (entered % 2 == 1) {
+            while (_user_data.callbacks.load() == entered) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+        }
+
+        std::erase_if(_sources, [&](auto const& source) {
+            return std::ranges::find(dropped, source.get()) != dropped.end() && unreachable(source.get());
+        });
+    }
+
     void AudioPlayer::pause() {
         if (_user_data.is_playing) {
             _user_data.is_playing = false;
@@ -344,14 +651,144 @@ namespace wt {
         }
     }
 
-    std::pair<std::array<float, WINDOW_SIZE>, std::size_t> AudioPlayer::current_window() const {
-        std::array<float, WINDOW_SIZE> result = {};
-        // TODO : Need to programatically get the number of channels
-        // TODO : Need to programatically get the format and use that
-        auto const buffer_channels = _user_data.buffer->channels;
-        auto const frames_to_read  = wt::WINDOW_SIZE / buffer_channels;
-        auto const read_size =
-            read_from_buffer(_user_data.buffer.get(), result.data(), frames_to_read) * buffer_channels;
-        return {result, read_size};
+    AudioWindow AudioPlayer::current_window() const {
+        AudioWindow result{.samples = {}, .size = 0, .position = 0};
+        if (!_user_data.tap) {
+            return result;
+        }
+
+        // Only read whole frames, the tail of the window stays zeroed
+        auto const buffer_channels = _user_data.tap->channels();
+        auto const samples_to_read = (wt::WINDOW_SIZE / buffer_channels) * buffer_channels;
+        if (auto const position = _user_data.tap->read_latest(std::span{result.samples.data(), samples_to_read})) {
+            result.size     = samples_to_read;
+            result.position = *position;
+        }
+        return result;
+    }
+
+    void AudioPlayer::current_channel_windows(ChannelWindows& windows) const {
+        read_channel_windows(_user_data.tap.get(), windows);
+    }
+
+    void AudioPlayer::audible_channel_windows(ChannelWindows& windows, PlaybackClock::clock::time_point at) const {
+        windows.channel_count = 0;
+        auto const audible    = _user_data.clock.audible_position(at);
+        if (!_user_data.tap || !audible) {
+            return;
+        }
+
+        // Centred on what is heard, the device only holds so much ahead
+        auto const end = std::min(*audible + WINDOW_SIZE / 2, _user_data.tap->write_position());
+        read_channel_windows(_user_data.tap.get(), windows, end);
+    }
+
+    PlaybackClock const& AudioPlayer::playback_clock() const {
+        return _user_data.clock;
+    }
+
+    void read_channel_windows(HistoryRing const* tap, ChannelWindows& windows, std::optional<std::uint64_t> end) {
+        windows.channel_count = 0;
+        if (!tap || tap->channels() > MAX_CHANNELS) {
+            return;
+        }
+
+        auto const channels = tap->channels();
+        std::array<float, WINDOW_SIZE * MAX_CHANNELS> interleaved;
+        auto const samples = std::span{interleaved.data(), WINDOW_SIZE * channels};
+        if (end) {
+            if (*end < WINDOW_SIZE || !tap->read(*end - WINDOW_SIZE, samples)) {
+                return;
+            }
+            windows.position = *end - WINDOW_SIZE;
+        } else if (auto const position = tap->read_latest(samples)) {
+            windows.position = *position;
+        } else {
+            return;
+        }
+
+        std::array<float*, MAX_CHANNELS> destinations{};
+        for (std::uint32_t c = 0; c < channels; ++c) {
+            destinations[c] = windows.channels[c].data();
+        }
+
+        auto const& kernels = wt::kernels::kernels();
+        kernels.deinterleave(destinations.data(), interleaved.data(), WINDOW_SIZE, channels);
+        if (channels == 2) {
+            kernels.mid_side(windows.mid.data(), windows.side.data(), windows.channels[0].data(),
+                windows.channels[1].data(), WINDOW_SIZE);
+        }
+        windows.channel_count = channels;
+    }
+
+    HistoryRing const* AudioPlayer::tap() const {
+        return _user_data.tap.get();
+    }
+
+    FifoWatermark AudioPlayer::fifo_watermark() const {
+        // Holding the lock keeps the source from being reclaimed under us
+        std::scoped_lock lock{_sources_mutex};
+        auto const* source = _user_data.source.load();
+        if (!source) {
+            return FifoWatermark{};
+        }
+        return source->watermark();
+    }
+
+    void AudioPlayer::reset_fifo_watermark() {
+        std::scoped_lock lock{_sources_mutex};
+        if (auto* source = _user_data.source.load()) {
+            source->reset_watermark();
+        }
+    }
+
+    std::optional<DeviceLatency> AudioPlayer::device_latency() const {
+        if (!_device_started) {
+            return std::nullopt;
+        }
+
+        // The internal figures are what the backend actually runs with
+        auto const& playback       = _device->playback;
+        std::uint32_t const frames = playback.internalPeriodSizeInFrames * playback.internalPeriods;
+        std::uint32_t const rate   = playback.internalSampleRate;
+
+        // clang-format off
+        return DeviceLatency{
+          .period_frames = playback.internalPeriodSizeInFrames,
+          .periods       = playback.internalPeriods,
+          .sample_rate   = rate,
+          .exclusive     = playback.shareMode == ma_share_mode_exclusive,
+          .buffer        = std::chrono::microseconds{1'000'000ull * frames / std::max<std::uint32_t>(rate, 1)}
+        };
+        // clang-format on
+    }
+
+    bool AudioPlayer::seek(std::chrono::milliseconds position) {
+        // Holding the lock keeps the source from being reclaimed under us
+        std::scoped_lock lock{_sources_mutex};
+        auto* const source = _user_data.source.load();
+        if (!source) {
+            return false;
+        }
+
+        auto const milliseconds = static_cast<std::uint64_t>(std::max<std::int64_t>(position.count(), 0));
+        return source->seek(milliseconds * source->sample_rate() / 1000, WINDOW_SIZE);
+    }
+
+    std::optional<std::chrono::milliseconds> AudioPlayer::position() const {
+        std::scoped_lock lock{_sources_mutex};
+        auto const* source = _user_data.source.load();
+        if (!source) {
+            return std::nullopt;
+        }
+        return std::chrono::milliseconds{source->position() * 1000 / source->sample_rate()};
+    }
+
+    CallbackStatsSnapshot AudioPlayer::callback_stats() const {
+        return _user_data.stats.snapshot();
+    }
+
+    void AudioPlayer::reset_callback_stats() {
+        _user_data.stats.reset();
     }
 }; // namespace wt
@@ -1,39 +1,168 @@
 #ifndef AUDIO_H
 #define AUDIO_H
 
+#include "audio_source.hpp"
+#include "callback_stats.hpp"
+#include "history_ring.hpp"
+#include "pcm_cache.hpp"
+#include "playback_clock.hpp"
+
+#include <analysis/window_size.hpp>
+
 #include <array>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
 #include <functional>
 #include <memory>
 #include <miniaudio.h>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 extern "C" {
 struct ma_decoder;
 struct ma_device;
 struct ma_device_config;
-
-typedef struct ma_pcm_rb ma_pcm_rb;
 }
 
 namespace wt {
 
-    static constexpr std::size_t WINDOW_SIZE = 2048;
-
-    template <typename T>
-    using CustomPtr = std::unique_ptr<T, std::function<void(T*)>>;
+    using analysis::WINDOW_SIZE;
+    static constexpr std::size_t MAX_CHANNELS = 8;
 
+    using ContextPtr      = CustomPtr<ma_context>;
     using DeviceConfigPtr = CustomPtr<ma_device_config>;
     using DevicePtr       = CustomPtr<ma_device>;
-    using DecoderPtr      = CustomPtr<ma_decoder>;
-    using RingBufferPtr   = CustomPtr<ma_pcm_rb>;
 
     class AudioPlayer;
 
+    struct AudioPlayerOptions {
+        /// @brief How much played audio the analysis tap remembers. Readers
+        /// lagging further behind the device than this miss frames.
+        std::chrono::milliseconds history{500};
+
+        /// @brief How much audio the decode thread keeps decoded ahead of
+        /// the device.
+        std::chrono::milliseconds decode_ahead{250};
+
+        /// @brief Memory maps the file instead of reading it. Uncompressed
+        /// WAVs then play straight out of the mapping, with no decoder.
+        bool memory_map{false};
+
+        /// @brief Frames per device period, 0 lets the backend pick. Smaller
+        /// periods cut latency but leave the callback less time to run.
+        std::uint32_t period_frames{0};
+
+        /// @brief Periods in the device buffer, 0 lets the backend pick.
+        std::uint32_t periods{0};
+
+        /// @brief Asks the backend for small buffers when the period size is
+        /// left to it, the conservative profile otherwise.
+        bool low_latency{true};
+
+        /// @brief Asks for exclusive use of the device, which skips the
+        /// system mixer where the backend supports it. Falls back to shared
+        /// mode if the device refuses.
+        bool exclusive{false};
+
+        /// @brief Plays through this backend instead of the system's
+        /// default, ma_backend_null plays to nowhere in real time.
+        std::optional<ma_backend> backend;
+
+        /// @brief How long audio takes from the callback to the speaker,
+        /// for the playback clock. Nothing takes the device buffer, which
+        /// leaves out whatever the system or a wireless link adds.
+        std::optional<std::chrono::microseconds> output_latency;
+
+        /// @brief Keeps decoded tracks in this directory, so that playing
+        /// one again maps it instead of decoding it. No cache without one.
+        std::optional<std::filesystem::path> cache_directory;
+
+        /// @brief The most the decoded tracks may take up on disk, the least
+        /// recently played go first.
+        std::uint64_t cache_budget_bytes{std::uint64_t{4} << 30};
+    };
+
+    /// @brief The buffering the device settled on, which may differ from
+    /// what the options asked for.
+    struct DeviceLatency {
+        std::uint32_t period_frames;
+        std::uint32_t periods;
+        std::uint32_t sample_rate;
+        bool exclusive;
+        /// @brief How long audio written by the callback can wait in the
+        /// device buffer before it is played, all periods at the device rate.
+        std::chrono::microseconds buffer;
+    };
+
+    /// @brief Opens the source for `file_name` as the options ask for.
+    /// @param target the format the source has to produce, the device's
+    /// once it is open. Without one the source keeps the file's format.
+    /// @param cache decoded tracks to play from, or to fill on a miss.
+    /// @return the source, or nullptr if the file cannot be played.
+    std::unique_ptr<AudioSource> open_source(std::string const& file_name, AudioPlayerOptions const& options,
+        std::optional<PcmFormat> target, PcmCache* cache);
+
+    /// @brief Opens a context for `backend`, or returns null to use the
+    /// default context miniaudio picks itself.
+    ContextPtr make_context(std::optional<ma_backend> backend);
+
+    /// @brief Interleaved samples from the tap, as many whole frames as fit
+    /// in `WINDOW_SIZE` samples.
+    struct AudioWindow {
+        std::array<float, WINDOW_SIZE> samples;
+        /// @brief How many of `samples` are valid, zero until enough audio
+        /// has been played.
+        std::size_t size;
+        /// @brief The tap position of the first frame.
+        std::uint64_t position;
+    };
+
+    /// @brief `WINDOW_SIZE` frames from the tap, split per channel.
+    struct ChannelWindows {
+        /// @brief How many of `channels` hold samples. Zero until enough
+        /// audio has been played, or for more than `MAX_CHANNELS` channels.
+        std::uint32_t channel_count;
+        /// @brief The tap position of the first frame, which the playback
+        /// clock can tell the time of.
+        std::uint64_t position;
+        std::array<std::array<float, WINDOW_SIZE>, MAX_CHANNELS> channels;
+
+        /// @brief (L + R) / 2 and (L - R) / 2, only filled for stereo.
+        std::array<float, WINDOW_SIZE> mid;
+        std::array<float, WINDOW_SIZE> side;
+    };
+
+    /// @brief Copies `WINDOW_SIZE` frames of `tap` into one window per
+    /// channel, plus mid and side for stereo. Leaves `channel_count` at zero
+    /// if the tap is null, does not hold the frames or has more than
+    /// `MAX_CHANNELS` channels.
+    /// @param end one past the last frame to copy, the most recent frames
+    /// without one.
+    void read_channel_windows(
+        HistoryRing const* tap, ChannelWindows& windows, std::optional<std::uint64_t> end = std::nullopt);
+
+    /// @brief What the device callback works with. The player owns the
+    /// sources, the callback only ever swaps `next` into `source`.
     struct AudioUserData {
-        DecoderPtr decoder;
-        RingBufferPtr buffer;
+        /// @brief The source being played, null until a file is played.
+        std::atomic<AudioSource*> source;
+        /// @brief A primed source that takes over on the frame after
+        /// `source` ends, or straight away if `switch_now` is set.
+        std::atomic<AudioSource*> next;
+        std::atomic_bool switch_now;
+        /// @brief Bumped on entry and exit of the callback, so it is odd
+        /// while a callback runs. Lets the player know when a source the
+        /// callback dropped can no longer be in use.
+        std::atomic<std::uint64_t> callbacks;
+        CallbackStats stats;
+        PlaybackClock clock;
+        std::unique_ptr<HistoryRing> tap;
         AudioPlayer* instance;
         std::atomic_bool is_playing;
     };
@@ -43,19 +172,118 @@ namespace wt {
     public:
         static void data_callback(ma_device* device, void* output, const void* input, std::uint32_t frame_count);
 
-        AudioPlayer();
+        explicit AudioPlayer(AudioPlayerOptions options = {});
+        ~AudioPlayer();
+
+        AudioPlayer(AudioPlayer const&)            = delete;
+        AudioPlayer& operator=(AudioPlayer const&) = delete;
+
+        /// @brief Plays a file. The first call opens the device, later calls
+        /// switch to the new file as soon as it is primed, on the same
+        /// device.
+        /// @return false if the first file or the device could not be
+        /// opened. Later files open in the background, see `load_failed`.
         bool play(std::string const& audio_file);
+
+        /// @brief Opens and primes a file on a background thread, to start
+        /// playing on the frame right after the current one ends. Replaces
+        /// any file queued before. Plays straight away if nothing is playing.
+        bool queue(std::string const& audio_file);
+
+        /// @brief Whether a queued file is still waiting to be played.
+        bool has_queued() const;
+
+        /// @brief Whether the last file given to `play` or `queue` on a
+        /// running device could not be opened, once it is no longer
+        /// loading. Cleared by the next call.
+        bool load_failed() const;
+
+        /// @brief How many sources the player holds: the one playing, one
+        /// queued and any a callback may still be reading. The rest are
+        /// freed by the next `play` or `queue`.
+        std::size_t source_count() const;
+
+        /// @brief Jumps to `position` in the current track. Returns at once,
+        /// the audio from there starts within a period or two. The analysis
+        /// tap gets the window of audio before `position` first, so the
+        /// spectrum is of the new position straight away.
+        /// @return false if nothing is playing.
+        bool seek(std::chrono::milliseconds position);
+
+        /// @brief How far into the current track the device has read, or
+        /// nothing if nothing is playing.
+        std::optional<std::chrono::milliseconds> position() const;
         void pause();
         void unpause();
 
-        std::pair<std::array<float, WINDOW_SIZE>, std::size_t> current_window() const;
+        /// @brief Copies the most recent interleaved samples played, without
+        /// consuming them.
+        AudioWindow current_window() const;
+
+        /// @brief Copies the most recent `WINDOW_SIZE` frames played into one
+        /// window per channel, plus mid and side for stereo, without
+        /// consuming them. Fills the caller's windows as they are large.
+        void current_channel_windows(ChannelWindows& windows) const;
+
+        /// @brief Copies the `WINDOW_SIZE` frames centred on the one heard
+        /// at `at`, or the most recent frames played when the device has not
+        /// got that far ahead. Zero channels until the clock has started.
+        void audible_channel_windows(
+            ChannelWindows& windows, PlaybackClock::clock::time_point at = PlaybackClock::clock::now()) const;
+
+        /// @brief When the frames in the tap are heard.
+        PlaybackClock const& playback_clock() const;
+
+        /// @brief The history of played audio, for readers that want to pick
+        /// their own positions. Null until a file is played.
+        HistoryRing const* tap() const;
+
+        /// @brief Reports how full the playing source's buffer is and how
+        /// often the device found it empty. All zeros until a file is played.
+        FifoWatermark fifo_watermark() const;
+
+        /// @brief Restarts the low watermark and underrun count.
+        void reset_fifo_watermark();
+
+        /// @brief The latency the device negotiated with the backend, or
+        /// nothing until a file is played.
+        std::optional<DeviceLatency> device_latency() const;
+
+        /// @brief Timings and counts recorded by the device callback since
+        /// the device opened or the last reset.
+        CallbackStatsSnapshot callback_stats() const;
+
+        void reset_callback_stats();
 
     private:
+        /// Opens the device in the format of `source` and starts playing it.
+        bool _start_device(std::unique_ptr<AudioSource> source);
+
+        /// Loads `file_name` on the loader thread into `next`.
+        void _load_next(std::string file_name, bool switch_now);
+
+        /// Frees the sources the callback can no longer reach.
+        void _reclaim();
+
+        AudioPlayerOptions _options;
+        std::unique_ptr<PcmCache> _cache;
         AudioUserData _user_data;
+
+        // Every source still alive, the callback only sees raw pointers.
+        // Declared before the device so they outlive its callback.
+        mutable std::mutex _sources_mutex;
+        std::vector<std::unique_ptr<AudioSource>> _sources;
+
+        ContextPtr _context;
         DevicePtr _device;
         DeviceConfigPtr _device_config;
+        bool _device_started;
         std::string _current_file;
         std::atomic_uint8_t _volume;
+
+        std::atomic_bool _loading;
+        std::atomic_bool _load_failed;
+        std::jthread _loader;
     };
 
 } // namespace wt
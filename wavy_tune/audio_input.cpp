@@ -0,0 +1,237 @@
+#include "audio_input.hpp"
+
+#include <fmt/base.h>
+#include <gsl/assert>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace wt {
+
+    /* Static Methods */
+    void CaptureDevice::data_callback(ma_device* device, void* /* output */, const void* input, ma_uint32 frame_count) {
+        auto* capture = static_cast<CaptureDevice*>(device->pUserData);
+        Expects(capture != nullptr);
+
+        auto const started = CallbackStats::clock::now();
+        auto const period  = std::chrono::nanoseconds{1'000'000'000ull * frame_count / device->sampleRate};
+
+        // The frames go straight into the tap, the analysis sees them as
+        // soon as this returns
+        auto* const tap = capture->_tap.load();
+        if (tap != nullptr && input != nullptr) {
+            auto const samples = std::size_t{frame_count} * device->capture.channels;
+            tap->write(std::span{static_cast<float const*>(input), samples});
+        }
+        capture->_stats.record(started, CallbackStats::clock::now(), period, frame_count, frame_count, false);
+    }
+    /* End Static Methods */
+
+    CaptureDevice::CaptureDevice(CaptureOptions options)
+        : _options{options},
+          _tap{nullptr},
+          _device{new ma_device{},
+              [](ma_device* ptr) {
+                  ma_device_uninit(ptr);
+                  delete ptr;
+              }},
+          _device_open{false} {}
+
+    CaptureDevice::~CaptureDevice() {
+        _device.reset();
+    }
+
+    bool CaptureDevice::open() {
+        if (_device_open) {
+            return true;
+        }
+
+        auto const type = _options.mode == CaptureMode::loopback ? ma_device_type_loopback : ma_device_type_capture;
+        ma_device_config config   = ma_device_config_init(type);
+        config.capture.format     = ma_format_f32;
+        config.capture.channels   = _options.channels;
+        config.sampleRate         = _options.sample_rate;
+        config.dataCallback       = data_callback;
+        config.pUserData          = this;
+        config.periodSizeInFrames = _options.period_frames;
+        config.periods            = _options.periods;
+        config.performanceProfile = ma_performance_profile_low_latency;
+
+        _context = make_context(_options.backend);
+        if (_options.backend && !_context) {
+            fmt::println("failed to open the requested audio backend");
+            return false;
+        }
+
+        if (ma_device_init(_context.get(), &config, _device.get()) != MA_SUCCESS) {
+            fmt::println("{:s}", _options.mode == CaptureMode::loopback
+                                     ? "failed to open loopback device, only WASAPI has one"
+                                     : "failed to open capture device");
+            return false;
+        }
+
+        if (_device->capture.channels > MAX_CHANNELS) {
+            fmt::println("capture device has {} channels, at most {} are supported", _device->capture.channels,
+                MAX_CHANNELS);
+            ma_device_uninit(_device.get());
+            return false;
+        }
+
+        _device_open = true;
+        return true;
+    }
+
+    bool CaptureDevice::start(HistoryRing& tap) {
+        Expects(_device_open);
+        Expects(tap.channels() == _device->capture.channels);
+
+        _tap.store(&tap);
+        if (ma_device_start(_device.get()) != MA_SUCCESS) {
+            _tap.store(nullptr);
+            fmt::println("failed to start capture device");
+            return false;
+        }
+        return true;
+    }
+
+    void CaptureDevice::stop() {
+        // Stopping waits for the callback in flight to return
+        if (_device_open) {
+            ma_device_stop(_device.get());
+        }
+        _tap.store(nullptr);
+    }
+
+    PcmFormat CaptureDevice::format() const {
+        Expects(_device_open);
+        return PcmFormat{ma_format_f32, _device->capture.channels, _device->sampleRate};
+    }
+
+    CallbackStatsSnapshot CaptureDevice::callback_stats() const {
+        return _stats.snapshot();
+    }
+
+    std::optional<DeviceLatency> CaptureDevice::device_latency() const {
+        if (!_device_open) {
+            return std::nullopt;
+        }
+
+        auto const& capture        = _device->capture;
+        std::uint32_t const frames = capture.internalPeriodSizeInFrames * capture.internalPeriods;
+        std::uint32_t const rate   = capture.internalSampleRate;
+
+        // clang-format off
+        return DeviceLatency{
+          .period_frames = capture.internalPeriodSizeInFrames,
+          .periods       = capture.internalPeriods,
+          .sample_rate   = rate,
+          .exclusive     = capture.shareMode == ma_share_mode_exclusive,
+          .buffer        = std::chrono::microseconds{1'000'000ull * frames / std::max<std::uint32_t>(rate, 1)}
+        };
+        // clang-format on
+    }
+
+    SyntheticInput::SyntheticInput(PcmFormat format, std::uint32_t period_frames, Generator generate)
+        : _format{format},
+          _period_frames{period_frames},
+          _generate{std::move(generate)} {
+        Expects(_format.format == ma_format_f32);
+        Expects(_format.channels > 0 && _format.channels <= MAX_CHANNELS);
+        Expects(_format.sample_rate > 0);
+        Expects(_period_frames > 0);
+    }
+
+    SyntheticInput::~SyntheticInput() {
+        stop();
+    }
+
+    bool SyntheticInput::open() {
+        return true;
+    }
+
+    bool SyntheticInput::start(HistoryRing& tap) {
+        Expects(tap.channels() == _format.channels);
+        _thread = std::jthread{[this, &tap](std::stop_token const& stop) { _run(stop, tap); }};
+        return true;
+    }
+
+    void SyntheticInput::stop() {
+        if (_thread.joinable()) {
+            _thread.request_stop();
+            _thread.join();
+        }
+    }
+
+    PcmFormat SyntheticInput::format() const {
+        return _format;
+    }
+
+    CallbackStatsSnapshot SyntheticInput::callback_stats() const {
+        return _stats.snapshot();
+    }
+
+    void SyntheticInput::_run(std::stop_token const& stop, HistoryRing& tap) {
+        std::vector<float> period(std::size_t{_period_frames} * _format.channels);
+        auto const length = std::chrono::nanoseconds{1'000'000'000ull * _period_frames / _format.sample_rate};
+
+        // Periods are due at fixed times from the start, like a device
+        // clock, so sleeping late does not make the stream drift
+        std::uint64_t first = 0;
+        auto due            = std::chrono::steady_clock::now() + length;
+        while (!stop.stop_requested()) {
+            std::this_thread::sleep_until(due);
+
+            auto const started = CallbackStats::clock::now();
+            _generate(period, first);
+            tap.write(period);
+            _stats.record(started, CallbackStats::clock::now(), length, _period_frames, _period_frames, false);
+
+            first += _period_frames;
+            due += length;
+        }
+    }
+
+    AudioInput::AudioInput(std::unique_ptr<InputSource> source, std::chrono::milliseconds history)
+        : _history{history},
+          _source{std::move(source)},
+          _started{false} {
+        Expects(_source != nullptr);
+    }
+
+    AudioInput::~AudioInput() {
+        _source->stop();
+    }
+
+    bool AudioInput::start() {
+        if (_started) {
+            return true;
+        }
+        if (!_source->open()) {
+            return false;
+        }
+
+        // The tap always holds at least one analysis window
+        auto const format                = _source->format();
+        std::size_t const history_frames = _history.count() * format.sample_rate / 1000;
+        _tap = std::make_unique<HistoryRing>(format.channels, std::max<std::size_t>(history_frames, WINDOW_SIZE));
+
+        if (!_source->start(*_tap)) {
+            return false;
+        }
+        _started = true;
+        return true;
+    }
+
+    HistoryRing const* AudioInput::tap() const {
+        return _tap.get();
+    }
+
+    void AudioInput::current_channel_windows(ChannelWindows& windows) const {
+        read_channel_windows(_tap.get(), windows);
+    }
+
+    InputSource const& AudioInput::source() const {
+        return *_source;
+    }
+} // namespace wt
@@ -0,0 +1,167 @@
+#ifndef AUDIO_INPUT_H
+#define AUDIO_INPUT_H
+
+#include "audio.hpp"
+#include "audio_source.hpp"
+#include "callback_stats.hpp"
+#include "history_ring.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <miniaudio.h>
+#include <optional>
+#include <span>
+#include <thread>
+
+namespace wt {
+
+    /// @brief Where live audio comes from. It delivers interleaved f32
+    /// frames straight into the analysis tap from its own thread, there is
+    /// no playback path and no buffer in between.
+    class InputSource {
+    public:
+        virtual ~InputSource() = default;
+
+        /// @brief Opens the source, which settles its channels and rate.
+        virtual bool open() = 0;
+
+        /// @brief Starts writing frames into `tap`, which must take the
+        /// source's channel count. The source is the tap's only writer
+        /// until it is stopped.
+        virtual bool start(HistoryRing& tap) = 0;
+
+        /// @brief Stops writing into the tap, returning once the last write
+        /// has finished.
+        virtual void stop() = 0;
+
+        /// @brief Always f32, valid once the source is open.
+        [[nodiscard]] virtual PcmFormat format() const = 0;
+
+        /// @brief Timings of the deliveries since the source started or the
+        /// last reset.
+        [[nodiscard]] virtual CallbackStatsSnapshot callback_stats() const = 0;
+    };
+
+    enum class CaptureMode {
+        /// @brief A microphone or line input.
+        capture,
+        /// @brief Whatever the system is playing, only WASAPI supports it.
+        loopback
+    };
+
+    struct CaptureOptions {
+        CaptureMode mode{CaptureMode::capture};
+
+        /// @brief The channels and rate to capture at, 0 for the device's.
+        std::uint32_t channels{0};
+        std::uint32_t sample_rate{0};
+
+        /// @brief Frames per device period. The tap sees nothing of a period
+        /// until it is over, so small periods mean fresh spectra.
+        std::uint32_t period_frames{128};
+        std::uint32_t periods{2};
+
+        /// @brief Captures through this backend instead of the system's
+        /// default, ma_backend_null captures silence in real time.
+        std::optional<ma_backend> backend;
+    };
+
+    /// @brief Captures from a miniaudio capture or loopback device.
+    class CaptureDevice : public InputSource {
+    public:
+        static void data_callback(ma_device* device, void* output, const void* input, std::uint32_t frame_count);
+
+        explicit CaptureDevice(CaptureOptions options = {});
+        ~CaptureDevice() override;
+
+        CaptureDevice(CaptureDevice const&)            = delete;
+        CaptureDevice& operator=(CaptureDevice const&) = delete;
+
+        bool open() override;
+        bool start(HistoryRing& tap) override;
+        void stop() override;
+
+        [[nodiscard]] PcmFormat format() const override;
+        [[nodiscard]] CallbackStatsSnapshot callback_stats() const override;
+
+        /// @brief The latency the device negotiated, or nothing until it is
+        /// open.
+        [[nodiscard]] std::optional<DeviceLatency> device_latency() const;
+
+    private:
+        CaptureOptions _options;
+        std::atomic<HistoryRing*> _tap;
+        CallbackStats _stats;
+
+        ContextPtr _context;
+        DevicePtr _device;
+        bool _device_open;
+    };
+
+    /// @brief Produces frames from a function in real time on its own
+    /// thread, one period at a time, as a capture device would. For tests
+    /// and for running the analysis without any audio hardware.
+    class SyntheticInput : public InputSource {
+    public:
+        /// @brief Fills `frames` interleaved frames, the first of which is
+        /// frame `first` of the stream.
+        using Generator = std::function<void(std::span<float> frames, std::uint64_t first)>;
+
+        SyntheticInput(PcmFormat format, std::uint32_t period_frames, Generator generate);
+        ~SyntheticInput() override;
+
+        bool open() override;
+        bool start(HistoryRing& tap) override;
+        void stop() override;
+
+        [[nodiscard]] PcmFormat format() const override;
+        [[nodiscard]] CallbackStatsSnapshot callback_stats() const override;
+
+    private:
+        void _run(std::stop_token const& stop, HistoryRing& tap);
+
+        PcmFormat _format;
+        std::uint32_t _period_frames;
+        Generator _generate;
+        CallbackStats _stats;
+        std::jthread _thread;
+    };
+
+    /// @brief Live audio for the analysis: an input source writing into a
+    /// tap that the analysis reads like the player's.
+    class AudioInput {
+    public:
+        /// @param history how much captured audio the tap remembers, at
+        /// least one analysis window.
+        explicit AudioInput(
+            std::unique_ptr<InputSource> source, std::chrono::milliseconds history = std::chrono::milliseconds{500});
+        ~AudioInput();
+
+        AudioInput(AudioInput const&)            = delete;
+        AudioInput& operator=(AudioInput const&) = delete;
+
+        /// @brief Opens and starts the source.
+        bool start();
+
+        /// @brief The history of captured audio. Null until started.
+        HistoryRing const* tap() const;
+
+        /// @brief Copies the most recent `WINDOW_SIZE` frames captured into
+        /// one window per channel, see `AudioPlayer::current_channel_windows`.
+        void current_channel_windows(ChannelWindows& windows) const;
+
+        [[nodiscard]] InputSource const& source() const;
+
+    private:
+        std::chrono::milliseconds _history;
+        std::unique_ptr<HistoryRing> _tap;
+        // Declared after the tap, so it stops writing before the tap goes
+        std::unique_ptr<InputSource> _source;
+        bool _started;
+    };
+} // namespace wt
+
+#endif // AUDIO_INPUT_H
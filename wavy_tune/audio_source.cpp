@@ -0,0 +1,25 @@
+#include "audio_source.hpp"
+#include "sample_kernels.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace wt {
+
+    void copy_with_gain(ma_format format, void* dst, void const* src, std::size_t samples, float gain) {
+        auto const& kernels = wt::kernels::kernels();
+        switch (format) {
+        case ma_format_f32:
+            kernels.gain_f32(static_cast<float*>(dst), static_cast<float const*>(src), samples, gain);
+            break;
+        case ma_format_s32:
+            kernels.gain_s32(static_cast<std::int32_t*>(dst), static_cast<std::int32_t const*>(src), samples, gain);
+            break;
+        case ma_format_s16:
+            kernels.gain_s16(static_cast<std::int16_t*>(dst), static_cast<std::int16_t const*>(src), samples, gain);
+            break;
+        default:
+            std::memcpy(dst, src, samples * ma_get_bytes_per_sample(format));
+        }
+    }
+} // namespace wt
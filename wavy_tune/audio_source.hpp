@@ -0,0 +1,93 @@
+#ifndef AUDIO_SOURCE_H
+#define AUDIO_SOURCE_H
+
+#include <miniaudio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+
+namespace wt {
+
+    template <typename T>
+    using CustomPtr = std::unique_ptr<T, std::function<void(T*)>>;
+
+    using DecoderPtr    = CustomPtr<ma_decoder>;
+    using RingBufferPtr = CustomPtr<ma_pcm_rb>;
+
+    /// @brief Fill level and health of the audio buffered ahead of the
+    /// device, in frames.
+    struct FifoWatermark {
+        std::size_t capacity_frames;
+        std::size_t fill_frames;
+        /// @brief Lowest fill the device saw since the last reset.
+        std::size_t low_watermark_frames;
+        /// @brief Device reads that found the buffer short of frames before
+        /// the source reached the end of the file.
+        std::uint64_t underruns;
+    };
+
+    /// @brief The sample format, channel count and rate of a PCM stream.
+    struct PcmFormat {
+        ma_format format;
+        std::uint32_t channels;
+        std::uint32_t sample_rate;
+
+        bool operator==(PcmFormat const&) const = default;
+    };
+
+    /// @brief Where the device callback pulls its PCM frames from. `read`
+    /// runs on the device thread and must never block, allocate or do I/O.
+    class AudioSource {
+    public:
+        virtual ~AudioSource() = default;
+
+        /// @brief Gets the source ready ahead of the first `read`, called
+        /// before the device starts.
+        virtual void start() = 0;
+
+        /// @brief Copies up to `frames` frames into `output`, scaling them
+        /// by `gain` in the same pass.
+        /// @return the number of frames copied.
+        virtual std::uint32_t read(void* output, std::uint32_t frames, float gain) = 0;
+
+        /// @brief Whether every frame of the source has been read.
+        [[nodiscard]] virtual bool finished() const = 0;
+
+        /// @brief Moves the source to frame `frame`. Returns at once, reads
+        /// carry on from the old position until the new one is ready.
+        /// @param primer_frames how many frames before `frame` to hand to
+        /// the device thread through `take_primer`.
+        /// @return false if the source cannot seek.
+        virtual bool seek(std::uint64_t frame, std::uint32_t primer_frames) = 0;
+
+        /// @brief Moves on to where the last seek landed once it is ready,
+        /// without reading, as `read` does first. A paused device calls it
+        /// so the source refills from the new position before playback
+        /// resumes. Only call this from the device thread.
+        virtual void take_seek() = 0;
+
+        /// @brief The frames just before where the last seek landed, in the
+        /// source's format, once reads have got there. Each seek's primer is
+        /// handed out once. Only call this from the device thread.
+        virtual std::span<std::byte const> take_primer() = 0;
+
+        /// @brief The frame the next read starts at.
+        [[nodiscard]] virtual std::uint64_t position() const = 0;
+
+        [[nodiscard]] virtual FifoWatermark watermark() const = 0;
+        virtual void reset_watermark() = 0;
+
+        [[nodiscard]] virtual ma_format format() const = 0;
+        [[nodiscard]] virtual std::uint32_t channels() const = 0;
+        [[nodiscard]] virtual std::uint32_t sample_rate() const = 0;
+    };
+
+    /// @brief Copies `samples` samples of `format` from `src` to `dst`,
+    /// scaling them by `gain`, with the vectorised sample kernels.
+    void copy_with_gain(ma_format format, void* dst, void const* src, std::size_t samples, float gain);
+} // namespace wt
+
+#endif // AUDIO_SOURCE_H
@@ -0,0 +1,140 @@
+#include "callback_stats.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+    static_assert(std::atomic<std::int64_t>::is_always_lock_free);
+
+    // A read-modify-write rather than a load and a store, so a reset from
+    // another thread in between is never overwritten with the old count.
+    // Uncontended, it costs about the same.
+    void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+} // namespace
+
+namespace wt {
+
+    std::size_t LatencyHistogram::bucket_of(std::chrono::nanoseconds duration) {
+        auto const micros = static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count() / 1000, 0));
+        return std::min<std::size_t>(std::bit_width(micros), BUCKETS - 1);
+    }
+
+    std::chrono::microseconds LatencyHistogram::upper_bound(std::size_t bucket) {
+        Expects(bucket < BUCKETS);
+        return std::chrono::microseconds{std::int64_t{1} << std::min(bucket, BUCKETS - 2)};
+    }
+
+    std::uint64_t LatencyHistogram::total() const {
+        std::uint64_t ret = 0;
+        for (auto const count : counts) {
+            ret += count;
+        }
+        return ret;
+    }
+
+    std::chrono::nanoseconds LatencyHistogram::quantile(double quantile) const {
+        Expects(quantile >= 0.0 && quantile <= 1.0);
+
+        std::uint64_t const recorded = total();
+        if (recorded == 0) {
+            return std::chrono::nanoseconds{0};
+        }
+
+        // The smallest bucket that covers at least this many durations
+        auto const wanted  = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(quantile * recorded)), 1);
+        std::uint64_t seen = 0;
+        for (std::size_t bucket = 0; bucket < BUCKETS - 1; ++bucket) {
+            seen += counts[bucket];
+            if (seen >= wanted) {
+                return std::min<std::chrono::nanoseconds>(upper_bound(bucket), max);
+            }
+        }
+        return max;
+    }
+
+    void CallbackStats::AtomicHistogram::record(std::chrono::nanoseconds duration) {
+        add(_counts[LatencyHistogram::bucket_of(duration)], 1);
+
+        auto max = _max_ns.load(std::memory_order_relaxed);
+        while (duration.count() > max
+               && !_max_ns.compare_exchange_weak(max, duration.count(), std::memory_order_relaxed)) {
+        }
+    }
+
+    LatencyHistogram CallbackStats::AtomicHistogram::snapshot() const {
+        LatencyHistogram ret{};
+        for (std::size_t bucket = 0; bucket < LatencyHistogram::BUCKETS; ++bucket) {
+            ret.counts[bucket] = _counts[bucket].load(std::memory_order_relaxed);
+        }
+        ret.max = std::chrono::nanoseconds{_max_ns.load(std::memory_order_relaxed)};
+        return ret;
+    }
+
+    void CallbackStats::AtomicHistogram::reset() {
+        for (auto& count : _counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        _max_ns.store(0, std::memory_order_relaxed);
+    }
+
+    CallbackStats::CallbackStats()
+        : _callbacks{0},
+          _frames_requested{0},
+          _frames_delivered{0},
+          _underflows{0},
+          _budget_overruns{0},
+          _last_start{0} {}
+
+    void CallbackStats::record(clock::time_point start, clock::time_point end, std::chrono::nanoseconds period,
+        std::uint32_t frames_requested, std::uint32_t frames_delivered, bool underflow) {
+        auto const duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+
+        add(_callbacks, 1);
+        add(_frames_requested, frames_requested);
+        add(_frames_delivered, frames_delivered);
+        add(_underflows, underflow ? 1 : 0);
+        add(_budget_overruns, duration > period ? 1 : 0);
+        _duration.record(duration);
+
+        // Callbacks should start one period apart, anything else is jitter
+        auto const last_start = _last_start.exchange(start.time_since_epoch().count(), std::memory_order_relaxed);
+        if (last_start != 0) {
+            auto const interval = start - clock::time_point{clock::duration{last_start}};
+            _jitter.record(std::chrono::abs(std::chrono::duration_cast<std::chrono::nanoseconds>(interval) - period));
+        }
+    }
+
+    CallbackStatsSnapshot CallbackStats::snapshot() const {
+        // clang-format off
+        return CallbackStatsSnapshot{
+          .callbacks        = _callbacks.load(std::memory_order_relaxed),
+          .frames_requested = _frames_requested.load(std::memory_order_relaxed),
+          .frames_delivered = _frames_delivered.load(std::memory_order_relaxed),
+          .underflows       = _underflows.load(std::memory_order_relaxed),
+          .budget_overruns  = _budget_overruns.load(std::memory_order_relaxed),
+          .duration         = _duration.snapshot(),
+          .jitter           = _jitter.snapshot()
+        };
+        // clang-format on
+    }
+
+    void CallbackStats::reset() {
+        _callbacks.store(0, std::memory_order_relaxed);
+        _frames_requested.store(0, std::memory_order_relaxed);
+        _frames_delivered.store(0, std::memory_order_relaxed);
+        _underflows.store(0, std::memory_order_relaxed);
+        _budget_overruns.store(0, std::memory_order_relaxed);
+        _duration.reset();
+        _jitter.reset();
+        _last_start.store(0, std::memory_order_relaxed);
+    }
+} // namespace wt
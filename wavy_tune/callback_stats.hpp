@@ -0,0 +1,107 @@
+#ifndef CALLBACK_STATS_H
+#define CALLBACK_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace wt {
+
+    /// @brief Counts of durations in fixed, power of two buckets. Bucket 0
+    /// holds everything under 1us, bucket i >= 1 holds [2^(i-1), 2^i) us
+    /// and the last bucket everything longer.
+    struct LatencyHistogram {
+        static constexpr std::size_t BUCKETS = 20;
+
+        std::array<std::uint64_t, BUCKETS> counts;
+        std::chrono::nanoseconds max;
+
+        /// @brief The bucket a duration is counted in.
+        static std::size_t bucket_of(std::chrono::nanoseconds duration);
+
+        /// @brief The exclusive upper bound of a bucket, that of the bucket
+        /// before it for the unbounded last one.
+        static std::chrono::microseconds upper_bound(std::size_t bucket);
+
+        [[nodiscard]] std::uint64_t total() const;
+
+        /// @brief An upper bound on the `quantile` (0 to 1) of the recorded
+        /// durations, the bound of the bucket it falls in, or the maximum if
+        /// it falls in the last bucket. Zero if nothing was recorded.
+        [[nodiscard]] std::chrono::nanoseconds quantile(double quantile) const;
+    };
+
+    /// @brief What the device callbacks did since the last reset.
+    struct CallbackStatsSnapshot {
+        std::uint64_t callbacks;
+        std::uint64_t frames_requested;
+        /// @brief Frames the sources delivered, the rest played as silence.
+        std::uint64_t frames_delivered;
+        /// @brief Callbacks the source left short of frames before the end
+        /// of its track, the old ring buffer underflow.
+        std::uint64_t underflows;
+        /// @brief Callbacks that took longer than the audio they produced
+        /// lasts, which the device cannot keep up with for long.
+        std::uint64_t budget_overruns;
+        /// @brief How long the callbacks ran.
+        LatencyHistogram duration;
+        /// @brief How far the time between callbacks strayed from the
+        /// length of a period.
+        LatencyHistogram jitter;
+    };
+
+    /// @brief Lock-free statistics the device callback records into and any
+    /// thread can snapshot. Only one thread may record at a time.
+    class CallbackStats {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        CallbackStats();
+
+        CallbackStats(CallbackStats const&)            = delete;
+        CallbackStats& operator=(CallbackStats const&) = delete;
+
+        /// @brief Records one callback. Never blocks or allocates.
+        /// @param start when the callback started.
+        /// @param end when it finished.
+        /// @param period how long the audio it was asked for lasts.
+        /// @param frames_requested the frames the device asked for.
+        /// @param frames_delivered the frames the source provided.
+        /// @param underflow whether the source ran short before its end.
+        void record(clock::time_point start, clock::time_point end, std::chrono::nanoseconds period,
+            std::uint32_t frames_requested, std::uint32_t frames_delivered, bool underflow);
+
+        [[nodiscard]] CallbackStatsSnapshot snapshot() const;
+
+        /// @brief Zeroes everything. Callbacks racing with it may land on
+        /// either side of the reset, but never undo it.
+        void reset();
+
+    private:
+        class AtomicHistogram {
+        public:
+            void record(std::chrono::nanoseconds duration);
+            [[nodiscard]] LatencyHistogram snapshot() const;
+            void reset();
+
+        private:
+            std::array<std::atomic<std::uint64_t>, LatencyHistogram::BUCKETS> _counts{};
+            std::atomic<std::int64_t> _max_ns{0};
+        };
+
+        std::atomic<std::uint64_t> _callbacks;
+        std::atomic<std::uint64_t> _frames_requested;
+        std::atomic<std::uint64_t> _frames_delivered;
+        std::atomic<std::uint64_t> _underflows;
+        std::atomic<std::uint64_t> _budget_overruns;
+        AtomicHistogram _duration;
+        AtomicHistogram _jitter;
+
+        // Start of the previous callback, zero when there is none
+        std::atomic<clock::rep> _last_start;
+    };
+} // namespace wt
+
+#endif // CALLBACK_STATS_H
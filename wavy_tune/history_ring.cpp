@@ -0,0 +1,117 @@
+#include "history_ring.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+
+namespace {
+    // A reader only retries when the producer laps it mid-copy, which
+    // means it asked for nearly the whole ring. Give up rather than spin.
+    constexpr int MAX_LATEST_ATTEMPTS = 4;
+} // namespace
+
+namespace wt {
+
+    HistoryRing::HistoryRing(std::uint32_t channels, std::size_t min_capacity_frames)
+        : _channels{channels},
+          _capacity{std::bit_ceil(std::max<std::size_t>(min_capacity_frames, 1))},
+          _mask{_capacity - 1},
+          _samples{new float[_capacity * channels]{}},
+          _published{0},
+          _reserved{0} {
+        Expects(channels > 0);
+    }
+
+    void HistoryRing::write(std::span<float const> frames) {
+        Expects(frames.size() % _channels == 0);
+
+        write_with(frames.size() / _channels, [&](float* destination, std::size_t first, std::size_t n_frames) {
+            std::memcpy(destination, frames.data() + first * _channels, n_frames * _channels * sizeof(float));
+        });
+    }
+
+    bool HistoryRing::read(std::uint64_t position, std::span<float> out) const {
+        Expects(out.size() % _channels == 0);
+
+        std::size_t const n_frames = out.size() / _channels;
+        if (n_frames > _capacity) {
+            return false;
+        }
+
+        std::uint64_t const published = _published.load(std::memory_order_acquire);
+        if (position + n_frames > published) {
+            return false;
+        }
+
+        _copy_out(position, out.data(), n_frames);
+
+        // If the producer may have started overwriting the oldest frame we
+        // copied, the copy could be torn and has to be thrown away
+        std::atomic_thread_fence(std::memory_order_acquire);
+        std::uint64_t const reserved = _reserved.load(std::memory_order_relaxed);
+        return reserved <= position + _capacity;
+    }
+
+    std::optional<std::uint64_t> HistoryRing::read_latest(std::span<float> out) const {
+        Expects(out.size() % _channels == 0);
+
+        std::size_t const n_frames = out.size() / _channels;
+        for (int attempt = 0; attempt < MAX_LATEST_ATTEMPTS; ++attempt) {
+            std::uint64_t const published = _published.load(std::memory_order_acquire);
+            if (published < n_frames) {
+                return std::nullopt;
+            }
+
+            std::uint64_t const position = published - n_frames;
+            if (read(position, out)) {
+                return position;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::uint64_t HistoryRing::write_position() const {
+        return _published.load(std::memory_order_acquire);
+    }
+
+    std::uint64_t HistoryRing::oldest_position() const {
+        std::uint64_t const reserved = _reserved.load(std::memory_order_acquire);
+        return reserved > _capacity ? reserved - _capacity : 0;
+    }
+
+    std::uint32_t HistoryRing::channels() const {
+        return _channels;
+    }
+
+    std::size_t HistoryRing::capacity() const {
+        return _capacity;
+    }
+
+    std::pair<std::uint64_t, std::size_t> HistoryRing::_reserve(std::size_t n_frames) {
+        // Only the newest `_capacity` frames can survive the write
+        std::size_t const skipped = n_frames > _capacity ? n_frames - _capacity : 0;
+        std::uint64_t const start = _published.load(std::memory_order_relaxed) + skipped;
+
+        // Announce the overwrite before touching the samples, readers
+        // check `_reserved` after copying to detect that they raced us
+        _reserved.store(start + (n_frames - skipped), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        return {start, skipped};
+    }
+
+    void HistoryRing::_copy_out(std::uint64_t position, float* out, std::size_t n_frames) const {
+        std::size_t const first_slot  = position & _mask;
+        std::size_t const first_chunk = std::min(n_frames, _capacity - first_slot);
+        std::memcpy(out, _samples.get() + first_slot * _channels, first_chunk * _channels * sizeof(float));
+        std::memcpy(
+            out + first_chunk * _channels, _samples.get(), (n_frames - first_chunk) * _channels * sizeof(float));
+    }
+} // namespace wt
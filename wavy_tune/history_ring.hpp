@@ -0,0 +1,104 @@
+#ifndef HISTORY_RING_H
+#define HISTORY_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace wt {
+
+    /// @brief Single-producer, multi-reader history of interleaved f32 frames.
+    ///
+    /// The producer (the device callback) appends frames and never waits for
+    /// readers. Every frame gets an absolute position, starting at zero, and
+    /// readers copy any range that is still held in the ring without consuming
+    /// it, so any number of readers can look at the same audio. A read that
+    /// races with the producer overwriting its range is detected and fails
+    /// rather than returning torn data.
+    class HistoryRing {
+    public:
+        /// @brief Creates a ring holding at least `min_capacity_frames` frames.
+        /// The capacity is rounded up to a power of two.
+        /// @param channels number of interleaved channels per frame.
+        /// @param min_capacity_frames the minimum history to keep, in frames.
+        HistoryRing(std::uint32_t channels, std::size_t min_capacity_frames);
+
+        HistoryRing(HistoryRing const&)            = delete;
+        HistoryRing& operator=(HistoryRing const&) = delete;
+
+        /// @brief Appends interleaved frames. Must only be called from the
+        /// producer thread. Writing more than the capacity keeps the tail.
+        /// @param frames the interleaved samples, a whole number of frames.
+        void write(std::span<float const> frames);
+
+        /// @brief Appends `n_frames` frames produced in place by `fill`,
+        /// which is called with the destination, the index of the first
+        /// frame it should produce and how many frames, once or twice when
+        /// the write wraps. Must only be called from the producer thread.
+        template <typename Fill>
+        void write_with(std::size_t n_frames, Fill&& fill);
+
+        /// @brief Copies the frames starting at `position` into `out`.
+        /// @param position absolute position of the first frame to read.
+        /// @param out destination, its size must be a whole number of frames.
+        /// @return false if the range was not written yet or was overwritten.
+        [[nodiscard]] bool read(std::uint64_t position, std::span<float> out) const;
+
+        /// @brief Copies the most recent frames into `out`.
+        /// @param out destination, its size must be a whole number of frames.
+        /// @return the position of the first frame copied, or nothing when the
+        /// ring does not hold enough frames yet.
+        [[nodiscard]] std::optional<std::uint64_t> read_latest(std::span<float> out) const;
+
+        /// @brief Position one past the newest published frame.
+        [[nodiscard]] std::uint64_t write_position() const;
+
+        /// @brief Position of the oldest frame that can still be read.
+        [[nodiscard]] std::uint64_t oldest_position() const;
+
+        [[nodiscard]] std::uint32_t channels() const;
+        [[nodiscard]] std::size_t capacity() const;
+
+    private:
+        // Returns the first position to write and how many leading frames
+        // of the write will not fit, after announcing the overwrite
+        std::pair<std::uint64_t, std::size_t> _reserve(std::size_t n_frames);
+        void _copy_out(std::uint64_t position, float* out, std::size_t n_frames) const;
+
+        std::uint32_t _channels;
+        std::size_t _capacity;
+        std::size_t _mask;
+        std::unique_ptr<float[]> _samples;
+
+        // Frames below `_published` are readable, frames below `_reserved`
+        // may be in the middle of being overwritten by the producer.
+        alignas(64) std::atomic<std::uint64_t> _published;
+        alignas(64) std::atomic<std::uint64_t> _reserved;
+    };
+
+    template <typename Fill>
+    void HistoryRing::write_with(std::size_t n_frames, Fill&& fill) {
+        if (n_frames == 0) {
+            return;
+        }
+
+        auto const [start, skipped]   = _reserve(n_frames);
+        std::size_t const to_write    = n_frames - skipped;
+        std::size_t const first_slot  = start & _mask;
+        std::size_t const first_chunk = std::min(to_write, _capacity - first_slot);
+
+        fill(_samples.get() + first_slot * _channels, skipped, first_chunk);
+        if (first_chunk < to_write) {
+            fill(_samples.get(), skipped + first_chunk, to_write - first_chunk);
+        }
+
+        _published.store(start + to_write, std::memory_order_release);
+    }
+} // namespace wt
+
+#endif // HISTORY_RING_H
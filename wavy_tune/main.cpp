@@ -1,4 +1,5 @@
 #include "audio.hpp"
+#include "audio_input.hpp"
 #include "cube.hpp"
 #include "window.hpp"
 
@@ -6,7 +7,12 @@
 #include <shaders/shader_program.h>
 
 #include <analysis/analysis.hpp>
+#include <analysis/beat_tracker.hpp>
+#include <analysis/filterbank.hpp>
 #include <analysis/hann_window.hpp>
+#include <analysis/onset.hpp>
+#include <analysis/pipeline.hpp>
+#include <analysis/stft.hpp>
 #include <graphics/concrete_renderer.hpp>
 #include <graphics/draw_buffer.hpp>
 
@@ -28,10 +34,16 @@
 #include <chrono>
 #include <cmath>
 #include <complex>
+#include <cstdint>
 #include <cstring>
+#include <deque>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <ranges>
+#include <span>
+#include <string>
+#include <vector>
 
 
 namespace {
@@ -43,6 +55,27 @@ namespace {
         std::string gs_path;
         std::string fs_path;
         std::string audio_path;
+        std::deque<std::string> playlist;
+        bool memory_map             = false;
+        std::uint32_t period_frames = 0;
+        std::uint32_t periods       = 0;
+        bool exclusive              = false;
+        std::optional<std::string> cache_directory;
+        std::optional<std::chrono::microseconds> output_latency;
+        std::optional<wt::CaptureMode> capture;
+        std::size_t hop                                     = wt::analysis::THREE_QUARTER_OVERLAP;
+        std::size_t bars                                    = 100;
+        wt::analysis::BandScale scale                       = wt::analysis::BandScale::log;
+        std::shared_ptr<wt::analysis::FftBackend const> fft = wt::analysis::default_fft_backend();
+    };
+
+    /// @brief The gap between the spectrum on screen and the audio heard,
+    /// over the frames since `since`.
+    struct AvOffset {
+        std::chrono::steady_clock::time_point since;
+        std::chrono::nanoseconds total{0};
+        std::chrono::nanoseconds worst{0};
+        std::int64_t frames{0};
     };
 
     auto parse_program_args(int argc, char** argv) -> std::optional<ProgramArgs> {
@@ -54,7 +87,24 @@ namespace {
           ("v,vertex-shader", "Vertex shader path", cxxopts::value<std::string>())
           ("f,frag-shader", "Fragment shader", cxxopts::value<std::string>())
           ("g,geo-shader", "Geometry shader", cxxopts::value<std::string>())
-          ("a,audio-file", "Audio file", cxxopts::value<std::string>());
+          ("a,audio-file", "Audio file", cxxopts::value<std::string>())
+          ("p,playlist", "Audio files to play after it, gaplessly", cxxopts::value<std::vector<std::string>>())
+          ("m,mmap", "Memory map the audio file")
+          ("period", "Frames per device period, 0 for default", cxxopts::value<std::uint32_t>()->default_value("0"))
+          ("periods", "Periods per device buffer, 0 for default", cxxopts::value<std::uint32_t>()->default_value("0"))
+          ("exclusive", "Ask for exclusive use of the audio device")
+          ("overlap", "How much analysis windows overlap, 50 or 75 percent",
+            cxxopts::value<std::uint32_t>()->default_value("75"))
+          ("output-latency", "Microseconds from the device to the speaker, the device buffer by default",
+            cxxopts::value<std::uint32_t>())
+          ("bars", "Number of bars to draw", cxxopts::value<std::size_t>()->default_value("100"))
+          ("scale", "How the bars are spaced: linear, log, mel or bark",
+            cxxopts::value<std::string>()->default_value("log"))
+          ("fft", "Where the FFTs come from: kissfft or fourier",
+            cxxopts::value<std::string>()->default_value("kissfft"))
+          ("c,cache", "Keep decoded tracks in this directory", cxxopts::value<std::string>())
+          ("capture", "Visualise the default capture device instead of a file")
+          ("loopback", "Visualise what the system is playing instead of a file");
         // clang-format on
 
         auto result = options.parse(argc, argv);
@@ -70,52 +120,76 @@ namespace {
         if (!result.count("frag-shader")) {
             return std::nullopt;
         }
-        if (!result.count("audio-file")) {
+        if (result.count("capture")) {
+            args.capture = wt::CaptureMode::capture;
+        } else if (result.count("loopback")) {
+            args.capture = wt::CaptureMode::loopback;
+        } else if (!result.count("audio-file")) {
             return std::nullopt;
         }
         if (result.count("geo-shader")) {
             args.gs_path = result["geo-shader"].as<std::string>();
         }
+        if (result.count("playlist")) {
+            auto const playlist = result["playlist"].as<std::vector<std::string>>();
+            args.playlist.assign(playlist.begin(), playlist.end());
+        }
+        args.memory_map    = result.count("mmap") > 0;
+        args.period_frames = result["period"].as<std::uint32_t>();
+        args.periods       = result["periods"].as<std::uint32_t>();
+        args.exclusive     = result.count("exclusive") > 0;
+        if (result.count("cache")) {
+            args.cache_directory = result["cache"].as<std::string>();
+        }
+        switch (result["overlap"].as<std::uint32_t>()) {
+        case 50:
+            args.hop = wt::analysis::HALF_OVERLAP;
+            break;
+        case 75:
+            args.hop = wt::analysis::THREE_QUARTER_OVERLAP;
+            break;
+        default:
+            return std::nullopt;
+        }
+        if (result.count("output-latency")) {
+            args.output_latency = std::chrono::microseconds{result["output-latency"].as<std::uint32_t>()};
+        }
+        args.bars = result["bars"].as<std::size_t>();
+        if (args.bars == 0) {
+            return std::nullopt;
+        }
+        auto const scale = wt::analysis::band_scale_from_string(result["scale"].as<std::string>());
+        if (!scale) {
+            return std::nullopt;
+        }
+        args.scale = *scale;
+        args.fft   = wt::analysis::fft_backend_from_string(result["fft"].as<std::string>());
+        if (!args.fft) {
+            return std::nullopt;
+        }
 
         args.vs_path    = result["vertex-shader"].as<std::string>();
         args.fs_path    = result["frag-shader"].as<std::string>();
-        args.audio_path = result["audio-file"].as<std::string>();
+        if (result.count("audio-file")) {
+            args.audio_path = result["audio-file"].as<std::string>();
+        }
 
         return args;
     }
 
 
-    // TODO : This may ignore items in the end if the input size,
-    // TODO : isn't divible exactly by output size
-    // Packs the array into an array of length Size
-    template <std::size_t OutSize, std::size_t InSize>
-    std::array<float, OutSize> bin_pack(std::array<float, InSize> const& data) {
-        static_assert(InSize > OutSize);
-        constexpr std::size_t window_size = InSize / OutSize;
-
-        std::array<float, OutSize> ret;
-        for (std::size_t i = 0; i < OutSize; ++i) {
-
-            float total = 0;
-            for (std::size_t j = 0; j < window_size; ++j) {
-                total += data[i * window_size + j];
-            }
+    /// @brief Scales `values` in place so the largest is `multiplier`,
+    /// leaving silence at zero.
+    template <typename T>
+    void normalize(std::span<T> values, T const& multiplier) {
+        Expects(!values.empty());
 
-            ret[i] = total / window_size;
+        auto const max = *std::max_element(begin(values), end(values));
+        if (max <= T{}) {
+            return;
         }
-
-        return ret;
-    }
-
-    template <typename T, std::size_t Size>
-    std::array<T, Size> normalize(std::array<T, Size> const& in, T const& multiplier) {
-        static_assert(Size > 0);
-
-        auto const max = *std::max_element(begin(in), end(in));
-        std::array<T, Size> ret;
-
-        std::transform(begin(in), end(in), begin(ret), [=](auto const& val) { return multiplier * val / max; });
-        return ret;
+        std::transform(
+            begin(values), end(values), begin(values), [=](auto const& val) { return multiplier * val / max; });
     }
 } // namespace
 
@@ -187,9 +261,50 @@ int main(int argc, char** argv) {
         return 0;
     }
 
-    wt::AudioPlayer player;
-    if (!player.play(args->audio_path)) {
-        return -1;
+    // clang-format off
+    wt::AudioPlayer player{wt::AudioPlayerOptions{
+      .memory_map      = args->memory_map,
+      .period_frames   = args->period_frames,
+      .periods         = args->periods,
+      .exclusive       = args->exclusive,
+      .output_latency  = args->output_latency,
+      .cache_directory = args->cache_directory
+    }};
+    // clang-format on
+
+    // Live input skips the player altogether, frames go from the device
+    // straight into the analysis tap
+    std::optional<wt::AudioInput> input;
+    std::optional<wt::DeviceLatency> latency;
+    if (args->capture) {
+        // clang-format off
+        auto device = std::make_unique<wt::CaptureDevice>(wt::CaptureOptions{
+          .mode          = *args->capture,
+          .period_frames = args->period_frames > 0 ? args->period_frames : 128,
+          .periods       = args->periods > 0 ? args->periods : 2
+        });
+        // clang-format on
+        auto const* capture = device.get();
+        input.emplace(std::move(device));
+        if (!input->start()) {
+            return -1;
+        }
+        latency = capture->device_latency();
+    } else {
+        if (!player.play(args->audio_path)) {
+            return -1;
+        }
+        latency = player.device_latency();
+    }
+    // The rate of the frames in the tap, which is what gets analysed. The
+    // device's own rate differs whenever miniaudio resamples for it.
+    float const tap_rate = static_cast<float>(
+        input ? input->source().format().sample_rate : player.playback_clock().sample_rate());
+
+    if (latency) {
+        std::cout << "device buffer: " << latency->periods << " x " << latency->period_frames << " frames at "
+                  << latency->sample_rate << "Hz, " << latency->buffer.count() << "us"
+                  << (latency->exclusive ? " (exclusive)" : "") << std::endl;
     }
 
     // Testing the fourier shit
@@ -231,9 +346,9 @@ int main(int argc, char** argv) {
 
     // creating all the offsets
     std::vector<glm::vec3> offsets;
-    offsets.reserve(100);
-    for (auto const& elem :
-        std::views::iota(0, 100) | std::views::transform([](auto const& i) { return glm::vec3{i, 0.0f, 0.0}; })) {
+    offsets.reserve(args->bars);
+    for (auto const& elem : std::views::iota(std::size_t{0}, args->bars)
+                                | std::views::transform([](auto const& i) { return glm::vec3{i, 0.0f, 0.0}; })) {
         offsets.push_back(std::move(elem));
     }
 
@@ -250,17 +365,41 @@ int main(int argc, char** argv) {
     up  = {0, 1, 0};
 
 
-    std::array<float, wt::analysis::WINDOW_SIZE> raw_audio{}; // TODO : needs to have double signal size
+    // Too big to want on the stack
+    std::vector<std::array<std::complex<float>, wt::analysis::WINDOW_SIZE / 2 + 1>> spectra(wt::MAX_CHANNELS);
 
-    wt::analysis::FftAnalyzer analyzer;
-    auto const hann_coefficients_input  = wt::analysis::make_hann_coefficients<wt::analysis::WINDOW_SIZE>();
-    auto const hann_coefficients_output = wt::analysis::make_hann_coefficients<wt::analysis::WINDOW_SIZE / 2 + 1>();
-    analyzer.set_preprocessor([&](std::array<float, wt::analysis::WINDOW_SIZE>& buffer) {
-        // TODO : We want to apply the hann coefficients to the array
-        for (std::size_t i = 0; i < wt::analysis::WINDOW_SIZE; ++i) {
-            buffer[i] *= hann_coefficients_input[i];
-        }
-    });
+    // The bars: each bin's magnitude, weighted and gathered into bands on
+    // the chosen scale in one pass over every channel's spectrum. Linear
+    // bars keep the old taper, on the other scales the low bars would
+    // otherwise sit at nothing.
+    constexpr std::size_t BINS = wt::analysis::WINDOW_SIZE / 2 + 1;
+    std::array<float, BINS> gains{};
+    if (args->scale == wt::analysis::BandScale::linear) {
+        gains = wt::analysis::make_hann_coefficients<BINS>();
+    } else {
+        gains.fill(1.0f);
+    }
+
+    // clang-format off
+    wt::analysis::Filterbank const filterbank{wt::analysis::FilterbankOptions{
+      .scale       = args->scale,
+      .bands       = args->bars,
+      .bins        = BINS,
+      .sample_rate = tap_rate
+    }};
+    // clang-format on
+    auto bars = wt::analysis::make_pipeline<wt::analysis::WINDOW_SIZE>(
+        args->fft, wt::analysis::Magnitude{}, wt::analysis::Weighting<BINS>{gains}, filterbank);
+
+    // The STFT reads the tap on from where it stopped, so every hop of
+    // audio is analysed once, at the same rate whatever the frame rate.
+    // Tap position `stft_origin` is the STFT's position zero.
+    constexpr std::size_t STFT_CHUNK = 1024;
+    std::optional<wt::analysis::Stft> stft;
+    std::uint64_t stft_origin = 0;
+    std::vector<float> stft_input(STFT_CHUNK * wt::MAX_CHANNELS);
+    std::size_t channels          = 0;
+    std::uint64_t window_position = 0;
 
     // analyzer.set_postprocessor([](std::array<std::complex<float>, wt::analysis::WINDOW_SIZE>& buffer) {
     //     for (std::size_t i = 0; i < wt::analysis::WINDOW_SIZE; ++i) {
@@ -273,33 +412,99 @@ int main(int argc, char** argv) {
     // Game loop - Main OpenGL rendering
     glClearColor(0.0f, 0.0f, 1.0f, 1.0f);
 
-    std::size_t sample_counter = 0;
-    std::array<float, 100> heights;
+    // Rhythm, from the same frames as the bars: onsets flash the
+    // background and beats pulse the bars, each fading over the audio
+    // analysed since rather than over rendered frames
+    wt::analysis::OnsetDetector onsets{wt::analysis::OnsetOptions{.sample_rate = tap_rate}};
+    wt::analysis::BeatTracker beats{wt::analysis::BeatTrackerOptions{.hop = args->hop, .sample_rate = tap_rate}};
+    std::optional<std::uint64_t> last_onset;
+    std::optional<std::uint64_t> last_beat;
+    auto const fade = [&](std::optional<std::uint64_t> since, float seconds) {
+        if (!since || window_position < *since) {
+            return 0.0f;
+        }
+        return std::max(0.0f, 1.0f - static_cast<float>(window_position - *since) / (seconds * tap_rate));
+    };
+
+    std::vector<float> heights(args->bars);
 
     auto last = std::chrono::system_clock::now();
     bool play = true;
 
+    AvOffset av_offset{.since = std::chrono::steady_clock::now()};
+
+    auto playlist = args->playlist;
     while (!window.closed()) {
 
-        // TODO : Need to figure out why read_from_buffer is reading
-        // TODO : dodgy data from the output into the raw_audio
-        // TODO : buffer.
-        // std::uint32_t samples_to_read = std::max(2u, static_cast<std::uint32_t>(raw_audio.size() - sample_counter)) / 2;
-        // sample_counter += read_from_buffer(&user_data.buffer, raw_audio.data() + sample_counter, samples_to_read,
-        //                       device.playback.format, device.playback.channels)
-        //                 * device.playback.channels;
-        //
-        auto const [current_window, window_size] = player.current_window();
-
-        // TODO : There's an issue where we have left over frames
-        sample_counter = sample_counter < raw_audio.size() ? sample_counter + window_size : 0;
-        mempcpy(raw_audio.data() + sample_counter, current_window.data(),
-            std::min(current_window.size(), raw_audio.size() - sample_counter));
+        // Keep the next track primed so the player can switch to it on the
+        // exact frame the current one ends
+        if (!input && !playlist.empty() && !player.has_queued()) {
+            player.queue(playlist.front());
+            playlist.pop_front();
+        }
+
+        // The STFT gets the tap up to half a window past what is heard,
+        // so the newest frame is centred on the audio heard right now
+        // rather than the latest decoded, which the speaker only plays a
+        // device buffer later
+        auto const* tap = input ? input->tap() : player.tap();
+        if (tap && tap->channels() <= wt::MAX_CHANNELS) {
+            if (!stft) {
+                stft.emplace(tap->channels(), args->hop, wt::analysis::WINDOW_SIZE, args->fft);
+                stft_origin = tap->oldest_position();
+            }
+
+            auto end = tap->write_position();
+            if (!input) {
+                // Nothing goes in until the clock knows what is heard
+                auto const audible = player.playback_clock().audible_position();
+                auto const next    = stft_origin + stft->position();
+                end                = audible ? std::min(*audible + stft->window_size() / 2, end) : next;
+            }
+
+            // More than a few hops behind, or past the history, skip ahead
+            // to the last window before `end`, staying on the same grid
+            auto const hop  = stft->hop();
+            auto const size = stft->window_size();
+            auto const next = stft_origin + stft->position();
+            if (end >= stft_origin + size && (end > next + size + 4 * hop || next < tap->oldest_position())) {
+                stft_origin += (end - size - stft_origin) / hop * hop;
+                stft->reset();
+                onsets.reset();
+                beats.reset();
+            }
+
+            while (stft_origin + stft->position() < end) {
+                auto const from   = stft_origin + stft->position();
+                auto const frames = std::min<std::uint64_t>(end - from, STFT_CHUNK);
+                auto const chunk  = std::span{stft_input}.first(frames * tap->channels());
+                if (!tap->read(from, chunk)) {
+                    break;
+                }
+                stft->push(chunk, [&](wt::analysis::StftFrame const& frame) {
+                    channels = frame.spectra.size() / frame.bins;
+                    for (std::size_t c = 0; c < channels; ++c) {
+                        std::ranges::copy(frame.spectrum(c), spectra[c].begin());
+                    }
+                    window_position = stft_origin + frame.position;
+
+                    if (auto const onset = onsets.push(window_position, frame)) {
+                        last_onset = onset->position;
+                    }
+                    if (auto const beat = beats.push(window_position, onsets.strength())) {
+                        last_beat = beat->position;
+                    }
+                });
+            }
+        }
+        bool const window_ready = channels > 0;
 
         // lookAt = glm::lookAt(cam.pos, cam.pos + cam.getDirection(), cam.getUp());
         auto const cam = window.camera();
         look_at        = glm::lookAt(cam.pos, cam.pos + cam.getDirection(), cam.getUp());
 
+        float const flash = fade(last_onset, 0.1f);
+        glClearColor(0.3f * flash, 0.3f * flash, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 
@@ -309,20 +514,20 @@ int main(int argc, char** argv) {
         // analysis into an array of floats representing the
         // frequency amount
         // auto const transform_complex = analyzer.analyze(wt::test::sin_10);
-        if (sample_counter == 0) {
-            // convert integer to floats for analysis
-
-            auto const transform_complex = analyzer.analyze(raw_audio);
-            std::array<float, wt::analysis::WINDOW_SIZE / 2 + 1> transform{};
+        if (window_ready) {
+            // Every channel gets its own FFT, the bars show their sum
+            auto const outputs = std::span{spectra}.first(channels);
 
-            std::transform(begin(transform_complex), end(transform_complex), begin(transform),
-                [](std::complex<float> in) { return std::abs(in); });
+            bars.clear(heights);
+            for (auto const& spectrum : outputs) {
+                bars.accumulate(spectrum, heights);
+            }
+            normalize(std::span{heights}, 10.0f);
 
-            for (int i = 0; i < transform.size(); i++) {
-                transform[i] *= hann_coefficients_output[i];
+            float const pulse = 1.0f + 0.25f * fade(last_beat, 0.15f);
+            for (auto& height : heights) {
+                height *= pulse;
             }
-            heights = bin_pack<100>(transform);
-            heights = normalize(heights, 10.0f);
         }
 
         // MARK: Sound analysis
@@ -332,24 +537,44 @@ int main(int argc, char** argv) {
             auto const now_secs = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch());
             if (play) {
                 player.pause();
-                player.current_window();
                 play = false;
             } else {
                 player.unpause();
-                player.current_window();
                 play = true;
             }
             last = now;
         }
 
         // std::vector<float> heights(100);
-        Expects(heights.size() == 100);
-        Expects(offsets.size() == 100);
+        Expects(heights.size() == args->bars);
+        Expects(offsets.size() == args->bars);
 
         renderer.render(proj, look_at, window.rotation(), heights, offsets);
         glBindVertexArray(0);
 
         window.process_frame();
+
+        // How long after its middle was heard the spectrum made it to the
+        // screen, negative when the picture runs ahead of the sound
+        if (!input && window_ready) {
+            auto const centre = window_position + stft->window_size() / 2;
+            if (auto const heard = player.playback_clock().audible_time(centre)) {
+                auto const offset = std::chrono::steady_clock::now() - *heard;
+                av_offset.total += offset;
+                av_offset.worst  = std::max(av_offset.worst, std::chrono::abs(offset));
+                av_offset.frames++;
+            }
+        }
+        if (auto const shown = std::chrono::steady_clock::now(); shown - av_offset.since >= std::chrono::seconds{1}) {
+            if (av_offset.frames > 0) {
+                auto const mean = av_offset.total / av_offset.frames;
+                std::cout << "a/v offset: " << std::chrono::duration_cast<std::chrono::microseconds>(mean).count()
+                          << "us mean, "
+                          << std::chrono::duration_cast<std::chrono::microseconds>(av_offset.worst).count()
+                          << "us worst" << std::endl;
+            }
+            av_offset = AvOffset{.since = shown};
+        }
     }
 
     return 0;
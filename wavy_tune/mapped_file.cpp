@@ -0,0 +1,139 @@
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    std::size_t page_size() {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+#else
+        static std::size_t const size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+#endif
+    }
+} // namespace
+
+namespace wt {
+
+    std::shared_ptr<MappedFile> MappedFile::open(std::string const& path) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return nullptr;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return nullptr;
+        }
+
+        // The mapping keeps the file open, so the file handle can go
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return nullptr;
+        }
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr) {
+            CloseHandle(mapping);
+            return nullptr;
+        }
+
+        return std::shared_ptr<MappedFile>{
+            new MappedFile{static_cast<std::byte const*>(data), static_cast<std::size_t>(size.QuadPart), mapping}};
+#else
+        int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+
+        struct stat info {};
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        // The mapping keeps its own reference to the file
+        auto const size = static_cast<std::size_t>(info.st_size);
+        void* data      = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return nullptr;
+        }
+
+        return std::shared_ptr<MappedFile>{new MappedFile{static_cast<std::byte const*>(data), size, nullptr}};
+#endif
+    }
+
+    MappedFile::MappedFile(std::byte const* data, std::size_t size, void* handle)
+        : _data{data},
+          _size{size},
+          _handle{handle} {}
+
+    MappedFile::~MappedFile() {
+#ifdef _WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(_handle);
+#else
+        munmap(const_cast<std::byte*>(_data), _size);
+#endif
+    }
+
+    std::span<std::byte const> MappedFile::bytes() const {
+        return {_data, _size};
+    }
+
+    void MappedFile::advise_sequential() const {
+#ifndef _WIN32
+        madvise(const_cast<std::byte*>(_data), _size, MADV_SEQUENTIAL);
+#endif
+    }
+
+    void MappedFile::will_need(std::size_t offset, std::size_t length) const {
+#ifndef _WIN32
+        if (offset >= _size) {
+            return;
+        }
+
+        // madvise wants a page aligned start address
+        std::size_t const start = offset - offset % page_size();
+        std::size_t const end   = std::min(offset + length, _size);
+        madvise(const_cast<std::byte*>(_data) + start, end - start, MADV_WILLNEED);
+#else
+        (void) offset;
+        (void) length;
+#endif
+    }
+
+    void MappedFile::prefault(std::size_t offset, std::size_t length) const {
+        std::size_t const end  = std::min(offset + length, _size);
+        std::size_t const step = page_size();
+
+        volatile std::byte sink{};
+        for (std::size_t position = offset - offset % step; position < end; position += step) {
+            sink = _data[position];
+        }
+        (void) sink;
+    }
+} // namespace wt
@@ -0,0 +1,48 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace wt {
+
+    /// @brief A read-only memory mapping of a whole file. The page cache
+    /// backs the mapping directly, so reading it costs no read syscalls and
+    /// no second copy of the file in memory.
+    class MappedFile {
+    public:
+        /// @brief Maps the file at `path`.
+        /// @return the mapping, or nullptr if the file could not be mapped.
+        static std::shared_ptr<MappedFile> open(std::string const& path);
+
+        ~MappedFile();
+
+        MappedFile(MappedFile const&)            = delete;
+        MappedFile& operator=(MappedFile const&) = delete;
+
+        [[nodiscard]] std::span<std::byte const> bytes() const;
+
+        /// @brief Tells the kernel the file will be read front to back, so
+        /// it reads ahead aggressively and drops pages behind the reader.
+        void advise_sequential() const;
+
+        /// @brief Starts reading a range into the page cache asynchronously.
+        void will_need(std::size_t offset, std::size_t length) const;
+
+        /// @brief Touches every page of a range so that later reads of it do
+        /// not fault. Blocks until the range is resident.
+        void prefault(std::size_t offset, std::size_t length) const;
+
+    private:
+        MappedFile(std::byte const* data, std::size_t size, void* handle);
+
+        std::byte const* _data;
+        std::size_t _size;
+        // The file mapping handle on Windows, unused elsewhere
+        void* _handle;
+    };
+} // namespace wt
+
+#endif // MAPPED_FILE_H
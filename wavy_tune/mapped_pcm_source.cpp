@@ -0,0 +1,276 @@
+#include "mapped_pcm_source.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+    constexpr std::uint16_t WAVE_FORMAT_PCM        = 0x0001;
+    constexpr std::uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+    constexpr std::uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    constexpr std::uint64_t NO_SEEK = std::numeric_limits<std::uint64_t>::max();
+
+    std::uint16_t read_u16(std::span<std::byte const> bytes, std::size_t offset) {
+        return static_cast<std::uint16_t>(
+            std::to_integer<std::uint16_t>(bytes[offset]) | (std::to_integer<std::uint16_t>(bytes[offset + 1]) << 8));
+    }
+
+    std::uint32_t read_u32(std::span<std::byte const> bytes, std::size_t offset) {
+        return read_u16(bytes, offset) | (static_cast<std::uint32_t>(read_u16(bytes, offset + 2)) << 16);
+    }
+
+    bool has_id(std::span<std::byte const> bytes, std::size_t offset, std::string_view id) {
+        return offset + id.size() <= bytes.size() && std::memcmp(bytes.data() + offset, id.data(), id.size()) == 0;
+    }
+
+    std::optional<ma_format> pcm_format(std::uint16_t tag, std::uint16_t bits) {
+        if (tag == WAVE_FORMAT_PCM && bits == 16) {
+            return ma_format_s16;
+        }
+        if (tag == WAVE_FORMAT_PCM && bits == 32) {
+            return ma_format_s32;
+        }
+        if (tag == WAVE_FORMAT_IEEE_FLOAT && bits == 32) {
+            return ma_format_f32;
+        }
+        return std::nullopt;
+    }
+} // namespace
+
+namespace wt {
+
+    std::optional<PcmLayout> parse_wav(std::span<std::byte const> bytes) {
+        if (bytes.size() < 12 || !has_id(bytes, 0, "RIFF") || !has_id(bytes, 8, "WAVE")) {
+            return std::nullopt;
+        }
+
+        std::optional<ma_format> format;
+        std::uint16_t channels    = 0;
+        std::uint32_t sample_rate = 0;
+        std::uint16_t block_align = 0;
+
+        // Chunks are an id, a little endian size and a body padded to an
+        // even length. We need "fmt " and then "data".
+        std::size_t offset = 12;
+        while (offset + 8 <= bytes.size()) {
+            std::uint32_t const chunk_size = read_u32(bytes, offset + 4);
+            std::size_t const body         = offset + 8;
+
+            if (has_id(bytes, offset, "fmt ") && chunk_size >= 16 && body + chunk_size <= bytes.size()) {
+                std::uint16_t tag = read_u16(bytes, body);
+                channels          = read_u16(bytes, body + 2);
+                sample_rate       = read_u32(bytes, body + 4);
+                block_align       = read_u16(bytes, body + 12);
+
+                // The real tag of an extensible format is the start of its
+                // sub-format GUID
+                if (tag == WAVE_FORMAT_EXTENSIBLE && chunk_size >= 40) {
+                    tag = read_u16(bytes, body + 24);
+                }
+                format = pcm_format(tag, read_u16(bytes, body + 14));
+            } else if (has_id(bytes, offset, "data")) {
+                if (!format || channels == 0 || sample_rate == 0) {
+                    return std::nullopt;
+                }
+
+                // Samples are read in place, they must be naturally aligned
+                std::uint32_t const sample_bytes = ma_get_bytes_per_sample(*format);
+                if (block_align != sample_bytes * channels || body % sample_bytes != 0) {
+                    return std::nullopt;
+                }
+
+                // Streamed WAVs may leave the size unset, trust the file
+                std::size_t const data_bytes = std::min<std::size_t>(chunk_size, bytes.size() - body);
+                return PcmLayout{*format, channels, sample_rate, body, data_bytes / block_align};
+            }
+
+            offset = body + chunk_size + (chunk_size & 1);
+        }
+
+        return std::nullopt;
+    }
+
+    MappedPcmSource::MappedPcmSource(std::shared_ptr<MappedFile> file, PcmLayout layout, std::uint32_t prefetch_frames)
+        : _file{std::move(file)},
+          _layout{layout},
+          _prefetch_frames{prefetch_frames},
+          _frame_bytes{ma_get_bytes_per_frame(layout.format, layout.channels)},
+          _cursor{0},
+          _prefetched_until{0},
+          _low_watermark{prefetch_frames},
+          _underruns{0},
+          _seek_to{NO_SEEK},
+          _seek_primer{0} {
+        Expects(_file);
+        Expects(_layout.data_offset + _layout.frames * _frame_bytes <= _file->bytes().size());
+    }
+
+    MappedPcmSource::~MappedPcmSource() {
+        if (_thread.joinable()) {
+            _thread.request_stop();
+            _thread.join();
+        }
+    }
+
+    void MappedPcmSource::start() {
+        Expects(!_thread.joinable());
+
+        _file->advise_sequential();
+        _prefetch();
+        _thread = std::jthread{[this](std::stop_token stop) { _run(stop); }};
+    }
+
+    std::uint32_t MappedPcmSource::read(void* output, std::uint32_t frames, float gain) {
+        Expects(output != nullptr);
+
+        take_seek();
+
+        std::uint64_t const cursor   = _cursor.load(std::memory_order_relaxed);
+        std::uint64_t const prefetch = _prefetched_until.load(std::memory_order_acquire);
+        auto const to_copy = static_cast<std::uint32_t>(std::min<std::uint64_t>(frames, _layout.frames - cursor));
+
+        // Reading past the prefetched range may fault on this thread
+        std::size_t const ahead = prefetch > cursor ? static_cast<std::size_t>(prefetch - cursor) : 0;
+        if (ahead < _low_watermark.load(std::memory_order_relaxed)) {
+            _low_watermark.store(ahead, std::memory_order_relaxed);
+        }
+        if (cursor + to_copy > prefetch && prefetch < _layout.frames) {
+            _underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::byte const* source = _file->bytes().data() + _layout.data_offset + cursor * _frame_bytes;
+        copy_with_gain(_layout.format, output, source, std::size_t{to_copy} * _layout.channels, gain);
+
+        _cursor.store(cursor + to_copy, std::memory_order_relaxed);
+        return to_copy;
+    }
+
+    bool MappedPcmSource::finished() const {
+        return _seek_to.load(std::memory_order_acquire) == NO_SEEK
+            && _cursor.load(std::memory_order_relaxed) >= _layout.frames;
+    }
+
+    bool MappedPcmSource::seek(std::uint64_t frame, std::uint32_t primer_frames) {
+        frame                     = std::min(frame, _layout.frames);
+        std::uint64_t const first = frame - std::min<std::uint64_t>(frame, primer_frames);
+        std::uint64_t const until = std::min<std::uint64_t>(frame + _prefetch_frames, _layout.frames);
+
+        std::scoped_lock lock{_prefetch_mutex};
+        if (until > first) {
+            std::size_t const offset = _layout.data_offset + first * _frame_bytes;
+            std::size_t const length = (until - first) * _frame_bytes;
+            _file->will_need(offset, length);
+            _file->prefault(offset, length);
+        }
+
+        // The frame goes last: whoever sees it with acquire also sees the
+        // range faulted in for it and the primer
+        _prefetched_until.store(until, std::memory_order_release);
+        _seek_primer.store(static_cast<std::uint32_t>(frame - first), std::memory_order_relaxed);
+        _seek_to.store(frame, std::memory_order_release);
+        return true;
+    }
+
+    void MappedPcmSource::take_seek() {
+        // The seek already faulted in the primer and the frames after it.
+        // Publishing the cursor before clearing the request keeps the
+        // prefetch thread from ever seeing the old cursor without it.
+        if (std::uint64_t seek_to = _seek_to.load(std::memory_order_acquire); seek_to != NO_SEEK) {
+            std::uint64_t const primer = std::min<std::uint64_t>(_seek_primer.load(std::memory_order_relaxed), seek_to);
+            std::size_t const offset   = _layout.data_offset + (seek_to - primer) * _frame_bytes;
+            _primer                    = _file->bytes().subspan(offset, primer * _frame_bytes);
+            _cursor.store(seek_to, std::memory_order_release);
+            _seek_to.compare_exchange_strong(seek_to, NO_SEEK, std::memory_order_acq_rel);
+        }
+    }
+
+    std::span<std::byte const> MappedPcmSource::take_primer() {
+        return std::exchange(_primer, {});
+    }
+
+    std::uint64_t MappedPcmSource::position() const {
+        std::uint64_t const seek_to = _seek_to.load(std::memory_order_acquire);
+        return seek_to != NO_SEEK ? seek_to : _cursor.load(std::memory_order_acquire);
+    }
+
+    FifoWatermark MappedPcmSource::watermark() const {
+        std::uint64_t const cursor   = _cursor.load(std::memory_order_relaxed);
+        std::uint64_t const prefetch = _prefetched_until.load(std::memory_order_relaxed);
+
+        // clang-format off
+        return FifoWatermark{
+          .capacity_frames      = _prefetch_frames,
+          .fill_frames          = prefetch > cursor ? static_cast<std::size_t>(prefetch - cursor) : 0,
+          .low_watermark_frames = _low_watermark.load(std::memory_order_relaxed),
+          .underruns            = _underruns.load(std::memory_order_relaxed)
+        };
+        // clang-format on
+    }
+
+    void MappedPcmSource::reset_watermark() {
+        _low_watermark.store(_prefetch_frames, std::memory_order_relaxed);
+        _underruns.store(0, std::memory_order_relaxed);
+    }
+
+    ma_format MappedPcmSource::format() const {
+        return _layout.format;
+    }
+
+    std::uint32_t MappedPcmSource::channels() const {
+        return _layout.channels;
+    }
+
+    std::uint32_t MappedPcmSource::sample_rate() const {
+        return _layout.sample_rate;
+    }
+
+    void MappedPcmSource::_prefetch() {
+        std::scoped_lock lock{_prefetch_mutex};
+
+        // Where the cursor is about to be if a seek is on its way. The seek
+        // is read first, so the prefetched range read after it is never
+        // older than the seek's.
+        std::uint64_t const seek_to = _seek_to.load(std::memory_order_acquire);
+        std::uint64_t const cursor  = seek_to != NO_SEEK ? seek_to : _cursor.load(std::memory_order_acquire);
+        std::uint64_t const from    = std::max(cursor, _prefetched_until.load(std::memory_order_acquire));
+        std::uint64_t const until   = std::min<std::uint64_t>(cursor + _prefetch_frames, _layout.frames);
+        if (from >= until) {
+            return;
+        }
+
+        // Ask for the whole window asynchronously, then block on it here
+        // so the device thread never has to
+        std::size_t const offset = _layout.data_offset + from * _frame_bytes;
+        std::size_t const length = (until - from) * _frame_bytes;
+        _file->will_need(offset, length);
+        _file->prefault(offset, length);
+
+        _prefetched_until.store(until, std::memory_order_release);
+    }
+
+    void MappedPcmSource::_run(std::stop_token const& stop) {
+        auto const window   = std::chrono::microseconds{1'000'000ull * _prefetch_frames / _layout.sample_rate};
+        auto const interval = std::max<std::chrono::microseconds>(window / 4, std::chrono::milliseconds{1});
+
+        std::mutex wake_mutex;
+        std::condition_variable_any wake;
+        std::unique_lock lock{wake_mutex};
+        // Keep going at the end of the file, a seek can always move back
+        while (!stop.stop_requested()) {
+            _prefetch();
+            wake.wait_for(lock, stop, interval, [] { return false; });
+        }
+    }
+} // namespace wt
@@ -0,0 +1,95 @@
+#ifndef MAPPED_PCM_SOURCE_H
+#define MAPPED_PCM_SOURCE_H
+
+#include "audio_source.hpp"
+#include "mapped_file.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+
+namespace wt {
+
+    /// @brief Where interleaved PCM frames sit inside a mapped file.
+    struct PcmLayout {
+        ma_format format;
+        std::uint32_t channels;
+        std::uint32_t sample_rate;
+        std::size_t data_offset;
+        std::uint64_t frames;
+    };
+
+    /// @brief Finds the PCM data of an uncompressed WAV file, 16 or 32 bit
+    /// integer or 32 bit float.
+    /// @return the layout, or nothing if the file is not a WAV we can read
+    /// samples from directly.
+    std::optional<PcmLayout> parse_wav(std::span<std::byte const> bytes);
+
+    /// @brief Plays uncompressed PCM straight out of a memory mapped file.
+    /// The device callback copies from the mapping into the device buffer,
+    /// so there is no decoder and no intermediate FIFO. A background thread
+    /// faults pages in ahead of the play cursor, keeping page faults off the
+    /// device thread.
+    class MappedPcmSource : public AudioSource {
+    public:
+        /// @param file the mapping holding the samples.
+        /// @param layout where the samples are in the mapping.
+        /// @param prefetch_frames how far ahead of the cursor to fault in.
+        MappedPcmSource(std::shared_ptr<MappedFile> file, PcmLayout layout, std::uint32_t prefetch_frames);
+        ~MappedPcmSource() override;
+
+        void start() override;
+        std::uint32_t read(void* output, std::uint32_t frames, float gain) override;
+        [[nodiscard]] bool finished() const override;
+
+        /// @brief Faults in the frames around `frame` on the calling thread,
+        /// so the device thread never waits on the jump.
+        bool seek(std::uint64_t frame, std::uint32_t primer_frames) override;
+        void take_seek() override;
+        std::span<std::byte const> take_primer() override;
+        [[nodiscard]] std::uint64_t position() const override;
+
+        [[nodiscard]] FifoWatermark watermark() const override;
+        void reset_watermark() override;
+
+        [[nodiscard]] ma_format format() const override;
+        [[nodiscard]] std::uint32_t channels() const override;
+        [[nodiscard]] std::uint32_t sample_rate() const override;
+
+    private:
+        /// Faults in the frames up to `prefetch_frames` past the cursor.
+        void _prefetch();
+        void _run(std::stop_token const& stop);
+
+        std::shared_ptr<MappedFile> _file;
+        PcmLayout _layout;
+        std::uint32_t _prefetch_frames;
+        std::uint32_t _frame_bytes;
+
+        std::atomic<std::uint64_t> _cursor;
+        std::atomic<std::uint64_t> _prefetched_until;
+        std::atomic<std::size_t> _low_watermark;
+        std::atomic<std::uint64_t> _underruns;
+
+        // Keeps a seek and the prefetch thread from faulting in different
+        // parts of the file under each other's feet
+        std::mutex _prefetch_mutex;
+
+        // The frame a seek is waiting to move the cursor to, and the primer
+        // it wants, until the device thread takes them
+        std::atomic<std::uint64_t> _seek_to;
+        std::atomic<std::uint32_t> _seek_primer;
+
+        // Only touched by the device thread
+        std::span<std::byte const> _primer;
+
+        std::jthread _thread;
+    };
+} // namespace wt
+
+#endif // MAPPED_PCM_SOURCE_H
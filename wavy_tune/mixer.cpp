@@ -0,0 +1,365 @@
+#include "mixer.hpp"
+#include "sample_kernels.hpp"
+
+#include <analysis/pipeline.hpp>
+
+#include <fmt/base.h>
+#include <gsl/assert>
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+    constexpr std::size_t BINS = wt::analysis::WINDOW_SIZE / 2 + 1;
+
+    // The callback mixes long periods in chunks, so the scratch buffer
+    // has a fixed size whatever the device asks for
+    constexpr std::uint32_t MIX_CHUNK_FRAMES = 1024;
+
+    using AnalysisWindow = std::array<float, wt::analysis::WINDOW_SIZE>;
+} // namespace
+
+namespace wt {
+
+    std::span<float const> StreamSpectrum::channel(std::uint32_t channel) const {
+        Expects(channel < channels);
+        return std::span{magnitudes}.subspan(channel * bins, bins);
+    }
+
+    /* Static Methods */
+    void Mixer::data_callback(ma_device* device, void* output, const void* /* input */, ma_uint32 frame_count) {
+        auto* mixer = static_cast<Mixer*>(device->pUserData);
+        Expects(mixer != nullptr);
+        mixer->mix(static_cast<float*>(output), frame_count);
+    }
+    /* End Static Methods */
+
+    Mixer::Mixer(MixerOptions options)
+        : _options{options},
+          _cache{options.playback.cache_directory
+                     ? std::make_unique<PcmCache>(
+                           *options.playback.cache_directory, options.playback.cache_budget_bytes)
+                     : nullptr},
+          _master_gain{1.0f},
+          _callbacks{0},
+          _scratch(MIX_CHUNK_FRAMES * options.channels),
+          _sources(options.max_streams),
+          _device{new ma_device{},
+              [](ma_device* ptr) {
+                  ma_device_uninit(ptr);
+                  delete ptr;
+              }},
+          _device_started{false} {
+        Expects(_options.channels > 0 && _options.channels <= MAX_CHANNELS);
+        Expects(_options.sample_rate > 0);
+
+        // The taps always hold at least one analysis window
+        std::size_t const history_frames = _options.playback.history.count() * _options.sample_rate / 1000;
+        _streams.reserve(_options.max_streams);
+        for (std::size_t i = 0; i < _options.max_streams; ++i) {
+            _streams.push_back(std::make_unique<Stream>());
+            _streams.back()->tap = std::make_unique<HistoryRing>(
+                _options.channels, std::max<std::size_t>(history_frames, wt::analysis::WINDOW_SIZE));
+        }
+
+        // Every thread looks after its own share of the slots, so a slot is
+        // only ever analysed by one of them
+        unsigned const threads = std::clamp<unsigned>(
+            _options.analysis_threads > 0 ? _options.analysis_threads : std::thread::hardware_concurrency(), 1,
+            static_cast<unsigned>(std::max<std::size_t>(_options.max_streams, 1)));
+        _analysis_threads.reserve(threads);
+        for (unsigned i = 0; i < threads; ++i) {
+            _analysis_threads.emplace_back(
+                [this, i, threads](std::stop_token const& stop) { _analyse(stop, i, threads); });
+        }
+    }
+
+    Mixer::~Mixer() {
+        // Stop everything reading the streams before the sources go
+        _analysis_threads.clear();
+        _device.reset();
+    }
+
+    bool Mixer::start() {
+        if (_device_started) {
+            return true;
+        }
+
+        ma_device_config config  = ma_device_config_init(ma_device_type_playback);
+        config.playback.format   = ma_format_f32;
+        config.playback.channels = _options.channels;
+        config.sampleRate        = _options.sample_rate;
+        config.dataCallback      = data_callback;
+        config.pUserData         = this;
+
+        auto const& playback      = _options.playback;
+        config.periodSizeInFrames = playback.period_frames;
+        config.periods            = playback.periods;
+        config.performanceProfile =
+            playback.low_latency ? ma_performance_profile_low_latency : ma_performance_profile_conservative;
+        config.playback.shareMode = playback.exclusive ? ma_share_mode_exclusive : ma_share_mode_shared;
+
+        _context = make_context(playback.backend);
+        if (playback.backend && !_context) {
+            fmt::println("failed to open the requested audio backend");
+            return false;
+        }
+
+        ma_result result = ma_device_init(_context.get(), &config, _device.get());
+        if (result != MA_SUCCESS && playback.exclusive) {
+            fmt::println("exclusive mode refused, falling back to shared mode");
+            config.playback.shareMode = ma_share_mode_shared;
+
+            result = ma_device_init(_context.get(), &config, _device.get());
+        }
+        if (result != MA_SUCCESS) {
+            fmt::println("failed to open playback device");
+            return false;
+        }
+
+        if (ma_device_start(_device.get()) != MA_SUCCESS) {
+            ma_device_uninit(_device.get());
+            fmt::println("failed to start playback device");
+            return false;
+        }
+
+        _device_started = true;
+        return true;
+    }
+
+    std::optional<Mixer::StreamId> Mixer::add(std::string const& file_name, float gain) {
+        auto source = open_source(file_name, _options.playback, format(), _cache.get());
+        if (!source) {
+            fmt::println("Could not load audio file: {:s}", file_name);
+            return std::nullopt;
+        }
+        return add(std::move(source), gain);
+    }
+
+    std::optional<Mixer::StreamId> Mixer::add(std::unique_ptr<AudioSource> source, float gain) {
+        Expects(source != nullptr);
+        Expects(source->format() == ma_format_f32);
+        Expects(source->channels() == _options.channels);
+        Expects(source->sample_rate() == _options.sample_rate);
+
+        std::scoped_lock lock{_sources_mutex};
+        auto const free = std::ranges::find_if(_sources, [](auto const& source) { return !source; });
+        if (free == _sources.end()) {
+            return std::nullopt;
+        }
+
+        auto const id = static_cast<StreamId>(std::distance(_sources.begin(), free));
+        auto& stream  = *_streams[id];
+        {
+            std::scoped_lock spectrum_lock{stream.spectrum_mutex};
+            stream.generation.fetch_add(1);
+            stream.first_position.store(stream.tap->write_position());
+            stream.spectrum.channels = 0;
+        }
+
+        // Prime the source before the callback can see it
+        source->start();
+        stream.gain.store(gain);
+        stream.source.store(source.get());
+        *free = std::move(source);
+        return id;
+    }
+
+    bool Mixer::remove(StreamId stream) {
+        std::scoped_lock lock{_sources_mutex};
+        if (stream >= _sources.size() || !_sources[stream]) {
+            return false;
+        }
+
+        _streams[stream]->source.store(nullptr);
+        _wait_for_callback();
+        _sources[stream].reset();
+        return true;
+    }
+
+    void Mixer::set_gain(StreamId stream, float gain) {
+        Expects(stream < _streams.size());
+        _streams[stream]->gain.store(gain);
+    }
+
+    void Mixer::set_master_gain(float gain) {
+        _master_gain.store(gain);
+    }
+
+    bool Mixer::finished(StreamId stream) const {
+        std::scoped_lock lock{_sources_mutex};
+        return stream >= _sources.size() || !_sources[stream] || _sources[stream]->finished();
+    }
+
+    std::size_t Mixer::stream_count() const {
+        std::scoped_lock lock{_sources_mutex};
+        return static_cast<std::size_t>(std::ranges::count_if(_sources, [](auto const& source) { return !!source; }));
+    }
+
+    HistoryRing const& Mixer::tap(StreamId stream) const {
+        Expects(stream < _streams.size());
+        return *_streams[stream]->tap;
+    }
+
+    bool Mixer::spectrum(StreamId stream, StreamSpectrum& spectrum) const {
+        Expects(stream < _streams.size());
+        auto const& slot = *_streams[stream];
+
+        std::scoped_lock lock{slot.spectrum_mutex};
+        if (slot.spectrum.channels == 0) {
+            return false;
+        }
+
+        spectrum.position = slot.spectrum.position;
+        spectrum.channels = slot.spectrum.channels;
+        spectrum.bins     = slot.spectrum.bins;
+        spectrum.magnitudes.assign(slot.spectrum.magnitudes.begin(), slot.spectrum.magnitudes.end());
+        return true;
+    }
+
+    FifoWatermark Mixer::fifo_watermark(StreamId stream) const {
+        std::scoped_lock lock{_sources_mutex};
+        if (stream >= _sources.size() || !_sources[stream]) {
+            return FifoWatermark{};
+        }
+        return _sources[stream]->watermark();
+    }
+
+    void Mixer::mix(float* output, std::uint32_t frame_count) {
+        // Odd while a mix runs, see `_wait_for_callback`
+        _callbacks.fetch_add(1);
+        auto const started = CallbackStats::clock::now();
+        auto const period  = std::chrono::nanoseconds{1'000'000'000ull * frame_count / _options.sample_rate};
+
+        auto const& kernels          = wt::kernels::kernels();
+        std::uint32_t const channels = _options.channels;
+        float const master_gain      = _master_gain.load(std::memory_order_relaxed);
+        bool underflow               = false;
+        std::fill_n(output, std::size_t{frame_count} * channels, 0.0f);
+
+        // Decoding happens on each source's thread, the spectra on the
+        // analysis threads. Here every stream is only copied into its tap
+        // and added into the output.
+        for (std::uint32_t done = 0; done < frame_count;) {
+            std::uint32_t const chunk = std::min(MIX_CHUNK_FRAMES, frame_count - done);
+            for (auto const& stream : _streams) {
+                auto* const source = stream->source.load();
+                if (source == nullptr) {
+                    continue;
+                }
+
+                // After a seek the tap gets the window before the new
+                // position first, as the player's tap does
+                auto const primer = source->take_primer();
+                if (!primer.empty()) {
+                    stream->tap->write(
+                        std::span{reinterpret_cast<float const*>(primer.data()), primer.size() / sizeof(float)});
+                }
+
+                std::uint32_t const read =
+                    source->read(_scratch.data(), chunk, stream->gain.load(std::memory_order_relaxed));
+                if (read > 0) {
+                    std::size_t const samples = std::size_t{read} * channels;
+                    stream->tap->write(std::span{_scratch.data(), samples});
+                    kernels.mix_f32(output + std::size_t{done} * channels, _scratch.data(), samples, master_gain);
+                }
+                underflow = underflow || (read < chunk && !source->finished());
+            }
+            done += chunk;
+        }
+
+        _stats.record(started, CallbackStats::clock::now(), period, frame_count, frame_count, underflow);
+        _callbacks.fetch_add(1);
+    }
+
+    PcmFormat Mixer::format() const {
+        return PcmFormat{ma_format_f32, _options.channels, _options.sample_rate};
+    }
+
+    CallbackStatsSnapshot Mixer::callback_stats() const {
+        return _stats.snapshot();
+    }
+
+    void Mixer::reset_callback_stats() {
+        _stats.reset();
+    }
+
+    void Mixer::_wait_for_callback() const {
+        // A mix that was running when the slot was cleared may still hold
+        // the source, any later one cannot find it
+        auto const entered = _callbacks.load();
+        if (entered % 2 == 1) {
+            while (_callbacks.load() == entered) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+        }
+    }
+
+    void Mixer::_analyse(std::stop_token const& stop, std::size_t first, std::size_t stride) {
+        std::uint32_t const channels = _options.channels;
+        constexpr std::size_t WINDOW = wt::analysis::WINDOW_SIZE;
+
+        // Everything the analysis needs is allocated here, once. The
+        // window and the magnitudes run inline with the FFT, as the bars do.
+        auto pipeline =
+            wt::analysis::make_pipeline<WINDOW>(wt::analysis::hann_windowing<WINDOW>(), wt::analysis::Magnitude{});
+        decltype(pipeline)::result_type magnitudes{};
+
+        std::vector<float> interleaved(WINDOW * channels);
+        std::vector<AnalysisWindow> windows(channels);
+        std::array<float*, MAX_CHANNELS> planes{};
+        for (std::uint32_t c = 0; c < channels; ++c) {
+            planes[c] = windows[c].data();
+        }
+
+        StreamSpectrum result{0, channels, static_cast<std::uint32_t>(BINS), std::vector<float>(channels * BINS)};
+        auto const& kernels = wt::kernels::kernels();
+
+        auto next = std::chrono::steady_clock::now();
+        while (!stop.stop_requested()) {
+            for (std::size_t i = first; i < _streams.size(); i += stride) {
+                auto& stream = *_streams[i];
+                if (stream.source.load() == nullptr) {
+                    continue;
+                }
+
+                auto const generation = stream.generation.load();
+                auto const written    = stream.tap->write_position();
+                if (written == stream.analysed_until || written < stream.first_position.load() + WINDOW) {
+                    continue;
+                }
+
+                // A window reaching back into the slot's previous stream is
+                // not this stream's spectrum
+                auto const position = stream.tap->read_latest(interleaved);
+                if (!position || *position < stream.first_position.load()) {
+                    continue;
+                }
+
+                kernels.deinterleave(planes.data(), interleaved.data(), WINDOW, channels);
+                for (std::uint32_t c = 0; c < channels; ++c) {
+                    pipeline.run(windows[c], magnitudes);
+                    std::ranges::copy(magnitudes, result.magnitudes.begin() + c * BINS);
+                }
+                result.position = *position;
+
+                // Swapping keeps both buffers allocated for the next round
+                std::scoped_lock lock{stream.spectrum_mutex};
+                if (stream.generation.load() == generation) {
+                    std::swap(stream.spectrum, result);
+                    result.channels = channels;
+                    result.bins     = static_cast<std::uint32_t>(BINS);
+                    result.magnitudes.resize(channels * BINS);
+                    stream.analysed_until = written;
+                }
+            }
+
+            // A round that overran starts the next one straight away,
+            // without trying to catch up on the ones it missed
+            next = std::max(next + _options.analysis_interval, std::chrono::steady_clock::now());
+            std::unique_lock lock{_analysis_mutex};
+            _analysis_wake.wait_until(lock, stop, next, [] { return false; });
+        }
+    }
+} // namespace wt
@@ -0,0 +1,180 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+#include "audio.hpp"
+#include "audio_source.hpp"
+#include "callback_stats.hpp"
+#include "history_ring.hpp"
+#include "pcm_cache.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <miniaudio.h>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace wt {
+
+    struct MixerOptions {
+        /// @brief Device buffering, backend, decode ahead, memory mapping and
+        /// cache, as for a single player. Every stream gets a tap holding
+        /// `history` of its audio.
+        AudioPlayerOptions playback{};
+
+        /// @brief The format the device plays, every stream is converted to
+        /// f32 at this rate and channel count on its own decode thread.
+        std::uint32_t sample_rate{48000};
+        std::uint32_t channels{2};
+
+        /// @brief The most streams mixed at once. Their taps and slots are
+        /// allocated up front, so adding a stream never touches the callback.
+        std::size_t max_streams{16};
+
+        /// @brief Threads analysing the streams' taps, 0 for one per core.
+        unsigned analysis_threads{0};
+
+        /// @brief How often each stream's spectrum is brought up to date.
+        std::chrono::milliseconds analysis_interval{10};
+    };
+
+    /// @brief The magnitude spectrum of the latest window of one stream.
+    struct StreamSpectrum {
+        /// @brief Position in the stream's tap of the first frame analysed.
+        std::uint64_t position;
+        /// @brief Zero until the stream has played a whole window.
+        std::uint32_t channels;
+        std::uint32_t bins;
+        /// @brief `bins` magnitudes for each channel, one after another.
+        std::vector<float> magnitudes;
+
+        [[nodiscard]] std::span<float const> channel(std::uint32_t channel) const;
+    };
+
+    /// @brief Mixes any number of sources into one device. Each stream
+    /// decodes on its own thread and gets its own analysis tap, which a pool
+    /// of worker threads turns into a spectrum per stream. The device
+    /// callback only reads every stream's frames, copies them into its tap
+    /// and adds them into the output.
+    class Mixer {
+    public:
+        using StreamId = std::size_t;
+
+        static void data_callback(ma_device* device, void* output, const void* input, std::uint32_t frame_count);
+
+        explicit Mixer(MixerOptions options = {});
+        ~Mixer();
+
+        Mixer(Mixer const&)            = delete;
+        Mixer& operator=(Mixer const&) = delete;
+
+        /// @brief Opens the device. Streams added before play from its
+        /// first period, later ones from the period after they are added.
+        bool start();
+
+        /// @brief Opens `file_name` converted to the mixer's format and
+        /// starts mixing it in.
+        /// @return the stream, or nothing if the file cannot be played or
+        /// every slot is taken.
+        std::optional<StreamId> add(std::string const& file_name, float gain = 1.0f);
+
+        /// @brief Starts mixing in a source already in the mixer's format.
+        std::optional<StreamId> add(std::unique_ptr<AudioSource> source, float gain = 1.0f);
+
+        /// @brief Stops mixing in `stream` and frees its source, waiting for
+        /// a callback that may still be reading it.
+        bool remove(StreamId stream);
+
+        void set_gain(StreamId stream, float gain);
+
+        /// @brief Scales the whole mix, 1 plays the streams as they are.
+        void set_master_gain(float gain);
+
+        /// @brief Whether `stream` has played to its end, or is not playing.
+        [[nodiscard]] bool finished(StreamId stream) const;
+
+        [[nodiscard]] std::size_t stream_count() const;
+
+        /// @brief The history of `stream`, at its own gain and before the
+        /// master gain. Positions carry on from the stream that used the
+        /// slot before, see `StreamSpectrum::position`.
+        [[nodiscard]] HistoryRing const& tap(StreamId stream) const;
+
+        /// @brief Copies the latest spectrum of `stream` into `spectrum`,
+        /// reusing its storage.
+        /// @return false if the stream has not been analysed yet.
+        bool spectrum(StreamId stream, StreamSpectrum& spectrum) const;
+
+        [[nodiscard]] FifoWatermark fifo_watermark(StreamId stream) const;
+
+        /// @brief Mixes `frame_count` frames of every stream into `output`,
+        /// all the device callback does. Only call it from one thread at a
+        /// time, and not while the device runs.
+        void mix(float* output, std::uint32_t frame_count);
+
+        [[nodiscard]] PcmFormat format() const;
+
+        /// @brief Timings and counts of the mixes since the device opened or
+        /// the last reset. An underflow is a mix any stream fell short in.
+        CallbackStatsSnapshot callback_stats() const;
+
+        void reset_callback_stats();
+
+    private:
+        struct Stream {
+            std::atomic<AudioSource*> source{nullptr};
+            std::atomic<float> gain{1.0f};
+            std::unique_ptr<HistoryRing> tap;
+
+            // Bumped whenever the slot takes a new stream, so an analysis
+            // of the old one is not published for the new one
+            std::atomic<std::uint64_t> generation{0};
+            // Tap position of the stream's first frame
+            std::atomic<std::uint64_t> first_position{0};
+
+            mutable std::mutex spectrum_mutex;
+            StreamSpectrum spectrum{};
+            // Tap position the spectrum was last brought up to, only
+            // touched by the analysis thread that owns the slot
+            std::uint64_t analysed_until{0};
+        };
+
+        /// Updates the spectra of every `stride`th stream from `first` on.
+        void _analyse(std::stop_token const& stop, std::size_t first, std::size_t stride);
+
+        /// Waits out a callback that may still be using a source taken off
+        /// its slot.
+        void _wait_for_callback() const;
+
+        MixerOptions _options;
+        std::unique_ptr<PcmCache> _cache;
+
+        // Fixed for the mixer's life, only what the slots point at changes
+        std::vector<std::unique_ptr<Stream>> _streams;
+        std::atomic<float> _master_gain;
+        std::atomic<std::uint64_t> _callbacks;
+        CallbackStats _stats;
+        std::vector<float> _scratch;
+
+        // Owns the sources the slots point at
+        mutable std::mutex _sources_mutex;
+        std::vector<std::unique_ptr<AudioSource>> _sources;
+
+        ContextPtr _context;
+        DevicePtr _device;
+        bool _device_started;
+
+        std::mutex _analysis_mutex;
+        std::condition_variable_any _analysis_wake;
+        std::vector<std::jthread> _analysis_threads;
+    };
+} // namespace wt
+
+#endif // MIXER_H
@@ -0,0 +1,167 @@
+#include "offline_analysis.hpp"
+
+#include <analysis/batch.hpp>
+
+#include <gsl/assert>
+#include <miniaudio.h>
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+    constexpr std::size_t DECODE_CHUNK   = 1 << 16;
+    constexpr std::uint32_t FILE_VERSION = 1;
+    constexpr std::array<char, 4> FILE_MAGIC{'W', 'T', 'S', 'G'};
+
+    // The file holds values in host order, keep it readable everywhere
+    // by only supporting the byte order every target we build has
+    static_assert(std::endian::native == std::endian::little);
+
+    struct FileHeader {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+        std::uint32_t sample_rate;
+        std::uint32_t window_size;
+        std::uint32_t hop;
+        std::uint32_t bins;
+        std::uint64_t windows;
+    };
+    static_assert(sizeof(FileHeader) == 32);
+} // namespace
+
+namespace wt::offline {
+
+    std::size_t Spectrogram::windows() const {
+        return bins == 0 ? 0 : magnitudes.size() / bins;
+    }
+
+    std::span<float const> Spectrogram::row(std::size_t window) const {
+        Expects(window < windows());
+        return std::span{magnitudes}.subspan(window * bins, bins);
+    }
+
+    std::optional<DecodedTrack> decode_file(std::string const& file_name) {
+        // Let the decoder downmix and convert, the analysis is mono f32
+        ma_decoder decoder;
+        ma_decoder_config const config = ma_decoder_config_init(ma_format_f32, 1, 0);
+        if (ma_decoder_init_file(file_name.c_str(), &config, &decoder) != MA_SUCCESS) {
+            return std::nullopt;
+        }
+
+        DecodedTrack track{decoder.outputSampleRate, {}};
+
+        // The length is only a hint, some formats cannot report it
+        ma_uint64 length = 0;
+        if (ma_decoder_get_length_in_pcm_frames(&decoder, &length) == MA_SUCCESS) {
+            track.samples.reserve(length);
+        }
+
+        std::size_t decoded_total = 0;
+        while (true) {
+            track.samples.resize(decoded_total + DECODE_CHUNK);
+
+            ma_uint64 decoded = 0;
+            ma_result const result =
+                ma_decoder_read_pcm_frames(&decoder, track.samples.data() + decoded_total, DECODE_CHUNK, &decoded);
+            decoded_total += decoded;
+            if (result != MA_SUCCESS || decoded < DECODE_CHUNK) {
+                break;
+            }
+        }
+
+        track.samples.resize(decoded_total);
+        ma_decoder_uninit(&decoder);
+        return track;
+    }
+
+    Spectrogram analyze_track(
+        DecodedTrack const& track, std::uint32_t hop, unsigned threads, std::size_t window_size) {
+        Expects(hop > 0);
+        Expects(threads > 0);
+        Expects(window_size >= 2 && window_size % 2 == 0);
+
+        wt::analysis::BatchAnalyzer const analyzer{window_size, threads};
+        std::size_t const bins    = analyzer.bins();
+        std::size_t const windows = analyzer.windows(track.samples.size(), hop);
+
+        // clang-format off
+        Spectrogram result{
+          .sample_rate = track.sample_rate,
+          .window_size = static_cast<std::uint32_t>(window_size),
+          .hop         = hop,
+          .bins        = static_cast<std::uint32_t>(bins),
+          .magnitudes  = std::vector<float>(windows * bins)
+        };
+        // clang-format on
+
+        analyzer.magnitudes(track.samples, result.magnitudes, hop);
+        return result;
+    }
+
+    bool write_spectrogram(Spectrogram const& spectrogram, std::string const& file_name) {
+        std::ofstream file{file_name, std::ios::binary | std::ios::trunc};
+        if (!file) {
+            return false;
+        }
+
+        // clang-format off
+        FileHeader const header{
+          .magic       = FILE_MAGIC,
+          .version     = FILE_VERSION,
+          .sample_rate = spectrogram.sample_rate,
+          .window_size = spectrogram.window_size,
+          .hop         = spectrogram.hop,
+          .bins        = spectrogram.bins,
+          .windows     = spectrogram.windows()
+        };
+        // clang-format on
+
+        file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        file.write(reinterpret_cast<char const*>(spectrogram.magnitudes.data()),
+            static_cast<std::streamsize>(spectrogram.magnitudes.size() * sizeof(float)));
+        return static_cast<bool>(file);
+    }
+
+    std::optional<Spectrogram> read_spectrogram(std::string const& file_name) {
+        std::ifstream file{file_name, std::ios::binary};
+        FileHeader header{};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            return std::nullopt;
+        }
+        if (header.magic != FILE_MAGIC || header.version != FILE_VERSION || header.bins == 0) {
+            return std::nullopt;
+        }
+
+        // The counts are only trusted as far as the file backs them, a
+        // truncated or corrupt one must not size the allocation
+        std::error_code error;
+        auto const file_size = std::filesystem::file_size(file_name, error);
+        if (error || file_size < sizeof(header)
+            || header.windows > (file_size - sizeof(header)) / sizeof(float) / header.bins) {
+            return std::nullopt;
+        }
+
+        // clang-format off
+        Spectrogram result{
+          .sample_rate = header.sample_rate,
+          .window_size = header.window_size,
+          .hop         = header.hop,
+          .bins        = header.bins,
+          .magnitudes  = std::vector<float>(header.windows * header.bins)
+        };
+        // clang-format on
+
+        if (!file.read(reinterpret_cast<char*>(result.magnitudes.data()),
+                static_cast<std::streamsize>(result.magnitudes.size() * sizeof(float)))) {
+            return std::nullopt;
+        }
+        return result;
+    }
+} // namespace wt::offline
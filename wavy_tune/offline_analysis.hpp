@@ -0,0 +1,54 @@
+#ifndef OFFLINE_ANALYSIS_H
+#define OFFLINE_ANALYSIS_H
+
+#include <analysis/window_size.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace wt::offline {
+
+    /// @brief A whole track decoded to mono f32.
+    struct DecodedTrack {
+        std::uint32_t sample_rate;
+        std::vector<float> samples;
+    };
+
+    /// @brief Magnitude spectra of consecutive windows of a track, one row
+    /// of `bins` values per window, rows stored back to back.
+    struct Spectrogram {
+        std::uint32_t sample_rate;
+        std::uint32_t window_size;
+        std::uint32_t hop;
+        std::uint32_t bins;
+        std::vector<float> magnitudes;
+
+        [[nodiscard]] std::size_t windows() const;
+        [[nodiscard]] std::span<float const> row(std::size_t window) const;
+    };
+
+    /// @brief Decodes `file_name` to the end, downmixed to one channel.
+    /// @return the track, or nothing if the file could not be decoded.
+    std::optional<DecodedTrack> decode_file(std::string const& file_name);
+
+    /// @brief Slices the track into Hann windowed analysis windows `hop`
+    /// samples apart and runs the FFT analyzer over them on `threads`
+    /// worker threads. The result does not depend on the thread count.
+    /// @param window_size samples per window, even.
+    Spectrogram analyze_track(DecodedTrack const& track, std::uint32_t hop, unsigned threads,
+        std::size_t window_size = analysis::WINDOW_SIZE);
+
+    /// @brief Writes the spectrogram as a small header followed by the raw
+    /// little endian magnitudes, see `read_spectrogram`.
+    /// @return whether the whole file was written.
+    bool write_spectrogram(Spectrogram const& spectrogram, std::string const& file_name);
+
+    /// @brief Reads back a file written by `write_spectrogram`.
+    std::optional<Spectrogram> read_spectrogram(std::string const& file_name);
+} // namespace wt::offline
+
+#endif // OFFLINE_ANALYSIS_H
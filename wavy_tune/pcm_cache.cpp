@@ -0,0 +1,398 @@
+#include "pcm_cache.hpp"
+#include "mapped_file.hpp"
+
+#include <fmt/base.h>
+#include <fmt/format.h>
+#include <gsl/assert>
+
+#include <miniaudio.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    constexpr std::uint32_t ENTRY_VERSION = 2;
+    constexpr std::array<char, 4> ENTRY_MAGIC{'W', 'T', 'P', 'C'};
+    constexpr std::string_view ENTRY_EXTENSION = ".wtpc";
+    constexpr std::string_view TEMP_EXTENSION  = ".tmp";
+
+    // Samples start on a page boundary, so the page cache maps them without
+    // the header sharing their first page
+    constexpr std::size_t DATA_OFFSET = 4096;
+
+    constexpr std::size_t WRITE_CHUNK_FRAMES = 1 << 14;
+
+    // Entries hold values in host order, like the spectrogram files
+    static_assert(std::endian::native == std::endian::little);
+
+    struct EntryHeader {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+        std::uint32_t channels;
+        std::uint32_t sample_rate;
+        std::uint64_t frames;
+        std::uint64_t file_hash;
+    };
+    static_assert(sizeof(EntryHeader) == 32);
+    static_assert(sizeof(EntryHeader) <= DATA_OFFSET);
+
+    std::uint64_t mix(std::uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xFF51AFD7ED558CCDull;
+        value ^= value >> 33;
+        value *= 0xC4CEB9FE1A85EC53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    bool is_entry(std::filesystem::path const& path) {
+        return path.extension() == ENTRY_EXTENSION;
+    }
+} // namespace
+
+namespace wt {
+
+    std::string PcmCacheKey::file_name() const {
+        return fmt::format("{:016x}-{}-{}{}", file_hash, channels, sample_rate, ENTRY_EXTENSION);
+    }
+
+    std::uint64_t hash_contents(std::span<std::byte const> bytes) {
+        // Eight bytes at a time keeps hashing well ahead of reading the
+        // file, the length goes in so that trailing zeros still count
+        std::uint64_t hash       = mix(bytes.size() + 0x9E3779B97F4A7C15ull);
+        std::size_t const blocks = bytes.size() / sizeof(std::uint64_t);
+        for (std::size_t i = 0; i < blocks; ++i) {
+            std::uint64_t block;
+            std::memcpy(&block, bytes.data() + i * sizeof(block), sizeof(block));
+            hash = (hash ^ mix(block)) * 0x9E3779B97F4A7C15ull;
+        }
+
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, bytes.data() + blocks * sizeof(tail), bytes.size() % sizeof(tail));
+        return mix(hash ^ tail);
+    }
+
+    std::optional<PcmLayout> parse_cache_entry(std::span<std::byte const> bytes) {
+        if (bytes.size() < DATA_OFFSET) {
+            return std::nullopt;
+        }
+
+        EntryHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (header.magic != ENTRY_MAGIC || header.version != ENTRY_VERSION || header.channels == 0
+            || header.sample_rate == 0) {
+            return std::nullopt;
+        }
+
+        // A short file is an entry whose write was cut off. Divided rather
+        // than multiplied, so a damaged frame count cannot wrap around
+        std::uint64_t const frame_bytes = std::uint64_t{header.channels} * sizeof(float);
+        if (header.frames > (bytes.size() - DATA_OFFSET) / frame_bytes) {
+            return std::nullopt;
+        }
+
+        // clang-format off
+        return PcmLayout{
+          .format      = ma_format_f32,
+          .channels    = header.channels,
+          .sample_rate = header.sample_rate,
+          .data_offset = DATA_OFFSET,
+          .frames      = header.frames
+        };
+        // clang-format on
+    }
+
+    PcmCache::PcmCache(std::filesystem::path directory, std::uint64_t budget_bytes)
+        : _directory{std::move(directory)},
+          _budget_bytes{budget_bytes},
+          _size_bytes{0},
+          _busy{false} {
+        std::error_code error;
+        std::filesystem::create_directories(_directory, error);
+
+        // Entries from earlier runs, in the order they were last played
+        struct Found {
+            std::filesystem::file_time_type played;
+            Entry entry;
+        };
+        std::vector<Found> found;
+        for (auto const& file : std::filesystem::directory_iterator{_directory, error}) {
+            if (file.path().extension() == TEMP_EXTENSION) {
+                // Left behind by a run that stopped mid write
+                std::filesystem::remove(file.path(), error);
+                continue;
+            }
+            if (!file.is_regular_file(error) || !is_entry(file.path())) {
+                continue;
+            }
+            found.push_back(
+                Found{file.last_write_time(error), Entry{file.path().filename().string(), file.file_size(error)}});
+        }
+
+        std::ranges::sort(found, [](Found const& lhs, Found const& rhs) { return lhs.played > rhs.played; });
+        for (auto& file : found) {
+            _size_bytes += file.entry.bytes;
+            _entries.push_back(std::move(file.entry));
+            _by_name.emplace(_entries.back().name, std::prev(_entries.end()));
+        }
+
+        {
+            std::scoped_lock lock{_mutex};
+            _evict();
+        }
+        _worker = std::jthread{[this](std::stop_token const& stop) { _run(stop); }};
+    }
+
+    std::optional<PcmCacheKey> PcmCache::key_for(
+        std::string const& file_name, std::optional<PcmFormat> const& target) {
+        std::error_code error;
+        auto const path = std::filesystem::canonical(file_name, error);
+        if (error) {
+            return std::nullopt;
+        }
+        auto const bytes    = std::filesystem::file_size(path, error);
+        auto const modified = std::filesystem::last_write_time(path, error);
+        if (error) {
+            return std::nullopt;
+        }
+
+        // Opening a decoder only reads the header, and gives the format it
+        // converts to whether or not there is a target
+        ma_decoder_config const config =
+            ma_decoder_config_init(ma_format_f32, target ? target->channels : 0, target ? target->sample_rate : 0);
+        ma_decoder decoder;
+        if (ma_decoder_init_file(path.string().c_str(), &config, &decoder) != MA_SUCCESS) {
+            return std::nullopt;
+        }
+        std::uint32_t const channels    = decoder.outputChannels;
+        std::uint32_t const sample_rate = decoder.outputSampleRate;
+        ma_decoder_uninit(&decoder);
+
+        auto const identity = fmt::format("{:s}\n{}\n{}", path.string(), bytes, modified.time_since_epoch().count());
+        // clang-format off
+        return PcmCacheKey{
+          .file_hash   = hash_contents(std::as_bytes(std::span{identity})),
+          .channels    = channels,
+          .sample_rate = sample_rate
+        };
+        // clang-format on
+    }
+
+    std::unique_ptr<AudioSource> PcmCache::open(PcmCacheKey const& key, std::chrono::milliseconds prefetch) {
+        auto const name = key.file_name();
+        {
+            std::scoped_lock lock{_mutex};
+            if (!_by_name.contains(name)) {
+                return nullptr;
+            }
+        }
+
+        auto file         = MappedFile::open((_directory / name).string());
+        auto const layout = file ? parse_cache_entry(file->bytes()) : std::nullopt;
+
+        std::scoped_lock lock{_mutex};
+        auto const entry = _by_name.find(name);
+        if (entry != _by_name.end() && !layout) {
+            fmt::println("dropping damaged cache entry {:s}", name);
+            std::error_code error;
+            std::filesystem::remove(_directory / name, error);
+            _size_bytes -= entry->second->bytes;
+            _entries.erase(entry->second);
+            _by_name.erase(entry);
+            return nullptr;
+        }
+
+        if (!layout) {
+            return nullptr;
+        }
+
+        // Evicted while it was being opened is still fine, the mapping
+        // keeps the samples around
+        if (entry != _by_name.end()) {
+            _touch(entry->second);
+        }
+        auto const prefetch_frames = static_cast<std::uint32_t>(prefetch.count() * layout->sample_rate / 1000);
+        return std::make_unique<MappedPcmSource>(std::move(file), *layout, prefetch_frames);
+    }
+
+    bool PcmCache::write(
+        PcmCacheKey const& key, std::uint32_t channels, std::uint32_t sample_rate, Producer const& produce) {
+        Expects(channels > 0);
+
+        auto const name = key.file_name();
+        auto const temp = _directory / (name + std::string{TEMP_EXTENSION});
+
+        // clang-format off
+        EntryHeader header{
+          .magic       = ENTRY_MAGIC,
+          .version     = ENTRY_VERSION,
+          .channels    = channels,
+          .sample_rate = sample_rate,
+          .frames      = 0,
+          .file_hash   = key.file_hash
+        };
+        // clang-format on
+        std::uint64_t data_bytes = 0;
+
+        {
+            std::ofstream file{temp, std::ios::binary | std::ios::trunc};
+            std::array<char, DATA_OFFSET> page{};
+            file.write(page.data(), page.size());
+
+            std::vector<float> chunk(WRITE_CHUNK_FRAMES * channels);
+            while (file) {
+                std::int64_t const frames = produce(chunk);
+                if (frames <= 0 || static_cast<std::uint64_t>(frames) > WRITE_CHUNK_FRAMES) {
+                    // More frames than fit in the chunk is as broken as an
+                    // error
+                    if (frames != 0) {
+                        file.setstate(std::ios::failbit);
+                    }
+                    break;
+                }
+
+                auto const chunk_bytes = static_cast<std::uint64_t>(frames) * channels * sizeof(float);
+                file.write(reinterpret_cast<char const*>(chunk.data()), static_cast<std::streamsize>(chunk_bytes));
+                header.frames += static_cast<std::uint64_t>(frames);
+                data_bytes += chunk_bytes;
+            }
+
+            // The header goes in last, so a cut off write never parses
+            file.seekp(0);
+            file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            if (!file || header.frames == 0) {
+                file.close();
+                std::error_code error;
+                std::filesystem::remove(temp, error);
+                return false;
+            }
+        }
+
+        std::uint64_t const bytes = DATA_OFFSET + data_bytes;
+
+        std::scoped_lock lock{_mutex};
+        std::error_code error;
+        std::filesystem::rename(temp, _directory / name, error);
+        if (error) {
+            std::filesystem::remove(temp, error);
+            return false;
+        }
+
+        if (auto const existing = _by_name.find(name); existing != _by_name.end()) {
+            _size_bytes -= existing->second->bytes;
+            _entries.erase(existing->second);
+            _by_name.erase(existing);
+        }
+        _entries.push_front(Entry{name, bytes});
+        _by_name.emplace(name, _entries.begin());
+        _size_bytes += bytes;
+        _evict();
+        return true;
+    }
+
+    void PcmCache::fill(std::string file_name, PcmCacheKey const& key) {
+        {
+            std::scoped_lock lock{_mutex};
+            if (_by_name.contains(key.file_name())
+                || std::ranges::any_of(_jobs, [&](Job const& job) { return job.key == key; })) {
+                return;
+            }
+            _jobs.push_back(Job{std::move(file_name), key});
+        }
+        _jobs_changed.notify_all();
+    }
+
+    void PcmCache::wait_idle() {
+        std::unique_lock lock{_mutex};
+        _jobs_changed.wait(lock, [this] { return _jobs.empty() && !_busy; });
+    }
+
+    bool PcmCache::contains(PcmCacheKey const& key) const {
+        std::scoped_lock lock{_mutex};
+        return _by_name.contains(key.file_name());
+    }
+
+    std::uint64_t PcmCache::size_bytes() const {
+        std::scoped_lock lock{_mutex};
+        return _size_bytes;
+    }
+
+    void PcmCache::_evict() {
+        // The newest entry stays even if it alone is over budget, it is
+        // about to be played
+        while (_size_bytes > _budget_bytes && _entries.size() > 1) {
+            Entry const& oldest = _entries.back();
+            std::error_code error;
+            std::filesystem::remove(_directory / oldest.name, error);
+            _size_bytes -= oldest.bytes;
+            _by_name.erase(oldest.name);
+            _entries.pop_back();
+        }
+    }
+
+    void PcmCache::_touch(std::list<Entry>::iterator entry) {
+        _entries.splice(_entries.begin(), _entries, entry);
+
+        // The modification time carries the play order over to the next run
+        std::error_code error;
+        std::filesystem::last_write_time(
+            _directory / entry->name, std::filesystem::file_time_type::clock::now(), error);
+    }
+
+    void PcmCache::_run(std::stop_token const& stop) {
+        while (true) {
+            Job job{};
+            {
+                std::unique_lock lock{_mutex};
+                if (!_jobs_changed.wait(lock, stop, [this] { return !_jobs.empty(); })) {
+                    return;
+                }
+                job = std::move(_jobs.front());
+                _jobs.pop_front();
+                _busy = true;
+            }
+
+            // Always f32, so that the entry maps straight into a device
+            // playing f32 without conversion
+            ma_decoder_config const config =
+                ma_decoder_config_init(ma_format_f32, job.key.channels, job.key.sample_rate);
+            ma_decoder decoder;
+            if (ma_decoder_init_file(job.file_name.c_str(), &config, &decoder) == MA_SUCCESS) {
+                bool const written = write(job.key, decoder.outputChannels, decoder.outputSampleRate,
+                    [&](std::span<float> frames) -> std::int64_t {
+                        if (stop.stop_requested()) {
+                            return -1;
+                        }
+
+                        ma_uint64 read         = 0;
+                        ma_result const result = ma_decoder_read_pcm_frames(
+                            &decoder, frames.data(), frames.size() / decoder.outputChannels, &read);
+                        if (result != MA_SUCCESS && result != MA_AT_END) {
+                            return -1;
+                        }
+                        return static_cast<std::int64_t>(read);
+                    });
+                ma_decoder_uninit(&decoder);
+
+                if (!written && !stop.stop_requested()) {
+                    fmt::println("could not cache {:s}", job.file_name);
+                }
+            }
+
+            {
+                std::scoped_lock lock{_mutex};
+                _busy = false;
+            }
+            _jobs_changed.notify_all();
+        }
+    }
+} // namespace wt
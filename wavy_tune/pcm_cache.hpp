@@ -0,0 +1,143 @@
+#ifndef PCM_CACHE_H
+#define PCM_CACHE_H
+
+#include "audio_source.hpp"
+#include "mapped_pcm_source.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace wt {
+
+    /// @brief Identifies a decoded track: what was decoded and how.
+    struct PcmCacheKey {
+        /// @brief Hash of the encoded file's path, size and modification
+        /// time, see `PcmCache::key_for`.
+        std::uint64_t file_hash;
+        /// @brief The channel count and rate the decoder put out.
+        std::uint32_t channels;
+        std::uint32_t sample_rate;
+
+        bool operator==(PcmCacheKey const&) const = default;
+
+        /// @brief The name of the entry's file inside the cache directory.
+        [[nodiscard]] std::string file_name() const;
+    };
+
+    /// @brief A fast, non-cryptographic 64 bit hash of `bytes`.
+    std::uint64_t hash_contents(std::span<std::byte const> bytes);
+
+    /// @brief Finds the interleaved f32 samples of a cache entry.
+    /// @return the layout, or nothing if `bytes` is not a complete entry.
+    std::optional<PcmLayout> parse_cache_entry(std::span<std::byte const> bytes);
+
+    /// @brief An on-disk cache of decoded tracks, so replaying a compressed
+    /// file costs a memory mapping instead of a decode. Entries hold f32
+    /// samples after a header padded to a page, so they play through a
+    /// `MappedPcmSource` straight from the page cache. The least recently
+    /// played entries are evicted once the cache outgrows its budget.
+    ///
+    /// Entries are written to a temporary file and renamed into place, so
+    /// a reader never sees half a track, even from another process.
+    class PcmCache {
+    public:
+        /// @brief Fills up to `frames.size() / channels` frames of f32
+        /// samples, returning how many it wrote, 0 at the end of the track
+        /// and a negative number to abandon the entry.
+        using Producer = std::function<std::int64_t(std::span<float> frames)>;
+
+        /// @param directory where the entries live, created if missing.
+        /// Entries already there are picked up, oldest played first.
+        /// @param budget_bytes the most the entries may take up on disk.
+        PcmCache(std::filesystem::path directory, std::uint64_t budget_bytes);
+
+        PcmCache(PcmCache const&)            = delete;
+        PcmCache& operator=(PcmCache const&) = delete;
+
+        /// @brief The key of `file_name` decoded to `target`'s channels and
+        /// rate, or to its own without one. Either way the key holds the
+        /// format the decoder resolves to, so a track first played with no
+        /// target has the same key when played again on the device it
+        /// opened.
+        ///
+        /// Only the file's header is read, the key stands for the file by
+        /// its path, size and modification time rather than its contents,
+        /// so nothing holds up the first sample.
+        /// @return the key, or nothing if the file cannot be decoded.
+        static std::optional<PcmCacheKey> key_for(
+            std::string const& file_name, std::optional<PcmFormat> const& target);
+
+        /// @brief Opens the entry for `key` as a source, marking it the most
+        /// recently played.
+        /// @param prefetch how far ahead of the play cursor to fault in.
+        /// @return the source, or nullptr on a miss.
+        std::unique_ptr<AudioSource> open(PcmCacheKey const& key, std::chrono::milliseconds prefetch);
+
+        /// @brief Writes the samples `produce` yields as the entry for `key`,
+        /// then evicts down to the budget.
+        /// @return whether the entry was written.
+        bool write(PcmCacheKey const& key, std::uint32_t channels, std::uint32_t sample_rate, Producer const& produce);
+
+        /// @brief Decodes `file_name` into the entry for `key` on the cache's
+        /// own thread. Does nothing if the entry exists or is already queued.
+        void fill(std::string file_name, PcmCacheKey const& key);
+
+        /// @brief Blocks until every queued fill has finished.
+        void wait_idle();
+
+        [[nodiscard]] bool contains(PcmCacheKey const& key) const;
+
+        /// @brief The bytes the entries take up on disk.
+        [[nodiscard]] std::uint64_t size_bytes() const;
+
+    private:
+        struct Entry {
+            std::string name;
+            std::uint64_t bytes;
+        };
+
+        struct Job {
+            std::string file_name;
+            PcmCacheKey key;
+        };
+
+        /// Removes the least recently played entries until under budget.
+        /// Expects `_mutex` to be held.
+        void _evict();
+
+        /// Moves an entry to the front of the play order. Expects `_mutex`
+        /// to be held.
+        void _touch(std::list<Entry>::iterator entry);
+
+        void _run(std::stop_token const& stop);
+
+        std::filesystem::path _directory;
+        std::uint64_t _budget_bytes;
+
+        mutable std::mutex _mutex;
+        // Most recently played first
+        std::list<Entry> _entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> _by_name;
+        std::uint64_t _size_bytes;
+
+        std::deque<Job> _jobs;
+        bool _busy;
+        std::condition_variable_any _jobs_changed;
+        std::jthread _worker;
+    };
+} // namespace wt
+
+#endif // PCM_CACHE_H
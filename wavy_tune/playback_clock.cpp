@@ -0,0 +1,94 @@
+#include "playback_clock.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // How far each tick later than the origin pulls it, about a second of
+    // 10ms periods to settle
+    constexpr double SMOOTHING = 1.0 / 64;
+
+    // Ticks this many of their own periods after the origin restart it
+    constexpr double RESYNC_PERIODS = 4;
+
+    constexpr double NANOS = 1e9;
+
+    double nanoseconds(wt::PlaybackClock::clock::time_point time) {
+        return static_cast<double>(std::chrono::nanoseconds{time.time_since_epoch()}.count());
+    }
+} // namespace
+
+namespace wt {
+
+    PlaybackClock::PlaybackClock()
+        : _sample_rate{0},
+          _latency{0},
+          _origin_estimate{0},
+          _origin{NO_ORIGIN},
+          _end{0} {}
+
+    void PlaybackClock::start(std::uint32_t sample_rate, std::chrono::nanoseconds latency) {
+        Expects(sample_rate > 0);
+        _sample_rate = sample_rate;
+        _latency     = latency;
+        _origin.store(NO_ORIGIN, std::memory_order_relaxed);
+        _end.store(0, std::memory_order_relaxed);
+    }
+
+    void PlaybackClock::tick(std::uint64_t position, std::uint32_t frames, clock::time_point when) {
+        Expects(_sample_rate > 0);
+
+        double const heard  = nanoseconds(when + _latency);
+        double const origin = heard - static_cast<double>(position) * NANOS / _sample_rate;
+        double const period = static_cast<double>(frames) * NANOS / _sample_rate;
+
+        if (_origin.load(std::memory_order_relaxed) == NO_ORIGIN
+            || origin - _origin_estimate > RESYNC_PERIODS * period) {
+            _origin_estimate = origin;
+        } else if (origin < _origin_estimate) {
+            _origin_estimate = origin;
+        } else {
+            _origin_estimate += (origin - _origin_estimate) * SMOOTHING;
+        }
+
+        _end.store(position + frames, std::memory_order_relaxed);
+        _origin.store(std::llround(_origin_estimate), std::memory_order_release);
+    }
+
+    std::optional<std::uint64_t> PlaybackClock::audible_position(clock::time_point at) const {
+        auto const origin = _origin.load(std::memory_order_acquire);
+        if (origin == NO_ORIGIN) {
+            return std::nullopt;
+        }
+
+        double const elapsed = nanoseconds(at) - static_cast<double>(origin);
+        if (elapsed < 0) {
+            return std::nullopt;
+        }
+
+        // Past the last frame handed over, the device is paused or starved
+        auto const position = static_cast<std::uint64_t>(elapsed * _sample_rate / NANOS);
+        return std::min(position, _end.load(std::memory_order_relaxed));
+    }
+
+    std::optional<PlaybackClock::clock::time_point> PlaybackClock::audible_time(std::uint64_t position) const {
+        auto const origin = _origin.load(std::memory_order_acquire);
+        if (origin == NO_ORIGIN) {
+            return std::nullopt;
+        }
+
+        auto const offset = std::llround(static_cast<double>(position) * NANOS / _sample_rate);
+        auto const heard  = std::chrono::nanoseconds{origin + offset};
+        return clock::time_point{std::chrono::duration_cast<clock::duration>(heard)};
+    }
+
+    std::uint32_t PlaybackClock::sample_rate() const {
+        return _sample_rate;
+    }
+
+    std::chrono::nanoseconds PlaybackClock::latency() const {
+        return _latency;
+    }
+} // namespace wt
@@ -0,0 +1,73 @@
+#ifndef PLAYBACK_CLOCK_H
+#define PLAYBACK_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+namespace wt {
+
+    /// @brief Maps tap positions to the time they are heard.
+    ///
+    /// The device callback ticks the clock with the tap position of the
+    /// first frame it hands to the device and when it ran. That frame is
+    /// heard one output latency later, which gives the time tap position
+    /// zero would be heard at, the origin. Callbacks only ever run late,
+    /// so the origin follows the earliest ticks at once and later ones
+    /// slowly, which irons out the scheduling jitter while still tracking
+    /// drift between the device and the system clock. A tick too far after
+    /// the origin, after a pause or an underrun, starts over from it.
+    ///
+    /// Any thread can read the clock, none of it locks or allocates.
+    class PlaybackClock {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        PlaybackClock();
+
+        PlaybackClock(PlaybackClock const&)            = delete;
+        PlaybackClock& operator=(PlaybackClock const&) = delete;
+
+        /// @brief Sets the rate of the tap and how long the device takes
+        /// from a callback to the speaker, forgetting any earlier ticks.
+        /// Must happen before the device starts ticking.
+        void start(std::uint32_t sample_rate, std::chrono::nanoseconds latency);
+
+        /// @brief Records a callback. Only one thread may tick.
+        /// @param position the tap position of the first frame the callback
+        /// handed to the device.
+        /// @param frames how many frames it handed over.
+        /// @param when when the callback started.
+        void tick(std::uint64_t position, std::uint32_t frames, clock::time_point when);
+
+        /// @brief The tap position being heard at `at`, at most one past the
+        /// last frame handed to the device.
+        /// @return nothing before the first tick, or if nothing is heard yet.
+        [[nodiscard]] std::optional<std::uint64_t> audible_position(clock::time_point at = clock::now()) const;
+
+        /// @brief When the frame at `position` is, or was, heard.
+        /// @return nothing before the first tick.
+        [[nodiscard]] std::optional<clock::time_point> audible_time(std::uint64_t position) const;
+
+        [[nodiscard]] std::uint32_t sample_rate() const;
+        [[nodiscard]] std::chrono::nanoseconds latency() const;
+
+    private:
+        static constexpr std::int64_t NO_ORIGIN = std::numeric_limits<std::int64_t>::min();
+
+        std::uint32_t _sample_rate;
+        std::chrono::nanoseconds _latency;
+
+        // Only the ticking thread touches the unrounded origin
+        double _origin_estimate;
+
+        // When tap position zero is heard, in nanoseconds of `clock`, and
+        // one past the last frame handed to the device
+        std::atomic<std::int64_t> _origin;
+        std::atomic<std::uint64_t> _end;
+    };
+} // namespace wt
+
+#endif // PLAYBACK_CLOCK_H
@@ -0,0 +1,488 @@
+#include "sample_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define WT_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// GCC and Clang only emit wider instructions in functions that ask for
+// them, MSVC emits any intrinsic it is given.
+#if defined(__GNUC__) || defined(__clang__)
+#define WT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define WT_TARGET(isa)
+#endif
+
+namespace {
+
+    constexpr float S16_SCALE = 1.0f / 32768.0f;
+    constexpr float S32_SCALE = 1.0f / 2147483648.0f;
+
+    // Largest floats that still convert into the integer range
+    constexpr float S16_MAX = 32767.0f;
+    constexpr float S16_MIN = -32768.0f;
+    constexpr float S32_MAX = 2147483520.0f;
+    constexpr float S32_MIN = -2147483648.0f;
+
+    // MARK: Scalar kernels, also used for the vector tails
+
+    void gain_f32_scalar(float* dst, float const* src, std::size_t n, float gain) {
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] = src[i] * gain;
+        }
+    }
+
+    void mix_f32_scalar(float* dst, float const* src, std::size_t n, float gain) {
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] += src[i] * gain;
+        }
+    }
+
+    void gain_s16_scalar(std::int16_t* dst, std::int16_t const* src, std::size_t n, float gain) {
+        for (std::size_t i = 0; i < n; ++i) {
+            float const scaled = std::clamp(src[i] * gain, S16_MIN, S16_MAX);
+            dst[i]             = static_cast<std::int16_t>(std::lrintf(scaled));
+        }
+    }
+
+    void gain_s32_scalar(std::int32_t* dst, std::int32_t const* src, std::size_t n, float gain) {
+        for (std::size_t i = 0; i < n; ++i) {
+            float const scaled = std::clamp(static_cast<float>(src[i]) * gain, S32_MIN, S32_MAX);
+            dst[i]             = static_cast<std::int32_t>(std::lrintf(scaled));
+        }
+    }
+
+    void s16_to_f32_scalar(float* dst, std::int16_t const* src, std::size_t n, float gain) {
+        float const scale = S16_SCALE * gain;
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] = src[i] * scale;
+        }
+    }
+
+    void s32_to_f32_scalar(float* dst, std::int32_t const* src, std::size_t n, float gain) {
+        float const scale = S32_SCALE * gain;
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] = static_cast<float>(src[i]) * scale;
+        }
+    }
+
+    void deinterleave_scalar(float* const* dst, float const* src, std::size_t frames, std::uint32_t channels) {
+        for (std::size_t i = 0; i < frames; ++i) {
+            for (std::uint32_t c = 0; c < channels; ++c) {
+                dst[c][i] = src[i * channels + c];
+            }
+        }
+    }
+
+    void mid_side_scalar(float* mid, float* side, float const* left, float const* right, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            mid[i]  = (left[i] + right[i]) * 0.5f;
+            side[i] = (left[i] - right[i]) * 0.5f;
+        }
+    }
+
+    constexpr wt::kernels::SampleKernels SCALAR_KERNELS{
+        wt::kernels::InstructionSet::scalar,
+        gain_f32_scalar,
+        gain_s16_scalar,
+        gain_s32_scalar,
+        s16_to_f32_scalar,
+        s32_to_f32_scalar,
+        deinterleave_scalar,
+        mid_side_scalar,
+        mix_f32_scalar,
+    };
+
+#ifdef WT_KERNELS_X86
+
+    // MARK: SSE2 kernels, 4 samples per step
+
+    WT_TARGET("sse2") void gain_f32_sse2(float* dst, float const* src, std::size_t n, float gain) {
+        __m128 const g = _mm_set1_ps(gain);
+        std::size_t i  = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), g));
+        }
+        gain_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("sse2") void mix_f32_sse2(float* dst, float const* src, std::size_t n, float gain) {
+        __m128 const g = _mm_set1_ps(gain);
+        std::size_t i  = 0;
+        for (; i + 4 <= n; i += 4) {
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+        }
+        mix_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("sse2") void gain_s16_sse2(std::int16_t* dst, std::int16_t const* src, std::size_t n, float gain) {
+        __m128 const g = _mm_set1_ps(gain);
+        std::size_t i  = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m128i const in = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+            __m128 const lo  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16));
+            __m128 const hi  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16));
+
+            // packs saturates back into the 16 bit range
+            __m128i const out =
+                _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(lo, g)), _mm_cvtps_epi32(_mm_mul_ps(hi, g)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+        }
+        gain_s16_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("sse2") void gain_s32_sse2(std::int32_t* dst, std::int32_t const* src, std::size_t n, float gain) {
+        __m128 const g    = _mm_set1_ps(gain);
+        __m128 const high = _mm_set1_ps(S32_MAX);
+        __m128 const low  = _mm_set1_ps(S32_MIN);
+        std::size_t i     = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128 const in     = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i)));
+            __m128 const scaled = _mm_max_ps(_mm_min_ps(_mm_mul_ps(in, g), high), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_epi32(scaled));
+        }
+        gain_s32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("sse2") void s16_to_f32_sse2(float* dst, std::int16_t const* src, std::size_t n, float gain) {
+        __m128 const scale = _mm_set1_ps(S16_SCALE * gain);
+        std::size_t i      = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m128i const in = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+            __m128 const lo  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16));
+            __m128 const hi  = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16));
+            _mm_storeu_ps(dst + i, _mm_mul_ps(lo, scale));
+            _mm_storeu_ps(dst + i + 4, _mm_mul_ps(hi, scale));
+        }
+        s16_to_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("sse2") void s32_to_f32_sse2(float* dst, std::int32_t const* src, std::size_t n, float gain) {
+        __m128 const scale = _mm_set1_ps(S32_SCALE * gain);
+        std::size_t i      = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128 const in = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i)));
+            _mm_storeu_ps(dst + i, _mm_mul_ps(in, scale));
+        }
+        s32_to_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("sse2")
+    void deinterleave_sse2(float* const* dst, float const* src, std::size_t frames, std::uint32_t channels) {
+        if (channels != 2) {
+            deinterleave_scalar(dst, src, frames, channels);
+            return;
+        }
+
+        std::size_t i = 0;
+        for (; i + 4 <= frames; i += 4) {
+            __m128 const a = _mm_loadu_ps(src + 2 * i);
+            __m128 const b = _mm_loadu_ps(src + 2 * i + 4);
+            _mm_storeu_ps(dst[0] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(dst[1] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+        float* const tail[] = {dst[0] + i, dst[1] + i};
+        deinterleave_scalar(tail, src + 2 * i, frames - i, 2);
+    }
+
+    WT_TARGET("sse2")
+    void mid_side_sse2(float* mid, float* side, float const* left, float const* right, std::size_t n) {
+        __m128 const half = _mm_set1_ps(0.5f);
+        std::size_t i     = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128 const l = _mm_loadu_ps(left + i);
+            __m128 const r = _mm_loadu_ps(right + i);
+            _mm_storeu_ps(mid + i, _mm_mul_ps(_mm_add_ps(l, r), half));
+            _mm_storeu_ps(side + i, _mm_mul_ps(_mm_sub_ps(l, r), half));
+        }
+        mid_side_scalar(mid + i, side + i, left + i, right + i, n - i);
+    }
+
+    // MARK: AVX2 kernels, 8 samples per step
+
+    WT_TARGET("avx2") void gain_f32_avx2(float* dst, float const* src, std::size_t n, float gain) {
+        __m256 const g = _mm256_set1_ps(gain);
+        std::size_t i  = 0;
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+        }
+        gain_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx2") void mix_f32_avx2(float* dst, float const* src, std::size_t n, float gain) {
+        __m256 const g = _mm256_set1_ps(gain);
+        std::size_t i  = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 const scaled = _mm256_mul_ps(_mm256_loadu_ps(src + i), g);
+            _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), scaled));
+        }
+        mix_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx2") void gain_s16_avx2(std::int16_t* dst, std::int16_t const* src, std::size_t n, float gain) {
+        __m256 const g = _mm256_set1_ps(gain);
+        std::size_t i  = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m128i const in_lo = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+            __m128i const in_hi = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i + 8));
+            __m256 const lo     = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(in_lo)), g);
+            __m256 const hi     = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(in_hi)), g);
+
+            // packs works per 128 bit lane, so the quadwords come out
+            // interleaved and need putting back in order
+            __m256i const packed = _mm256_packs_epi32(_mm256_cvtps_epi32(lo), _mm256_cvtps_epi32(hi));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+        gain_s16_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx2") void gain_s32_avx2(std::int32_t* dst, std::int32_t const* src, std::size_t n, float gain) {
+        __m256 const g    = _mm256_set1_ps(gain);
+        __m256 const high = _mm256_set1_ps(S32_MAX);
+        __m256 const low  = _mm256_set1_ps(S32_MIN);
+        std::size_t i     = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 const in     = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i)));
+            __m256 const scaled = _mm256_max_ps(_mm256_min_ps(_mm256_mul_ps(in, g), high), low);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cvtps_epi32(scaled));
+        }
+        gain_s32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx2") void s16_to_f32_avx2(float* dst, std::int16_t const* src, std::size_t n, float gain) {
+        __m256 const scale = _mm256_set1_ps(S16_SCALE * gain);
+        std::size_t i      = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m128i const in = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(in)), scale));
+        }
+        s16_to_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx2") void s32_to_f32_avx2(float* dst, std::int32_t const* src, std::size_t n, float gain) {
+        __m256 const scale = _mm256_set1_ps(S32_SCALE * gain);
+        std::size_t i      = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 const in = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i)));
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(in, scale));
+        }
+        s32_to_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx2")
+    void deinterleave_avx2(float* const* dst, float const* src, std::size_t frames, std::uint32_t channels) {
+        if (channels != 2) {
+            deinterleave_scalar(dst, src, frames, channels);
+            return;
+        }
+
+        std::size_t i = 0;
+        for (; i + 8 <= frames; i += 8) {
+            __m256 const a = _mm256_loadu_ps(src + 2 * i);
+            __m256 const b = _mm256_loadu_ps(src + 2 * i + 8);
+
+            // The shuffles work per 128 bit lane, which leaves the pairs of
+            // samples out of order across lanes
+            __m256d const left  = _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            __m256d const right = _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            _mm256_storeu_ps(dst[0] + i, _mm256_castpd_ps(_mm256_permute4x64_pd(left, 0xD8)));
+            _mm256_storeu_ps(dst[1] + i, _mm256_castpd_ps(_mm256_permute4x64_pd(right, 0xD8)));
+        }
+        float* const tail[] = {dst[0] + i, dst[1] + i};
+        deinterleave_scalar(tail, src + 2 * i, frames - i, 2);
+    }
+
+    WT_TARGET("avx2")
+    void mid_side_avx2(float* mid, float* side, float const* left, float const* right, std::size_t n) {
+        __m256 const half = _mm256_set1_ps(0.5f);
+        std::size_t i     = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 const l = _mm256_loadu_ps(left + i);
+            __m256 const r = _mm256_loadu_ps(right + i);
+            _mm256_storeu_ps(mid + i, _mm256_mul_ps(_mm256_add_ps(l, r), half));
+            _mm256_storeu_ps(side + i, _mm256_mul_ps(_mm256_sub_ps(l, r), half));
+        }
+        mid_side_scalar(mid + i, side + i, left + i, right + i, n - i);
+    }
+
+    // MARK: AVX-512 kernels, 16 samples per step
+
+    // GCC 12 flags the deliberately undefined registers inside its own
+    // AVX-512 conversion intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+    WT_TARGET("avx512f") void gain_f32_avx512(float* dst, float const* src, std::size_t n, float gain) {
+        __m512 const g = _mm512_set1_ps(gain);
+        std::size_t i  = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_loadu_ps(src + i), g));
+        }
+        gain_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx512f") void mix_f32_avx512(float* dst, float const* src, std::size_t n, float gain) {
+        __m512 const g = _mm512_set1_ps(gain);
+        std::size_t i  = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512 const scaled = _mm512_mul_ps(_mm512_loadu_ps(src + i), g);
+            _mm512_storeu_ps(dst + i, _mm512_add_ps(_mm512_loadu_ps(dst + i), scaled));
+        }
+        mix_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx512f")
+    void gain_s16_avx512(std::int16_t* dst, std::int16_t const* src, std::size_t n, float gain) {
+        __m512 const g = _mm512_set1_ps(gain);
+        std::size_t i  = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m256i const in = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+            __m512 const out = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(in)), g);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(out)));
+        }
+        gain_s16_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx512f")
+    void gain_s32_avx512(std::int32_t* dst, std::int32_t const* src, std::size_t n, float gain) {
+        __m512 const g    = _mm512_set1_ps(gain);
+        __m512 const high = _mm512_set1_ps(S32_MAX);
+        __m512 const low  = _mm512_set1_ps(S32_MIN);
+        std::size_t i     = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512 const in     = _mm512_cvtepi32_ps(_mm512_loadu_si512(src + i));
+            __m512 const scaled = _mm512_max_ps(_mm512_min_ps(_mm512_mul_ps(in, g), high), low);
+            _mm512_storeu_si512(dst + i, _mm512_cvtps_epi32(scaled));
+        }
+        gain_s32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx512f") void s16_to_f32_avx512(float* dst, std::int16_t const* src, std::size_t n, float gain) {
+        __m512 const scale = _mm512_set1_ps(S16_SCALE * gain);
+        std::size_t i      = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m256i const in = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+            _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(in)), scale));
+        }
+        s16_to_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx512f") void s32_to_f32_avx512(float* dst, std::int32_t const* src, std::size_t n, float gain) {
+        __m512 const scale = _mm512_set1_ps(S32_SCALE * gain);
+        std::size_t i      = 0;
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_loadu_si512(src + i)), scale));
+        }
+        s32_to_f32_scalar(dst + i, src + i, n - i, gain);
+    }
+
+    WT_TARGET("avx512f")
+    void deinterleave_avx512(float* const* dst, float const* src, std::size_t frames, std::uint32_t channels) {
+        if (channels != 2) {
+            deinterleave_scalar(dst, src, frames, channels);
+            return;
+        }
+
+        // Indices 0-15 pick from the first register, 16-31 from the second
+        __m512i const even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        __m512i const odd  = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+        std::size_t i      = 0;
+        for (; i + 16 <= frames; i += 16) {
+            __m512 const a = _mm512_loadu_ps(src + 2 * i);
+            __m512 const b = _mm512_loadu_ps(src + 2 * i + 16);
+            _mm512_storeu_ps(dst[0] + i, _mm512_permutex2var_ps(a, even, b));
+            _mm512_storeu_ps(dst[1] + i, _mm512_permutex2var_ps(a, odd, b));
+        }
+        float* const tail[] = {dst[0] + i, dst[1] + i};
+        deinterleave_scalar(tail, src + 2 * i, frames - i, 2);
+    }
+
+    WT_TARGET("avx512f")
+    void mid_side_avx512(float* mid, float* side, float const* left, float const* right, std::size_t n) {
+        __m512 const half = _mm512_set1_ps(0.5f);
+        std::size_t i     = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m512 const l = _mm512_loadu_ps(left + i);
+            __m512 const r = _mm512_loadu_ps(right + i);
+            _mm512_storeu_ps(mid + i, _mm512_mul_ps(_mm512_add_ps(l, r), half));
+            _mm512_storeu_ps(side + i, _mm512_mul_ps(_mm512_sub_ps(l, r), half));
+        }
+        mid_side_scalar(mid + i, side + i, left + i, right + i, n - i);
+    }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+    constexpr wt::kernels::SampleKernels SSE2_KERNELS{
+        wt::kernels::InstructionSet::sse2,
+        gain_f32_sse2,
+        gain_s16_sse2,
+        gain_s32_sse2,
+        s16_to_f32_sse2,
+        s32_to_f32_sse2,
+        deinterleave_sse2,
+        mid_side_sse2,
+        mix_f32_sse2,
+    };
+
+    constexpr wt::kernels::SampleKernels AVX2_KERNELS{
+        wt::kernels::InstructionSet::avx2,
+        gain_f32_avx2,
+        gain_s16_avx2,
+        gain_s32_avx2,
+        s16_to_f32_avx2,
+        s32_to_f32_avx2,
+        deinterleave_avx2,
+        mid_side_avx2,
+        mix_f32_avx2,
+    };
+
+    constexpr wt::kernels::SampleKernels AVX512_KERNELS{
+        wt::kernels::InstructionSet::avx512,
+        gain_f32_avx512,
+        gain_s16_avx512,
+        gain_s32_avx512,
+        s16_to_f32_avx512,
+        s32_to_f32_avx512,
+        deinterleave_avx512,
+        mid_side_avx512,
+        mix_f32_avx512,
+    };
+
+#endif // WT_KERNELS_X86
+} // namespace
+
+namespace wt::kernels {
+
+    SampleKernels const& kernels() {
+        static SampleKernels const& selected = *kernels_for(detect_instruction_set());
+        return selected;
+    }
+
+    SampleKernels const* kernels_for(InstructionSet instruction_set) {
+        if (static_cast<int>(instruction_set) > static_cast<int>(detect_instruction_set())) {
+            return nullptr;
+        }
+
+        switch (instruction_set) {
+#ifdef WT_KERNELS_X86
+        case InstructionSet::sse2:
+            return &SSE2_KERNELS;
+        case InstructionSet::avx2:
+            return &AVX2_KERNELS;
+        case InstructionSet::avx512:
+            return &AVX512_KERNELS;
+#endif
+        default:
+            return &SCALAR_KERNELS;
+        }
+    }
+} // namespace wt::kernels
@@ -0,0 +1,48 @@
+#ifndef SAMPLE_KERNELS_H
+#define SAMPLE_KERNELS_H
+
+#include <analysis/instruction_set.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace wt::kernels {
+
+    /// @brief Sample format conversion and gain kernels for one
+    /// instruction set. All of them take unaligned pointers of any length,
+    /// `n` counts samples (frames times channels), and integer samples
+    /// are scaled to [-1, 1) when converted to floats. Only stereo
+    /// deinterleaving is vectorised, other layouts use the scalar loop.
+    struct SampleKernels {
+        InstructionSet instruction_set;
+
+        /// dst[i] = src[i] * gain, `dst` may alias `src`
+        void (*gain_f32)(float* dst, float const* src, std::size_t n, float gain);
+        /// dst[i] = saturate(src[i] * gain), `dst` may alias `src`
+        void (*gain_s16)(std::int16_t* dst, std::int16_t const* src, std::size_t n, float gain);
+        /// dst[i] = saturate(src[i] * gain), `dst` may alias `src`
+        void (*gain_s32)(std::int32_t* dst, std::int32_t const* src, std::size_t n, float gain);
+        /// dst[i] = src[i] / 2^15 * gain
+        void (*s16_to_f32)(float* dst, std::int16_t const* src, std::size_t n, float gain);
+        /// dst[i] = src[i] / 2^31 * gain
+        void (*s32_to_f32)(float* dst, std::int32_t const* src, std::size_t n, float gain);
+
+        /// dst[c][i] = src[i * channels + c], for `frames` frames
+        void (*deinterleave)(float* const* dst, float const* src, std::size_t frames, std::uint32_t channels);
+        /// mid[i] = (left[i] + right[i]) / 2, side[i] = (left[i] - right[i]) / 2
+        void (*mid_side)(float* mid, float* side, float const* left, float const* right, std::size_t n);
+        /// dst[i] += src[i] * gain
+        void (*mix_f32)(float* dst, float const* src, std::size_t n, float gain);
+    };
+
+    /// @brief The kernels for the detected instruction set, chosen once
+    /// on first use.
+    SampleKernels const& kernels();
+
+    /// @brief The kernels for a given instruction set, used by tests and
+    /// benchmarks to compare implementations.
+    /// @return the kernels, or nullptr if the CPU cannot run them.
+    SampleKernels const* kernels_for(InstructionSet instruction_set);
+} // namespace wt::kernels
+
+#endif // SAMPLE_KERNELS_H
@@ -0,0 +1,319 @@
+#include "seek_index.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace {
+
+    constexpr std::uint32_t FILE_VERSION = 1;
+    constexpr std::array<char, 4> FILE_MAGIC{'W', 'T', 'S', 'K'};
+
+    // Bytes of earlier frames a layer III frame can borrow, and how far
+    // back a point may start to get that many
+    constexpr std::uint32_t MAX_RESERVOIR_BYTES = 511;
+    constexpr std::size_t MAX_LEAD_FRAMES       = 16;
+
+    // How far into the file to look for the first frame
+    constexpr std::size_t MAX_SYNC_BYTES = 1 << 16;
+
+    // The file holds values in host order, like the spectrogram files
+    static_assert(std::endian::native == std::endian::little);
+
+    struct FileHeader {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+        std::uint32_t sample_rate;
+        std::uint32_t reserved;
+        std::uint64_t file_size;
+        std::int64_t file_modified;
+        std::uint64_t frames;
+        std::uint64_t points;
+    };
+    static_assert(sizeof(FileHeader) == 48);
+
+    struct FileStamp {
+        std::uint64_t size;
+        std::int64_t modified;
+    };
+
+    struct FrameHeader {
+        bool mpeg1;
+        std::uint32_t sample_rate;
+        std::uint32_t samples;
+        std::size_t length;
+        // Bytes before the side info, the header and its optional CRC
+        std::size_t side_info_offset;
+        std::size_t side_info_bytes;
+    };
+
+    // What a decoder starting mid-stream needs to know about each frame
+    struct FrameInfo {
+        std::uint64_t offset;
+        std::uint32_t main_data_begin;
+        std::uint32_t main_data_bytes;
+    };
+
+    // Bitrates in kbps by the header's bitrate index
+    constexpr std::array<std::uint32_t, 15> MPEG1_KBPS{
+        0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320};
+    constexpr std::array<std::uint32_t, 15> MPEG2_KBPS{0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160};
+    constexpr std::array<std::uint32_t, 3> MPEG1_RATES{44100, 48000, 32000};
+
+    std::uint8_t byte_at(std::span<std::byte const> bytes, std::size_t offset) {
+        return std::to_integer<std::uint8_t>(bytes[offset]);
+    }
+
+    /// Parses the layer III frame header at `offset`, if there is a whole
+    /// frame there.
+    std::optional<FrameHeader> parse_header(std::span<std::byte const> bytes, std::size_t offset) {
+        if (offset + 4 > bytes.size()) {
+            return std::nullopt;
+        }
+
+        std::uint8_t const b1 = byte_at(bytes, offset + 1);
+        std::uint8_t const b2 = byte_at(bytes, offset + 2);
+        std::uint8_t const b3 = byte_at(bytes, offset + 3);
+        if (byte_at(bytes, offset) != 0xFF || (b1 & 0xE0) != 0xE0) {
+            return std::nullopt;
+        }
+
+        // Version 1 is reserved, layer 1 in the header is layer III
+        std::uint32_t const version       = (b1 >> 3) & 3;
+        std::uint32_t const layer         = (b1 >> 1) & 3;
+        std::uint32_t const bitrate_index = b2 >> 4;
+        std::uint32_t const rate_index    = (b2 >> 2) & 3;
+        if (version == 1 || layer != 1 || bitrate_index == 0 || bitrate_index == 15 || rate_index == 3) {
+            return std::nullopt;
+        }
+
+        bool const mpeg1         = version == 3;
+        bool const mono          = (b3 >> 6) == 3;
+        bool const has_crc       = (b1 & 1) == 0;
+        std::uint32_t const kbps = mpeg1 ? MPEG1_KBPS[bitrate_index] : MPEG2_KBPS[bitrate_index];
+
+        // MPEG 2 halves the MPEG 1 rates and MPEG 2.5 quarters them
+        FrameHeader header;
+        header.mpeg1            = mpeg1;
+        header.sample_rate      = MPEG1_RATES[rate_index] >> (mpeg1 ? 0 : version == 2 ? 1 : 2);
+        header.samples          = mpeg1 ? 1152 : 576;
+        header.length           = header.samples / 8 * kbps * 1000 / header.sample_rate + ((b2 >> 1) & 1);
+        header.side_info_offset = has_crc ? 6 : 4;
+        header.side_info_bytes  = mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+
+        if (header.length < header.side_info_offset + header.side_info_bytes || offset + header.length > bytes.size()) {
+            return std::nullopt;
+        }
+        return header;
+    }
+
+    /// Skips an ID3v2 tag at the start of the file.
+    std::size_t skip_id3v2(std::span<std::byte const> bytes) {
+        if (bytes.size() < 10 || byte_at(bytes, 0) != 'I' || byte_at(bytes, 1) != 'D' || byte_at(bytes, 2) != '3') {
+            return 0;
+        }
+
+        // The size is seven bits per byte, without the header and footer
+        std::size_t size = 0;
+        for (std::size_t i = 6; i < 10; ++i) {
+            size = (size << 7) | (byte_at(bytes, i) & 0x7F);
+        }
+        bool const has_footer = (byte_at(bytes, 5) & 0x10) != 0;
+        return std::min(bytes.size(), 10 + size + (has_footer ? 10 : 0));
+    }
+
+    /// The first frame from `first` on that decodes when decoding starts
+    /// at `first`, `last + 1` if none up to `last` does. A frame decodes
+    /// once the reservoir holds all the bytes it borrows from before its
+    /// header; until then the decoder keeps the main data it was given.
+    std::size_t first_decoded(std::span<FrameInfo const> frames, std::size_t first, std::size_t last) {
+        std::uint32_t reservoir = 0;
+        for (std::size_t i = first; i <= last; ++i) {
+            if (frames[i].main_data_begin <= reservoir) {
+                return i;
+            }
+            reservoir = std::min(
+                MAX_RESERVOIR_BYTES, std::min(reservoir, frames[i].main_data_begin) + frames[i].main_data_bytes);
+        }
+        return last + 1;
+    }
+
+    std::optional<FileStamp> stamp_of(std::string const& file_name) {
+        std::error_code error;
+        auto const size     = std::filesystem::file_size(file_name, error);
+        auto const modified = std::filesystem::last_write_time(file_name, error);
+        if (error) {
+            return std::nullopt;
+        }
+        return FileStamp{size, static_cast<std::int64_t>(modified.time_since_epoch().count())};
+    }
+} // namespace
+
+namespace wt {
+
+    SeekPoint const* SeekIndex::find(std::uint64_t frame) const {
+        auto const after =
+            std::ranges::upper_bound(points, frame, std::less<>{}, [](SeekPoint const& point) { return point.frame; });
+        return after == points.begin() ? nullptr : &*std::prev(after);
+    }
+
+    std::optional<SeekIndex> scan_mp3(std::span<std::byte const> bytes, std::uint32_t frames_per_point) {
+        std::size_t offset = skip_id3v2(bytes);
+
+        // Junk before the first frame is common, take the first header
+        // followed by another matching one as the start of the stream
+        std::size_t const sync_limit = std::min(bytes.size(), offset + MAX_SYNC_BYTES);
+        std::optional<FrameHeader> first;
+        for (; offset < sync_limit; ++offset) {
+            first = parse_header(bytes, offset);
+            if (!first) {
+                continue;
+            }
+
+            auto const next = parse_header(bytes, offset + first->length);
+            if (next && next->sample_rate == first->sample_rate && next->samples == first->samples) {
+                break;
+            }
+            first.reset();
+        }
+        if (!first) {
+            return std::nullopt;
+        }
+
+        // Then walk the frames back to back until the stream ends, at
+        // trailing tags or a truncated last frame
+        std::vector<FrameInfo> frames;
+        while (auto const header = parse_header(bytes, offset)) {
+            if (header->sample_rate != first->sample_rate || header->samples != first->samples) {
+                break;
+            }
+
+            // main_data_begin opens the side info, 9 bits in MPEG 1, 8 after
+            std::size_t const side_info = offset + header->side_info_offset;
+            std::uint32_t begin         = byte_at(bytes, side_info);
+            if (header->mpeg1) {
+                begin = (begin << 1) | (byte_at(bytes, side_info + 1) >> 7);
+            }
+            auto const main_bytes =
+                static_cast<std::uint32_t>(header->length - header->side_info_offset - header->side_info_bytes);
+
+            frames.push_back(FrameInfo{offset, begin, main_bytes});
+            offset += header->length;
+        }
+
+        SeekIndex index{first->sample_rate, frames.size() * first->samples, {}};
+        std::size_t const step = std::max<std::uint32_t>(frames_per_point, 1);
+        for (std::size_t target = 0; target < frames.size(); target += step) {
+            // Start as late as possible while still decoding by the target
+            for (std::size_t start = target; target - start <= MAX_LEAD_FRAMES; --start) {
+                std::size_t const decoded = first_decoded(frames, start, target);
+                if (decoded <= target) {
+                    SeekPoint const point{decoded * first->samples, frames[start].offset};
+                    if (index.points.empty() || index.points.back().frame < point.frame) {
+                        index.points.push_back(point);
+                    }
+                    break;
+                }
+                if (start == 0) {
+                    break;
+                }
+            }
+        }
+
+        return index;
+    }
+
+    std::string seek_index_path(std::string const& file_name) {
+        return file_name + ".wtsk";
+    }
+
+    bool write_seek_index(SeekIndex const& index, std::string const& file_name) {
+        auto const stamp = stamp_of(file_name);
+        if (!stamp) {
+            return false;
+        }
+
+        std::ofstream file{seek_index_path(file_name), std::ios::binary | std::ios::trunc};
+        if (!file) {
+            return false;
+        }
+
+        // clang-format off
+        FileHeader const header{
+          .magic         = FILE_MAGIC,
+          .version       = FILE_VERSION,
+          .sample_rate   = index.sample_rate,
+          .reserved      = 0,
+          .file_size     = stamp->size,
+          .file_modified = stamp->modified,
+          .frames        = index.frames,
+          .points        = index.points.size()
+        };
+        // clang-format on
+
+        file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        file.write(reinterpret_cast<char const*>(index.points.data()),
+            static_cast<std::streamsize>(index.points.size() * sizeof(SeekPoint)));
+        return static_cast<bool>(file);
+    }
+
+    std::optional<SeekIndex> read_seek_index(std::string const& file_name) {
+        auto const stamp = stamp_of(file_name);
+        if (!stamp) {
+            return std::nullopt;
+        }
+
+        auto const index_path = seek_index_path(file_name);
+        std::ifstream file{index_path, std::ios::binary};
+        FileHeader header{};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            return std::nullopt;
+        }
+        if (header.magic != FILE_MAGIC || header.version != FILE_VERSION || header.file_size != stamp->size
+            || header.file_modified != stamp->modified) {
+            return std::nullopt;
+        }
+
+        // The count is only trusted as far as the index file backs it. This
+        // runs in the background, where a failed allocation would escape
+        // the future rather than fall back to scanning.
+        std::error_code error;
+        auto const index_size = std::filesystem::file_size(index_path, error);
+        if (error || index_size < sizeof(header)
+            || header.points > (index_size - sizeof(header)) / sizeof(SeekPoint)) {
+            return std::nullopt;
+        }
+
+        SeekIndex index{header.sample_rate, header.frames, std::vector<SeekPoint>(header.points)};
+        if (!file.read(reinterpret_cast<char*>(index.points.data()),
+                static_cast<std::streamsize>(index.points.size() * sizeof(SeekPoint)))) {
+            return std::nullopt;
+        }
+        return index;
+    }
+
+    std::shared_ptr<SeekIndex const> load_seek_index(std::string const& file_name) {
+        if (auto index = read_seek_index(file_name)) {
+            return std::make_shared<SeekIndex const>(std::move(*index));
+        }
+
+        auto const file = MappedFile::open(file_name);
+        if (!file) {
+            return nullptr;
+        }
+
+        auto index = scan_mp3(file->bytes());
+        if (!index) {
+            return nullptr;
+        }
+
+        // Not being able to keep it, say in a read-only library, only
+        // means scanning again next time
+        write_seek_index(*index, file_name);
+        return std::make_shared<SeekIndex const>(std::move(*index));
+    }
+} // namespace wt
@@ -0,0 +1,69 @@
+#ifndef SEEK_INDEX_H
+#define SEEK_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace wt {
+
+    /// @brief A place a decoder can start decoding from: opened on the file
+    /// at `byte_offset`, the first frame it outputs is frame `frame` of the
+    /// whole track.
+    struct SeekPoint {
+        std::uint64_t frame;
+        std::uint64_t byte_offset;
+
+        bool operator==(SeekPoint const&) const = default;
+    };
+
+    /// @brief Seek points spread through a compressed file, so that a seek
+    /// decodes from the nearest point instead of from the start.
+    struct SeekIndex {
+        /// @brief The rate of the frames counted by the points.
+        std::uint32_t sample_rate;
+        /// @brief Frames in the whole track.
+        std::uint64_t frames;
+        /// @brief In increasing order of frame and offset.
+        std::vector<SeekPoint> points;
+
+        /// @brief The last point at or before `frame`, null if there is none.
+        [[nodiscard]] SeekPoint const* find(std::uint64_t frame) const;
+    };
+
+    /// @brief Builds the index of an MPEG layer III stream from its frame
+    /// headers and side info alone, without decoding any audio.
+    ///
+    /// A decoder starting mid-stream outputs nothing for frames whose bit
+    /// reservoir reaches back before its start. Each point starts a few
+    /// frames early and counts from the first frame that does decode, so
+    /// the frame it names is exact.
+    /// @param bytes the whole file, ID3v2 tags are skipped.
+    /// @param frames_per_point how many MP3 frames apart the points are.
+    /// @return the index, or nothing if `bytes` holds no layer III stream.
+    std::optional<SeekIndex> scan_mp3(std::span<std::byte const> bytes, std::uint32_t frames_per_point = 8);
+
+    /// @brief Where the index of `file_name` is kept, next to the file.
+    std::string seek_index_path(std::string const& file_name);
+
+    /// @brief Writes `index` for `file_name`, stamped with the file's size
+    /// and modification time.
+    bool write_seek_index(SeekIndex const& index, std::string const& file_name);
+
+    /// @brief Reads the index kept for `file_name`.
+    /// @return the index, or nothing if there is none or the file changed
+    /// since it was written.
+    std::optional<SeekIndex> read_seek_index(std::string const& file_name);
+
+    /// @brief Reads the index kept for `file_name`, or scans the file and
+    /// keeps the index next to it for next time. Blocking, meant for a
+    /// background thread.
+    /// @return the index, or null if the file is not one we index.
+    std::shared_ptr<SeekIndex const> load_seek_index(std::string const& file_name);
+} // namespace wt
+
+#endif // SEEK_INDEX_H
@@ -0,0 +1,289 @@
+#include "streaming_decoder.hpp"
+
+#include <gsl/assert>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+
+    constexpr std::uint64_t NO_SEEK         = std::numeric_limits<std::uint64_t>::max();
+    constexpr std::uint32_t SKIP_CHUNK_SIZE = 4096;
+
+    wt::RingBufferPtr make_fifo(ma_format format, ma_uint32 channels, ma_uint32 frames) {
+        wt::RingBufferPtr fifo{new ma_pcm_rb, [](ma_pcm_rb* ptr) {
+                                   ma_pcm_rb_uninit(ptr);
+                                   delete ptr;
+                               }};
+
+        if (ma_pcm_rb_init(format, channels, frames, nullptr, nullptr, fifo.get()) != MA_SUCCESS) {
+            delete fifo.release();
+            throw std::runtime_error{"could not initialise the decode fifo"};
+        }
+        return fifo;
+    }
+} // namespace
+
+namespace wt {
+
+    StreamingDecoder::StreamingDecoder(DecoderPtr decoder, std::uint32_t fifo_frames)
+        : _decoder{std::move(decoder)},
+          _format{_decoder->outputFormat, _decoder->outputChannels, _decoder->outputSampleRate},
+          _fifo{make_fifo(_format.format, _format.channels, fifo_frames)},
+          _capacity{fifo_frames},
+          _frame_bytes{ma_get_bytes_per_frame(_format.format, _format.channels)},
+          _decoder_at_end{false},
+          _low_watermark{fifo_frames},
+          _underruns{0},
+          _position{0},
+          _seek_to{NO_SEEK},
+          _seek_primer{0},
+          _seeking{false},
+          _flush_epoch{0},
+          _flushed_epoch{0},
+          _flush_position{0},
+          _refilling{false} {
+        Expects(fifo_frames > 0);
+    }
+
+    StreamingDecoder::~StreamingDecoder() {
+        if (_thread.joinable()) {
+            _thread.request_stop();
+            _thread.join();
+        }
+    }
+
+    void StreamingDecoder::start() {
+        Expects(!_thread.joinable());
+
+        _fill();
+        _thread = std::jthread{[this](std::stop_token stop) { _run(stop); }};
+    }
+
+    void StreamingDecoder::use_seek_index(
+        std::shared_future<std::shared_ptr<SeekIndex const>> index, Reopen reopen) {
+        Expects(!_thread.joinable());
+
+        _index  = std::move(index);
+        _reopen = std::move(reopen);
+    }
+
+    std::uint32_t StreamingDecoder::read(void* output, std::uint32_t frames, float gain) {
+        Expects(output != nullptr);
+
+        take_seek();
+
+        std::size_t const available = ma_pcm_rb_available_read(_fifo.get());
+        if (available < _low_watermark.load(std::memory_order_relaxed)) {
+            _low_watermark.store(available, std::memory_order_relaxed);
+        }
+
+        // The FIFO may wrap, so this takes at most two copies
+        std::uint32_t copied = 0;
+        while (copied < frames) {
+            ma_uint32 chunk = frames - copied;
+            void* source    = nullptr;
+            if (ma_pcm_rb_acquire_read(_fifo.get(), &chunk, &source) != MA_SUCCESS || chunk == 0) {
+                break;
+            }
+
+            copy_with_gain(format(), static_cast<std::uint8_t*>(output) + copied * _frame_bytes, source,
+                chunk * channels(), gain);
+            ma_pcm_rb_commit_read(_fifo.get(), chunk);
+            copied += chunk;
+        }
+
+        // Coming up short while refilling after a seek is expected
+        _refilling = _refilling && copied < frames;
+        if (copied < frames && !_refilling && !_decoder_at_end.load(std::memory_order_acquire)) {
+            _underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        _position.store(_position.load(std::memory_order_relaxed) + copied, std::memory_order_relaxed);
+        return copied;
+    }
+
+    bool StreamingDecoder::finished() const {
+        // A pending seek may bring an ended track back
+        if (_seek_to.load() != NO_SEEK || _seeking.load()) {
+            return false;
+        }
+        return _decoder_at_end.load(std::memory_order_acquire) && ma_pcm_rb_available_read(_fifo.get()) == 0;
+    }
+
+    bool StreamingDecoder::seek(std::uint64_t frame, std::uint32_t primer_frames) {
+        _seek_primer.store(primer_frames, std::memory_order_relaxed);
+        _seek_to.store(frame);
+        {
+            // Taking the lock means the decode thread is either before its
+            // check for seeks or already waiting, so it cannot miss this
+            std::scoped_lock lock{_wake_mutex};
+        }
+        _wake.notify_one();
+        return true;
+    }
+
+    void StreamingDecoder::take_seek() {
+        // A seek is ready: everything still buffered is from before it.
+        // The decode thread is waiting on us, so the FIFO holds still.
+        std::uint64_t const epoch = _flush_epoch.load(std::memory_order_acquire);
+        if (epoch != _flushed_epoch.load(std::memory_order_relaxed)) {
+            ma_pcm_rb_seek_read(_fifo.get(), ma_pcm_rb_available_read(_fifo.get()));
+            _primer    = _primers[epoch & 1];
+            _refilling = true;
+            _position.store(_flush_position.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            _flushed_epoch.store(epoch, std::memory_order_release);
+        }
+    }
+
+    std::span<std::byte const> StreamingDecoder::take_primer() {
+        return std::exchange(_primer, {});
+    }
+
+    std::uint64_t StreamingDecoder::position() const {
+        return _position.load(std::memory_order_relaxed);
+    }
+
+    FifoWatermark StreamingDecoder::watermark() const {
+        // clang-format off
+        return FifoWatermark{
+          .capacity_frames      = _capacity,
+          .fill_frames          = ma_pcm_rb_available_read(_fifo.get()),
+          .low_watermark_frames = _low_watermark.load(std::memory_order_relaxed),
+          .underruns            = _underruns.load(std::memory_order_relaxed)
+        };
+        // clang-format on
+    }
+
+    void StreamingDecoder::reset_watermark() {
+        _low_watermark.store(_capacity, std::memory_order_relaxed);
+        _underruns.store(0, std::memory_order_relaxed);
+    }
+
+    ma_format StreamingDecoder::format() const {
+        return _format.format;
+    }
+
+    std::uint32_t StreamingDecoder::channels() const {
+        return _format.channels;
+    }
+
+    std::uint32_t StreamingDecoder::sample_rate() const {
+        return _format.sample_rate;
+    }
+
+    std::uint32_t StreamingDecoder::_fill() {
+        std::uint32_t written = 0;
+        while (!_decoder_at_end.load(std::memory_order_relaxed)) {
+            ma_uint32 frames  = _capacity;
+            void* destination = nullptr;
+            if (ma_pcm_rb_acquire_write(_fifo.get(), &frames, &destination) != MA_SUCCESS || frames == 0) {
+                break;
+            }
+
+            ma_uint64 decoded      = 0;
+            ma_result const result = ma_decoder_read_pcm_frames(_decoder.get(), destination, frames, &decoded);
+            ma_pcm_rb_commit_write(_fifo.get(), static_cast<ma_uint32>(decoded));
+            written += static_cast<std::uint32_t>(decoded);
+
+            // Decoding errors end the stream as well, there is nobody to retry
+            if (result != MA_SUCCESS || decoded == 0) {
+                _decoder_at_end.store(true, std::memory_order_release);
+            }
+        }
+
+        return written;
+    }
+
+    void StreamingDecoder::_seek(std::uint64_t target, std::uint32_t primer_frames, std::stop_token const& stop) {
+        std::uint64_t const first = target - std::min<std::uint64_t>(target, primer_frames);
+        bool const landed         = _seek_decoder(first);
+
+        std::uint64_t const epoch = _flush_epoch.load(std::memory_order_relaxed) + 1;
+        auto& primer              = _primers[epoch & 1];
+        primer.resize((target - first) * _frame_bytes);
+
+        ma_uint64 decoded = 0;
+        if (landed) {
+            ma_decoder_read_pcm_frames(_decoder.get(), primer.data(), target - first, &decoded);
+        }
+        primer.resize(decoded * _frame_bytes);
+
+        // A decoder that could not seek is left wherever it is, end the
+        // track rather than play from there
+        _decoder_at_end.store(!landed || decoded < target - first, std::memory_order_release);
+        _flush_position.store(target, std::memory_order_relaxed);
+        _flush_epoch.store(epoch, std::memory_order_release);
+
+        // The device thread only flushes on its next callback, a period away
+        std::unique_lock lock{_wake_mutex};
+        while (!stop.stop_requested() && _flushed_epoch.load(std::memory_order_acquire) != epoch) {
+            _wake.wait_for(lock, stop, std::chrono::milliseconds{1}, [] { return false; });
+        }
+    }
+
+    bool StreamingDecoder::_seek_decoder(std::uint64_t frame) {
+        bool const index_ready =
+            _reopen && _index.valid() && _index.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
+        if (index_ready && _index.get()) {
+            // The index counts frames at the file's rate, the decoder may
+            // be resampling to another
+            auto const& index            = *_index.get();
+            std::uint64_t const in_frame = frame * index.sample_rate / _format.sample_rate;
+            if (auto const* point = index.find(in_frame)) {
+                if (auto decoder = _reopen(point->byte_offset, _format)) {
+                    _decoder = std::move(decoder);
+                    return _skip((in_frame - point->frame) * _format.sample_rate / index.sample_rate);
+                }
+            }
+        }
+
+        return ma_decoder_seek_to_pcm_frame(_decoder.get(), frame) == MA_SUCCESS;
+    }
+
+    bool StreamingDecoder::_skip(std::uint64_t frames) {
+        _scratch.resize(std::size_t{SKIP_CHUNK_SIZE} * _frame_bytes);
+        while (frames > 0) {
+            ma_uint64 const chunk = std::min<std::uint64_t>(frames, SKIP_CHUNK_SIZE);
+            ma_uint64 decoded     = 0;
+            if (ma_decoder_read_pcm_frames(_decoder.get(), _scratch.data(), chunk, &decoded) != MA_SUCCESS
+                || decoded == 0) {
+                return false;
+            }
+            frames -= decoded;
+        }
+        return true;
+    }
+
+    void StreamingDecoder::_run(std::stop_token const& stop) {
+        // Wake up often enough to top the FIFO up before a quarter of it
+        // has been played, but never busy spin on tiny FIFOs
+        auto const fifo_duration = std::chrono::microseconds{1'000'000ull * _capacity / sample_rate()};
+        auto const interval      = std::max<std::chrono::microseconds>(fifo_duration / 4, std::chrono::milliseconds{1});
+
+        // Keeps running at the end of the track, a seek can bring it back
+        while (!stop.stop_requested()) {
+            if (_seek_to.load() != NO_SEEK) {
+                // Only this thread clears the request, so it is still there
+                _seeking.store(true);
+                std::uint64_t const target = _seek_to.exchange(NO_SEEK);
+                _seek(target, _seek_primer.load(std::memory_order_relaxed), stop);
+                _seeking.store(false);
+            }
+
+            if (!_decoder_at_end.load(std::memory_order_relaxed)) {
+                _fill();
+            }
+
+            std::unique_lock lock{_wake_mutex};
+            _wake.wait_for(lock, stop, interval, [this] { return _seek_to.load() != NO_SEEK; });
+        }
+    }
+} // namespace wt
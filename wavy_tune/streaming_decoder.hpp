@@ -0,0 +1,133 @@
+#ifndef STREAMING_DECODER_H
+#define STREAMING_DECODER_H
+
+#include "audio_source.hpp"
+#include "seek_index.hpp"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace wt {
+
+    /// @brief Decodes a file on a background thread into a FIFO of PCM
+    /// frames, in the decoder's output format, that the device callback
+    /// drains without ever touching the decoder.
+    class StreamingDecoder : public AudioSource {
+    public:
+        /// @brief Opens a new decoder on the same file, starting at a byte
+        /// offset and producing `format`. Returns null on failure.
+        using Reopen = std::function<DecoderPtr(std::uint64_t byte_offset, PcmFormat const& format)>;
+
+        /// @param decoder an initialised decoder, owned from now on.
+        /// @param fifo_frames how many frames to keep decoded ahead.
+        StreamingDecoder(DecoderPtr decoder, std::uint32_t fifo_frames);
+        ~StreamingDecoder() override;
+
+        StreamingDecoder(StreamingDecoder const&)            = delete;
+        StreamingDecoder& operator=(StreamingDecoder const&) = delete;
+
+        /// @brief Fills the FIFO on the calling thread, then starts the
+        /// background decode thread to keep it topped up.
+        void start() override;
+
+        /// @brief Copies up to `frames` frames out of the FIFO, scaling them
+        /// by `gain` in the same pass. Only call this from the device
+        /// thread, it never blocks or allocates.
+        /// @return the number of frames copied.
+        std::uint32_t read(void* output, std::uint32_t frames, float gain) override;
+
+        /// @brief Whether the decoder hit the end and the FIFO is drained.
+        [[nodiscard]] bool finished() const override;
+
+        /// @brief Lets seeks start decoding from the nearest point of an
+        /// index rather than leave the decoder to find the frame, which for
+        /// some formats means decoding everything before it. Call it before
+        /// `start`; seeks fall back to the decoder until the index is ready.
+        /// @param index the index, possibly still being built.
+        /// @param reopen opens the file at the index's byte offsets.
+        void use_seek_index(std::shared_future<std::shared_ptr<SeekIndex const>> index, Reopen reopen);
+
+        /// @brief Hands the seek to the decode thread. Once it has decoded
+        /// the primer, the device thread drops the frames still buffered
+        /// from the old position and reads are short until the FIFO refills.
+        bool seek(std::uint64_t frame, std::uint32_t primer_frames) override;
+        void take_seek() override;
+        std::span<std::byte const> take_primer() override;
+        [[nodiscard]] std::uint64_t position() const override;
+
+        [[nodiscard]] FifoWatermark watermark() const override;
+        void reset_watermark() override;
+
+        [[nodiscard]] ma_format format() const override;
+        [[nodiscard]] std::uint32_t channels() const override;
+        [[nodiscard]] std::uint32_t sample_rate() const override;
+
+    private:
+        /// Decodes into the free part of the FIFO, returns the frames written.
+        std::uint32_t _fill();
+
+        /// Moves the decoder to `target`, decodes the primer and waits for
+        /// the device thread to flush the FIFO. Decode thread only.
+        void _seek(std::uint64_t target, std::uint32_t primer_frames, std::stop_token const& stop);
+
+        /// Points the decoder at `frame`, through the index if it is ready.
+        bool _seek_decoder(std::uint64_t frame);
+
+        /// Decodes and drops `frames` frames.
+        bool _skip(std::uint64_t frames);
+
+        void _run(std::stop_token const& stop);
+
+        DecoderPtr _decoder;
+        // The decoder is replaced when seeking through the index, so the
+        // other threads go by this copy of its format
+        PcmFormat _format;
+        RingBufferPtr _fifo;
+        std::uint32_t _capacity;
+        std::uint32_t _frame_bytes;
+
+        std::atomic_bool _decoder_at_end;
+        std::atomic<std::size_t> _low_watermark;
+        std::atomic<std::uint64_t> _underruns;
+        std::atomic<std::uint64_t> _position;
+
+        std::shared_future<std::shared_ptr<SeekIndex const>> _index;
+        Reopen _reopen;
+
+        // A seek asked for and not yet taken by the decode thread, and
+        // whether the decode thread is in the middle of one
+        std::atomic<std::uint64_t> _seek_to;
+        std::atomic<std::uint32_t> _seek_primer;
+        std::atomic_bool _seeking;
+
+        // The decode thread bumps the flush epoch once a seek's primer is
+        // ready and writes nothing until the device thread has dropped the
+        // old frames and acknowledged the epoch. Primers alternate between
+        // two buffers so the next seek never writes the one being read.
+        std::atomic<std::uint64_t> _flush_epoch;
+        std::atomic<std::uint64_t> _flushed_epoch;
+        std::atomic<std::uint64_t> _flush_position;
+        std::array<std::vector<std::byte>, 2> _primers;
+        std::vector<std::byte> _scratch;
+
+        // Only touched by the device thread
+        std::span<std::byte const> _primer;
+        bool _refilling;
+
+        std::mutex _wake_mutex;
+        std::condition_variable_any _wake;
+        std::jthread _thread;
+    };
+} // namespace wt
+
+#endif // STREAMING_DECODER_H